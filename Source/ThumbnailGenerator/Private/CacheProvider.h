@@ -1,94 +1,117 @@
 // Copyright Mans Isaksson. All Rights Reserved.
 
 #pragma once
-#include "Framework/Application/SlateApplication.h"
-
+#include "CoreMinimal.h"
+#include "UObject/GCObject.h"
+#include "Containers/SparseArray.h"
+
+// Size-aware LRU cache of UObjects.
+// Entries are stored in a sparse array (stable indices) and linked together in an intrusive doubly-linked list ordered by
+// recency, which makes touch, insert and evict O(1). Inserting an item evicts the least recently used entries until the
+// total memory footprint is back under MaxCacheSize().
 template<typename HashableKey, typename UObjectValue>
 struct TCacheProvider : public FGCObject
 {
-public:
+private:
 	struct FCacheEntry
 	{
-		float LastAccessed;
-		int64 MemoryFootprint;
+		HashableKey              Key;
+		TObjectPtr<UObjectValue> Object          = nullptr;
+		uint64                   LastAccessed    = 0; // Value of AccessCounter at the last access, higher is more recent
+		int64                    MemoryFootprint = 0;
+		int32                    Prev            = INDEX_NONE; // Towards the most recently used entry
+		int32                    Next            = INDEX_NONE; // Towards the least recently used entry
 	};
-	TMap<HashableKey, FCacheEntry>              CacheEntries;
-	TMap<HashableKey, TObjectPtr<UObjectValue>> CacheTable; // GC:d table using AddReferencedObjects
 
+	TSparseArray<FCacheEntry> CacheEntries; // GC:d using AddReferencedObjects
+	TMap<HashableKey, int32>  CacheLookup;  // Key -> Index into CacheEntries
+
+	int32 MostRecentlyUsed  = INDEX_NONE;
+	int32 LeastRecentlyUsed = INDEX_NONE;
+
+	uint64 AccessCounter        = 0;
 	uint64 TotalMemoryFootprint = 0;
 
 public:
 
-	void ClearCache() 
-	{ 
-		for (const auto& CacheObjectPair : CacheTable)
-			if (IsValid(CacheObjectPair.Value))
-				OnItemRemovedFromCache(CacheObjectPair.Value);
+	virtual ~TCacheProvider() = default;
+
+	void ClearCache()
+	{
+		for (const FCacheEntry& CacheEntry : CacheEntries)
+		{
+			if (IsValid(CacheEntry.Object))
+				OnItemRemovedFromCache(CacheEntry.Object);
+			OnKeyRemovedFromCache(CacheEntry.Key);
+		}
+
+		CacheEntries.Empty();
+		CacheLookup.Empty();
+		MostRecentlyUsed     = INDEX_NONE;
+		LeastRecentlyUsed    = INDEX_NONE;
+		TotalMemoryFootprint = 0;
 
-		CacheEntries.Empty(); 
-		CacheTable.Empty(); 
-		TotalMemoryFootprint = 0; 
+		OnMemoryFootprintChanged();
 	}
 
 	void CacheItem(const HashableKey& Key, UObjectValue* InObject)
 	{
 		const auto CacheSize = MaxCacheSize();
-		if (CacheSize <= 0)
+		if (CacheSize <= 0 || !IsValid(InObject))
 			return;
 
 		const auto DataSize = GetItemDataFootprint(InObject);
 
 		// Reserve the expected number of slots required
-		if (CacheEntries.Num() == 0)
+		if (CacheEntries.Num() == 0 && DataSize > 0)
 		{
 			const auto ReserveSize = CacheSize / DataSize;
 			CacheEntries.Reserve(ReserveSize);
-			CacheTable.Reserve(ReserveSize);
+			CacheLookup.Reserve(ReserveSize);
+		}
+
+		int32 EntryIndex = INDEX_NONE;
+		if (const int32* ExistingIndex = CacheLookup.Find(Key))
+		{
+			EntryIndex = *ExistingIndex;
+
+			FCacheEntry& CacheEntry = CacheEntries[EntryIndex];
+			if (CacheEntry.Object != InObject && IsValid(CacheEntry.Object))
+				OnItemRemovedFromCache(CacheEntry.Object);
+
+			TotalMemoryFootprint -= CacheEntry.MemoryFootprint;
+			CacheEntry.Object          = InObject;
+			CacheEntry.MemoryFootprint = DataSize;
+
+			Unlink(EntryIndex);
+		}
+		else
+		{
+			FCacheEntry NewEntry;
+			NewEntry.Key             = Key;
+			NewEntry.Object          = InObject;
+			NewEntry.MemoryFootprint = DataSize;
+
+			EntryIndex = CacheEntries.Add(MoveTemp(NewEntry));
+			CacheLookup.Add(Key, EntryIndex);
 		}
 
-		CacheEntries.Add(Key, FCacheEntry{ (float)FSlateApplication::Get().GetCurrentTime(), DataSize });
-		CacheTable.Add(Key, InObject);
+		LinkAsMostRecent(EntryIndex);
+		CacheEntries[EntryIndex].LastAccessed = ++AccessCounter;
 
 		TotalMemoryFootprint += DataSize;
 
 		UE_LOG(LogThumbnailGenerator, Verbose, TEXT("%s: Add object %s of size %f (MB) to cache"), *DebugCacheName(), *InObject->GetName(), float(DataSize / 1000000.f));
 		UE_LOG(LogThumbnailGenerator, Verbose, TEXT("%s: Total cache size: %f (MB)"), *DebugCacheName(), float(TotalMemoryFootprint / 1000000.f));
 
-		// Clear out old cache
-		if (TotalMemoryFootprint > CacheSize && CacheEntries.Num() > 1)
+		// Clear out old cache. Never evict the item we just added, the caller is about to use it.
+		while (TotalMemoryFootprint > uint64(CacheSize) && LeastRecentlyUsed != INDEX_NONE && LeastRecentlyUsed != EntryIndex)
 		{
-			HashableKey  OldestKey;
-			FMemory::Memzero(&OldestKey, sizeof(HashableKey));
-			FCacheEntry* OldestCacheEntry = nullptr;
-			for (auto It = CacheEntries.CreateIterator(); It; ++It)
-			{
-				const auto OldestTime = OldestCacheEntry ? OldestCacheEntry->LastAccessed : -1.f;
-				if (It.Value().LastAccessed > OldestTime)
-				{
-					OldestCacheEntry = &It.Value();
-					OldestKey        = It.Key();
-				}
-			}
-
-			if (OldestCacheEntry)
-			{
-				UE_LOG(LogThumbnailGenerator, Verbose, TEXT("%s: Clear out object of size %f (MB)"), *DebugCacheName(), float(OldestCacheEntry->MemoryFootprint / 1000000.f));
-
-				TotalMemoryFootprint -= OldestCacheEntry->MemoryFootprint;
-				CacheEntries.Remove(OldestKey);
-
-				// Run cleanup on cached object
-				if (TObjectPtr<UObjectValue>* OldCachedObject = CacheTable.Find(OldestKey))
-				{
-					if (IsValid(*OldCachedObject))
-					{
-						UE_LOG(LogThumbnailGenerator, Verbose, TEXT("%s: Remove cached object %s"), *DebugCacheName(), *(*OldCachedObject)->GetName());
-						OnItemRemovedFromCache(*OldCachedObject);
-					}
-				}
-				CacheTable.Remove(OldestKey);
-			}
+			UE_LOG(LogThumbnailGenerator, Verbose, TEXT("%s: Clear out object of size %f (MB)"), *DebugCacheName(), float(CacheEntries[LeastRecentlyUsed].MemoryFootprint / 1000000.f));
+			RemoveEntry(LeastRecentlyUsed, true);
 		}
+
+		OnMemoryFootprintChanged();
 	}
 
 	UObjectValue* GetCachedItem(const HashableKey& Key)
@@ -96,27 +119,51 @@ public:
 		if (MaxCacheSize() <= 0)
 			return nullptr;
 
-		if (FCacheEntry* CacheEntry = CacheEntries.Find(Key))
+		if (const int32* EntryIndex = CacheLookup.Find(Key))
 		{
-			TObjectPtr<UObjectValue>* CachedObject = CacheTable.Find(Key);
-			
+			const int32 Index = *EntryIndex;
+			FCacheEntry& CacheEntry = CacheEntries[Index];
+
 			// Double check that the object has not been destroyed
-			if (!CachedObject || !IsValid(*CachedObject))
+			if (!IsValid(CacheEntry.Object))
 			{
-				CacheEntries.Remove(Key);
-				CacheTable.Remove(Key);
+				RemoveEntry(Index, false);
 				return nullptr;
 			}
 
-			UE_LOG(LogThumbnailGenerator, Verbose, TEXT("%s: Fetched object %s from cache"), *DebugCacheName(), *(*CachedObject)->GetName());
+			UE_LOG(LogThumbnailGenerator, Verbose, TEXT("%s: Fetched object %s from cache"), *DebugCacheName(), *CacheEntry.Object->GetName());
+
+			CacheEntry.LastAccessed = ++AccessCounter;
+			if (MostRecentlyUsed != Index)
+			{
+				Unlink(Index);
+				LinkAsMostRecent(Index);
+			}
 
-			CacheEntry->LastAccessed = (float)FSlateApplication::Get().GetCurrentTime();
-			return *CachedObject;
+			return CacheEntry.Object;
 		}
 
 		return nullptr;
 	}
 
+	/** Removes a single item from the cache, returns true if the item was found. */
+	bool RemoveCachedItem(const HashableKey& Key)
+	{
+		if (const int32* EntryIndex = CacheLookup.Find(Key))
+		{
+			RemoveEntry(*EntryIndex, true);
+			return true;
+		}
+		return false;
+	}
+
+	/** Returns true if the key is in the cache, without affecting its recency. */
+	FORCEINLINE bool IsItemCached(const HashableKey& Key) const { return CacheLookup.Contains(Key); }
+
+	FORCEINLINE int32 NumCachedItems() const { return CacheEntries.Num(); }
+
+	FORCEINLINE uint64 GetTotalMemoryFootprint() const { return TotalMemoryFootprint; }
+
 	virtual int32 MaxCacheSize() = 0;
 
 	virtual int32 GetItemDataFootprint(UObjectValue* InObject) = 0;
@@ -125,8 +172,75 @@ public:
 
 	virtual void OnItemRemovedFromCache(UObjectValue* InObject) {}
 
+	// Called whenever a key leaves the cache, regardless of whether its object is still valid
+	virtual void OnKeyRemovedFromCache(const HashableKey& Key) {}
+
+	// Called after items have been added or removed, used to report memory stats
+	virtual void OnMemoryFootprintChanged() {}
+
 	// ~Begin: FGCObject Interface
-	virtual void AddReferencedObjects(FReferenceCollector& Collector) override { Collector.AddReferencedObjects(CacheTable); }
+	virtual void AddReferencedObjects(FReferenceCollector& Collector) override
+	{
+		for (FCacheEntry& CacheEntry : CacheEntries)
+			Collector.AddReferencedObject(CacheEntry.Object);
+	}
 	virtual FString GetReferencerName() const override { return FString::Printf(TEXT("ThumbnailGeneratorCache[%s]"), *DebugCacheName()); }
 	// ~End: FGCObject Interface
+
+private:
+
+	void Unlink(int32 Index)
+	{
+		FCacheEntry& CacheEntry = CacheEntries[Index];
+
+		if (CacheEntry.Prev != INDEX_NONE)
+			CacheEntries[CacheEntry.Prev].Next = CacheEntry.Next;
+		else
+			MostRecentlyUsed = CacheEntry.Next;
+
+		if (CacheEntry.Next != INDEX_NONE)
+			CacheEntries[CacheEntry.Next].Prev = CacheEntry.Prev;
+		else
+			LeastRecentlyUsed = CacheEntry.Prev;
+
+		CacheEntry.Prev = INDEX_NONE;
+		CacheEntry.Next = INDEX_NONE;
+	}
+
+	void LinkAsMostRecent(int32 Index)
+	{
+		FCacheEntry& CacheEntry = CacheEntries[Index];
+		CacheEntry.Prev = INDEX_NONE;
+		CacheEntry.Next = MostRecentlyUsed;
+
+		if (MostRecentlyUsed != INDEX_NONE)
+			CacheEntries[MostRecentlyUsed].Prev = Index;
+
+		MostRecentlyUsed = Index;
+
+		if (LeastRecentlyUsed == INDEX_NONE)
+			LeastRecentlyUsed = Index;
+	}
+
+	void RemoveEntry(int32 Index, bool bNotifyRemoved)
+	{
+		Unlink(Index);
+
+		FCacheEntry& CacheEntry = CacheEntries[Index];
+		TotalMemoryFootprint -= CacheEntry.MemoryFootprint;
+
+		// Run cleanup on cached object
+		if (bNotifyRemoved && IsValid(CacheEntry.Object))
+		{
+			UE_LOG(LogThumbnailGenerator, Verbose, TEXT("%s: Remove cached object %s"), *DebugCacheName(), *CacheEntry.Object->GetName());
+			OnItemRemovedFromCache(CacheEntry.Object);
+		}
+
+		OnKeyRemovedFromCache(CacheEntry.Key);
+
+		CacheLookup.Remove(CacheEntry.Key);
+		CacheEntries.RemoveAt(Index);
+
+		OnMemoryFootprintChanged();
+	}
 };
@@ -0,0 +1,360 @@
+// Copyright Mans Isaksson. All Rights Reserved.
+
+#include "CoreMinimal.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include "ThumbnailGeneratorModule.h"
+#include "CacheProvider.h"
+
+#include "Engine/Texture2D.h"
+#include "HAL/PlatformTime.h"
+#include "Math/RandomStream.h"
+
+// Checks the LRU cache used by the render target and thumbnail result caches: eviction order, memory accounting and that
+// lookups and inserts don't get slower as the cache grows. The timings are reported next to those of the cache it replaced,
+// which scanned every entry to find the one to evict.
+
+namespace CacheProviderTests
+{
+	// The footprint of each object is set by the test, the cache size is given in bytes
+	struct FTestCache : public TCacheProvider<int32, UTexture2D>
+	{
+		int32 MaxSize = 0;
+		TMap<const UTexture2D*, int32> Footprints;
+		TArray<int32> RemovedKeys; // In the order they left the cache
+
+		explicit FTestCache(int32 InMaxSize)
+			: MaxSize(InMaxSize)
+		{}
+
+		virtual int32 MaxCacheSize() override { return MaxSize; }
+		virtual int32 GetItemDataFootprint(UTexture2D* InObject) override
+		{
+			const int32* Footprint = Footprints.Find(InObject);
+			return Footprint ? *Footprint : 1;
+		}
+		virtual FString DebugCacheName() const override { return TEXT("Test Cache"); }
+		virtual void OnKeyRemovedFromCache(const int32& Key) override { RemovedKeys.Add(Key); }
+	};
+
+	static UTexture2D* MakeObject(FTestCache& Cache, int32 Footprint)
+	{
+		UTexture2D* Object = NewObject<UTexture2D>(GetTransientPackage());
+		Cache.Footprints.Add(Object, Footprint);
+		return Object;
+	}
+
+	// The cache provider before it was made an LRU, kept as the reference for the timings. Same as it was, except that the access
+	// time is taken from FPlatformTime rather than FSlateApplication, which isn't initialized in every test run.
+	template<typename HashableKey, typename UObjectValue>
+	struct TLinearScanCacheProvider : public FGCObject
+	{
+	public:
+		struct FCacheEntry
+		{
+			float LastAccessed;
+			int64 MemoryFootprint;
+		};
+		TMap<HashableKey, FCacheEntry>              CacheEntries;
+		TMap<HashableKey, TObjectPtr<UObjectValue>> CacheTable; // GC:d table using AddReferencedObjects
+
+		uint64 TotalMemoryFootprint = 0;
+
+	public:
+
+		void CacheItem(const HashableKey& Key, UObjectValue* InObject)
+		{
+			const auto CacheSize = MaxCacheSize();
+			if (CacheSize <= 0)
+				return;
+
+			const auto DataSize = GetItemDataFootprint(InObject);
+
+			// Reserve the expected number of slots required
+			if (CacheEntries.Num() == 0)
+			{
+				const auto ReserveSize = CacheSize / DataSize;
+				CacheEntries.Reserve(ReserveSize);
+				CacheTable.Reserve(ReserveSize);
+			}
+
+			CacheEntries.Add(Key, FCacheEntry{ (float)FPlatformTime::Seconds(), DataSize });
+			CacheTable.Add(Key, InObject);
+
+			TotalMemoryFootprint += DataSize;
+
+			// Clear out old cache
+			if (TotalMemoryFootprint > CacheSize && CacheEntries.Num() > 1)
+			{
+				HashableKey  OldestKey;
+				FMemory::Memzero(&OldestKey, sizeof(HashableKey));
+				FCacheEntry* OldestCacheEntry = nullptr;
+				for (auto It = CacheEntries.CreateIterator(); It; ++It)
+				{
+					const auto OldestTime = OldestCacheEntry ? OldestCacheEntry->LastAccessed : -1.f;
+					if (It.Value().LastAccessed > OldestTime)
+					{
+						OldestCacheEntry = &It.Value();
+						OldestKey        = It.Key();
+					}
+				}
+
+				if (OldestCacheEntry)
+				{
+					TotalMemoryFootprint -= OldestCacheEntry->MemoryFootprint;
+					CacheEntries.Remove(OldestKey);
+
+					// Run cleanup on cached object
+					if (TObjectPtr<UObjectValue>* OldCachedObject = CacheTable.Find(OldestKey))
+					{
+						if (IsValid(*OldCachedObject))
+							OnItemRemovedFromCache(*OldCachedObject);
+					}
+					CacheTable.Remove(OldestKey);
+				}
+			}
+		}
+
+		UObjectValue* GetCachedItem(const HashableKey& Key)
+		{
+			if (MaxCacheSize() <= 0)
+				return nullptr;
+
+			if (FCacheEntry* CacheEntry = CacheEntries.Find(Key))
+			{
+				TObjectPtr<UObjectValue>* CachedObject = CacheTable.Find(Key);
+
+				// Double check that the object has not been destroyed
+				if (!CachedObject || !IsValid(*CachedObject))
+				{
+					CacheEntries.Remove(Key);
+					CacheTable.Remove(Key);
+					return nullptr;
+				}
+
+				CacheEntry->LastAccessed = (float)FPlatformTime::Seconds();
+				return *CachedObject;
+			}
+
+			return nullptr;
+		}
+
+		int32 NumCachedItems() const { return CacheTable.Num(); }
+
+		virtual int32 MaxCacheSize() = 0;
+
+		virtual int32 GetItemDataFootprint(UObjectValue* InObject) = 0;
+
+		virtual void OnItemRemovedFromCache(UObjectValue* InObject) {}
+
+		// ~Begin: FGCObject Interface
+		virtual void AddReferencedObjects(FReferenceCollector& Collector) override { Collector.AddReferencedObjects(CacheTable); }
+		virtual FString GetReferencerName() const override { return TEXT("CacheProviderTests::TLinearScanCacheProvider"); }
+		// ~End: FGCObject Interface
+	};
+
+	// Every item has a footprint of 1, the cache size is the number of items
+	struct FReferenceTestCache : public TLinearScanCacheProvider<int32, UTexture2D>
+	{
+		int32 MaxSize = 0;
+
+		explicit FReferenceTestCache(int32 InMaxSize)
+			: MaxSize(InMaxSize)
+		{}
+
+		virtual int32 MaxCacheSize() override { return MaxSize; }
+		virtual int32 GetItemDataFootprint(UTexture2D* InObject) override { return 1; }
+	};
+
+	// Average time of Op over NumOps calls, in nanoseconds
+	template<typename OpType>
+	static double TimeOps(int32 NumOps, OpType&& Op)
+	{
+		const double StartTime = FPlatformTime::Seconds();
+		for (int32 i = 0; i < NumOps; i++)
+			Op(i);
+		return (FPlatformTime::Seconds() - StartTime) * 1e9 / NumOps;
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FCacheProviderEvictionOrderTest, "ThumbnailGenerator.CacheProvider.EvictionOrder", EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FCacheProviderEvictionOrderTest::RunTest(const FString& Parameters)
+{
+	using namespace CacheProviderTests;
+
+	FTestCache Cache(3);
+	UTexture2D* Objects[6];
+	for (UTexture2D*& Object : Objects)
+		Object = MakeObject(Cache, 1);
+
+	Cache.CacheItem(0, Objects[0]);
+	Cache.CacheItem(1, Objects[1]);
+	Cache.CacheItem(2, Objects[2]);
+	TestEqual(TEXT("Nothing evicted below the cap"), Cache.RemovedKeys.Num(), 0);
+
+	// Fetching an item makes it the most recently used, so 1 is now the least recently used
+	TestTrue(TEXT("Get returns the cached object"), Cache.GetCachedItem(0) == Objects[0]);
+
+	Cache.CacheItem(3, Objects[3]);
+	TestTrue(TEXT("Least recently used evicted first"), Cache.RemovedKeys == TArray<int32>{ 1 });
+
+	// Re-caching an existing key touches it as well, 2 is now the least recently used
+	Cache.CacheItem(0, Objects[0]);
+	Cache.CacheItem(4, Objects[4]);
+	TestTrue(TEXT("Re-cached key is kept"), Cache.RemovedKeys == TArray<int32>{ 1, 2 });
+
+	// Checking for a key doesn't touch it
+	TestTrue(TEXT("Key 3 is cached"), Cache.IsItemCached(3));
+	Cache.CacheItem(5, Objects[5]);
+	TestTrue(TEXT("IsItemCached doesn't affect recency"), Cache.RemovedKeys == TArray<int32>{ 1, 2, 3 });
+
+	TestEqual(TEXT("Cached items"), Cache.NumCachedItems(), 3);
+	TestTrue(TEXT("Evicted items are gone"), Cache.GetCachedItem(1) == nullptr && Cache.GetCachedItem(2) == nullptr && Cache.GetCachedItem(3) == nullptr);
+	TestTrue(TEXT("Remaining items are cached"), Cache.GetCachedItem(0) == Objects[0] && Cache.GetCachedItem(4) == Objects[4] && Cache.GetCachedItem(5) == Objects[5]);
+
+	// Destroyed objects are dropped when fetched
+	Objects[4]->MarkAsGarbage();
+	TestNull(TEXT("Destroyed object is not returned"), Cache.GetCachedItem(4));
+	TestFalse(TEXT("Destroyed object is removed"), Cache.IsItemCached(4));
+
+	// A disabled cache neither stores nor returns anything
+	Cache.MaxSize = 0;
+	TestNull(TEXT("Disabled cache returns nothing"), Cache.GetCachedItem(0));
+	Cache.CacheItem(6, Objects[0]);
+	TestFalse(TEXT("Disabled cache stores nothing"), Cache.IsItemCached(6));
+
+	return !HasAnyErrors();
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FCacheProviderSizeAccountingTest, "ThumbnailGenerator.CacheProvider.SizeAccounting", EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FCacheProviderSizeAccountingTest::RunTest(const FString& Parameters)
+{
+	using namespace CacheProviderTests;
+
+	FTestCache Cache(100);
+	UTexture2D* Small  = MakeObject(Cache, 10);
+	UTexture2D* Medium = MakeObject(Cache, 30);
+	UTexture2D* Large  = MakeObject(Cache, 60);
+	UTexture2D* Huge   = MakeObject(Cache, 150);
+
+	Cache.CacheItem(0, Small);
+	Cache.CacheItem(1, Medium);
+	TestEqual(TEXT("Footprint of two items"), Cache.GetTotalMemoryFootprint(), uint64(40));
+
+	// Replacing the object of a key accounts for the new object only
+	Cache.CacheItem(1, Large);
+	TestEqual(TEXT("Footprint after replacing an object"), Cache.GetTotalMemoryFootprint(), uint64(70));
+	TestEqual(TEXT("Replacing an object doesn't remove the key"), Cache.RemovedKeys.Num(), 0);
+
+	// Exactly at the cap is allowed
+	Cache.CacheItem(2, Medium);
+	TestEqual(TEXT("Footprint at the cap"), Cache.GetTotalMemoryFootprint(), uint64(100));
+	TestEqual(TEXT("Nothing evicted at the cap"), Cache.RemovedKeys.Num(), 0);
+
+	// Going over evicts as many of the least recently used items as needed
+	Cache.CacheItem(3, Large);
+	TestTrue(TEXT("Evicted to make room"), Cache.RemovedKeys == TArray<int32>{ 0, 1 });
+	TestEqual(TEXT("Footprint after eviction"), Cache.GetTotalMemoryFootprint(), uint64(90));
+
+	TestTrue(TEXT("Remove cached item"), Cache.RemoveCachedItem(2));
+	TestFalse(TEXT("Remove missing item"), Cache.RemoveCachedItem(2));
+	TestEqual(TEXT("Footprint after removal"), Cache.GetTotalMemoryFootprint(), uint64(60));
+
+	// An item larger than the cap evicts everything else, but is kept since the caller is about to use it
+	Cache.CacheItem(4, Huge);
+	TestEqual(TEXT("Only the oversized item is cached"), Cache.NumCachedItems(), 1);
+	TestTrue(TEXT("Oversized item is cached"), Cache.IsItemCached(4));
+	TestEqual(TEXT("Footprint of the oversized item"), Cache.GetTotalMemoryFootprint(), uint64(150));
+
+	Cache.ClearCache();
+	TestEqual(TEXT("Footprint after clear"), Cache.GetTotalMemoryFootprint(), uint64(0));
+	TestEqual(TEXT("Items after clear"), Cache.NumCachedItems(), 0);
+
+	return !HasAnyErrors();
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FCacheProviderPerfTest, "ThumbnailGenerator.Perf.CacheProvider", EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+
+bool FCacheProviderPerfTest::RunTest(const FString& Parameters)
+{
+	using namespace CacheProviderTests;
+
+	static constexpr int32 NumOps          = 200000;
+	static constexpr int32 NumReferenceOps = 2000; // Each insert into the reference cache scans every entry
+	static constexpr int32 SmallSize       = 1024;
+	static constexpr int32 LargeSize       = 64 * 1024;
+	static constexpr double MaxSlowdown    = 8.0; // A cache which scans its entries would be 64x slower
+
+	struct FTimings
+	{
+		double GetNs = 0.0;
+		double PutNs = 0.0;
+	};
+
+	// Every entry has the same object and a footprint of 1, so the cache holds exactly NumEntries items
+	const auto MeasureCache = [&](auto& Cache, UTexture2D* Object, int32 NumEntries, int32 NumCacheOps) -> FTimings
+	{
+		for (int32 Key = 0; Key < NumEntries; Key++)
+			Cache.CacheItem(Key, Object);
+
+		FRandomStream Random(NumEntries);
+		TArray<int32> Keys;
+		Keys.SetNumUninitialized(NumCacheOps);
+		for (int32& Key : Keys)
+			Key = Random.RandRange(0, NumEntries - 1);
+
+		FTimings Timings;
+
+		// Hits at random recency, each moves the entry to the front
+		int32 NumHits = 0;
+		Timings.GetNs = TimeOps(NumCacheOps, [&](int32 i) { NumHits += Cache.GetCachedItem(Keys[i]) ? 1 : 0; });
+		TestEqual(*FString::Printf(TEXT("%d entries: every get hits"), NumEntries), NumHits, NumCacheOps);
+
+		// New keys, each evicts one entry
+		Timings.PutNs = TimeOps(NumCacheOps, [&](int32 i) { Cache.CacheItem(NumEntries + i, Object); });
+		TestEqual(*FString::Printf(TEXT("%d entries: size is kept at the cap"), NumEntries), Cache.NumCachedItems(), NumEntries);
+
+		return Timings;
+	};
+
+	const auto Measure = [&](int32 NumEntries) -> FTimings
+	{
+		FTestCache Cache(NumEntries);
+		return MeasureCache(Cache, MakeObject(Cache, 1), NumEntries, NumOps);
+	};
+
+	const auto MeasureReference = [&](int32 NumEntries) -> FTimings
+	{
+		FReferenceTestCache Cache(NumEntries);
+		return MeasureCache(Cache, NewObject<UTexture2D>(GetTransientPackage()), NumEntries, NumReferenceOps);
+	};
+
+	// Warm up the allocator and caches
+	Measure(SmallSize);
+	MeasureReference(SmallSize);
+
+	const FTimings Small          = Measure(SmallSize);
+	const FTimings Large          = Measure(LargeSize);
+	const FTimings SmallReference = MeasureReference(SmallSize);
+	const FTimings LargeReference = MeasureReference(LargeSize);
+
+	const auto Report = [&](int32 NumEntries, const FTimings& Timings, const FTimings& Reference)
+	{
+		AddInfo(FString::Printf(TEXT("Cache provider, %d entries: get %.1f ns (linear scan %.1f ns), put %.1f ns (linear scan %.1f ns, %.1fx)"),
+			NumEntries, Timings.GetNs, Reference.GetNs, Timings.PutNs, Reference.PutNs, Timings.PutNs > 0.0 ? Reference.PutNs / Timings.PutNs : 0.0));
+	};
+
+	Report(SmallSize, Small, SmallReference);
+	Report(LargeSize, Large, LargeReference);
+
+	TestTrue(*FString::Printf(TEXT("Get is O(1): %.2fx slower with %dx the entries"), Large.GetNs / Small.GetNs, LargeSize / SmallSize), Large.GetNs <= Small.GetNs * MaxSlowdown);
+	TestTrue(*FString::Printf(TEXT("Put is O(1): %.2fx slower with %dx the entries"), Large.PutNs / Small.PutNs, LargeSize / SmallSize), Large.PutNs <= Small.PutNs * MaxSlowdown);
+
+	return !HasAnyErrors();
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
@@ -0,0 +1,218 @@
+// Copyright Mans Isaksson. All Rights Reserved.
+
+#include "CoreMinimal.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include "ThumbnailAlphaKernels.h"
+
+#include "HAL/PlatformTime.h"
+#include "Math/RandomStream.h"
+
+namespace ThumbnailAlphaKernelsTests
+{
+	using namespace ThumbnailGenerator;
+
+	static const EThumbnailAlphaBlendMode BlendModes[] =
+	{
+		EThumbnailAlphaBlendMode::EReplace,
+		EThumbnailAlphaBlendMode::EAdd,
+		EThumbnailAlphaBlendMode::EMultiply,
+		EThumbnailAlphaBlendMode::ESubtract,
+	};
+
+	static FString GetBlendModeName(EThumbnailAlphaBlendMode BlendMode)
+	{
+		return StaticEnum<EThumbnailAlphaBlendMode>()->GetNameStringByValue((int64)BlendMode);
+	}
+
+	struct FTestImage
+	{
+		TArray<FColor> Color8;
+		TArray<FColor> AlphaPass8;
+		TArray<uint8> Alpha8;
+
+		TArray<FFloat16Color> Color16;
+		TArray<FFloat16Color> AlphaPass16;
+		TArray<FFloat16> Alpha16;
+
+		FTestImage(int32 NumPixels, int32 Seed)
+		{
+			FRandomStream Random(Seed);
+			const auto RandomByte  = [&Random]() { return (uint8)Random.RandRange(0, 255); };
+			const auto RandomHalf  = [&Random]() { return FFloat16(Random.FRand()); };
+			const auto RandomColor = [&RandomByte]() { return FColor(RandomByte(), RandomByte(), RandomByte(), RandomByte()); };
+			const auto RandomColor16 = [&RandomHalf]()
+			{
+				FFloat16Color Color;
+				Color.R = RandomHalf();
+				Color.G = RandomHalf();
+				Color.B = RandomHalf();
+				Color.A = RandomHalf();
+				return Color;
+			};
+
+			for (int32 Pixel = 0; Pixel < NumPixels; Pixel++)
+			{
+				Color8.Add(RandomColor());
+				AlphaPass8.Add(RandomColor());
+				Alpha8.Add(RandomByte());
+
+				Color16.Add(RandomColor16());
+				AlphaPass16.Add(RandomColor16());
+				Alpha16.Add(RandomHalf());
+			}
+		}
+	};
+
+	template<typename T>
+	static bool IsBitwiseEqual(const TArray<T>& A, const TArray<T>& B)
+	{
+		return A.Num() == B.Num() && FMemory::Memcmp(A.GetData(), B.GetData(), A.Num() * sizeof(T)) == 0;
+	}
+
+	// Runs a kernel and its scalar reference on copies of Pixels
+	template<typename T, typename KernelType, typename ReferenceType>
+	static bool MatchesReference(const TArray<T>& Pixels, KernelType&& Kernel, ReferenceType&& Reference)
+	{
+		TArray<T> KernelResult    = Pixels;
+		TArray<T> ReferenceResult = Pixels;
+		Kernel(KernelResult.GetData());
+		Reference(ReferenceResult.GetData());
+		return IsBitwiseEqual(KernelResult, ReferenceResult);
+	}
+
+	// Best of NumRuns, in milliseconds
+	template<typename T, typename KernelType>
+	static double TimeKernel(const TArray<T>& Pixels, int32 NumRuns, KernelType&& Kernel)
+	{
+		TArray<T> Scratch;
+		double BestMs = TNumericLimits<double>::Max();
+		for (int32 Run = 0; Run < NumRuns; Run++)
+		{
+			Scratch = Pixels;
+			const uint64 StartCycles = FPlatformTime::Cycles64();
+			Kernel(Scratch.GetData());
+			BestMs = FMath::Min(BestMs, FPlatformTime::ToMilliseconds64(FPlatformTime::Cycles64() - StartCycles));
+		}
+		return BestMs;
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FThumbnailAlphaKernelsTest, "ThumbnailGenerator.AlphaKernels", EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FThumbnailAlphaKernelsTest::RunTest(const FString& Parameters)
+{
+	using namespace ThumbnailAlphaKernelsTests;
+
+	// Sizes around every vector width, so both the vector loops and the scalar tails are covered
+	for (int32 NumPixels : { 0, 1, 2, 3, 4, 5, 7, 8, 9, 15, 16, 17, 31, 33, 64, 1021 })
+	{
+		const FTestImage Image(NumPixels, NumPixels);
+
+		for (EThumbnailAlphaBlendMode BlendMode : BlendModes)
+		{
+			const FString Context = FString::Printf(TEXT("%s, %d pixels, %s"), AlphaKernels::GetInstructionSetName(), NumPixels, *GetBlendModeName(BlendMode));
+
+			TestTrue(*FString::Printf(TEXT("MergeAlpha FColor (%s)"), *Context), MatchesReference(Image.Color8,
+				[&](FColor* Pixels) { AlphaKernels::MergeAlpha(Pixels, Image.Alpha8.GetData(), NumPixels, BlendMode); },
+				[&](FColor* Pixels) { AlphaKernels::Scalar::MergeAlpha(Pixels, Image.Alpha8.GetData(), NumPixels, BlendMode); }));
+
+			TestTrue(*FString::Printf(TEXT("MergeAlpha FFloat16Color (%s)"), *Context), MatchesReference(Image.Color16,
+				[&](FFloat16Color* Pixels) { AlphaKernels::MergeAlpha(Pixels, Image.Alpha16.GetData(), NumPixels, BlendMode); },
+				[&](FFloat16Color* Pixels) { AlphaKernels::Scalar::MergeAlpha(Pixels, Image.Alpha16.GetData(), NumPixels, BlendMode); }));
+
+			TestTrue(*FString::Printf(TEXT("MergeInverseAlpha FColor (%s)"), *Context), MatchesReference(Image.Color8,
+				[&](FColor* Pixels) { AlphaKernels::MergeInverseAlpha(Pixels, Image.AlphaPass8.GetData(), NumPixels, BlendMode); },
+				[&](FColor* Pixels) { AlphaKernels::Scalar::MergeInverseAlpha(Pixels, Image.AlphaPass8.GetData(), NumPixels, BlendMode); }));
+
+			TestTrue(*FString::Printf(TEXT("MergeInverseAlpha FFloat16Color (%s)"), *Context), MatchesReference(Image.Color16,
+				[&](FFloat16Color* Pixels) { AlphaKernels::MergeInverseAlpha(Pixels, Image.AlphaPass16.GetData(), NumPixels, BlendMode); },
+				[&](FFloat16Color* Pixels) { AlphaKernels::Scalar::MergeInverseAlpha(Pixels, Image.AlphaPass16.GetData(), NumPixels, BlendMode); }));
+		}
+
+		TestTrue(*FString::Printf(TEXT("SetOpaqueAlpha FColor (%d pixels)"), NumPixels), MatchesReference(Image.Color8,
+			[&](FColor* Pixels) { AlphaKernels::SetOpaqueAlpha(Pixels, NumPixels); },
+			[&](FColor* Pixels) { AlphaKernels::Scalar::SetOpaqueAlpha(Pixels, NumPixels); }));
+
+		TestTrue(*FString::Printf(TEXT("SetOpaqueAlpha FFloat16Color (%d pixels)"), NumPixels), MatchesReference(Image.Color16,
+			[&](FFloat16Color* Pixels) { AlphaKernels::SetOpaqueAlpha(Pixels, NumPixels); },
+			[&](FFloat16Color* Pixels) { AlphaKernels::Scalar::SetOpaqueAlpha(Pixels, NumPixels); }));
+
+		{
+			TArray<uint8> Reference;
+			Reference.SetNumUninitialized(NumPixels);
+			AlphaKernels::Scalar::ExtractInverseAlpha(Image.AlphaPass8.GetData(), Reference.GetData(), NumPixels);
+
+			TArray<uint8> Plane;
+			Plane.SetNumUninitialized(NumPixels);
+			AlphaKernels::ExtractInverseAlpha(Image.AlphaPass8.GetData(), Plane.GetData(), NumPixels);
+			TestTrue(*FString::Printf(TEXT("ExtractInverseAlpha FColor (%d pixels)"), NumPixels), IsBitwiseEqual(Plane, Reference));
+		}
+
+		{
+			TArray<FFloat16> Reference;
+			Reference.SetNumUninitialized(NumPixels);
+			AlphaKernels::Scalar::ExtractInverseAlpha(Image.AlphaPass16.GetData(), Reference.GetData(), NumPixels);
+
+			TArray<FFloat16> Plane;
+			Plane.SetNumUninitialized(NumPixels);
+			AlphaKernels::ExtractInverseAlpha(Image.AlphaPass16.GetData(), Plane.GetData(), NumPixels);
+			TestTrue(*FString::Printf(TEXT("ExtractInverseAlpha FFloat16Color (%d pixels)"), NumPixels), IsBitwiseEqual(Plane, Reference));
+		}
+	}
+
+	return !HasAnyErrors();
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FThumbnailAlphaKernelsPerfTest, "ThumbnailGenerator.Perf.AlphaMerge", EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+
+bool FThumbnailAlphaKernelsPerfTest::RunTest(const FString& Parameters)
+{
+	using namespace ThumbnailAlphaKernelsTests;
+
+	// A 2048x2048 thumbnail
+	const int32 NumPixels = 2048 * 2048;
+	const int32 NumRuns   = 10;
+	const FTestImage Image(NumPixels, 0);
+
+	const auto Report = [this](const TCHAR* Kernel, const FString& BlendMode, double ScalarMs, double VectorMs)
+	{
+		AddInfo(FString::Printf(TEXT("%-34s %-10s scalar %7.3f ms, %s %7.3f ms (%.1fx)"),
+			Kernel, *BlendMode, ScalarMs, AlphaKernels::GetInstructionSetName(), VectorMs, VectorMs > 0.0 ? ScalarMs / VectorMs : 0.0));
+	};
+
+	for (EThumbnailAlphaBlendMode BlendMode : BlendModes)
+	{
+		const FString BlendModeName = GetBlendModeName(BlendMode);
+
+		Report(TEXT("MergeAlpha FColor"), BlendModeName,
+			TimeKernel(Image.Color8, NumRuns, [&](FColor* Pixels) { AlphaKernels::Scalar::MergeAlpha(Pixels, Image.Alpha8.GetData(), NumPixels, BlendMode); }),
+			TimeKernel(Image.Color8, NumRuns, [&](FColor* Pixels) { AlphaKernels::MergeAlpha(Pixels, Image.Alpha8.GetData(), NumPixels, BlendMode); }));
+
+		Report(TEXT("MergeAlpha FFloat16Color"), BlendModeName,
+			TimeKernel(Image.Color16, NumRuns, [&](FFloat16Color* Pixels) { AlphaKernels::Scalar::MergeAlpha(Pixels, Image.Alpha16.GetData(), NumPixels, BlendMode); }),
+			TimeKernel(Image.Color16, NumRuns, [&](FFloat16Color* Pixels) { AlphaKernels::MergeAlpha(Pixels, Image.Alpha16.GetData(), NumPixels, BlendMode); }));
+
+		Report(TEXT("MergeInverseAlpha FColor"), BlendModeName,
+			TimeKernel(Image.Color8, NumRuns, [&](FColor* Pixels) { AlphaKernels::Scalar::MergeInverseAlpha(Pixels, Image.AlphaPass8.GetData(), NumPixels, BlendMode); }),
+			TimeKernel(Image.Color8, NumRuns, [&](FColor* Pixels) { AlphaKernels::MergeInverseAlpha(Pixels, Image.AlphaPass8.GetData(), NumPixels, BlendMode); }));
+
+		Report(TEXT("MergeInverseAlpha FFloat16Color"), BlendModeName,
+			TimeKernel(Image.Color16, NumRuns, [&](FFloat16Color* Pixels) { AlphaKernels::Scalar::MergeInverseAlpha(Pixels, Image.AlphaPass16.GetData(), NumPixels, BlendMode); }),
+			TimeKernel(Image.Color16, NumRuns, [&](FFloat16Color* Pixels) { AlphaKernels::MergeInverseAlpha(Pixels, Image.AlphaPass16.GetData(), NumPixels, BlendMode); }));
+	}
+
+	Report(TEXT("SetOpaqueAlpha FColor"), TEXT("-"),
+		TimeKernel(Image.Color8, NumRuns, [&](FColor* Pixels) { AlphaKernels::Scalar::SetOpaqueAlpha(Pixels, NumPixels); }),
+		TimeKernel(Image.Color8, NumRuns, [&](FColor* Pixels) { AlphaKernels::SetOpaqueAlpha(Pixels, NumPixels); }));
+
+	Report(TEXT("SetOpaqueAlpha FFloat16Color"), TEXT("-"),
+		TimeKernel(Image.Color16, NumRuns, [&](FFloat16Color* Pixels) { AlphaKernels::Scalar::SetOpaqueAlpha(Pixels, NumPixels); }),
+		TimeKernel(Image.Color16, NumRuns, [&](FFloat16Color* Pixels) { AlphaKernels::SetOpaqueAlpha(Pixels, NumPixels); }));
+
+	return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
@@ -0,0 +1,316 @@
+// Copyright Mans Isaksson. All Rights Reserved.
+
+#include "CoreMinimal.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include "ThumbnailGenerator.h"
+#include "ThumbnailGeneratorSettings.h"
+#include "ThumbnailActorBounds.h"
+
+#include "Animation/SkeletalMeshActor.h"
+#include "Components/SkeletalMeshComponent.h"
+#include "Engine/SkeletalMesh.h"
+#include "Engine/Texture2D.h"
+#include "Engine/World.h"
+#include "HAL/PlatformTime.h"
+#include "Misc/CommandLine.h"
+#include "Misc/Parse.h"
+#include "Templates/UnrealTemplate.h"
+#include "UObject/UObjectGlobals.h"
+
+// Checks the bounds and view cache (UThumbnailGeneratorSettings::MaxThumbnailBoundsCacheSize): which captures reuse the cached
+// bounds and views, and that the cache is emptied when the actor's class or the assets it uses might have changed.
+//
+// Also checks how the bounds of each FThumbnailSettings::BoundsMode relate to the exact bounds of a skeletal mesh, and reports how
+// long each mode takes (Perf.BoundsModes). Command line options of the timing test:
+//   -ThumbnailPerfIterations=N        Bounds calculations per mode (default 100)
+//   -ThumbnailPerfSkeletalMesh=Path   Mesh to calculate the bounds of (default /Engine/EngineMeshes/SkeletalCube)
+//   -ThumbnailPerfBoundsSamples=N     Sample count of the sampled vertices bounds mode (default FThumbnailSettings::BoundsSampleCount)
+
+namespace ThumbnailBoundsTests
+{
+	static const TCHAR* ActorClassPath = TEXT("/ThumbnailGenerator/SkySphere/BP_ThumbnailGenerator_SkySphere.BP_ThumbnailGenerator_SkySphere_C");
+
+	// The plugin ships no skeletal meshes
+	static const TCHAR* SkeletalMeshPath = TEXT("/Engine/EngineMeshes/SkeletalCube.SkeletalCube");
+
+	// True if Inner fits inside Outer grown by Tolerance on every side
+	static bool IsInsideBox(const FBox& Outer, const FBox& Inner, double Tolerance)
+	{
+		const FBox Expanded = Outer.ExpandBy(Tolerance);
+		return Outer.IsValid && Inner.IsValid && Expanded.IsInsideOrOn(Inner.Min) && Expanded.IsInsideOrOn(Inner.Max);
+	}
+
+	static FThumbnailSettings MakeThumbnailSettings()
+	{
+		FThumbnailSettings Overrides;
+		Overrides.bOverride_ThumbnailTextureWidth  = true;
+		Overrides.ThumbnailTextureWidth            = 32;
+		Overrides.bOverride_ThumbnailTextureHeight = true;
+		Overrides.ThumbnailTextureHeight           = 32;
+
+		FThumbnailSettings Settings = FThumbnailSettings::MergeThumbnailSettings(UThumbnailGeneratorSettings::Get()->DefaultThumbnailSettings, Overrides);
+
+		// Only automatically framed views are cached, and debug bounds are never cached
+		Settings.bOverride_CustomCameraLocation = false;
+		Settings.bOverride_CustomCameraRotation = false;
+		Settings.bOverride_CustomOrthoWidth     = false;
+		Settings.bDebugBounds                   = false;
+		return Settings;
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FThumbnailBoundsCacheTest, "ThumbnailGenerator.Bounds.Cache", EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FThumbnailBoundsCacheTest::RunTest(const FString& Parameters)
+{
+	using namespace ThumbnailBoundsTests;
+
+	UClass* ActorClass = LoadClass<AActor>(nullptr, ActorClassPath);
+	if (!TestNotNull(TEXT("Test actor class"), ActorClass))
+		return false;
+
+	// Every capture has to go through framing, so neither thumbnails nor pixels may be cached
+	UThumbnailGeneratorSettings* GeneratorSettings = UThumbnailGeneratorSettings::Get();
+	TGuardValue<bool> DiskCacheGuard(GeneratorSettings->bEnableThumbnailDiskCache, false);
+	TGuardValue<int32> ResultCacheGuard(GeneratorSettings->MaxThumbnailResultCacheSize, 0);
+	TGuardValue<int32> BoundsCacheGuard(GeneratorSettings->MaxThumbnailBoundsCacheSize, FMath::Max(16, GeneratorSettings->MaxThumbnailBoundsCacheSize));
+
+	FThumbnailGenerator Generator(false);
+	Generator.InitializeThumbnailWorld(FThumbnailBackgroundSceneSettings());
+
+	const FThumbnailSettings Settings = MakeThumbnailSettings();
+
+	const auto Capture = [&](const FThumbnailSettings& CaptureSettings, const TMap<FString, FString>& Properties = TMap<FString, FString>())
+	{
+		UTexture2D* Thumbnail = Generator.GenerateActorThumbnail(ActorClass, CaptureSettings, nullptr, Properties);
+		TestNotNull(TEXT("Thumbnail"), Thumbnail);
+		Generator.ReleaseThumbnail(Thumbnail);
+	};
+
+	const auto TestStats = [&](const TCHAR* What, int64 ViewHits, int64 ViewMisses, int64 BoundsHits, int64 BoundsMisses)
+	{
+		const FThumbnailBoundsCacheStats Stats = Generator.GetThumbnailBoundsCacheStats();
+		TestEqual(*FString::Printf(TEXT("%s: view hits"), What), Stats.ViewHits, ViewHits);
+		TestEqual(*FString::Printf(TEXT("%s: view misses"), What), Stats.ViewMisses, ViewMisses);
+		TestEqual(*FString::Printf(TEXT("%s: bounds hits"), What), Stats.BoundsHits, BoundsHits);
+		TestEqual(*FString::Printf(TEXT("%s: bounds misses"), What), Stats.BoundsMisses, BoundsMisses);
+	};
+
+	// The first capture computes the bounds and the view, the bounds are only looked up when the view isn't cached
+	Capture(Settings);
+	TestStats(TEXT("First capture"), 0, 1, 0, 1);
+
+	Capture(Settings);
+	TestStats(TEXT("Same request"), 1, 1, 0, 1);
+
+	// Camera settings only affect the view
+	FThumbnailSettings OrbitSettings = Settings;
+	OrbitSettings.CameraOrbitRotation.Yaw += 90.f;
+	Capture(OrbitSettings);
+	TestStats(TEXT("Other camera orbit"), 1, 2, 1, 1);
+
+	Capture(OrbitSettings);
+	TestStats(TEXT("Same camera orbit"), 2, 2, 1, 1);
+
+	// Property overrides might change the actor's components
+	TMap<FString, FString> Properties;
+	Properties.Add(TEXT("InitialLifeSpan"), TEXT("5.0"));
+	Capture(Settings, Properties);
+	TestStats(TEXT("Property override"), 2, 3, 1, 2);
+
+	Capture(Settings, Properties);
+	TestStats(TEXT("Same property override"), 3, 3, 1, 2);
+
+	const FThumbnailBoundsCacheStats Stats = Generator.GetThumbnailBoundsCacheStats();
+	TestEqual(TEXT("Cached views"), Stats.NumCachedViews, 3);
+	TestEqual(TEXT("Cached bounds"), Stats.NumCachedBounds, 2);
+
+	// A disabled cache neither stores nor looks anything up
+	{
+		TGuardValue<int32> DisabledGuard(GeneratorSettings->MaxThumbnailBoundsCacheSize, 0);
+		Generator.ClearThumbnailBoundsCache();
+		Capture(Settings);
+		Capture(Settings);
+		TestStats(TEXT("Disabled cache"), 3, 3, 1, 2);
+		TestEqual(TEXT("Disabled cache: cached views"), Generator.GetThumbnailBoundsCacheStats().NumCachedViews, 0);
+	}
+
+#if WITH_EDITOR
+	const auto TestInvalidated = [&](const TCHAR* What, TFunctionRef<void()> Invalidate)
+	{
+		Capture(Settings);
+		TestTrue(*FString::Printf(TEXT("%s: cached before"), What), Generator.GetThumbnailBoundsCacheStats().NumCachedViews > 0);
+
+		Invalidate();
+
+		const FThumbnailBoundsCacheStats Before = Generator.GetThumbnailBoundsCacheStats();
+		TestEqual(*FString::Printf(TEXT("%s: cached views"), What), Before.NumCachedViews, 0);
+		TestEqual(*FString::Printf(TEXT("%s: cached bounds"), What), Before.NumCachedBounds, 0);
+
+		Capture(Settings);
+		const FThumbnailBoundsCacheStats After = Generator.GetThumbnailBoundsCacheStats();
+		TestEqual(*FString::Printf(TEXT("%s: view recomputed"), What), After.ViewMisses, Before.ViewMisses + 1);
+		TestEqual(*FString::Printf(TEXT("%s: bounds recomputed"), What), After.BoundsMisses, Before.BoundsMisses + 1);
+	};
+
+	// Editing the class defaults (or an asset the actor uses)
+	TestInvalidated(TEXT("CDO property change"), [&]()
+	{
+		FPropertyChangedEvent PropertyChangedEvent(nullptr);
+		FCoreUObjectDelegates::OnObjectPropertyChanged.Broadcast(ActorClass->GetDefaultObject(), PropertyChangedEvent);
+	});
+
+	// Recompiling a blueprint re-instances its objects
+	TestInvalidated(TEXT("Objects replaced"), [&]()
+	{
+		TMap<UObject*, UObject*> ReplacedObjects;
+		ReplacedObjects.Add(NewObject<UTexture2D>(GetTransientPackage()), NewObject<UTexture2D>(GetTransientPackage()));
+		FCoreUObjectDelegates::OnObjectsReplaced.Broadcast(ReplacedObjects);
+	});
+
+	// Other objects don't affect the bounds
+	Capture(Settings);
+	{
+		FPropertyChangedEvent PropertyChangedEvent(nullptr);
+		FCoreUObjectDelegates::OnObjectPropertyChanged.Broadcast(NewObject<UTexture2D>(GetTransientPackage()), PropertyChangedEvent);
+	}
+	TestTrue(TEXT("Transient object change keeps the cache"), Generator.GetThumbnailBoundsCacheStats().NumCachedViews > 0);
+#endif
+
+	return !HasAnyErrors();
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FThumbnailBoundsModesTest, "ThumbnailGenerator.Bounds.Modes", EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FThumbnailBoundsModesTest::RunTest(const FString& Parameters)
+{
+	using namespace ThumbnailBoundsTests;
+	using ThumbnailGenerator::FSkinnedMeshBounds;
+	using ThumbnailGenerator::CalcSkinnedMeshLocalBounds;
+
+	USkeletalMesh* Mesh = LoadObject<USkeletalMesh>(nullptr, SkeletalMeshPath);
+	if (!TestNotNull(TEXT("Skeletal mesh"), Mesh))
+		return false;
+
+	FThumbnailGenerator Generator(false);
+	Generator.InitializeThumbnailWorld(FThumbnailBackgroundSceneSettings());
+
+	ASkeletalMeshActor* Actor = Generator.GetThumbnailWorld()->SpawnActor<ASkeletalMeshActor>();
+	if (!TestNotNull(TEXT("Skeletal mesh actor"), Actor))
+		return false;
+
+	// The render bounds are the imported bounds rather than the physics asset's, so they hold every vertex in the reference pose
+	USkeletalMeshComponent* Component = Actor->GetSkeletalMeshComponent();
+	Component->bComponentUseFixedSkelBounds = true;
+	Component->SetSkeletalMeshAsset(Mesh);
+
+	const FSkinnedMeshBounds Exact = CalcSkinnedMeshLocalBounds(Component, EThumbnailBoundsMode::EExact, 1);
+	if (!TestTrue(TEXT("Exact bounds are valid"), Exact.Bounds.IsValid))
+		return false;
+
+	// Room for the float to double conversions of the vertices
+	const double Tolerance = FMath::Max(Exact.Bounds.GetSize().GetMax(), 1.0) * 1e-4;
+
+	TestTrue(TEXT("Exact bounds are deterministic"), CalcSkinnedMeshLocalBounds(Component, EThumbnailBoundsMode::EExact, 1).Bounds == Exact.Bounds);
+	TestEqual(TEXT("Exact bounds have no error estimate"), Exact.ErrorEstimate, 0.0);
+
+	const FSkinnedMeshBounds Render = CalcSkinnedMeshLocalBounds(Component, EThumbnailBoundsMode::ERenderBounds, 1);
+	TestTrue(TEXT("Render bounds contain the exact bounds"), IsInsideBox(Render.Bounds, Exact.Bounds, Tolerance));
+	TestEqual(TEXT("Render bounds skin no vertices"), Render.NumSkinnedVertices, 0);
+
+	// Every sample is a vertex of LOD 0
+	const int32 SampleCount = FMath::Max(1, Exact.NumSkinnedVertices / 4);
+	const FSkinnedMeshBounds Sampled = CalcSkinnedMeshLocalBounds(Component, EThumbnailBoundsMode::ESampled, SampleCount);
+	TestTrue(TEXT("Exact bounds contain the sampled bounds"), IsInsideBox(Exact.Bounds, Sampled.Bounds, Tolerance));
+	TestTrue(TEXT("Sampled vertices are capped by the sample count"), Sampled.NumSkinnedVertices <= SampleCount);
+	TestTrue(TEXT("Sampled error estimate is not negative"), Sampled.ErrorEstimate >= 0.0);
+
+	// Sampling every vertex is the same as the exact bounds
+	const FSkinnedMeshBounds AllSampled = CalcSkinnedMeshLocalBounds(Component, EThumbnailBoundsMode::ESampled, FMath::Max(1, Exact.NumSkinnedVertices));
+	TestTrue(TEXT("Sampling every vertex gives the exact bounds"), AllSampled.Bounds == Exact.Bounds);
+	TestEqual(TEXT("Sampling every vertex skins every vertex"), AllSampled.NumSkinnedVertices, Exact.NumSkinnedVertices);
+	TestEqual(TEXT("Sampling every vertex has no error estimate"), AllSampled.ErrorEstimate, 0.0);
+
+	const FSkinnedMeshBounds LowestLOD = CalcSkinnedMeshLocalBounds(Component, EThumbnailBoundsMode::ELowestLOD, 1);
+	TestTrue(TEXT("Lowest LOD bounds are valid"), LowestLOD.Bounds.IsValid);
+	if (Mesh->GetLODNum() == 1)
+		TestTrue(TEXT("Lowest LOD of a single LOD mesh gives the exact bounds"), LowestLOD.Bounds == Exact.Bounds);
+	else
+		TestTrue(TEXT("Lowest LOD skins at most as many vertices as LOD 0"), LowestLOD.NumSkinnedVertices <= Exact.NumSkinnedVertices);
+
+	const FSkinnedMeshBounds Physics = CalcSkinnedMeshLocalBounds(Component, EThumbnailBoundsMode::EPhysicsAsset, 1);
+	TestTrue(TEXT("Physics asset bounds are valid"), Physics.Bounds.IsValid);
+	if (!Component->GetPhysicsAsset())
+		TestTrue(TEXT("Physics asset bounds without a physics asset give the exact bounds"), Physics.Bounds == Exact.Bounds);
+
+	Actor->Destroy();
+
+	return !HasAnyErrors();
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FThumbnailBoundsModesPerfTest, "ThumbnailGenerator.Perf.BoundsModes", EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+
+// Time and accuracy of each FThumbnailSettings::BoundsMode on a skeletal mesh in its reference pose, compared to the exact bounds.
+// The results are only reported, Bounds.Modes checks the bounds themselves.
+bool FThumbnailBoundsModesPerfTest::RunTest(const FString& Parameters)
+{
+	using namespace ThumbnailBoundsTests;
+	using ThumbnailGenerator::FSkinnedMeshBounds;
+	using ThumbnailGenerator::CalcSkinnedMeshLocalBounds;
+
+	int32 NumIterations = 100;
+	int32 SampleCount   = FThumbnailSettings().BoundsSampleCount;
+	FString MeshPath    = SkeletalMeshPath;
+	FParse::Value(FCommandLine::Get(), TEXT("ThumbnailPerfIterations="), NumIterations);
+	FParse::Value(FCommandLine::Get(), TEXT("ThumbnailPerfBoundsSamples="), SampleCount);
+	FParse::Value(FCommandLine::Get(), TEXT("ThumbnailPerfSkeletalMesh="), MeshPath);
+	NumIterations = FMath::Max(1, NumIterations);
+
+	USkeletalMesh* Mesh = LoadObject<USkeletalMesh>(nullptr, *MeshPath);
+	if (!Mesh)
+	{
+		AddWarning(FString::Printf(TEXT("Could not load '%s', pass a skeletal mesh with -ThumbnailPerfSkeletalMesh= to run this test"), *MeshPath));
+		return true;
+	}
+
+	FThumbnailGenerator Generator(false);
+	Generator.InitializeThumbnailWorld(FThumbnailBackgroundSceneSettings());
+
+	ASkeletalMeshActor* Actor = Generator.GetThumbnailWorld()->SpawnActor<ASkeletalMeshActor>();
+	if (!TestNotNull(TEXT("Skeletal mesh actor"), Actor))
+		return false;
+
+	USkeletalMeshComponent* Component = Actor->GetSkeletalMeshComponent();
+	Component->SetSkeletalMeshAsset(Mesh);
+
+	const FBox ExactBounds = CalcSkinnedMeshLocalBounds(Component, EThumbnailBoundsMode::EExact, SampleCount).Bounds;
+	const double MeshSize  = FMath::Max(ExactBounds.GetSize().GetMax(), UE_KINDA_SMALL_NUMBER);
+
+	const UEnum* BoundsModeEnum = StaticEnum<EThumbnailBoundsMode>();
+	for (int32 i = 0; i < BoundsModeEnum->NumEnums() - 1; i++) // Skip _MAX
+	{
+		const EThumbnailBoundsMode BoundsMode = (EThumbnailBoundsMode)BoundsModeEnum->GetValueByIndex(i);
+
+		FSkinnedMeshBounds Bounds;
+		const uint64 StartCycles = FPlatformTime::Cycles64();
+		for (int32 Iteration = 0; Iteration < NumIterations; Iteration++)
+			Bounds = CalcSkinnedMeshLocalBounds(Component, BoundsMode, SampleCount);
+
+		const double Ms = FPlatformTime::ToMilliseconds64(FPlatformTime::Cycles64() - StartCycles) / NumIterations;
+
+		// The largest distance between a face of the bounds and the same face of the exact bounds
+		const double Error = FMath::Max((Bounds.Bounds.Min - ExactBounds.Min).GetAbs().GetMax(), (Bounds.Bounds.Max - ExactBounds.Max).GetAbs().GetMax());
+
+		AddInfo(FString::Printf(TEXT("Bounds mode %s (%s): %.4f ms, %d vertices skinned, error %.2f%% of the mesh size (estimated %.2f%%)"),
+			*BoundsModeEnum->GetDisplayNameTextByIndex(i).ToString(), *Mesh->GetName(), Ms, Bounds.NumSkinnedVertices, Error / MeshSize * 100.0, Bounds.ErrorEstimate / MeshSize * 100.0));
+	}
+
+	Actor->Destroy();
+
+	return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
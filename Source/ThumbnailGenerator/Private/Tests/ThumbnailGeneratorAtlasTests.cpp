@@ -0,0 +1,277 @@
+// Copyright Mans Isaksson. All Rights Reserved.
+
+#include "CoreMinimal.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include "ThumbnailGenerator.h"
+#include "ThumbnailGeneratorSettings.h"
+#include "ThumbnailCaptureBackend.h"
+
+#include "Engine/Texture2D.h"
+#include "Templates/UnrealTemplate.h"
+
+// Checks the thumbnail atlases, the multi-view thumbnails, the flipbook of the scene simulation and the layout of their tiles.
+// The pixels of the tiles are only compared with the deterministic CPU capture backend (-nullrhi or -ThumbnailCPUCapture).
+
+namespace ThumbnailGeneratorAtlasTests
+{
+	static const TCHAR* ActorClassPath = TEXT("/ThumbnailGenerator/SkySphere/BP_ThumbnailGenerator_SkySphere.BP_ThumbnailGenerator_SkySphere_C");
+
+	static constexpr int32 TileSize = 32;
+
+	static FThumbnailSettings MakeThumbnailSettings(EThumbnailBitDepth BitDepth, EThumbnailSceneSimulationMode SimulationMode)
+	{
+		FThumbnailSettings Overrides;
+		Overrides.bOverride_ThumbnailTextureWidth  = true;
+		Overrides.ThumbnailTextureWidth            = TileSize;
+		Overrides.bOverride_ThumbnailTextureHeight = true;
+		Overrides.ThumbnailTextureHeight           = TileSize;
+		Overrides.bOverride_ThumbnailBitDepth      = true;
+		Overrides.ThumbnailBitDepth                = BitDepth;
+		Overrides.bOverride_SimulationMode         = true;
+		Overrides.SimulationMode                   = SimulationMode;
+		Overrides.bOverride_SimulateSceneTime      = true;
+		Overrides.SimulateSceneTime                = 1.f;
+		Overrides.bOverride_SimulateSceneFramerate = true;
+		Overrides.SimulateSceneFramerate           = 8.f;
+
+		return FThumbnailSettings::MergeThumbnailSettings(UThumbnailGeneratorSettings::Get()->DefaultThumbnailSettings, Overrides);
+	}
+
+	static int32 GetBytesPerPixel(const UTexture2D* Texture)
+	{
+		return Texture->GetPixelFormat() == PF_B8G8R8A8 ? sizeof(FColor) : sizeof(FFloat16Color);
+	}
+
+	// The pixels of a rectangle of the texture's mip, row by row
+	static TArray<uint8> ReadPixels(UTexture2D* Texture, const FIntPoint& Offset, const FIntPoint& Size)
+	{
+		TArray<uint8> Pixels;
+
+		FTexturePlatformData* PlatformData = Texture->GetPlatformData();
+		if (!PlatformData || PlatformData->Mips.Num() == 0)
+			return Pixels;
+
+		FByteBulkData& BulkData = PlatformData->Mips[0].BulkData;
+		const uint8* MipData = static_cast<const uint8*>(BulkData.LockReadOnly());
+		if (MipData)
+		{
+			const int64 BytesPerPixel = GetBytesPerPixel(Texture);
+			const int64 MipRowBytes   = Texture->GetSizeX() * BytesPerPixel;
+			const int64 RowBytes      = Size.X * BytesPerPixel;
+
+			Pixels.SetNumUninitialized(RowBytes * Size.Y);
+			for (int32 Row = 0; Row < Size.Y; Row++)
+				FMemory::Memcpy(Pixels.GetData() + Row * RowBytes, MipData + (Offset.Y + Row) * MipRowBytes + Offset.X * BytesPerPixel, RowBytes);
+		}
+		BulkData.Unlock();
+
+		return Pixels;
+	}
+
+	static TArray<uint8> ReadTile(UTexture2D* Atlas, const FThumbnailAtlasLayout& Layout, int32 TileIndex)
+	{
+		return ReadPixels(Atlas, Layout.GetTileOffset(TileIndex), FIntPoint(Layout.TileWidth, Layout.TileHeight));
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FThumbnailGeneratorAtlasLayoutTest, "ThumbnailGenerator.Atlas.Layout", EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FThumbnailGeneratorAtlasLayoutTest::RunTest(const FString& Parameters)
+{
+	// Square by default, the last row is partially filled
+	const FThumbnailAtlasLayout Layout = FThumbnailAtlasLayout::Make(5, 32, 16);
+	TestEqual(TEXT("Tiles"), Layout.NumTiles, 5);
+	TestEqual(TEXT("Columns"), Layout.NumColumns, 3);
+	TestEqual(TEXT("Rows"), Layout.NumRows, 2);
+	TestEqual(TEXT("Atlas width"), Layout.GetAtlasWidth(), 96);
+	TestEqual(TEXT("Atlas height"), Layout.GetAtlasHeight(), 32);
+	TestEqual(TEXT("Frame rate"), Layout.FrameRate, 0.f);
+
+	// Tiles are laid out row by row
+	const FIntPoint ExpectedOffsets[] = { { 0, 0 }, { 32, 0 }, { 64, 0 }, { 0, 16 }, { 32, 16 } };
+	for (int32 TileIndex = 0; TileIndex < Layout.NumTiles; TileIndex++)
+	{
+		const FIntPoint Offset = Layout.GetTileOffset(TileIndex);
+		TestTrue(*FString::Printf(TEXT("Tile %d offset"), TileIndex), Offset == ExpectedOffsets[TileIndex]);
+
+		// The UVs cover the same pixels as the offset and tile size
+		const FBox2D UVs = Layout.GetTileUVs(TileIndex);
+		const FVector2D AtlasSize(Layout.GetAtlasWidth(), Layout.GetAtlasHeight());
+		TestTrue(*FString::Printf(TEXT("Tile %d UV min"), TileIndex), (UVs.Min * AtlasSize).Equals(FVector2D(Offset), 1e-3));
+		TestTrue(*FString::Printf(TEXT("Tile %d UV max"), TileIndex), (UVs.Max * AtlasSize).Equals(FVector2D(Offset + FIntPoint(Layout.TileWidth, Layout.TileHeight)), 1e-3));
+	}
+
+	const FThumbnailAtlasLayout TwoColumns = FThumbnailAtlasLayout::Make(5, 32, 16, 2);
+	TestEqual(TEXT("Requested columns"), TwoColumns.NumColumns, 2);
+	TestEqual(TEXT("Rows of requested columns"), TwoColumns.NumRows, 3);
+	TestTrue(TEXT("Last tile of requested columns"), TwoColumns.GetTileOffset(4) == FIntPoint(0, 32));
+
+	const FBox2D LastTileUVs = TwoColumns.GetTileUVs(4);
+	TestTrue(TEXT("Last tile UVs of requested columns"), LastTileUVs.Min.Equals(FVector2D(0.0, 2.0 / 3.0), 1e-6) && LastTileUVs.Max.Equals(FVector2D(0.5, 1.0), 1e-6));
+
+	const FThumbnailAtlasLayout SingleRow = FThumbnailAtlasLayout::Make(3, 32, 32, 8);
+	TestEqual(TEXT("Columns are clamped to the tiles"), SingleRow.NumColumns, 3);
+	TestEqual(TEXT("Rows of clamped columns"), SingleRow.NumRows, 1);
+
+	const FThumbnailAtlasLayout Empty = FThumbnailAtlasLayout::Make(0, 32, 32);
+	TestEqual(TEXT("Empty layout columns"), Empty.NumColumns, 1);
+	TestEqual(TEXT("Empty layout rows"), Empty.NumRows, 1);
+	TestTrue(TEXT("Tile UVs without columns"), FThumbnailAtlasLayout().GetTileUVs(0) == FBox2D(FVector2D::ZeroVector, FVector2D::ZeroVector));
+
+	return !HasAnyErrors();
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FThumbnailGeneratorMultiViewTest, "ThumbnailGenerator.Atlas.MultiView", EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FThumbnailGeneratorMultiViewTest::RunTest(const FString& Parameters)
+{
+	using namespace ThumbnailGeneratorAtlasTests;
+
+	UClass* ActorClass = LoadClass<AActor>(nullptr, ActorClassPath);
+	if (!TestNotNull(TEXT("Test actor class"), ActorClass))
+		return false;
+
+	UThumbnailGeneratorSettings* GeneratorSettings = UThumbnailGeneratorSettings::Get();
+	TGuardValue<bool> DiskCacheGuard(GeneratorSettings->bEnableThumbnailDiskCache, false);
+	TGuardValue<int32> ResultCacheGuard(GeneratorSettings->MaxThumbnailResultCacheSize, 0);
+
+	FThumbnailGenerator Generator(false);
+	Generator.InitializeThumbnailWorld(FThumbnailBackgroundSceneSettings());
+
+	const FThumbnailSettings Settings = MakeThumbnailSettings(EThumbnailBitDepth::E8, EThumbnailSceneSimulationMode::ENone);
+
+	const TArray<FRotator> Rotations = FThumbnailGenerator::MakeTurntableRotations(5, Settings.CameraOrbitRotation);
+	TestEqual(TEXT("Turntable rotations"), Rotations.Num(), 5);
+	for (int32 ViewIndex = 0; ViewIndex < Rotations.Num(); ViewIndex++)
+	{
+		const FRotator Expected(Settings.CameraOrbitRotation.Pitch, Settings.CameraOrbitRotation.Yaw + 72.0 * ViewIndex, Settings.CameraOrbitRotation.Roll);
+		TestTrue(*FString::Printf(TEXT("Turntable rotation %d"), ViewIndex), Rotations[ViewIndex].Equals(Expected, 1e-3));
+	}
+
+	const TArray<UTexture2D*> Views = Generator.GenerateActorThumbnailViews(ActorClass, Settings, Rotations);
+
+	FThumbnailAtlasLayout Layout;
+	UTexture2D* Atlas = Generator.GenerateActorThumbnailAtlas(ActorClass, Settings, Rotations, Layout);
+
+	if (TestEqual(TEXT("One thumbnail per view"), Views.Num(), Rotations.Num()) && TestNotNull(TEXT("Atlas"), Atlas))
+	{
+		TestEqual(TEXT("Atlas tiles"), Layout.NumTiles, Rotations.Num());
+		TestEqual(TEXT("Atlas width"), Atlas->GetSizeX(), Layout.GetAtlasWidth());
+		TestEqual(TEXT("Atlas height"), Atlas->GetSizeY(), Layout.GetAtlasHeight());
+
+		FThumbnailSettings ViewSettings = Settings;
+		for (int32 ViewIndex = 0; ViewIndex < Views.Num(); ViewIndex++)
+		{
+			UTexture2D* View = Views[ViewIndex];
+			if (!TestNotNull(*FString::Printf(TEXT("View %d"), ViewIndex), View))
+				continue;
+
+			TestEqual(*FString::Printf(TEXT("View %d width"), ViewIndex), View->GetSizeX(), TileSize);
+			TestEqual(*FString::Printf(TEXT("View %d height"), ViewIndex), View->GetSizeY(), TileSize);
+
+			// Each view, and each tile of the atlas, matches a capture of its own at the same rotation
+			if (ThumbnailGenerator::ShouldUseCPUCaptureBackend())
+			{
+				ViewSettings.CameraOrbitRotation = Rotations[ViewIndex];
+				UTexture2D* Thumbnail = Generator.GenerateActorThumbnail(ActorClass, ViewSettings);
+				if (TestNotNull(*FString::Printf(TEXT("Thumbnail %d"), ViewIndex), Thumbnail))
+				{
+					const TArray<uint8> ThumbnailPixels = ReadPixels(Thumbnail, FIntPoint::ZeroValue, FIntPoint(TileSize, TileSize));
+					TestTrue(*FString::Printf(TEXT("View %d matches the thumbnail"), ViewIndex), ReadPixels(View, FIntPoint::ZeroValue, FIntPoint(TileSize, TileSize)) == ThumbnailPixels);
+					TestTrue(*FString::Printf(TEXT("Tile %d matches the thumbnail"), ViewIndex), ReadTile(Atlas, Layout, ViewIndex) == ThumbnailPixels);
+				}
+				Generator.ReleaseThumbnail(Thumbnail);
+			}
+		}
+	}
+
+	for (UTexture2D* View : Views)
+		Generator.ReleaseThumbnail(View);
+	Generator.ReleaseThumbnail(Atlas);
+
+	AddExpectedError(TEXT("No camera orbit rotations"), EAutomationExpectedErrorFlags::Contains, 1);
+	TestNull(TEXT("Atlas without rotations"), Generator.GenerateActorThumbnailAtlas(ActorClass, Settings, TConstArrayView<FRotator>(), Layout));
+
+	return !HasAnyErrors();
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FThumbnailGeneratorFlipbookTest, "ThumbnailGenerator.Atlas.Flipbook", EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FThumbnailGeneratorFlipbookTest::RunTest(const FString& Parameters)
+{
+	using namespace ThumbnailGeneratorAtlasTests;
+
+	UClass* ActorClass = LoadClass<AActor>(nullptr, ActorClassPath);
+	if (!TestNotNull(TEXT("Test actor class"), ActorClass))
+		return false;
+
+	UThumbnailGeneratorSettings* GeneratorSettings = UThumbnailGeneratorSettings::Get();
+	TGuardValue<bool> DiskCacheGuard(GeneratorSettings->bEnableThumbnailDiskCache, false);
+
+	FThumbnailGenerator Generator(false);
+	Generator.InitializeThumbnailWorld(FThumbnailBackgroundSceneSettings());
+
+	// 8 simulated steps, a frame every 2nd step
+	for (const EThumbnailBitDepth BitDepth : { EThumbnailBitDepth::E8, EThumbnailBitDepth::E16 })
+	{
+		const FThumbnailSettings Settings = MakeThumbnailSettings(BitDepth, EThumbnailSceneSimulationMode::EAllComponents);
+		const FString BitDepthName = StaticEnum<EThumbnailBitDepth>()->GetNameStringByValue((int64)BitDepth);
+
+		FThumbnailAtlasLayout Layout;
+		UTexture2D* Flipbook = Generator.GenerateActorThumbnailFlipbook(ActorClass, Settings, 2, false, Layout);
+		if (!TestNotNull(*FString::Printf(TEXT("%s flipbook"), *BitDepthName), Flipbook))
+			continue;
+
+		TestEqual(*FString::Printf(TEXT("%s frames"), *BitDepthName), Layout.NumTiles, 4);
+		TestEqual(*FString::Printf(TEXT("%s columns"), *BitDepthName), Layout.NumColumns, 2);
+		TestEqual(*FString::Printf(TEXT("%s rows"), *BitDepthName), Layout.NumRows, 2);
+		TestEqual(*FString::Printf(TEXT("%s frame rate"), *BitDepthName), Layout.FrameRate, 4.f);
+		TestEqual(*FString::Printf(TEXT("%s atlas width"), *BitDepthName), Flipbook->GetSizeX(), 2 * TileSize);
+		TestEqual(*FString::Printf(TEXT("%s atlas height"), *BitDepthName), Flipbook->GetSizeY(), 2 * TileSize);
+		TestEqual(*FString::Printf(TEXT("%s pixel format"), *BitDepthName), (int32)Flipbook->GetPixelFormat(), (int32)(BitDepth == EThumbnailBitDepth::E8 ? PF_B8G8R8A8 : PF_FloatRGBA));
+
+		// The sky sphere holds still, so with one framing solution every frame matches a regular capture
+		if (ThumbnailGenerator::ShouldUseCPUCaptureBackend())
+		{
+			UTexture2D* Thumbnail = Generator.GenerateActorThumbnail(ActorClass, Settings);
+			if (TestNotNull(*FString::Printf(TEXT("%s thumbnail"), *BitDepthName), Thumbnail))
+			{
+				const TArray<uint8> ThumbnailPixels = ReadPixels(Thumbnail, FIntPoint::ZeroValue, FIntPoint(TileSize, TileSize));
+				for (int32 FrameIndex = 0; FrameIndex < Layout.NumTiles; FrameIndex++)
+					TestTrue(*FString::Printf(TEXT("%s frame %d matches the thumbnail"), *BitDepthName, FrameIndex), ReadTile(Flipbook, Layout, FrameIndex) == ThumbnailPixels);
+			}
+			Generator.ReleaseThumbnail(Thumbnail);
+		}
+
+		Generator.ReleaseThumbnail(Flipbook);
+	}
+
+	{
+		const FThumbnailSettings Settings = MakeThumbnailSettings(EThumbnailBitDepth::E8, EThumbnailSceneSimulationMode::EAllComponents);
+
+		FThumbnailAtlasLayout Layout;
+		UTexture2D* Flipbook = Generator.GenerateActorThumbnailFlipbook(ActorClass, Settings, 3, true, Layout, 4);
+		if (TestNotNull(TEXT("Flipbook framed per frame"), Flipbook))
+		{
+			TestEqual(TEXT("Frames of a partial last frame"), Layout.NumTiles, 2);
+			TestEqual(TEXT("Columns are clamped to the frames"), Layout.NumColumns, 2);
+			TestEqual(TEXT("Frame rate"), Layout.FrameRate, 8.f / 3.f);
+		}
+		Generator.ReleaseThumbnail(Flipbook);
+	}
+
+	FThumbnailAtlasLayout Layout;
+
+	AddExpectedError(TEXT("A flipbook requires a simulation mode"), EAutomationExpectedErrorFlags::Contains, 1);
+	TestNull(TEXT("Flipbook without simulation"), Generator.GenerateActorThumbnailFlipbook(ActorClass, MakeThumbnailSettings(EThumbnailBitDepth::E8, EThumbnailSceneSimulationMode::ENone), 1, false, Layout));
+
+	AddExpectedError(TEXT("is shorter than a frame"), EAutomationExpectedErrorFlags::Contains, 1);
+	TestNull(TEXT("Flipbook shorter than a frame"), Generator.GenerateActorThumbnailFlipbook(ActorClass, MakeThumbnailSettings(EThumbnailBitDepth::E8, EThumbnailSceneSimulationMode::EAllComponents), 9, false, Layout));
+
+	return !HasAnyErrors();
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
@@ -0,0 +1,485 @@
+// Copyright Mans Isaksson. All Rights Reserved.
+
+#include "CoreMinimal.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include "ThumbnailGenerator.h"
+#include "ThumbnailGeneratorModule.h"
+#include "ThumbnailGeneratorSettings.h"
+#include "ThumbnailCaptureBackend.h"
+
+#include "Blueprint/UserWidget.h"
+#include "Components/StaticMeshComponent.h"
+#include "Engine/StaticMesh.h"
+#include "Engine/StaticMeshActor.h"
+#include "Engine/Texture2D.h"
+#include "Engine/World.h"
+#include "HAL/PlatformTime.h"
+#include "Misc/CommandLine.h"
+#include "Misc/DateTime.h"
+#include "Misc/FileHelper.h"
+#include "Misc/PackageName.h"
+#include "Misc/Parse.h"
+#include "Misc/Paths.h"
+#include "Templates/UnrealTemplate.h"
+
+// Throughput benchmark of the synchronous thumbnail path (BeginGenerateActorThumbnail + FinishGenerateActorThumbnail).
+//
+// Each case changes one setting from the reference case (256x256, 8-bit, no alpha, no simulation, preview scene, no UI),
+// captures a number of thumbnails and reports thumbnails/second and p50/p95/p99 latency. Results are appended to
+// Saved/Automation/ThumbnailGeneratorPerf.csv.
+//
+// If a baseline file exists, the case fails when its throughput drops, or its p95 latency rises, by more than the
+// regression threshold. Baselines are only compared against results from the same capture backend.
+//
+// Runs headless, under -nullrhi the CPU capture backend is used. Command line options:
+//   -ThumbnailPerfIterations=N        Measured captures per case (default 100)
+//   -ThumbnailPerfWarmup=N            Unmeasured captures per case (default 10)
+//   -ThumbnailPerfThreshold=Percent   Default regression threshold (default 15)
+//   -ThumbnailPerfBaseline=Path       Baseline file (default Saved/Automation/ThumbnailGeneratorPerfBaseline.csv)
+//   -ThumbnailPerfWriteBaseline       Store the results of this run in the baseline file instead of comparing
+//   -ThumbnailPerfBackgroundWorld=Map World used by the background scene case (default /Engine/Maps/Entry)
+//   -ThumbnailPerfWorldActors=N       Actors added to the thumbnail world by the large world case (default 10000)
+
+namespace ThumbnailGeneratorPerf
+{
+	struct FPerfCase
+	{
+		int32 Size                                   = 256;
+		EThumbnailBitDepth BitDepth                  = EThumbnailBitDepth::E8;
+		bool bCaptureAlpha                           = false;
+		EThumbnailSceneSimulationMode SimulationMode = EThumbnailSceneSimulationMode::ENone;
+		bool bBackgroundScene                        = false;
+		bool bThumbnailUI                            = false;
+		bool bLargeWorld                             = false; // Fills the thumbnail world with -ThumbnailPerfWorldActors idle actors, like a large background level
+	};
+
+	struct FPerfResult
+	{
+		int32 NumCaptures          = 0;
+		double ThumbnailsPerSecond = 0.0;
+		double P50Ms               = 0.0;
+		double P95Ms               = 0.0;
+		double P99Ms               = 0.0;
+		double MaxMs               = 0.0;
+	};
+
+	struct FBaselineEntry
+	{
+		double ThumbnailsPerSecond = 0.0;
+		double P95Ms               = 0.0;
+		float Threshold            = -1.f; // Percent, negative to use the default threshold
+	};
+
+	static const TCHAR* ResultsHeader  = TEXT("Timestamp,Case,Backend,Width,Height,BitDepth,Alpha,Simulation,Scene,UI,Iterations,ThumbnailsPerSecond,P50Ms,P95Ms,P99Ms,MaxMs");
+	static const TCHAR* BaselineHeader = TEXT("Case,Backend,ThumbnailsPerSecond,P95Ms,Threshold");
+
+	static TMap<FString, FPerfCase> GetPerfCases()
+	{
+		TMap<FString, FPerfCase> Cases;
+
+		const FPerfCase Reference;
+		Cases.Add(TEXT("Reference"), Reference);
+
+		for (int32 Size : { 64, 512, 1024, 2048 })
+		{
+			FPerfCase& Case = Cases.Add(FString::Printf(TEXT("Size_%d"), Size), Reference);
+			Case.Size = Size;
+		}
+
+		Cases.Add(TEXT("BitDepth_E16"), Reference).BitDepth = EThumbnailBitDepth::E16;
+		Cases.Add(TEXT("Alpha_On"), Reference).bCaptureAlpha = true;
+		Cases.Add(TEXT("Scene_Background"), Reference).bBackgroundScene = true;
+		Cases.Add(TEXT("Scene_LargeWorld"), Reference).bLargeWorld = true;
+		Cases.Add(TEXT("UI_On"), Reference).bThumbnailUI = true;
+
+		const UEnum* SimulationModeEnum = StaticEnum<EThumbnailSceneSimulationMode>();
+		for (int32 i = 0; i < SimulationModeEnum->NumEnums() - 1; i++) // Skip _MAX
+		{
+			const EThumbnailSceneSimulationMode SimulationMode = (EThumbnailSceneSimulationMode)SimulationModeEnum->GetValueByIndex(i);
+			if (SimulationMode == Reference.SimulationMode)
+				continue;
+
+			FPerfCase& Case = Cases.Add(FString::Printf(TEXT("Simulation_%s"), *SimulationModeEnum->GetNameStringByIndex(i)), Reference);
+			Case.SimulationMode = SimulationMode;
+		}
+
+		return Cases;
+	}
+
+	static FThumbnailSettings MakeThumbnailSettings(const FPerfCase& Case)
+	{
+		FThumbnailSettings Overrides;
+		Overrides.bOverride_ThumbnailTextureWidth  = true;
+		Overrides.ThumbnailTextureWidth            = Case.Size;
+		Overrides.bOverride_ThumbnailTextureHeight = true;
+		Overrides.ThumbnailTextureHeight           = Case.Size;
+		Overrides.bOverride_ThumbnailBitDepth      = true;
+		Overrides.ThumbnailBitDepth                = Case.BitDepth;
+		Overrides.bOverride_bCaptureAlpha          = true;
+		Overrides.bCaptureAlpha                    = Case.bCaptureAlpha;
+		Overrides.bOverride_ThumbnailUI            = true;
+		Overrides.ThumbnailUI                      = Case.bThumbnailUI ? UUserWidget::StaticClass() : nullptr;
+		Overrides.bOverride_SimulationMode         = true;
+		Overrides.SimulationMode                   = Case.SimulationMode;
+
+		if (Case.SimulationMode != EThumbnailSceneSimulationMode::ENone)
+		{
+			Overrides.bOverride_SimulateSceneTime      = true;
+			Overrides.SimulateSceneTime                = 0.5f;
+			Overrides.bOverride_SimulateSceneFramerate = true;
+			Overrides.SimulateSceneFramerate           = 30.f;
+		}
+
+		if (Case.SimulationMode == EThumbnailSceneSimulationMode::ESpecifiedComponents)
+		{
+			Overrides.bOverride_ComponentsToSimulate = true;
+			Overrides.ComponentsToSimulate           = { UStaticMeshComponent::StaticClass() };
+		}
+
+		return FThumbnailSettings::MergeThumbnailSettings(UThumbnailGeneratorSettings::Get()->DefaultThumbnailSettings, Overrides);
+	}
+
+	static double GetPercentile(const TArray<double>& SortedValues, double Percentile)
+	{
+		if (SortedValues.Num() == 0)
+			return 0.0;
+
+		// Nearest-rank
+		const int32 Rank = FMath::CeilToInt(Percentile / 100.0 * SortedValues.Num());
+		return SortedValues[FMath::Clamp(Rank - 1, 0, SortedValues.Num() - 1)];
+	}
+
+	static FString GetBackendName()
+	{
+		return ThumbnailGenerator::ShouldUseCPUCaptureBackend() ? TEXT("CPU") : TEXT("SceneCapture");
+	}
+
+	static FString GetBackgroundWorldPath()
+	{
+		FString WorldPath = TEXT("/Engine/Maps/Entry");
+		FParse::Value(FCommandLine::Get(), TEXT("ThumbnailPerfBackgroundWorld="), WorldPath);
+		return WorldPath;
+	}
+
+	static FString GetBaselinePath()
+	{
+		FString BaselinePath = FPaths::Combine(FPaths::AutomationDir(), TEXT("ThumbnailGeneratorPerfBaseline.csv"));
+		FParse::Value(FCommandLine::Get(), TEXT("ThumbnailPerfBaseline="), BaselinePath);
+		return BaselinePath;
+	}
+
+	static FString MakeBaselineKey(const FString& CaseName, const FString& Backend)
+	{
+		return CaseName + TEXT("|") + Backend;
+	}
+
+	static TMap<FString, FBaselineEntry> LoadBaseline(const FString& BaselinePath)
+	{
+		TMap<FString, FBaselineEntry> Baseline;
+
+		TArray<FString> Lines;
+		if (!FFileHelper::LoadFileToStringArray(Lines, *BaselinePath))
+			return Baseline;
+
+		for (const FString& Line : Lines)
+		{
+			TArray<FString> Columns;
+			Line.ParseIntoArray(Columns, TEXT(","), false);
+			if (Columns.Num() < 4 || Line.StartsWith(TEXT("#")) || Columns[0] == TEXT("Case"))
+				continue;
+
+			FBaselineEntry& Entry = Baseline.Add(MakeBaselineKey(Columns[0].TrimStartAndEnd(), Columns[1].TrimStartAndEnd()));
+			Entry.ThumbnailsPerSecond = FCString::Atod(*Columns[2]);
+			Entry.P95Ms               = FCString::Atod(*Columns[3]);
+
+			if (Columns.IsValidIndex(4) && !Columns[4].TrimStartAndEnd().IsEmpty())
+				Entry.Threshold = FCString::Atof(*Columns[4]);
+		}
+
+		return Baseline;
+	}
+
+	static bool SaveBaseline(const FString& BaselinePath, const TMap<FString, FBaselineEntry>& Baseline)
+	{
+		TArray<FString> Keys;
+		Baseline.GetKeys(Keys);
+		Keys.Sort();
+
+		TArray<FString> Lines = { BaselineHeader };
+		for (const FString& Key : Keys)
+		{
+			FString CaseName, Backend;
+			Key.Split(TEXT("|"), &CaseName, &Backend);
+
+			const FBaselineEntry& Entry = Baseline[Key];
+			Lines.Add(FString::Printf(TEXT("%s,%s,%.3f,%.3f,%s"), *CaseName, *Backend, Entry.ThumbnailsPerSecond, Entry.P95Ms,
+				Entry.Threshold >= 0.f ? *FString::SanitizeFloat(Entry.Threshold) : TEXT("")));
+		}
+
+		return FFileHelper::SaveStringArrayToFile(Lines, *BaselinePath);
+	}
+
+	static void AppendResult(const FString& CaseName, const FPerfCase& Case, const FPerfResult& Result)
+	{
+		const FString ResultsPath = FPaths::Combine(FPaths::AutomationDir(), TEXT("ThumbnailGeneratorPerf.csv"));
+
+		FString Row;
+		if (!IFileManager::Get().FileExists(*ResultsPath))
+			Row += FString(ResultsHeader) + LINE_TERMINATOR;
+
+		Row += FString::Printf(TEXT("%s,%s,%s,%d,%d,%s,%d,%s,%s,%d,%d,%.3f,%.3f,%.3f,%.3f,%.3f") LINE_TERMINATOR,
+			*FDateTime::UtcNow().ToIso8601(),
+			*CaseName,
+			*GetBackendName(),
+			Case.Size,
+			Case.Size,
+			Case.BitDepth == EThumbnailBitDepth::E16 ? TEXT("E16") : TEXT("E8"),
+			Case.bCaptureAlpha ? 1 : 0,
+			*StaticEnum<EThumbnailSceneSimulationMode>()->GetNameStringByValue((int64)Case.SimulationMode),
+			Case.bBackgroundScene ? TEXT("Background") : Case.bLargeWorld ? TEXT("LargeWorld") : TEXT("Preview"),
+			Case.bThumbnailUI ? 1 : 0,
+			Result.NumCaptures,
+			Result.ThumbnailsPerSecond,
+			Result.P50Ms,
+			Result.P95Ms,
+			Result.P99Ms,
+			Result.MaxMs);
+
+		FFileHelper::SaveStringToFile(Row, *ResultsPath, FFileHelper::EEncodingOptions::AutoDetect, &IFileManager::Get(), FILEWRITE_Append);
+	}
+}
+
+IMPLEMENT_COMPLEX_AUTOMATION_TEST(FThumbnailGeneratorPerfThroughputTest, "ThumbnailGenerator.Perf.Throughput", EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+
+void FThumbnailGeneratorPerfThroughputTest::GetTests(TArray<FString>& OutBeautifiedNames, TArray<FString>& OutTestCommands) const
+{
+	TArray<FString> CaseNames;
+	ThumbnailGeneratorPerf::GetPerfCases().GetKeys(CaseNames);
+
+	for (const FString& CaseName : CaseNames)
+	{
+		OutBeautifiedNames.Add(CaseName);
+		OutTestCommands.Add(CaseName);
+	}
+}
+
+bool FThumbnailGeneratorPerfThroughputTest::RunTest(const FString& Parameters)
+{
+	using namespace ThumbnailGeneratorPerf;
+
+	const FPerfCase* Case = GetPerfCases().Find(Parameters);
+	if (!Case)
+	{
+		AddError(FString::Printf(TEXT("Unknown perf case '%s'"), *Parameters));
+		return false;
+	}
+
+	int32 NumIterations = 100;
+	int32 NumWarmup     = 10;
+	float Threshold     = 15.f;
+	FParse::Value(FCommandLine::Get(), TEXT("ThumbnailPerfIterations="), NumIterations);
+	FParse::Value(FCommandLine::Get(), TEXT("ThumbnailPerfWarmup="), NumWarmup);
+	FParse::Value(FCommandLine::Get(), TEXT("ThumbnailPerfThreshold="), Threshold);
+	NumIterations = FMath::Max(1, NumIterations);
+	NumWarmup     = FMath::Max(0, NumWarmup);
+
+	FThumbnailBackgroundSceneSettings BackgroundSceneSettings;
+	if (Case->bBackgroundScene)
+	{
+		const FString WorldPath = GetBackgroundWorldPath();
+		if (!FPackageName::DoesPackageExist(WorldPath))
+		{
+			AddWarning(FString::Printf(TEXT("Background world '%s' does not exist, skipping. Use -ThumbnailPerfBackgroundWorld= to specify a world."), *WorldPath));
+			return true;
+		}
+		BackgroundSceneSettings.BackgroundWorld = TSoftObjectPtr<UWorld>(FSoftObjectPath(WorldPath));
+	}
+
+	UStaticMesh* Mesh = LoadObject<UStaticMesh>(nullptr, TEXT("/Engine/BasicShapes/Cube.Cube"));
+	if (!TestNotNull(TEXT("Benchmark mesh"), Mesh))
+		return false;
+
+	// A dedicated generator, so the benchmark neither shares caches with nor invalidates the global one
+	FThumbnailGenerator Generator(false);
+	Generator.InitializeThumbnailWorld(BackgroundSceneSettings);
+
+	if (Case->bLargeWorld)
+	{
+		int32 NumWorldActors = 10000;
+		FParse::Value(FCommandLine::Get(), TEXT("ThumbnailPerfWorldActors="), NumWorldActors);
+
+		// Actors which are already in the world when a capture starts are left alone, only their number matters
+		for (int32 i = 0; i < NumWorldActors; i++)
+			Generator.GetThumbnailWorld()->SpawnActor<AActor>();
+	}
+
+	const FThumbnailSettings ThumbnailSettings = MakeThumbnailSettings(*Case);
+
+	const auto CaptureThumbnail = [&]() -> bool
+	{
+		AActor* Actor = Generator.BeginGenerateActorThumbnail(AStaticMeshActor::StaticClass(), ThumbnailSettings, TMap<FString, FString>(), false);
+		if (AStaticMeshActor* MeshActor = Cast<AStaticMeshActor>(Actor))
+		{
+			MeshActor->GetStaticMeshComponent()->SetMobility(EComponentMobility::Movable);
+			MeshActor->GetStaticMeshComponent()->SetStaticMesh(Mesh);
+		}
+		return Generator.FinishGenerateActorThumbnail(Actor, ThumbnailSettings, nullptr, true) != nullptr;
+	};
+
+	for (int32 i = 0; i < NumWarmup; i++)
+		CaptureThumbnail();
+
+	TArray<double> LatenciesMs;
+	LatenciesMs.Reserve(NumIterations);
+
+	int32 NumFailed = 0;
+	const uint64 StartCycles = FPlatformTime::Cycles64();
+	for (int32 i = 0; i < NumIterations; i++)
+	{
+		const uint64 CaptureStartCycles = FPlatformTime::Cycles64();
+		if (!CaptureThumbnail())
+			NumFailed++;
+		LatenciesMs.Add(FPlatformTime::ToMilliseconds64(FPlatformTime::Cycles64() - CaptureStartCycles));
+	}
+	const double TotalSeconds = FPlatformTime::ToSeconds64(FPlatformTime::Cycles64() - StartCycles);
+
+	if (NumFailed > 0)
+	{
+		AddError(FString::Printf(TEXT("%d of %d thumbnails failed to generate"), NumFailed, NumIterations));
+		return false;
+	}
+
+	LatenciesMs.Sort();
+
+	FPerfResult Result;
+	Result.NumCaptures         = NumIterations;
+	Result.ThumbnailsPerSecond = TotalSeconds > 0.0 ? NumIterations / TotalSeconds : 0.0;
+	Result.P50Ms               = GetPercentile(LatenciesMs, 50.0);
+	Result.P95Ms               = GetPercentile(LatenciesMs, 95.0);
+	Result.P99Ms               = GetPercentile(LatenciesMs, 99.0);
+	Result.MaxMs               = LatenciesMs.Last();
+
+	const FString Backend = GetBackendName();
+	AddInfo(FString::Printf(TEXT("%s (%s): %.1f thumbnails/s, p50 %.3f ms, p95 %.3f ms, p99 %.3f ms"),
+		*Parameters, *Backend, Result.ThumbnailsPerSecond, Result.P50Ms, Result.P95Ms, Result.P99Ms));
+
+	AppendResult(Parameters, *Case, Result);
+
+	const FString BaselinePath = GetBaselinePath();
+	TMap<FString, FBaselineEntry> Baseline = LoadBaseline(BaselinePath);
+	const FString BaselineKey = MakeBaselineKey(Parameters, Backend);
+
+	if (FParse::Param(FCommandLine::Get(), TEXT("ThumbnailPerfWriteBaseline")))
+	{
+		// Keep a hand-tuned threshold when refreshing the numbers
+		FBaselineEntry& Entry = Baseline.FindOrAdd(BaselineKey);
+		Entry.ThumbnailsPerSecond = Result.ThumbnailsPerSecond;
+		Entry.P95Ms               = Result.P95Ms;
+
+		if (!SaveBaseline(BaselinePath, Baseline))
+			AddError(FString::Printf(TEXT("Failed to write baseline '%s'"), *BaselinePath));
+		return true;
+	}
+
+	const FBaselineEntry* Entry = Baseline.Find(BaselineKey);
+	if (!Entry)
+	{
+		AddInfo(FString::Printf(TEXT("No baseline for %s (%s) in '%s', run with -ThumbnailPerfWriteBaseline to create one"), *Parameters, *Backend, *BaselinePath));
+		return true;
+	}
+
+	const double Tolerance = (Entry->Threshold >= 0.f ? Entry->Threshold : Threshold) / 100.0;
+
+	if (Entry->ThumbnailsPerSecond > 0.0 && Result.ThumbnailsPerSecond < Entry->ThumbnailsPerSecond * (1.0 - Tolerance))
+	{
+		AddError(FString::Printf(TEXT("Throughput regressed: %.1f thumbnails/s, baseline %.1f (threshold %.0f%%)"),
+			Result.ThumbnailsPerSecond, Entry->ThumbnailsPerSecond, Tolerance * 100.0));
+	}
+
+	if (Entry->P95Ms > 0.0 && Result.P95Ms > Entry->P95Ms * (1.0 + Tolerance))
+	{
+		AddError(FString::Printf(TEXT("p95 latency regressed: %.3f ms, baseline %.3f ms (threshold %.0f%%)"),
+			Result.P95Ms, Entry->P95Ms, Tolerance * 100.0));
+	}
+
+	return !HasAnyErrors();
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FThumbnailGeneratorPerfActorPoolTest, "ThumbnailGenerator.Perf.ActorPool", EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+
+// Per-capture speedup of reusing the thumbnail actor (UThumbnailGeneratorSettings::PooledActorClasses) with the reference case settings.
+// Takes -ThumbnailPerfIterations= and -ThumbnailPerfWarmup=, the results are only reported.
+bool FThumbnailGeneratorPerfActorPoolTest::RunTest(const FString& Parameters)
+{
+	using namespace ThumbnailGeneratorPerf;
+
+	int32 NumIterations = 100;
+	int32 NumWarmup     = 10;
+	FParse::Value(FCommandLine::Get(), TEXT("ThumbnailPerfIterations="), NumIterations);
+	FParse::Value(FCommandLine::Get(), TEXT("ThumbnailPerfWarmup="), NumWarmup);
+	NumIterations = FMath::Max(1, NumIterations);
+	NumWarmup     = FMath::Max(0, NumWarmup);
+
+	UStaticMesh* Mesh = LoadObject<UStaticMesh>(nullptr, TEXT("/Engine/BasicShapes/Cube.Cube"));
+	if (!TestNotNull(TEXT("Benchmark mesh"), Mesh))
+		return false;
+
+	const FThumbnailSettings ThumbnailSettings = MakeThumbnailSettings(FPerfCase());
+
+	// Milliseconds per capture, negative if a capture failed
+	const auto MeasureCaptures = [&](bool bPoolActors) -> double
+	{
+		UThumbnailGeneratorSettings* Settings = UThumbnailGeneratorSettings::Get();
+		TGuardValue<TArray<TSoftClassPtr<AActor>>> PooledActorClassesGuard(Settings->PooledActorClasses, 
+			bPoolActors ? TArray<TSoftClassPtr<AActor>>{ AStaticMeshActor::StaticClass() } : TArray<TSoftClassPtr<AActor>>());
+		TGuardValue<int32> MaxPooledActorsGuard(Settings->MaxPooledThumbnailActors, FMath::Max(1, Settings->MaxPooledThumbnailActors));
+
+		FThumbnailGenerator Generator(false);
+		Generator.InitializeThumbnailWorld(FThumbnailBackgroundSceneSettings());
+
+		const auto CaptureThumbnail = [&]() -> bool
+		{
+			AActor* Actor = Generator.BeginGenerateActorThumbnail(AStaticMeshActor::StaticClass(), ThumbnailSettings, TMap<FString, FString>(), false);
+			if (AStaticMeshActor* MeshActor = Cast<AStaticMeshActor>(Actor))
+			{
+				MeshActor->GetStaticMeshComponent()->SetMobility(EComponentMobility::Movable);
+				MeshActor->GetStaticMeshComponent()->SetStaticMesh(Mesh);
+			}
+
+			UTexture2D* Thumbnail = Generator.FinishGenerateActorThumbnail(Actor, ThumbnailSettings, nullptr, true);
+			Generator.ReleaseThumbnail(Thumbnail);
+			return Thumbnail != nullptr;
+		};
+
+		for (int32 i = 0; i < NumWarmup; i++)
+			CaptureThumbnail();
+
+		const uint64 StartCycles = FPlatformTime::Cycles64();
+		for (int32 i = 0; i < NumIterations; i++)
+		{
+			if (!CaptureThumbnail())
+				return -1.0;
+		}
+
+		return FPlatformTime::ToMilliseconds64(FPlatformTime::Cycles64() - StartCycles) / NumIterations;
+	};
+
+	const double SpawnedMs = MeasureCaptures(false);
+	const double PooledMs  = MeasureCaptures(true);
+
+	if (SpawnedMs < 0.0 || PooledMs < 0.0)
+	{
+		AddError(TEXT("Failed to generate thumbnails"));
+		return false;
+	}
+
+	AddInfo(FString::Printf(TEXT("Actor pool (%s): %.3f ms/thumbnail spawned, %.3f ms/thumbnail pooled, %.2fx speedup"),
+		*GetBackendName(), SpawnedMs, PooledMs, PooledMs > 0.0 ? SpawnedMs / PooledMs : 0.0));
+
+	return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
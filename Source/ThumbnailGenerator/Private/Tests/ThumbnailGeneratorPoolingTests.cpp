@@ -0,0 +1,276 @@
+// Copyright Mans Isaksson. All Rights Reserved.
+
+#include "CoreMinimal.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include "ThumbnailGenerator.h"
+#include "ThumbnailGeneratorScript.h"
+#include "ThumbnailGeneratorSettings.h"
+
+#include "Components/StaticMeshComponent.h"
+#include "Engine/StaticMesh.h"
+#include "Engine/StaticMeshActor.h"
+#include "Engine/Texture2D.h"
+#include "Templates/UnrealTemplate.h"
+#include "UObject/UObjectArray.h"
+
+// Checks that once warmed up, repeated captures don't create any new UObjects: thumbnail textures handed back with
+// ReleaseThumbnail, ThumbnailUI widgets, thumbnail generator scripts and thumbnail actors (PooledActorClasses) are all reused.
+// Also checks that textures which are still held elsewhere, or which belong to the caller, are never reused, and that a reused actor
+// starts out in the state it was spawned in.
+
+namespace ThumbnailGeneratorPoolingTests
+{
+	static constexpr int32 NumWarmupCaptures = 10;
+	static constexpr int32 NumCaptures       = 1000;
+
+	static const TCHAR* ScriptClassPath = TEXT("/ThumbnailGenerator/BP_Thumbnail_CustomDepth_Script.BP_Thumbnail_CustomDepth_Script_C");
+
+	// Counts the objects added to GUObjectArray while alive
+	class FObjectCreationCounter : public FUObjectArray::FUObjectCreateListener
+	{
+	public:
+		int32 NumCreated = 0;
+		TArray<FString> CreatedObjects; // The first few, for the error message
+
+		FObjectCreationCounter()
+		{
+			GUObjectArray.AddUObjectCreateListener(this);
+		}
+
+		virtual ~FObjectCreationCounter()
+		{
+			GUObjectArray.RemoveUObjectCreateListener(this);
+		}
+
+		virtual void NotifyUObjectCreated(const UObjectBase* Object, int32 Index) override
+		{
+			// Class, outer and name are set before the object is added to the array
+			const UObject* NewObject = static_cast<const UObject*>(Object);
+
+			NumCreated++;
+			if (CreatedObjects.Num() < 10)
+				CreatedObjects.Add(FString::Printf(TEXT("%s %s"), *NewObject->GetClass()->GetName(), *NewObject->GetName()));
+		}
+
+		virtual void OnUObjectArrayShutdown() override
+		{
+			GUObjectArray.RemoveUObjectCreateListener(this);
+		}
+	};
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FThumbnailGeneratorSteadyStateObjectsTest, "ThumbnailGenerator.Pooling.SteadyStateObjects", EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FThumbnailGeneratorSteadyStateObjectsTest::RunTest(const FString& Parameters)
+{
+	using namespace ThumbnailGeneratorPoolingTests;
+
+	UStaticMesh* Mesh = LoadObject<UStaticMesh>(nullptr, TEXT("/Engine/BasicShapes/Cube.Cube"));
+	if (!TestNotNull(TEXT("Test mesh"), Mesh))
+		return false;
+
+	if (UThumbnailGeneratorSettings::Get()->MaxPooledThumbnailTextureSize <= 0)
+	{
+		AddWarning(TEXT("Texture pooling is disabled in the project settings (MaxPooledThumbnailTextureSize), skipping"));
+		return true;
+	}
+
+	FThumbnailSettings Overrides;
+	Overrides.bOverride_ThumbnailTextureWidth  = true;
+	Overrides.ThumbnailTextureWidth            = 64;
+	Overrides.bOverride_ThumbnailTextureHeight = true;
+	Overrides.ThumbnailTextureHeight           = 64;
+	Overrides.bOverride_SimulationMode         = true;
+	Overrides.SimulationMode                   = EThumbnailSceneSimulationMode::ENone;
+
+	// Alternating between two script sets makes every capture swap its scripts
+	FThumbnailSettings ScriptOverrides = Overrides;
+	if (UClass* ScriptClass = LoadClass<UThumbnailGeneratorScript>(nullptr, ScriptClassPath))
+	{
+		ScriptOverrides.bOverride_ThumbnailGeneratorScripts = true;
+		ScriptOverrides.ThumbnailGeneratorScripts           = { ScriptClass };
+	}
+	else
+	{
+		AddWarning(FString::Printf(TEXT("Could not load '%s', script pooling is not covered"), ScriptClassPath));
+	}
+
+	const FThumbnailSettings ThumbnailSettings[2] =
+	{
+		FThumbnailSettings::MergeThumbnailSettings(UThumbnailGeneratorSettings::Get()->DefaultThumbnailSettings, Overrides),
+		FThumbnailSettings::MergeThumbnailSettings(UThumbnailGeneratorSettings::Get()->DefaultThumbnailSettings, ScriptOverrides),
+	};
+
+	UThumbnailGeneratorSettings* GeneratorSettings = UThumbnailGeneratorSettings::Get();
+	TGuardValue<TArray<TSoftClassPtr<AActor>>> PooledActorClassesGuard(GeneratorSettings->PooledActorClasses, { AStaticMeshActor::StaticClass() });
+	TGuardValue<int32> MaxPooledActorsGuard(GeneratorSettings->MaxPooledThumbnailActors, FMath::Max(1, GeneratorSettings->MaxPooledThumbnailActors));
+
+	// A dedicated generator, so the test neither shares pools with nor invalidates the global one
+	FThumbnailGenerator Generator(false);
+	Generator.InitializeThumbnailWorld(FThumbnailBackgroundSceneSettings());
+
+	int32 NumFailed = 0;
+	const auto CaptureThumbnail = [&](int32 Iteration)
+	{
+		const FThumbnailSettings& Settings = ThumbnailSettings[Iteration % 2];
+
+		AActor* Actor = Generator.BeginGenerateActorThumbnail(AStaticMeshActor::StaticClass(), Settings, TMap<FString, FString>(), false);
+		if (AStaticMeshActor* MeshActor = Cast<AStaticMeshActor>(Actor))
+		{
+			MeshActor->GetStaticMeshComponent()->SetMobility(EComponentMobility::Movable);
+			MeshActor->GetStaticMeshComponent()->SetStaticMesh(Mesh);
+		}
+
+		if (UTexture2D* Thumbnail = Generator.FinishGenerateActorThumbnail(Actor, Settings, nullptr, true))
+			Generator.ReleaseThumbnail(Thumbnail);
+		else
+			NumFailed++;
+	};
+
+	for (int32 i = 0; i < NumWarmupCaptures; i++)
+		CaptureThumbnail(i);
+
+	const int32 NumObjectsBefore = GUObjectArray.GetObjectArrayNumMinusAvailable();
+
+	FObjectCreationCounter CreationCounter;
+	for (int32 i = 0; i < NumCaptures; i++)
+		CaptureThumbnail(i);
+
+	AddInfo(FString::Printf(TEXT("%d captures: %d objects created, GUObjectArray grew by %d"),
+		NumCaptures, CreationCounter.NumCreated, GUObjectArray.GetObjectArrayNumMinusAvailable() - NumObjectsBefore));
+
+	TestEqual(TEXT("Failed captures"), NumFailed, 0);
+
+	if (CreationCounter.NumCreated > 0)
+	{
+		AddError(FString::Printf(TEXT("%d UObjects were created by %d warmed up captures, first: %s"),
+			CreationCounter.NumCreated, NumCaptures, *FString::Join(CreationCounter.CreatedObjects, TEXT(", "))));
+	}
+
+	return !HasAnyErrors();
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FThumbnailGeneratorSharedTexturesTest, "ThumbnailGenerator.Pooling.SharedTextures", EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+// A texture is only reused once every holder has released it (result cache hits share the texture), and textures supplied by the caller are never reused
+bool FThumbnailGeneratorSharedTexturesTest::RunTest(const FString& Parameters)
+{
+	UThumbnailGeneratorSettings* GeneratorSettings = UThumbnailGeneratorSettings::Get();
+	TGuardValue<int32> TexturePoolGuard(GeneratorSettings->MaxPooledThumbnailTextureSize, FMath::Max(1, GeneratorSettings->MaxPooledThumbnailTextureSize));
+	TGuardValue<int32> ResultCacheGuard(GeneratorSettings->MaxThumbnailResultCacheSize, FMath::Max(1, GeneratorSettings->MaxThumbnailResultCacheSize));
+	TGuardValue<bool> DiskCacheGuard(GeneratorSettings->bEnableThumbnailDiskCache, false);
+
+	FThumbnailSettings Overrides;
+	Overrides.bOverride_ThumbnailTextureWidth  = true;
+	Overrides.ThumbnailTextureWidth            = 64;
+	Overrides.bOverride_ThumbnailTextureHeight = true;
+	Overrides.ThumbnailTextureHeight           = 64;
+	Overrides.bOverride_SimulationMode         = true;
+	Overrides.SimulationMode                   = EThumbnailSceneSimulationMode::ENone;
+	const FThumbnailSettings Settings = FThumbnailSettings::MergeThumbnailSettings(GeneratorSettings->DefaultThumbnailSettings, Overrides);
+
+	FThumbnailGenerator Generator(false);
+	Generator.InitializeThumbnailWorld(FThumbnailBackgroundSceneSettings());
+
+	UTexture2D* Thumbnail = Generator.GenerateActorThumbnail(AStaticMeshActor::StaticClass(), Settings);
+	if (!TestNotNull(TEXT("Thumbnail"), Thumbnail))
+		return false;
+
+	// Held by the caller and by the result cache hit
+	Generator.AddCachedThumbnail(AStaticMeshActor::StaticClass(), Settings, TMap<FString, FString>(), Thumbnail);
+	UTexture2D* CachedThumbnail = Generator.FindCachedThumbnail(AStaticMeshActor::StaticClass(), Settings);
+	TestTrue(TEXT("Result cache hit returns the thumbnail"), CachedThumbnail == Thumbnail);
+
+	Generator.ReleaseThumbnail(Thumbnail);
+	UTexture2D* SecondThumbnail = Generator.GenerateActorThumbnail(AStaticMeshActor::StaticClass(), Settings);
+	TestTrue(TEXT("A texture still held by a cache hit is not reused"), SecondThumbnail != Thumbnail);
+	TestTrue(TEXT("A texture still held by a cache hit stays cached"), Generator.FindCachedThumbnail(AStaticMeshActor::StaticClass(), Settings) == Thumbnail);
+
+	// The extra hit above, and the first one
+	Generator.ReleaseThumbnail(CachedThumbnail);
+	Generator.ReleaseThumbnail(CachedThumbnail);
+	TestNull(TEXT("A released texture is removed from the result cache"), Generator.FindCachedThumbnail(AStaticMeshActor::StaticClass(), Settings));
+
+	UTexture2D* ReusedThumbnail = Generator.GenerateActorThumbnail(AStaticMeshActor::StaticClass(), Settings);
+	TestTrue(TEXT("A texture released by every holder is reused"), ReusedThumbnail == Thumbnail);
+
+	// A transient texture supplied by the caller
+	UTexture2D* ResourceObject = UTexture2D::CreateTransient(64, 64, PF_B8G8R8A8);
+	UTexture2D* ResourceThumbnail = Generator.GenerateActorThumbnail(AStaticMeshActor::StaticClass(), Settings, ResourceObject);
+	TestTrue(TEXT("The thumbnail is captured into the resource object"), ResourceThumbnail == ResourceObject);
+
+	Generator.ReleaseThumbnail(ResourceObject);
+	Generator.ReleaseThumbnail(SecondThumbnail);
+	Generator.ReleaseThumbnail(ReusedThumbnail);
+
+	UTexture2D* NextThumbnail = Generator.GenerateActorThumbnail(AStaticMeshActor::StaticClass(), Settings);
+	TestTrue(TEXT("A resource object is never reused"), NextThumbnail != ResourceObject);
+	Generator.ReleaseThumbnail(NextThumbnail);
+
+	return !HasAnyErrors();
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FThumbnailGeneratorPooledActorStateTest, "ThumbnailGenerator.Pooling.ActorState", EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+// Whatever the previous capture changed on a pooled actor is restored before it is reused, and actors which can't be restored are destroyed
+bool FThumbnailGeneratorPooledActorStateTest::RunTest(const FString& Parameters)
+{
+	UStaticMesh* Mesh = LoadObject<UStaticMesh>(nullptr, TEXT("/Engine/BasicShapes/Cube.Cube"));
+	if (!TestNotNull(TEXT("Test mesh"), Mesh))
+		return false;
+
+	UThumbnailGeneratorSettings* GeneratorSettings = UThumbnailGeneratorSettings::Get();
+	TGuardValue<TArray<TSoftClassPtr<AActor>>> PooledActorClassesGuard(GeneratorSettings->PooledActorClasses, { AStaticMeshActor::StaticClass() });
+	TGuardValue<int32> MaxPooledActorsGuard(GeneratorSettings->MaxPooledThumbnailActors, FMath::Max(1, GeneratorSettings->MaxPooledThumbnailActors));
+	TGuardValue<bool> DiskCacheGuard(GeneratorSettings->bEnableThumbnailDiskCache, false);
+
+	FThumbnailSettings Overrides;
+	Overrides.bOverride_ThumbnailTextureWidth  = true;
+	Overrides.ThumbnailTextureWidth            = 64;
+	Overrides.bOverride_ThumbnailTextureHeight = true;
+	Overrides.ThumbnailTextureHeight           = 64;
+	Overrides.bOverride_SimulationMode         = true;
+	Overrides.SimulationMode                   = EThumbnailSceneSimulationMode::ENone;
+	const FThumbnailSettings Settings = FThumbnailSettings::MergeThumbnailSettings(GeneratorSettings->DefaultThumbnailSettings, Overrides);
+
+	FThumbnailGenerator Generator(false);
+	Generator.InitializeThumbnailWorld(FThumbnailBackgroundSceneSettings());
+
+	const UStaticMeshComponent* DefaultComponent = GetDefault<AStaticMeshActor>()->GetStaticMeshComponent();
+
+	// The caller changes the actor and one of its components between Begin and Finish, the same way a PreCapture callback would
+	AStaticMeshActor* FirstActor = Cast<AStaticMeshActor>(Generator.BeginGenerateActorThumbnail(AStaticMeshActor::StaticClass(), Settings, TMap<FString, FString>(), false));
+	if (!TestNotNull(TEXT("First actor"), FirstActor))
+		return false;
+
+	FirstActor->Tags.Add(TEXT("Changed"));
+	FirstActor->GetStaticMeshComponent()->SetMobility(EComponentMobility::Movable);
+	FirstActor->GetStaticMeshComponent()->SetStaticMesh(Mesh);
+	Generator.ReleaseThumbnail(Generator.FinishGenerateActorThumbnail(FirstActor, Settings, nullptr, true));
+
+	AStaticMeshActor* SecondActor = Cast<AStaticMeshActor>(Generator.BeginGenerateActorThumbnail(AStaticMeshActor::StaticClass(), Settings, TMap<FString, FString>(), false));
+	if (!TestNotNull(TEXT("Second actor"), SecondActor))
+		return false;
+
+	TestTrue(TEXT("The actor is reused"), SecondActor == FirstActor);
+	TestEqual(TEXT("Actor properties are restored"), SecondActor->Tags.Num(), 0);
+	TestNull(TEXT("Component properties are restored"), SecondActor->GetStaticMeshComponent()->GetStaticMesh().Get());
+	TestEqual(TEXT("Component mobility is restored"), (int32)SecondActor->GetStaticMeshComponent()->Mobility, (int32)DefaultComponent->Mobility);
+	TestTrue(TEXT("Restored component is registered"), SecondActor->GetStaticMeshComponent()->IsRegistered());
+
+	// A component added at runtime isn't part of the class, the actor can't be restored
+	UStaticMeshComponent* AddedComponent = NewObject<UStaticMeshComponent>(SecondActor);
+	AddedComponent->SetupAttachment(SecondActor->GetRootComponent());
+	AddedComponent->RegisterComponent();
+
+	const TWeakObjectPtr<AActor> WeakSecondActor = SecondActor;
+	Generator.ReleaseThumbnail(Generator.FinishGenerateActorThumbnail(SecondActor, Settings, nullptr, true));
+	TestFalse(TEXT("An actor with runtime components is destroyed"), WeakSecondActor.IsValid());
+
+	return !HasAnyErrors();
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
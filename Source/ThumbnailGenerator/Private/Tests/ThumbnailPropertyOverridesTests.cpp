@@ -0,0 +1,316 @@
+// Copyright Mans Isaksson. All Rights Reserved.
+
+#include "CoreMinimal.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include "ThumbnailGenerator.h"
+#include "ThumbnailGeneratorSettings.h"
+#include "ThumbnailPropertyOverrides.h"
+#include "ThumbnailRequestHash.h"
+
+#include "Components/StaticMeshComponent.h"
+#include "Engine/StaticMeshActor.h"
+#include "Engine/Texture2D.h"
+#include "Engine/TextureRenderTarget2D.h"
+#include "Engine/World.h"
+#include "GameFramework/HUD.h"
+#include "StructUtils/PropertyBag.h"
+#include "Templates/UnrealTemplate.h"
+#include "UObject/UObjectGlobals.h"
+
+// Checks that the property override plans are reused per actor class and set of property names, that unknown properties are only
+// reported once per plan, that values referencing objects are resolved against the actor they are applied to, and that the plans
+// are forgotten when objects are re-instanced. Partially specified struct values keep the class defaults of the members they leave
+// out. Also checks how property bag values are copied and hashed into the request key.
+
+namespace ThumbnailPropertyOverridesTests
+{
+	using namespace ThumbnailGenerator;
+
+	static TMap<FString, FString> MakeProperties(float InitialLifeSpan, const FString& Tag)
+	{
+		TMap<FString, FString> Properties;
+		Properties.Add(TEXT("InitialLifeSpan"), FString::SanitizeFloat(InitialLifeSpan));
+		Properties.Add(TEXT("Tags"), FString::Printf(TEXT("(\"%s\")"), *Tag));
+		return Properties;
+	}
+
+	static bool HasProperties(const AActor* Actor, float InitialLifeSpan, const FString& Tag)
+	{
+		return Actor->InitialLifeSpan == InitialLifeSpan && Actor->Tags.Num() == 1 && Actor->Tags[0] == FName(*Tag);
+	}
+
+	static const FProperty* GetBagProperty(const FInstancedPropertyBag& PropertyBag, FName PropertyName)
+	{
+		const FPropertyBagPropertyDesc* PropertyDesc = PropertyBag.FindPropertyDescByName(PropertyName);
+		return PropertyDesc ? PropertyDesc->CachedProperty : nullptr;
+	}
+
+	// Sets a property of Dest to the value of a property of Source, the way the Blueprint nodes do
+	static void SetFromBag(FInstancedPropertyBag& Dest, FName DestName, const FInstancedPropertyBag& Source, FName SourceName)
+	{
+		const FProperty* SourceProperty = GetBagProperty(Source, SourceName);
+		SetPropertyBagValue(Dest, DestName, SourceProperty, SourceProperty->ContainerPtrToValuePtr<void>(Source.GetValue().GetMemory()));
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FThumbnailPropertyOverridesPlansTest, "ThumbnailGenerator.PropertyOverrides.Plans", EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FThumbnailPropertyOverridesPlansTest::RunTest(const FString& Parameters)
+{
+	using namespace ThumbnailPropertyOverridesTests;
+
+	FThumbnailGenerator Generator(false);
+	Generator.InitializeThumbnailWorld(FThumbnailBackgroundSceneSettings());
+
+	UWorld* ThumbnailWorld = Generator.GetThumbnailWorld();
+	if (!TestNotNull(TEXT("Thumbnail world"), ThumbnailWorld))
+		return false;
+
+	AStaticMeshActor* ActorA = ThumbnailWorld->SpawnActor<AStaticMeshActor>();
+	AStaticMeshActor* ActorB = ThumbnailWorld->SpawnActor<AStaticMeshActor>();
+	AActor* OtherClassActor  = ThumbnailWorld->SpawnActor<AActor>();
+	if (!TestNotNull(TEXT("Actor A"), ActorA) || !TestNotNull(TEXT("Actor B"), ActorB) || !TestNotNull(TEXT("Other class actor"), OtherClassActor))
+		return false;
+
+	FThumbnailPropertyOverrides Overrides;
+
+	// One plan per class and set of names, one set of parsed values per set of value strings
+	TArray<const FProperty*> AppliedProperties;
+	Overrides.Apply(ActorA, MakeProperties(1.f, TEXT("A")), &AppliedProperties);
+	TestTrue(TEXT("First values applied"), HasProperties(ActorA, 1.f, TEXT("A")));
+	TestEqual(TEXT("Applied properties"), AppliedProperties.Num(), 2);
+	TestEqual(TEXT("Plans after first apply"), Overrides.GetNumPlans(), 1);
+	TestEqual(TEXT("Parsed values after first apply"), Overrides.GetNumParsedValues(), 1);
+
+	Overrides.Apply(ActorB, MakeProperties(2.f, TEXT("B")));
+	TestTrue(TEXT("Other values applied"), HasProperties(ActorB, 2.f, TEXT("B")));
+	TestEqual(TEXT("Plan reused for other values"), Overrides.GetNumPlans(), 1);
+	TestEqual(TEXT("Parsed values for other values"), Overrides.GetNumParsedValues(), 2);
+
+	Overrides.Apply(ActorB, MakeProperties(1.f, TEXT("A")));
+	TestTrue(TEXT("Cached values applied"), HasProperties(ActorB, 1.f, TEXT("A")));
+	TestEqual(TEXT("Parsed values reused"), Overrides.GetNumParsedValues(), 2);
+
+	TMap<FString, FString> OtherNames;
+	OtherNames.Add(TEXT("InitialLifeSpan"), TEXT("3.0"));
+	Overrides.Apply(ActorA, OtherNames);
+	TestEqual(TEXT("Value of other names applied"), ActorA->InitialLifeSpan, 3.f);
+	TestEqual(TEXT("Plan for other names"), Overrides.GetNumPlans(), 2);
+
+	Overrides.Apply(OtherClassActor, MakeProperties(1.f, TEXT("A")));
+	TestTrue(TEXT("Values applied to other class"), HasProperties(OtherClassActor, 1.f, TEXT("A")));
+	TestEqual(TEXT("Plan for other class"), Overrides.GetNumPlans(), 3);
+
+	// Unknown names are reported when the plan is created, not every time it's applied
+	AddExpectedError(TEXT("has no property named 'NoSuchProperty'"), EAutomationExpectedErrorFlags::Contains, 1);
+	for (int32 i = 0; i < 3; i++)
+	{
+		TMap<FString, FString> UnknownName;
+		UnknownName.Add(TEXT("NoSuchProperty"), FString::FromInt(i));
+		Overrides.Apply(ActorA, UnknownName);
+	}
+
+	// Object paths are resolved relative to the actor, the value parsed for one actor must not be reused for another
+	FProperty* RootComponentProperty = FindFProperty<FProperty>(AActor::StaticClass(), TEXT("RootComponent"));
+	if (TestNotNull(TEXT("RootComponent property"), RootComponentProperty))
+	{
+		TMap<FString, FString> RootComponent;
+		RootComponent.Add(TEXT("RootComponent"), ActorA->GetStaticMeshComponent()->GetName());
+
+		for (AStaticMeshActor* Actor : { ActorA, ActorB })
+		{
+			CastFieldChecked<FObjectPropertyBase>(RootComponentProperty)->SetObjectPropertyValue_InContainer(Actor, nullptr);
+			Overrides.Apply(Actor, RootComponent);
+			TestTrue(*FString::Printf(TEXT("%s resolved against its own component"), *Actor->GetName()), Actor->GetRootComponent() == Actor->GetStaticMeshComponent());
+		}
+	}
+
+	Overrides.Reset();
+	TestEqual(TEXT("Plans after reset"), Overrides.GetNumPlans(), 0);
+
+	ActorA->Destroy();
+	ActorB->Destroy();
+	OtherClassActor->Destroy();
+
+	return !HasAnyErrors();
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FThumbnailPropertyOverridesPartialStructTest, "ThumbnailGenerator.PropertyOverrides.PartialStruct", EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FThumbnailPropertyOverridesPartialStructTest::RunTest(const FString& Parameters)
+{
+	FThumbnailGenerator Generator(false);
+	Generator.InitializeThumbnailWorld(FThumbnailBackgroundSceneSettings());
+
+	UWorld* ThumbnailWorld = Generator.GetThumbnailWorld();
+	if (!TestNotNull(TEXT("Thumbnail world"), ThumbnailWorld))
+		return false;
+
+	// AHUD::RedColor defaults to opaque red, while a default constructed FColor is zero
+	const FColor DefaultColor = GetDefault<AHUD>()->RedColor;
+	FColor ExpectedColor      = DefaultColor;
+	ExpectedColor.G           = 128;
+
+	AHUD* ActorA = ThumbnailWorld->SpawnActor<AHUD>();
+	AHUD* ActorB = ThumbnailWorld->SpawnActor<AHUD>();
+	if (!TestNotNull(TEXT("Actor A"), ActorA) || !TestNotNull(TEXT("Actor B"), ActorB))
+		return false;
+
+	TMap<FString, FString> Properties;
+	Properties.Add(TEXT("RedColor"), TEXT("(G=128)"));
+
+	ThumbnailGenerator::FThumbnailPropertyOverrides Overrides;
+
+	// The first apply parses the value, the second copies the parsed value
+	Overrides.Apply(ActorA, Properties);
+	Overrides.Apply(ActorB, Properties);
+	TestEqual(TEXT("Parsed values"), Overrides.GetNumParsedValues(), 1);
+
+	TestTrue(FString::Printf(TEXT("Parsed value keeps the class defaults (%s, expected %s)"), *ActorA->RedColor.ToString(), *ExpectedColor.ToString()), ActorA->RedColor == ExpectedColor);
+	TestTrue(FString::Printf(TEXT("Cached value keeps the class defaults (%s, expected %s)"), *ActorB->RedColor.ToString(), *ExpectedColor.ToString()), ActorB->RedColor == ExpectedColor);
+
+	ActorA->Destroy();
+	ActorB->Destroy();
+
+	return !HasAnyErrors();
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FThumbnailPropertyOverridesPropertyBagTest, "ThumbnailGenerator.PropertyOverrides.PropertyBag", EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FThumbnailPropertyOverridesPropertyBagTest::RunTest(const FString& Parameters)
+{
+	using namespace ThumbnailPropertyOverridesTests;
+	using ECopyMode = FThumbnailPropertyOverrides::ECopyMode;
+
+	UTexture2D* Texture                  = NewObject<UTexture2D>(GetTransientPackage());
+	UTexture2D* OtherTexture             = NewObject<UTexture2D>(GetTransientPackage());
+	UTextureRenderTarget2D* NotTexture2D = NewObject<UTextureRenderTarget2D>(GetTransientPackage());
+
+	// The layout of the Blueprint node's bag, and values of other types to fill it with
+	FInstancedPropertyBag Bag;
+	Bag.AddProperty(TEXT("Bool"), EPropertyBagPropertyType::Bool);
+	Bag.AddProperty(TEXT("Int64"), EPropertyBagPropertyType::Int64);
+	Bag.AddProperty(TEXT("Double"), EPropertyBagPropertyType::Double);
+	Bag.AddProperty(TEXT("Texture2D"), EPropertyBagPropertyType::Object, UTexture2D::StaticClass());
+	Bag.AddProperty(TEXT("String"), EPropertyBagPropertyType::String);
+
+	FInstancedPropertyBag Values;
+	Values.AddProperty(TEXT("Bool"), EPropertyBagPropertyType::Bool);
+	Values.AddProperty(TEXT("Int32"), EPropertyBagPropertyType::Int32);
+	Values.AddProperty(TEXT("Float"), EPropertyBagPropertyType::Float);
+	Values.AddProperty(TEXT("Texture"), EPropertyBagPropertyType::Object, UTexture::StaticClass());
+	Values.AddProperty(TEXT("String"), EPropertyBagPropertyType::String);
+	Values.SetValueBool(TEXT("Bool"), true);
+	Values.SetValueInt32(TEXT("Int32"), -7);
+	Values.SetValueFloat(TEXT("Float"), 1.5f);
+	Values.SetValueObject(TEXT("Texture"), Texture);
+	Values.SetValueString(TEXT("String"), TEXT("Value"));
+
+	const auto TestCopyMode = [&](const TCHAR* What, FName BagName, FName ValueName, ECopyMode Expected)
+	{
+		TestEqual(What, (int32)FThumbnailPropertyOverrides::GetCopyMode(GetBagProperty(Bag, BagName), GetBagProperty(Values, ValueName)), (int32)Expected);
+	};
+
+	TestCopyMode(TEXT("Bool copy mode"), TEXT("Bool"), TEXT("Bool"), ECopyMode::Bool);
+	TestCopyMode(TEXT("Integer copy mode"), TEXT("Int64"), TEXT("Int32"), ECopyMode::Integer);
+	TestCopyMode(TEXT("Float copy mode"), TEXT("Double"), TEXT("Float"), ECopyMode::Float);
+	TestCopyMode(TEXT("Object copy mode"), TEXT("Texture2D"), TEXT("Texture"), ECopyMode::Object);
+	TestCopyMode(TEXT("Same type copy mode"), TEXT("String"), TEXT("String"), ECopyMode::Copy);
+	TestCopyMode(TEXT("Incompatible copy mode"), TEXT("Int64"), TEXT("String"), ECopyMode::Invalid);
+
+	SetFromBag(Bag, TEXT("Bool"), Values, TEXT("Bool"));
+	SetFromBag(Bag, TEXT("Int64"), Values, TEXT("Int32"));
+	SetFromBag(Bag, TEXT("Double"), Values, TEXT("Float"));
+	SetFromBag(Bag, TEXT("Texture2D"), Values, TEXT("Texture"));
+	SetFromBag(Bag, TEXT("String"), Values, TEXT("String"));
+
+	TestTrue(TEXT("Bool value"), Bag.GetValueBool(TEXT("Bool")).GetValue());
+	TestEqual(TEXT("Integer value"), Bag.GetValueInt64(TEXT("Int64")).GetValue(), int64(-7));
+	TestEqual(TEXT("Float value"), Bag.GetValueDouble(TEXT("Double")).GetValue(), 1.5);
+	TestTrue(TEXT("Object value"), Bag.GetValueObject(TEXT("Texture2D")).GetValue() == Texture);
+	TestEqual(TEXT("String value"), Bag.GetValueString(TEXT("String")).GetValue(), FString(TEXT("Value")));
+
+	// An object which isn't of the bag property's class is rejected, and the value is left as it was
+	AddExpectedError(TEXT("can't be assigned to"), EAutomationExpectedErrorFlags::Contains, 2);
+	Values.SetValueObject(TEXT("Texture"), NotTexture2D);
+	SetFromBag(Bag, TEXT("Texture2D"), Values, TEXT("Texture"));
+	TestTrue(TEXT("Object of another class is rejected"), Bag.GetValueObject(TEXT("Texture2D")).GetValue() == Texture);
+
+	SetFromBag(Bag, TEXT("Int64"), Values, TEXT("String"));
+	TestEqual(TEXT("Incompatible value is rejected"), Bag.GetValueInt64(TEXT("Int64")).GetValue(), int64(-7));
+
+	AddExpectedError(TEXT("has no property named 'NoSuchProperty'"), EAutomationExpectedErrorFlags::Contains, 1);
+	SetFromBag(Bag, TEXT("NoSuchProperty"), Values, TEXT("Bool"));
+
+	// Request keys
+	const FThumbnailSettings Settings = UThumbnailGeneratorSettings::Get()->DefaultThumbnailSettings;
+	const TMap<FString, FString> Properties = MakeProperties(1.f, TEXT("A"));
+	const auto GetKey = [&](const FInstancedPropertyBag* PropertyBag)
+	{
+		return ComputeRequestKey(AStaticMeshActor::StaticClass(), Settings, Properties, PropertyBag);
+	};
+
+	const FThumbnailRequestKey NoBagKey = GetKey(nullptr);
+	const FInstancedPropertyBag EmptyBag;
+	TestTrue(TEXT("An empty bag doesn't change the key"), GetKey(&EmptyBag) == NoBagKey);
+
+	FInstancedPropertyBag SameValues = Bag;
+	TestTrue(TEXT("Same values give the same key"), GetKey(&SameValues) == GetKey(&Bag));
+	TestFalse(TEXT("A bag with values changes the key"), GetKey(&Bag) == NoBagKey);
+
+	const auto TestOtherValueKey = [&](const TCHAR* What, TFunctionRef<void(FInstancedPropertyBag&)> SetValue)
+	{
+		FInstancedPropertyBag OtherValues = Bag;
+		SetValue(OtherValues);
+		TestFalse(What, GetKey(&OtherValues) == GetKey(&Bag));
+	};
+
+	TestOtherValueKey(TEXT("Other bool gives another key"), [](FInstancedPropertyBag& OtherValues) { OtherValues.SetValueBool(TEXT("Bool"), false); });
+	TestOtherValueKey(TEXT("Other integer gives another key"), [](FInstancedPropertyBag& OtherValues) { OtherValues.SetValueInt64(TEXT("Int64"), 7); });
+	TestOtherValueKey(TEXT("Other float gives another key"), [](FInstancedPropertyBag& OtherValues) { OtherValues.SetValueDouble(TEXT("Double"), 2.5); });
+	TestOtherValueKey(TEXT("Other object gives another key"), [&](FInstancedPropertyBag& OtherValues) { OtherValues.SetValueObject(TEXT("Texture2D"), OtherTexture); });
+	TestOtherValueKey(TEXT("Other string gives another key"), [](FInstancedPropertyBag& OtherValues) { OtherValues.SetValueString(TEXT("String"), TEXT("Other")); });
+
+	return !HasAnyErrors();
+}
+
+#if WITH_EDITOR
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FThumbnailPropertyOverridesObjectsReplacedTest, "ThumbnailGenerator.PropertyOverrides.ObjectsReplaced", EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FThumbnailPropertyOverridesObjectsReplacedTest::RunTest(const FString& Parameters)
+{
+	UThumbnailGeneratorSettings* GeneratorSettings = UThumbnailGeneratorSettings::Get();
+	TGuardValue<bool> DiskCacheGuard(GeneratorSettings->bEnableThumbnailDiskCache, false);
+	TGuardValue<int32> ResultCacheGuard(GeneratorSettings->MaxThumbnailResultCacheSize, 0);
+
+	FThumbnailGenerator Generator(false);
+	Generator.InitializeThumbnailWorld(FThumbnailBackgroundSceneSettings());
+
+	const FThumbnailSettings Settings = UThumbnailGeneratorSettings::Get()->DefaultThumbnailSettings;
+
+	TMap<FString, FString> UnknownName;
+	UnknownName.Add(TEXT("NoSuchProperty"), TEXT("1"));
+
+	// Reported once by the first two captures, and once more after the plans have been forgotten
+	AddExpectedError(TEXT("has no property named 'NoSuchProperty'"), EAutomationExpectedErrorFlags::Contains, 2);
+
+	for (int32 i = 0; i < 2; i++)
+		Generator.ReleaseThumbnail(Generator.GenerateActorThumbnail(AStaticMeshActor::StaticClass(), Settings, nullptr, UnknownName));
+
+	// Re-instancing any object (e.g. compiling a blueprint) resets the plans
+	TMap<UObject*, UObject*> ReplacedObjects;
+	ReplacedObjects.Add(NewObject<UTexture2D>(GetTransientPackage()), NewObject<UTexture2D>(GetTransientPackage()));
+	FCoreUObjectDelegates::OnObjectsReplaced.Broadcast(ReplacedObjects);
+
+	Generator.ReleaseThumbnail(Generator.GenerateActorThumbnail(AStaticMeshActor::StaticClass(), Settings, nullptr, UnknownName));
+
+	return !HasAnyErrors();
+}
+
+#endif // WITH_EDITOR
+
+#endif // WITH_DEV_AUTOMATION_TESTS
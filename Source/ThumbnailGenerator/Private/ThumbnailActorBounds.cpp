@@ -0,0 +1,242 @@
+// Copyright Mans Isaksson. All Rights Reserved.
+
+#include "ThumbnailActorBounds.h"
+#include "ThumbnailGeneratorSettings.h"
+#include "ThumbnailGeneratorInterfaces.h"
+#include "ThumbnailGeneratorStats.h"
+
+#include "Async/ParallelFor.h"
+#include "Components/PrimitiveComponent.h"
+#include "Components/SkeletalMeshComponent.h"
+#include "Engine/SkeletalMesh.h"
+#include "GameFramework/Actor.h"
+#include "PhysicsEngine/PhysicsAsset.h"
+#include "Rendering/SkeletalMeshRenderData.h"
+#include "DrawDebugHelpers.h"
+
+namespace ThumbnailGenerator
+{
+	// Vertices skinned per ParallelFor task, meshes with fewer vertices are skinned on the calling thread
+	static constexpr int32 SkinningChunkSize = 8192;
+
+	// Running min/max of a set of points, kept in vector registers
+	struct FVectorBounds
+	{
+		VectorRegister4Float Min = VectorSetFloat1(UE_MAX_FLT);
+		VectorRegister4Float Max = VectorSetFloat1(-UE_MAX_FLT);
+
+		FORCEINLINE void Add(const FVector3f& Point)
+		{
+			const VectorRegister4Float Vector = VectorLoadFloat3(&Point.X);
+			Min = VectorMin(Min, Vector);
+			Max = VectorMax(Max, Vector);
+		}
+
+		FORCEINLINE void Add(const FVectorBounds& Other)
+		{
+			Min = VectorMin(Min, Other.Min);
+			Max = VectorMax(Max, Other.Max);
+		}
+
+		FBox ToBox() const
+		{
+			FVector3f OutMin, OutMax;
+			VectorStoreFloat3(Min, &OutMin.X);
+			VectorStoreFloat3(Max, &OutMax.X);
+			return FBox(FVector(OutMin), FVector(OutMax));
+		}
+	};
+
+	struct FSkinningChunk
+	{
+		FVectorBounds SkinnedBounds;
+		FVectorBounds RefPoseBounds; // Only gathered for sampled vertices
+	};
+
+	static bool IsBlacklisted(UActorComponent* Component, const TSet<UClass*>& Blacklist)
+	{
+		if (Blacklist.Num() == 0)
+			return false;
+
+		// Check if our owners are blacklisted, useful for components that are auto-generated such as the Text3DComponent
+		for (UActorComponent* It = Component; It; It = Cast<UActorComponent>(It->GetOuter()))
+		{
+			for (UClass* BlacklistedClass : Blacklist)
+			{
+				if (It->IsA(BlacklistedClass))
+					return true;
+			}
+		}
+
+		return false;
+	}
+
+	FSkinnedMeshBounds CalcSkinnedMeshLocalBounds(USkinnedMeshComponent* Component, EThumbnailBoundsMode BoundsMode, int32 SampleCount)
+	{
+		FSkinnedMeshBounds OutBounds;
+
+		const auto RenderBounds = [&]()->FSkinnedMeshBounds
+		{
+			OutBounds.Bounds = Component->CalcBounds(FTransform::Identity).GetBox();
+			return OutBounds;
+		};
+
+		if (BoundsMode == EThumbnailBoundsMode::ERenderBounds)
+			return RenderBounds();
+
+		if (BoundsMode == EThumbnailBoundsMode::EPhysicsAsset)
+		{
+			if (const UPhysicsAsset* PhysicsAsset = Component->GetPhysicsAsset())
+			{
+				OutBounds.Bounds = PhysicsAsset->CalcAABB(Component, FTransform::Identity);
+				if (OutBounds.Bounds.IsValid)
+					return OutBounds;
+			}
+
+			BoundsMode = EThumbnailBoundsMode::EExact;
+		}
+
+		const USkeletalMesh* SkeletalMesh = Cast<USkeletalMesh>(Component->GetSkinnedAsset());
+		const FSkeletalMeshRenderData* RenderData = IsValid(SkeletalMesh) ? SkeletalMesh->GetResourceForRendering() : nullptr;
+		if (!RenderData || RenderData->LODRenderData.Num() == 0)
+			return RenderBounds();
+
+		const int32 LODIndex = BoundsMode == EThumbnailBoundsMode::ELowestLOD ? RenderData->LODRenderData.Num() - 1 : 0;
+		const FSkeletalMeshLODRenderData& LODData = RenderData->LODRenderData[LODIndex];
+		FSkinWeightVertexBuffer* SkinWeightBuffer = Component->GetSkinWeightBuffer(LODIndex);
+		const int32 NumVertices = int32(LODData.GetNumVertices());
+		if (!SkinWeightBuffer || NumVertices == 0)
+			return RenderBounds();
+
+		const bool bSampled    = BoundsMode == EThumbnailBoundsMode::ESampled;
+		const int32 Stride     = bSampled ? FMath::DivideAndRoundUp(NumVertices, FMath::Max(1, SampleCount)) : 1;
+		const int32 NumSamples = FMath::DivideAndRoundUp(NumVertices, Stride);
+		const int32 NumChunks  = FMath::DivideAndRoundUp(NumSamples, SkinningChunkSize);
+
+		TArray<FMatrix44f> CachedRefToLocals;
+		Component->CacheRefToLocalMatrices(CachedRefToLocals);
+
+		const FPositionVertexBuffer& PositionBuffer = LODData.StaticVertexBuffers.PositionVertexBuffer;
+
+		TArray<FSkinningChunk, TInlineAllocator<16>> Chunks;
+		Chunks.SetNum(NumChunks);
+
+		// Skinning only reads the mesh and the cached matrices, so the chunks can be skinned in parallel
+		ParallelFor(NumChunks, [&](int32 ChunkIndex)
+		{
+			FSkinningChunk& Chunk = Chunks[ChunkIndex];
+
+			const int32 FirstSample = ChunkIndex * SkinningChunkSize;
+			const int32 EndSample   = FMath::Min(FirstSample + SkinningChunkSize, NumSamples);
+			for (int32 Sample = FirstSample; Sample < EndSample; Sample++)
+			{
+				const int32 VertexIndex = Sample * Stride;
+				Chunk.SkinnedBounds.Add(USkinnedMeshComponent::GetSkinnedVertexPosition(Component, VertexIndex, LODData, *SkinWeightBuffer, CachedRefToLocals));
+
+				if (bSampled)
+					Chunk.RefPoseBounds.Add(PositionBuffer.VertexPosition(VertexIndex));
+			}
+		}, NumChunks == 1 ? EParallelForFlags::ForceSingleThread : EParallelForFlags::None);
+
+		FSkinningChunk Result;
+		for (const FSkinningChunk& Chunk : Chunks)
+		{
+			Result.SkinnedBounds.Add(Chunk.SkinnedBounds);
+			Result.RefPoseBounds.Add(Chunk.RefPoseBounds);
+		}
+
+		OutBounds.Bounds             = Result.SkinnedBounds.ToBox();
+		OutBounds.NumSkinnedVertices = NumSamples;
+
+		if (bSampled && Stride > 1)
+		{
+			// The imported bounds are the bounds of every vertex of LOD 0 in the reference pose
+			const FBox MeshBounds    = SkeletalMesh->GetImportedBounds().GetBox();
+			const FBox SampledBounds = Result.RefPoseBounds.ToBox();
+			const FVector MinError   = (SampledBounds.Min - MeshBounds.Min).ComponentMax(FVector::ZeroVector);
+			const FVector MaxError   = (MeshBounds.Max - SampledBounds.Max).ComponentMax(FVector::ZeroVector);
+			OutBounds.ErrorEstimate  = FMath::Max(MinError.GetMax(), MaxError.GetMax());
+		}
+
+		return OutBounds;
+	}
+
+	static FBox CalcPrimitiveLocalBounds(UPrimitiveComponent* PrimitiveComponent, const FThumbnailSettings& ThumbnailSettings)
+	{
+		FBox OutBounds(EForceInit::ForceInit);
+		if (PrimitiveComponent->bUseAttachParentBound && PrimitiveComponent->GetAttachParent() != nullptr)
+			return OutBounds;
+
+		if (USkinnedMeshComponent* SkinnedMeshComponent = Cast<USkeletalMeshComponent>(PrimitiveComponent))
+			OutBounds = CalcSkinnedMeshLocalBounds(SkinnedMeshComponent, ThumbnailSettings.BoundsMode, ThumbnailSettings.BoundsSampleCount).Bounds;
+		else
+			OutBounds = PrimitiveComponent->CalcBounds(FTransform::Identity).GetBox();
+
+		const FTransform& ActorTransform = PrimitiveComponent->GetOwner()->GetActorTransform();
+		const FTransform& ComponentTransform = PrimitiveComponent->GetComponentTransform();
+		const FTransform ComponentActorSpaceTransform = ComponentTransform.GetRelativeTransform(ActorTransform);
+
+		return OutBounds.TransformBy(ComponentActorSpaceTransform);
+	}
+
+	FBox CalcActorLocalBounds(AActor* Actor, const FThumbnailSettings& ThumbnailSettings, bool bDrawDebug)
+	{
+		FBox Box(EForceInit::ForceInit);
+		for (UActorComponent* ActorComponent : Actor->GetComponents())
+		{
+			UPrimitiveComponent* PrimComp = Cast<UPrimitiveComponent>(ActorComponent);
+			if (PrimComp && PrimComp->IsRegistered()
+				&& (PrimComp->IsVisible() || ThumbnailSettings.bIncludeHiddenComponentsInBounds)
+				&& !IsBlacklisted(PrimComp, ThumbnailSettings.ComponentBoundsBlacklist))
+			{
+				const FBox PrimitiveBounds = CalcPrimitiveLocalBounds(PrimComp, ThumbnailSettings);
+				Box += PrimitiveBounds;
+
+				if (bDrawDebug)
+				{
+					const FTransform& ActorTransform = Actor->GetActorTransform();
+					DrawDebugBox(
+						PrimComp->GetWorld(),
+						ActorTransform.TransformPosition(PrimitiveBounds.GetCenter()),
+						PrimitiveBounds.GetExtent() * ActorTransform.GetScale3D(),
+						ActorTransform.GetRotation(),
+						FColor::Red,
+						true,
+						-1.f,
+						-1
+					);
+				}
+			}
+		}
+
+		return Box;
+	}
+
+	bool GetActorSuppliedBounds(AActor* Actor, FBox& OutBounds)
+	{
+		if (!Actor->Implements<UThumbnailActorInterface>())
+			return false;
+
+		FBox Bounds(EForceInit::ForceInit);
+		if (!IThumbnailActorInterface::Execute_GetThumbnailBounds(Actor, Bounds) || !Bounds.IsValid)
+			return false;
+
+		INC_DWORD_STAT(STAT_ThumbnailGenerator_ActorSuppliedBounds);
+
+		OutBounds = Bounds;
+		return true;
+	}
+
+	FBox CenterBoundsOnFocusPoint(AActor* Actor, const FBox& Bounds)
+	{
+		FVector FocusPoint = FVector::ZeroVector;
+		if (!Actor->Implements<UThumbnailActorInterface>() || !IThumbnailActorInterface::Execute_GetThumbnailFocusPoint(Actor, FocusPoint))
+			return Bounds;
+
+		if (!Bounds.IsValid)
+			return FBox(FocusPoint, FocusPoint);
+
+		const FVector Extent = (Bounds.Max - FocusPoint).ComponentMax(FocusPoint - Bounds.Min);
+		return FBox(FocusPoint - Extent, FocusPoint + Extent);
+	}
+}
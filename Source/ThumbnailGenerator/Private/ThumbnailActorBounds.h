@@ -0,0 +1,57 @@
+// Copyright Mans Isaksson. All Rights Reserved.
+
+#pragma once
+#include "CoreMinimal.h"
+
+class AActor;
+class USkinnedMeshComponent;
+struct FThumbnailSettings;
+enum class EThumbnailBoundsMode : uint8;
+
+namespace ThumbnailGenerator
+{
+	// Bounds of a skinned mesh in component space
+	struct FSkinnedMeshBounds
+	{
+		FBox Bounds              = FBox(EForceInit::ForceInit);
+		int32 NumSkinnedVertices = 0;
+
+		// Sampled vertices only, how far the sampled vertices fall short of the mesh's bounds in the reference pose (in component space units).
+		// An estimate, the bounds in the current pose can be off by a different amount.
+		double ErrorEstimate = 0.0;
+	};
+
+	/**
+	* Calculates the bounds of a skinned mesh in its current pose.
+	* Meshes without CPU accessible render data fall back to the render bounds.
+	*
+	* @param Component   The skinned mesh.
+	* @param BoundsMode  How the bounds are calculated, see FThumbnailSettings::BoundsMode.
+	* @param SampleCount The max number of vertices skinned by EThumbnailBoundsMode::ESampled.
+	* @return            The bounds in component space.
+	*/
+	FSkinnedMeshBounds CalcSkinnedMeshLocalBounds(USkinnedMeshComponent* Component, EThumbnailBoundsMode BoundsMode, int32 SampleCount);
+
+	/**
+	* Calculates the bounds of an actor's registered primitive components, used to frame the thumbnail camera.
+	* Honors the BoundsMode, BoundsSampleCount, ComponentBoundsBlacklist and bIncludeHiddenComponentsInBounds settings.
+	*
+	* @param Actor             The thumbnail actor.
+	* @param ThumbnailSettings The (merged) settings of the capture.
+	* @param bDrawDebug        Whether to draw the bounds of each component in the actor's world.
+	* @return                  The bounds in actor space.
+	*/
+	FBox CalcActorLocalBounds(AActor* Actor, const FThumbnailSettings& ThumbnailSettings, bool bDrawDebug);
+
+	/** @return True and the bounds in actor space if the actor supplies its own bounds with IThumbnailActorInterface::GetThumbnailBounds. */
+	bool GetActorSuppliedBounds(AActor* Actor, FBox& OutBounds);
+
+	/**
+	* Centers the bounds on the actor's focus point (IThumbnailActorInterface::GetThumbnailFocusPoint), growing them so they still contain the original bounds.
+	* 
+	* @param Actor  The thumbnail actor.
+	* @param Bounds The bounds in actor space.
+	* @return       The centered bounds, or Bounds if the actor doesn't supply a focus point.
+	*/
+	FBox CenterBoundsOnFocusPoint(AActor* Actor, const FBox& Bounds);
+}
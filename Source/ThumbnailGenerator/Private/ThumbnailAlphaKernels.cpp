@@ -0,0 +1,550 @@
+// Copyright Mans Isaksson. All Rights Reserved.
+
+#include "ThumbnailAlphaKernels.h"
+#include "Math/VectorRegister.h"
+
+#if PLATFORM_ENABLE_VECTORINTRINSICS_NEON
+	#define THUMBNAIL_ALPHA_KERNELS_NEON 1
+#else
+	#define THUMBNAIL_ALPHA_KERNELS_NEON 0
+#endif
+
+#if !THUMBNAIL_ALPHA_KERNELS_NEON && PLATFORM_ENABLE_VECTORINTRINSICS && PLATFORM_ALWAYS_HAS_SSE4_1
+	#define THUMBNAIL_ALPHA_KERNELS_SSE4 1
+#else
+	#define THUMBNAIL_ALPHA_KERNELS_SSE4 0
+#endif
+
+#if THUMBNAIL_ALPHA_KERNELS_SSE4 && PLATFORM_ALWAYS_HAS_AVX_2
+	#define THUMBNAIL_ALPHA_KERNELS_AVX2 1
+#else
+	#define THUMBNAIL_ALPHA_KERNELS_AVX2 0
+#endif
+
+// Every AVX2 CPU has F16C, but clang only exposes the intrinsics if the build enables them
+#if THUMBNAIL_ALPHA_KERNELS_AVX2 && (defined(_MSC_VER) || defined(__F16C__))
+	#define THUMBNAIL_ALPHA_KERNELS_F16C 1
+#else
+	#define THUMBNAIL_ALPHA_KERNELS_F16C 0
+#endif
+
+#if THUMBNAIL_ALPHA_KERNELS_NEON
+	#include <arm_neon.h>
+#elif THUMBNAIL_ALPHA_KERNELS_AVX2
+	#include <immintrin.h>
+#elif THUMBNAIL_ALPHA_KERNELS_SSE4
+	#include <smmintrin.h>
+#endif
+
+// The vector kernels treat a FColor as a uint32 with alpha in the top byte, and a FFloat16Color as a uint64 with alpha in the top 16 bits
+static_assert(PLATFORM_LITTLE_ENDIAN, "Alpha kernels assume a little endian pixel layout");
+static_assert(sizeof(FColor) == sizeof(uint32) && sizeof(FFloat16Color) == sizeof(uint64), "Unexpected pixel size");
+
+namespace ThumbnailGenerator
+{
+	namespace AlphaKernels
+	{
+		namespace Scalar
+		{
+			template<typename T>
+			static FORCEINLINE T MixAlpha(const T& A1, const T& A2, EThumbnailAlphaBlendMode BlendMode)
+			{
+				switch (BlendMode)
+				{
+				case EThumbnailAlphaBlendMode::EReplace:
+					return A2;
+				case EThumbnailAlphaBlendMode::EAdd:
+					return A1 + A2;
+				case EThumbnailAlphaBlendMode::EMultiply:
+					return A1 * A2;
+				case EThumbnailAlphaBlendMode::ESubtract:
+					return A1 - A2;
+				}
+				return A2;
+			}
+
+			void MergeAlpha(FColor* Pixels, const uint8* Alpha, int32 NumPixels, EThumbnailAlphaBlendMode BlendMode)
+			{
+				for (int32 Pixel = 0; Pixel < NumPixels; Pixel++)
+					Pixels[Pixel].A = MixAlpha(Pixels[Pixel].A, Alpha[Pixel], BlendMode);
+			}
+
+			void MergeAlpha(FFloat16Color* Pixels, const FFloat16* Alpha, int32 NumPixels, EThumbnailAlphaBlendMode BlendMode)
+			{
+				for (int32 Pixel = 0; Pixel < NumPixels; Pixel++)
+					Pixels[Pixel].A = MixAlpha(Pixels[Pixel].A, Alpha[Pixel], BlendMode);
+			}
+
+			void MergeInverseAlpha(FColor* Pixels, const FColor* AlphaPass, int32 NumPixels, EThumbnailAlphaBlendMode BlendMode)
+			{
+				for (int32 Pixel = 0; Pixel < NumPixels; Pixel++)
+					Pixels[Pixel].A = MixAlpha(Pixels[Pixel].A, uint8(255 - AlphaPass[Pixel].A), BlendMode);
+			}
+
+			void MergeInverseAlpha(FFloat16Color* Pixels, const FFloat16Color* AlphaPass, int32 NumPixels, EThumbnailAlphaBlendMode BlendMode)
+			{
+				for (int32 Pixel = 0; Pixel < NumPixels; Pixel++)
+					Pixels[Pixel].A = MixAlpha(Pixels[Pixel].A, FFloat16(1.f - (float)AlphaPass[Pixel].A), BlendMode);
+			}
+
+			void SetOpaqueAlpha(FColor* Pixels, int32 NumPixels)
+			{
+				for (int32 Pixel = 0; Pixel < NumPixels; Pixel++)
+					Pixels[Pixel].A = 255;
+			}
+
+			void SetOpaqueAlpha(FFloat16Color* Pixels, int32 NumPixels)
+			{
+				const FFloat16 OpaqueAlpha = FFloat16(1.f);
+				for (int32 Pixel = 0; Pixel < NumPixels; Pixel++)
+					Pixels[Pixel].A = OpaqueAlpha;
+			}
+
+			void ExtractInverseAlpha(const FColor* Pixels, uint8* OutAlpha, int32 NumPixels)
+			{
+				for (int32 Pixel = 0; Pixel < NumPixels; Pixel++)
+					OutAlpha[Pixel] = 255 - Pixels[Pixel].A;
+			}
+
+			void ExtractInverseAlpha(const FFloat16Color* Pixels, FFloat16* OutAlpha, int32 NumPixels)
+			{
+				for (int32 Pixel = 0; Pixel < NumPixels; Pixel++)
+					OutAlpha[Pixel] = FFloat16(1.f - (float)Pixels[Pixel].A);
+			}
+		}
+
+		// Blend mode resolved at compile time, used for the pixels which don't fill a whole vector
+		template<EThumbnailAlphaBlendMode BlendMode>
+		static FORCEINLINE uint8 MixAlpha8(uint8 A1, uint8 A2)
+		{
+			if constexpr (BlendMode == EThumbnailAlphaBlendMode::EAdd)           return uint8(A1 + A2);
+			else if constexpr (BlendMode == EThumbnailAlphaBlendMode::EMultiply) return uint8(A1 * A2);
+			else if constexpr (BlendMode == EThumbnailAlphaBlendMode::ESubtract) return uint8(A1 - A2);
+			else                                                                 return A2;
+		}
+
+		template<EThumbnailAlphaBlendMode BlendMode>
+		static FORCEINLINE FFloat16 MixAlpha16(FFloat16 A1, FFloat16 A2)
+		{
+			if constexpr (BlendMode == EThumbnailAlphaBlendMode::EAdd)           return FFloat16((float)A1 + (float)A2);
+			else if constexpr (BlendMode == EThumbnailAlphaBlendMode::EMultiply) return FFloat16((float)A1 * (float)A2);
+			else if constexpr (BlendMode == EThumbnailAlphaBlendMode::ESubtract) return FFloat16((float)A1 - (float)A2);
+			else                                                                 return A2;
+		}
+
+#if THUMBNAIL_ALPHA_KERNELS_SSE4
+		// Color holds 4 pixels, Alpha the new alpha of each pixel in the top byte with the other bits cleared.
+		// Since the color bits of Alpha are zero, add and subtract can operate on the whole pixel without carrying into the color.
+		template<EThumbnailAlphaBlendMode BlendMode>
+		static FORCEINLINE __m128i MixAlphaSSE(__m128i Color, __m128i Alpha)
+		{
+			const __m128i ColorMask = _mm_set1_epi32(0x00FFFFFF);
+			if constexpr (BlendMode == EThumbnailAlphaBlendMode::EAdd)
+				return _mm_add_epi32(Color, Alpha);
+			else if constexpr (BlendMode == EThumbnailAlphaBlendMode::ESubtract)
+				return _mm_sub_epi32(Color, Alpha);
+			else if constexpr (BlendMode == EThumbnailAlphaBlendMode::EMultiply)
+				return _mm_or_si128(_mm_and_si128(Color, ColorMask), _mm_slli_epi32(_mm_mullo_epi32(_mm_srli_epi32(Color, 24), _mm_srli_epi32(Alpha, 24)), 24));
+			else
+				return _mm_or_si128(_mm_and_si128(Color, ColorMask), Alpha);
+		}
+#endif
+
+#if THUMBNAIL_ALPHA_KERNELS_AVX2
+		template<EThumbnailAlphaBlendMode BlendMode>
+		static FORCEINLINE __m256i MixAlphaAVX2(__m256i Color, __m256i Alpha)
+		{
+			const __m256i ColorMask = _mm256_set1_epi32(0x00FFFFFF);
+			if constexpr (BlendMode == EThumbnailAlphaBlendMode::EAdd)
+				return _mm256_add_epi32(Color, Alpha);
+			else if constexpr (BlendMode == EThumbnailAlphaBlendMode::ESubtract)
+				return _mm256_sub_epi32(Color, Alpha);
+			else if constexpr (BlendMode == EThumbnailAlphaBlendMode::EMultiply)
+				return _mm256_or_si256(_mm256_and_si256(Color, ColorMask), _mm256_slli_epi32(_mm256_mullo_epi32(_mm256_srli_epi32(Color, 24), _mm256_srli_epi32(Alpha, 24)), 24));
+			else
+				return _mm256_or_si256(_mm256_and_si256(Color, ColorMask), Alpha);
+		}
+#endif
+
+#if THUMBNAIL_ALPHA_KERNELS_F16C
+		template<EThumbnailAlphaBlendMode BlendMode>
+		static FORCEINLINE __m256 MixAlphaF16C(__m256 A1, __m256 A2)
+		{
+			if constexpr (BlendMode == EThumbnailAlphaBlendMode::EAdd)           return _mm256_add_ps(A1, A2);
+			else if constexpr (BlendMode == EThumbnailAlphaBlendMode::EMultiply) return _mm256_mul_ps(A1, A2);
+			else if constexpr (BlendMode == EThumbnailAlphaBlendMode::ESubtract) return _mm256_sub_ps(A1, A2);
+			else                                                                 return A2;
+		}
+
+		// Packs the alpha of 8 FFloat16Color pixels into 8 halfs
+		static FORCEINLINE __m128i GatherAlpha16(const FFloat16Color* Pixels)
+		{
+			const __m128i* Src = (const __m128i*)Pixels;
+			const __m128i A01 = _mm_srli_epi64(_mm_loadu_si128(Src + 0), 48);
+			const __m128i A23 = _mm_srli_epi64(_mm_loadu_si128(Src + 1), 48);
+			const __m128i A45 = _mm_srli_epi64(_mm_loadu_si128(Src + 2), 48);
+			const __m128i A67 = _mm_srli_epi64(_mm_loadu_si128(Src + 3), 48);
+			return _mm_packus_epi32(_mm_packus_epi32(A01, A23), _mm_packus_epi32(A45, A67));
+		}
+
+		// Writes 8 halfs into the alpha of 8 FFloat16Color pixels
+		static FORCEINLINE void ScatterAlpha16(FFloat16Color* Pixels, __m128i Alpha)
+		{
+			const __m128i ColorMask = _mm_set1_epi64x(0x0000FFFFFFFFFFFFll);
+			__m128i* Dst = (__m128i*)Pixels;
+
+			const auto Store = [ColorMask](__m128i* Dst, __m128i AlphaPair)
+			{
+				const __m128i AlphaBits = _mm_slli_epi64(_mm_cvtepu16_epi64(AlphaPair), 48);
+				_mm_storeu_si128(Dst, _mm_or_si128(_mm_and_si128(_mm_loadu_si128(Dst), ColorMask), AlphaBits));
+			};
+
+			Store(Dst + 0, Alpha);
+			Store(Dst + 1, _mm_srli_si128(Alpha, 4));
+			Store(Dst + 2, _mm_srli_si128(Alpha, 8));
+			Store(Dst + 3, _mm_srli_si128(Alpha, 12));
+		}
+#endif
+
+#if THUMBNAIL_ALPHA_KERNELS_NEON
+		template<EThumbnailAlphaBlendMode BlendMode>
+		static FORCEINLINE uint8x16_t MixAlphaNEON8(uint8x16_t A1, uint8x16_t A2)
+		{
+			if constexpr (BlendMode == EThumbnailAlphaBlendMode::EAdd)           return vaddq_u8(A1, A2);
+			else if constexpr (BlendMode == EThumbnailAlphaBlendMode::EMultiply) return vmulq_u8(A1, A2);
+			else if constexpr (BlendMode == EThumbnailAlphaBlendMode::ESubtract) return vsubq_u8(A1, A2);
+			else                                                                 return A2;
+		}
+
+		template<EThumbnailAlphaBlendMode BlendMode>
+		static FORCEINLINE float32x4_t MixAlphaNEONFloat(float32x4_t A1, float32x4_t A2)
+		{
+			if constexpr (BlendMode == EThumbnailAlphaBlendMode::EAdd)           return vaddq_f32(A1, A2);
+			else if constexpr (BlendMode == EThumbnailAlphaBlendMode::EMultiply) return vmulq_f32(A1, A2);
+			else if constexpr (BlendMode == EThumbnailAlphaBlendMode::ESubtract) return vsubq_f32(A1, A2);
+			else                                                                 return A2;
+		}
+
+		static FORCEINLINE float32x4_t HalfToFloatLow(uint16x8_t Halfs)  { return vcvt_f32_f16(vreinterpret_f16_u16(vget_low_u16(Halfs))); }
+		static FORCEINLINE float32x4_t HalfToFloatHigh(uint16x8_t Halfs) { return vcvt_f32_f16(vreinterpret_f16_u16(vget_high_u16(Halfs))); }
+
+		static FORCEINLINE uint16x8_t FloatToHalf(float32x4_t Low, float32x4_t High)
+		{
+			return vcombine_u16(vreinterpret_u16_f16(vcvt_f16_f32(Low)), vreinterpret_u16_f16(vcvt_f16_f32(High)));
+		}
+
+		// A1 and A2 are 8 halfs each
+		template<EThumbnailAlphaBlendMode BlendMode>
+		static FORCEINLINE uint16x8_t MixAlphaNEON16(uint16x8_t A1, uint16x8_t A2)
+		{
+			if constexpr (BlendMode == EThumbnailAlphaBlendMode::EReplace)
+				return A2;
+			else
+				return FloatToHalf(
+					MixAlphaNEONFloat<BlendMode>(HalfToFloatLow(A1), HalfToFloatLow(A2)),
+					MixAlphaNEONFloat<BlendMode>(HalfToFloatHigh(A1), HalfToFloatHigh(A2)));
+		}
+#endif
+
+		template<EThumbnailAlphaBlendMode BlendMode>
+		static void MergeAlpha8(FColor* Pixels, const uint8* Alpha, int32 NumPixels)
+		{
+			int32 Pixel = 0;
+#if THUMBNAIL_ALPHA_KERNELS_NEON
+			for (; Pixel + 16 <= NumPixels; Pixel += 16)
+			{
+				uint8x16x4_t Color = vld4q_u8((const uint8*)(Pixels + Pixel));
+				Color.val[3] = MixAlphaNEON8<BlendMode>(Color.val[3], vld1q_u8(Alpha + Pixel));
+				vst4q_u8((uint8*)(Pixels + Pixel), Color);
+			}
+#elif THUMBNAIL_ALPHA_KERNELS_SSE4
+#if THUMBNAIL_ALPHA_KERNELS_AVX2
+			for (; Pixel + 8 <= NumPixels; Pixel += 8)
+			{
+				__m256i* Color = (__m256i*)(Pixels + Pixel);
+				const __m256i AlphaBits = _mm256_slli_epi32(_mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*)(Alpha + Pixel))), 24);
+				_mm256_storeu_si256(Color, MixAlphaAVX2<BlendMode>(_mm256_loadu_si256(Color), AlphaBits));
+			}
+#endif
+			for (; Pixel + 4 <= NumPixels; Pixel += 4)
+			{
+				int32 AlphaBytes;
+				FMemory::Memcpy(&AlphaBytes, Alpha + Pixel, sizeof(int32));
+
+				__m128i* Color = (__m128i*)(Pixels + Pixel);
+				const __m128i AlphaBits = _mm_slli_epi32(_mm_cvtepu8_epi32(_mm_cvtsi32_si128(AlphaBytes)), 24);
+				_mm_storeu_si128(Color, MixAlphaSSE<BlendMode>(_mm_loadu_si128(Color), AlphaBits));
+			}
+#endif
+			for (; Pixel < NumPixels; Pixel++)
+				Pixels[Pixel].A = MixAlpha8<BlendMode>(Pixels[Pixel].A, Alpha[Pixel]);
+		}
+
+		template<EThumbnailAlphaBlendMode BlendMode>
+		static void MergeInverseAlpha8(FColor* Pixels, const FColor* AlphaPass, int32 NumPixels)
+		{
+			int32 Pixel = 0;
+#if THUMBNAIL_ALPHA_KERNELS_NEON
+			for (; Pixel + 16 <= NumPixels; Pixel += 16)
+			{
+				uint8x16x4_t Color = vld4q_u8((const uint8*)(Pixels + Pixel));
+				const uint8x16_t InverseAlpha = vmvnq_u8(vld4q_u8((const uint8*)(AlphaPass + Pixel)).val[3]); // 255 - A
+				Color.val[3] = MixAlphaNEON8<BlendMode>(Color.val[3], InverseAlpha);
+				vst4q_u8((uint8*)(Pixels + Pixel), Color);
+			}
+#elif THUMBNAIL_ALPHA_KERNELS_SSE4
+#if THUMBNAIL_ALPHA_KERNELS_AVX2
+			const __m256i AlphaMask256 = _mm256_set1_epi32((int32)0xFF000000);
+			for (; Pixel + 8 <= NumPixels; Pixel += 8)
+			{
+				__m256i* Color = (__m256i*)(Pixels + Pixel);
+				const __m256i InverseAlpha = _mm256_andnot_si256(_mm256_loadu_si256((const __m256i*)(AlphaPass + Pixel)), AlphaMask256);
+				_mm256_storeu_si256(Color, MixAlphaAVX2<BlendMode>(_mm256_loadu_si256(Color), InverseAlpha));
+			}
+#endif
+			const __m128i AlphaMask = _mm_set1_epi32((int32)0xFF000000);
+			for (; Pixel + 4 <= NumPixels; Pixel += 4)
+			{
+				__m128i* Color = (__m128i*)(Pixels + Pixel);
+				const __m128i InverseAlpha = _mm_andnot_si128(_mm_loadu_si128((const __m128i*)(AlphaPass + Pixel)), AlphaMask);
+				_mm_storeu_si128(Color, MixAlphaSSE<BlendMode>(_mm_loadu_si128(Color), InverseAlpha));
+			}
+#endif
+			for (; Pixel < NumPixels; Pixel++)
+				Pixels[Pixel].A = MixAlpha8<BlendMode>(Pixels[Pixel].A, uint8(255 - AlphaPass[Pixel].A));
+		}
+
+		template<EThumbnailAlphaBlendMode BlendMode>
+		static void MergeAlpha16(FFloat16Color* Pixels, const FFloat16* Alpha, int32 NumPixels)
+		{
+			int32 Pixel = 0;
+#if THUMBNAIL_ALPHA_KERNELS_NEON
+			for (; Pixel + 8 <= NumPixels; Pixel += 8)
+			{
+				uint16x8x4_t Color = vld4q_u16((const uint16*)(Pixels + Pixel));
+				Color.val[3] = MixAlphaNEON16<BlendMode>(Color.val[3], vld1q_u16((const uint16*)(Alpha + Pixel)));
+				vst4q_u16((uint16*)(Pixels + Pixel), Color);
+			}
+#elif THUMBNAIL_ALPHA_KERNELS_F16C
+			for (; Pixel + 8 <= NumPixels; Pixel += 8)
+			{
+				const __m128i NewAlpha = _mm_loadu_si128((const __m128i*)(Alpha + Pixel));
+				if constexpr (BlendMode == EThumbnailAlphaBlendMode::EReplace)
+				{
+					ScatterAlpha16(Pixels + Pixel, NewAlpha);
+				}
+				else
+				{
+					const __m256 Mixed = MixAlphaF16C<BlendMode>(_mm256_cvtph_ps(GatherAlpha16(Pixels + Pixel)), _mm256_cvtph_ps(NewAlpha));
+					ScatterAlpha16(Pixels + Pixel, _mm256_cvtps_ph(Mixed, _MM_FROUND_TO_NEAREST_INT));
+				}
+			}
+#endif
+			for (; Pixel < NumPixels; Pixel++)
+				Pixels[Pixel].A = MixAlpha16<BlendMode>(Pixels[Pixel].A, Alpha[Pixel]);
+		}
+
+		template<EThumbnailAlphaBlendMode BlendMode>
+		static void MergeInverseAlpha16(FFloat16Color* Pixels, const FFloat16Color* AlphaPass, int32 NumPixels)
+		{
+			// The inverse alpha is rounded to half before blending, just like the scalar version
+			int32 Pixel = 0;
+#if THUMBNAIL_ALPHA_KERNELS_NEON
+			const float32x4_t One = vdupq_n_f32(1.f);
+			for (; Pixel + 8 <= NumPixels; Pixel += 8)
+			{
+				uint16x8x4_t Color = vld4q_u16((const uint16*)(Pixels + Pixel));
+				const uint16x8_t PassAlpha = vld4q_u16((const uint16*)(AlphaPass + Pixel)).val[3];
+				const uint16x8_t InverseAlpha = FloatToHalf(vsubq_f32(One, HalfToFloatLow(PassAlpha)), vsubq_f32(One, HalfToFloatHigh(PassAlpha)));
+				Color.val[3] = MixAlphaNEON16<BlendMode>(Color.val[3], InverseAlpha);
+				vst4q_u16((uint16*)(Pixels + Pixel), Color);
+			}
+#elif THUMBNAIL_ALPHA_KERNELS_F16C
+			const __m256 One = _mm256_set1_ps(1.f);
+			for (; Pixel + 8 <= NumPixels; Pixel += 8)
+			{
+				const __m128i InverseAlpha = _mm256_cvtps_ph(_mm256_sub_ps(One, _mm256_cvtph_ps(GatherAlpha16(AlphaPass + Pixel))), _MM_FROUND_TO_NEAREST_INT);
+				if constexpr (BlendMode == EThumbnailAlphaBlendMode::EReplace)
+				{
+					ScatterAlpha16(Pixels + Pixel, InverseAlpha);
+				}
+				else
+				{
+					const __m256 Mixed = MixAlphaF16C<BlendMode>(_mm256_cvtph_ps(GatherAlpha16(Pixels + Pixel)), _mm256_cvtph_ps(InverseAlpha));
+					ScatterAlpha16(Pixels + Pixel, _mm256_cvtps_ph(Mixed, _MM_FROUND_TO_NEAREST_INT));
+				}
+			}
+#endif
+			for (; Pixel < NumPixels; Pixel++)
+				Pixels[Pixel].A = MixAlpha16<BlendMode>(Pixels[Pixel].A, FFloat16(1.f - (float)AlphaPass[Pixel].A));
+		}
+
+		void MergeAlpha(FColor* Pixels, const uint8* Alpha, int32 NumPixels, EThumbnailAlphaBlendMode BlendMode)
+		{
+			switch (BlendMode)
+			{
+			case EThumbnailAlphaBlendMode::EReplace:  MergeAlpha8<EThumbnailAlphaBlendMode::EReplace>(Pixels, Alpha, NumPixels); return;
+			case EThumbnailAlphaBlendMode::EAdd:      MergeAlpha8<EThumbnailAlphaBlendMode::EAdd>(Pixels, Alpha, NumPixels); return;
+			case EThumbnailAlphaBlendMode::EMultiply: MergeAlpha8<EThumbnailAlphaBlendMode::EMultiply>(Pixels, Alpha, NumPixels); return;
+			case EThumbnailAlphaBlendMode::ESubtract: MergeAlpha8<EThumbnailAlphaBlendMode::ESubtract>(Pixels, Alpha, NumPixels); return;
+			}
+			MergeAlpha8<EThumbnailAlphaBlendMode::EReplace>(Pixels, Alpha, NumPixels);
+		}
+
+		void MergeAlpha(FFloat16Color* Pixels, const FFloat16* Alpha, int32 NumPixels, EThumbnailAlphaBlendMode BlendMode)
+		{
+			switch (BlendMode)
+			{
+			case EThumbnailAlphaBlendMode::EReplace:  MergeAlpha16<EThumbnailAlphaBlendMode::EReplace>(Pixels, Alpha, NumPixels); return;
+			case EThumbnailAlphaBlendMode::EAdd:      MergeAlpha16<EThumbnailAlphaBlendMode::EAdd>(Pixels, Alpha, NumPixels); return;
+			case EThumbnailAlphaBlendMode::EMultiply: MergeAlpha16<EThumbnailAlphaBlendMode::EMultiply>(Pixels, Alpha, NumPixels); return;
+			case EThumbnailAlphaBlendMode::ESubtract: MergeAlpha16<EThumbnailAlphaBlendMode::ESubtract>(Pixels, Alpha, NumPixels); return;
+			}
+			MergeAlpha16<EThumbnailAlphaBlendMode::EReplace>(Pixels, Alpha, NumPixels);
+		}
+
+		void MergeInverseAlpha(FColor* Pixels, const FColor* AlphaPass, int32 NumPixels, EThumbnailAlphaBlendMode BlendMode)
+		{
+			switch (BlendMode)
+			{
+			case EThumbnailAlphaBlendMode::EReplace:  MergeInverseAlpha8<EThumbnailAlphaBlendMode::EReplace>(Pixels, AlphaPass, NumPixels); return;
+			case EThumbnailAlphaBlendMode::EAdd:      MergeInverseAlpha8<EThumbnailAlphaBlendMode::EAdd>(Pixels, AlphaPass, NumPixels); return;
+			case EThumbnailAlphaBlendMode::EMultiply: MergeInverseAlpha8<EThumbnailAlphaBlendMode::EMultiply>(Pixels, AlphaPass, NumPixels); return;
+			case EThumbnailAlphaBlendMode::ESubtract: MergeInverseAlpha8<EThumbnailAlphaBlendMode::ESubtract>(Pixels, AlphaPass, NumPixels); return;
+			}
+			MergeInverseAlpha8<EThumbnailAlphaBlendMode::EReplace>(Pixels, AlphaPass, NumPixels);
+		}
+
+		void MergeInverseAlpha(FFloat16Color* Pixels, const FFloat16Color* AlphaPass, int32 NumPixels, EThumbnailAlphaBlendMode BlendMode)
+		{
+			switch (BlendMode)
+			{
+			case EThumbnailAlphaBlendMode::EReplace:  MergeInverseAlpha16<EThumbnailAlphaBlendMode::EReplace>(Pixels, AlphaPass, NumPixels); return;
+			case EThumbnailAlphaBlendMode::EAdd:      MergeInverseAlpha16<EThumbnailAlphaBlendMode::EAdd>(Pixels, AlphaPass, NumPixels); return;
+			case EThumbnailAlphaBlendMode::EMultiply: MergeInverseAlpha16<EThumbnailAlphaBlendMode::EMultiply>(Pixels, AlphaPass, NumPixels); return;
+			case EThumbnailAlphaBlendMode::ESubtract: MergeInverseAlpha16<EThumbnailAlphaBlendMode::ESubtract>(Pixels, AlphaPass, NumPixels); return;
+			}
+			MergeInverseAlpha16<EThumbnailAlphaBlendMode::EReplace>(Pixels, AlphaPass, NumPixels);
+		}
+
+		void SetOpaqueAlpha(FColor* Pixels, int32 NumPixels)
+		{
+			int32 Pixel = 0;
+#if THUMBNAIL_ALPHA_KERNELS_NEON
+			const uint32x4_t AlphaMask = vdupq_n_u32(0xFF000000);
+			for (; Pixel + 4 <= NumPixels; Pixel += 4)
+			{
+				uint32* Color = (uint32*)(Pixels + Pixel);
+				vst1q_u32(Color, vorrq_u32(vld1q_u32(Color), AlphaMask));
+			}
+#elif THUMBNAIL_ALPHA_KERNELS_SSE4
+#if THUMBNAIL_ALPHA_KERNELS_AVX2
+			const __m256i AlphaMask256 = _mm256_set1_epi32((int32)0xFF000000);
+			for (; Pixel + 8 <= NumPixels; Pixel += 8)
+			{
+				__m256i* Color = (__m256i*)(Pixels + Pixel);
+				_mm256_storeu_si256(Color, _mm256_or_si256(_mm256_loadu_si256(Color), AlphaMask256));
+			}
+#endif
+			const __m128i AlphaMask = _mm_set1_epi32((int32)0xFF000000);
+			for (; Pixel + 4 <= NumPixels; Pixel += 4)
+			{
+				__m128i* Color = (__m128i*)(Pixels + Pixel);
+				_mm_storeu_si128(Color, _mm_or_si128(_mm_loadu_si128(Color), AlphaMask));
+			}
+#endif
+			for (; Pixel < NumPixels; Pixel++)
+				Pixels[Pixel].A = 255;
+		}
+
+		void SetOpaqueAlpha(FFloat16Color* Pixels, int32 NumPixels)
+		{
+			const FFloat16 OpaqueAlpha = FFloat16(1.f);
+
+			int32 Pixel = 0;
+#if THUMBNAIL_ALPHA_KERNELS_NEON || THUMBNAIL_ALPHA_KERNELS_SSE4
+			const uint64 ColorMask = 0x0000FFFFFFFFFFFFull;
+			const uint64 AlphaBits = uint64(OpaqueAlpha.Encoded) << 48;
+#endif
+#if THUMBNAIL_ALPHA_KERNELS_NEON
+			const uint64x2_t ColorMask128 = vdupq_n_u64(ColorMask);
+			const uint64x2_t AlphaBits128 = vdupq_n_u64(AlphaBits);
+			for (; Pixel + 2 <= NumPixels; Pixel += 2)
+			{
+				uint64* Color = (uint64*)(Pixels + Pixel);
+				vst1q_u64(Color, vorrq_u64(vandq_u64(vld1q_u64(Color), ColorMask128), AlphaBits128));
+			}
+#elif THUMBNAIL_ALPHA_KERNELS_SSE4
+			const __m128i ColorMask128 = _mm_set1_epi64x((int64)ColorMask);
+			const __m128i AlphaBits128 = _mm_set1_epi64x((int64)AlphaBits);
+			for (; Pixel + 2 <= NumPixels; Pixel += 2)
+			{
+				__m128i* Color = (__m128i*)(Pixels + Pixel);
+				_mm_storeu_si128(Color, _mm_or_si128(_mm_and_si128(_mm_loadu_si128(Color), ColorMask128), AlphaBits128));
+			}
+#endif
+			for (; Pixel < NumPixels; Pixel++)
+				Pixels[Pixel].A = OpaqueAlpha;
+		}
+
+		void ExtractInverseAlpha(const FColor* Pixels, uint8* OutAlpha, int32 NumPixels)
+		{
+			int32 Pixel = 0;
+#if THUMBNAIL_ALPHA_KERNELS_NEON
+			for (; Pixel + 16 <= NumPixels; Pixel += 16)
+				vst1q_u8(OutAlpha + Pixel, vmvnq_u8(vld4q_u8((const uint8*)(Pixels + Pixel)).val[3]));
+#elif THUMBNAIL_ALPHA_KERNELS_SSE4
+			const __m128i AllBits = _mm_set1_epi32(-1);
+			for (; Pixel + 16 <= NumPixels; Pixel += 16)
+			{
+				const __m128i* Src = (const __m128i*)(Pixels + Pixel);
+				const __m128i A0 = _mm_srli_epi32(_mm_loadu_si128(Src + 0), 24);
+				const __m128i A1 = _mm_srli_epi32(_mm_loadu_si128(Src + 1), 24);
+				const __m128i A2 = _mm_srli_epi32(_mm_loadu_si128(Src + 2), 24);
+				const __m128i A3 = _mm_srli_epi32(_mm_loadu_si128(Src + 3), 24);
+				const __m128i Alpha = _mm_packus_epi16(_mm_packus_epi32(A0, A1), _mm_packus_epi32(A2, A3));
+				_mm_storeu_si128((__m128i*)(OutAlpha + Pixel), _mm_xor_si128(Alpha, AllBits)); // 255 - A
+			}
+#endif
+			for (; Pixel < NumPixels; Pixel++)
+				OutAlpha[Pixel] = 255 - Pixels[Pixel].A;
+		}
+
+		void ExtractInverseAlpha(const FFloat16Color* Pixels, FFloat16* OutAlpha, int32 NumPixels)
+		{
+			int32 Pixel = 0;
+#if THUMBNAIL_ALPHA_KERNELS_NEON
+			const float32x4_t One = vdupq_n_f32(1.f);
+			for (; Pixel + 8 <= NumPixels; Pixel += 8)
+			{
+				const uint16x8_t Alpha = vld4q_u16((const uint16*)(Pixels + Pixel)).val[3];
+				vst1q_u16((uint16*)(OutAlpha + Pixel), FloatToHalf(vsubq_f32(One, HalfToFloatLow(Alpha)), vsubq_f32(One, HalfToFloatHigh(Alpha))));
+			}
+#elif THUMBNAIL_ALPHA_KERNELS_F16C
+			const __m256 One = _mm256_set1_ps(1.f);
+			for (; Pixel + 8 <= NumPixels; Pixel += 8)
+			{
+				const __m128i InverseAlpha = _mm256_cvtps_ph(_mm256_sub_ps(One, _mm256_cvtph_ps(GatherAlpha16(Pixels + Pixel))), _MM_FROUND_TO_NEAREST_INT);
+				_mm_storeu_si128((__m128i*)(OutAlpha + Pixel), InverseAlpha);
+			}
+#endif
+			for (; Pixel < NumPixels; Pixel++)
+				OutAlpha[Pixel] = FFloat16(1.f - (float)Pixels[Pixel].A);
+		}
+
+		const TCHAR* GetInstructionSetName()
+		{
+#if THUMBNAIL_ALPHA_KERNELS_NEON
+			return TEXT("NEON");
+#elif THUMBNAIL_ALPHA_KERNELS_F16C
+			return TEXT("AVX2+F16C");
+#elif THUMBNAIL_ALPHA_KERNELS_AVX2
+			return TEXT("AVX2");
+#elif THUMBNAIL_ALPHA_KERNELS_SSE4
+			return TEXT("SSE4.1");
+#else
+			return TEXT("Scalar");
+#endif
+		}
+	}
+}
@@ -0,0 +1,58 @@
+// Copyright Mans Isaksson. All Rights Reserved.
+
+#pragma once
+#include "CoreMinimal.h"
+#include "ThumbnailGeneratorSettings.h"
+
+// Kernels which merge the captured alpha into the color of a thumbnail.
+//
+// The blend mode is dispatched once per image, the per-pixel loops are vectorised with SSE4.1 (AVX2 + F16C if the build
+// targets it) on x64 and NEON on ARM. Other targets use branch free scalar loops. Every kernel produces the exact same
+// bits as its counterpart in AlphaKernels::Scalar, which is the reference implementation used by the tests.
+//
+// Alpha blending follows MixAlpha, meaning 8-bit alpha wraps around and FP16 alpha is computed in float and rounded to half.
+namespace ThumbnailGenerator
+{
+	namespace AlphaKernels
+	{
+		/** Pixels[i].A = MixAlpha(Pixels[i].A, Alpha[i]) */
+		void MergeAlpha(FColor* Pixels, const uint8* Alpha, int32 NumPixels, EThumbnailAlphaBlendMode BlendMode);
+
+		/** Pixels[i].A = MixAlpha(Pixels[i].A, Alpha[i]) */
+		void MergeAlpha(FFloat16Color* Pixels, const FFloat16* Alpha, int32 NumPixels, EThumbnailAlphaBlendMode BlendMode);
+
+		/** Pixels[i].A = MixAlpha(Pixels[i].A, 1 - AlphaPass[i].A), where AlphaPass is a capture of the scene's (inverse) alpha. */
+		void MergeInverseAlpha(FColor* Pixels, const FColor* AlphaPass, int32 NumPixels, EThumbnailAlphaBlendMode BlendMode);
+
+		/** Pixels[i].A = MixAlpha(Pixels[i].A, 1 - AlphaPass[i].A), where AlphaPass is a capture of the scene's (inverse) alpha. */
+		void MergeInverseAlpha(FFloat16Color* Pixels, const FFloat16Color* AlphaPass, int32 NumPixels, EThumbnailAlphaBlendMode BlendMode);
+
+		/** Pixels[i].A = 255 */
+		void SetOpaqueAlpha(FColor* Pixels, int32 NumPixels);
+
+		/** Pixels[i].A = 1.0 */
+		void SetOpaqueAlpha(FFloat16Color* Pixels, int32 NumPixels);
+
+		/** OutAlpha[i] = 255 - Pixels[i].A, compacts the alpha pass into a plane which can be passed to MergeAlpha. */
+		void ExtractInverseAlpha(const FColor* Pixels, uint8* OutAlpha, int32 NumPixels);
+
+		/** OutAlpha[i] = 1 - Pixels[i].A, compacts the alpha pass into a plane which can be passed to MergeAlpha. */
+		void ExtractInverseAlpha(const FFloat16Color* Pixels, FFloat16* OutAlpha, int32 NumPixels);
+
+		/** @return Name of the instruction set used by the kernels in this build. */
+		const TCHAR* GetInstructionSetName();
+
+		// Per-pixel reference implementations, which branch on the blend mode for every pixel
+		namespace Scalar
+		{
+			void MergeAlpha(FColor* Pixels, const uint8* Alpha, int32 NumPixels, EThumbnailAlphaBlendMode BlendMode);
+			void MergeAlpha(FFloat16Color* Pixels, const FFloat16* Alpha, int32 NumPixels, EThumbnailAlphaBlendMode BlendMode);
+			void MergeInverseAlpha(FColor* Pixels, const FColor* AlphaPass, int32 NumPixels, EThumbnailAlphaBlendMode BlendMode);
+			void MergeInverseAlpha(FFloat16Color* Pixels, const FFloat16Color* AlphaPass, int32 NumPixels, EThumbnailAlphaBlendMode BlendMode);
+			void SetOpaqueAlpha(FColor* Pixels, int32 NumPixels);
+			void SetOpaqueAlpha(FFloat16Color* Pixels, int32 NumPixels);
+			void ExtractInverseAlpha(const FColor* Pixels, uint8* OutAlpha, int32 NumPixels);
+			void ExtractInverseAlpha(const FFloat16Color* Pixels, FFloat16* OutAlpha, int32 NumPixels);
+		}
+	}
+}
@@ -0,0 +1,123 @@
+// Copyright Mans Isaksson. All Rights Reserved.
+
+#include "ThumbnailBoundsCache.h"
+#include "ThumbnailGeneratorModule.h"
+#include "ThumbnailGeneratorStats.h"
+#include "ThumbnailPrecomputedBounds.h"
+
+namespace ThumbnailGenerator
+{
+	void FThumbnailBoundsCache::SetPrecomputedBounds(const UThumbnailPrecomputedBounds* InPrecomputedBounds)
+	{
+		PrecomputedBounds.Reset();
+		if (!IsValid(InPrecomputedBounds))
+			return;
+
+		PrecomputedBounds.Reserve(InPrecomputedBounds->ActorBounds.Num());
+		for (const FThumbnailPrecomputedActorBounds& ActorBounds : InPrecomputedBounds->ActorBounds)
+		{
+			FThumbnailRequestKey Key;
+			Key.Hash.HashHigh = ActorBounds.BoundsKeyHigh;
+			Key.Hash.HashLow  = ActorBounds.BoundsKeyLow;
+
+			if (Key.IsValid() && ActorBounds.Bounds.IsValid)
+				PrecomputedBounds.Add(Key, ActorBounds.Bounds);
+		}
+
+		UE_LOG(LogThumbnailGenerator, Log, TEXT("FThumbnailBoundsCache::SetPrecomputedBounds - Loaded %d precomputed bounds from %s"), PrecomputedBounds.Num(), *InPrecomputedBounds->GetPathName());
+	}
+
+	bool FThumbnailBoundsCache::FindPrecomputedBounds(const FThumbnailRequestKey& Key, FBox& OutBounds)
+	{
+		const FBox* Entry = PrecomputedBounds.Find(Key);
+		if (!Entry)
+			return false;
+
+		Stats.PrecomputedHits++;
+		INC_DWORD_STAT(STAT_ThumbnailGenerator_PrecomputedBoundsHits);
+
+		OutBounds = *Entry;
+		return true;
+	}
+
+	bool FThumbnailBoundsCache::FindBounds(const FThumbnailRequestKey& Key, FBox& OutBounds)
+	{
+		const FBoundsEntry* Entry = Bounds.Find(Key);
+		if (!Entry)
+		{
+			Stats.BoundsMisses++;
+			INC_DWORD_STAT(STAT_ThumbnailGenerator_BoundsCacheMisses);
+			return false;
+		}
+
+		Stats.BoundsHits++;
+		Stats.TimeSaved += Entry->Seconds;
+		INC_DWORD_STAT(STAT_ThumbnailGenerator_BoundsCacheHits);
+		INC_FLOAT_STAT_BY(STAT_ThumbnailGenerator_BoundsCacheTimeSaved, float(Entry->Seconds * 1000.0));
+
+		OutBounds = Entry->Bounds;
+		return true;
+	}
+
+	void FThumbnailBoundsCache::AddBounds(const FThumbnailRequestKey& Key, const FBox& InBounds, double Seconds, int32 MaxEntries)
+	{
+		if (MaxEntries <= 0)
+			return;
+
+		if (Bounds.Num() >= MaxEntries)
+		{
+			UE_LOG(LogThumbnailGenerator, Verbose, TEXT("FThumbnailBoundsCache::AddBounds - Cache is full (%d bounds), emptying it"), Bounds.Num());
+			Bounds.Reset();
+		}
+
+		Bounds.Add(Key, { InBounds, Seconds });
+	}
+
+	bool FThumbnailBoundsCache::FindView(const FThumbnailRequestKey& Key, FCachedView& OutView)
+	{
+		const FViewEntry* Entry = Views.Find(Key);
+		if (!Entry)
+		{
+			Stats.ViewMisses++;
+			INC_DWORD_STAT(STAT_ThumbnailGenerator_ViewCacheMisses);
+			return false;
+		}
+
+		Stats.ViewHits++;
+		Stats.TimeSaved += Entry->Seconds;
+		INC_DWORD_STAT(STAT_ThumbnailGenerator_ViewCacheHits);
+		INC_FLOAT_STAT_BY(STAT_ThumbnailGenerator_BoundsCacheTimeSaved, float(Entry->Seconds * 1000.0));
+
+		OutView = Entry->View;
+		return true;
+	}
+
+	void FThumbnailBoundsCache::AddView(const FThumbnailRequestKey& Key, const FCachedView& View, double Seconds, int32 MaxEntries)
+	{
+		if (MaxEntries <= 0)
+			return;
+
+		if (Views.Num() >= MaxEntries)
+		{
+			UE_LOG(LogThumbnailGenerator, Verbose, TEXT("FThumbnailBoundsCache::AddView - Cache is full (%d views), emptying it"), Views.Num());
+			Views.Reset();
+		}
+
+		Views.Add(Key, { View, Seconds });
+	}
+
+	void FThumbnailBoundsCache::Reset()
+	{
+		Bounds.Empty();
+		Views.Empty();
+	}
+
+	FThumbnailBoundsCacheStats FThumbnailBoundsCache::GetStats() const
+	{
+		FThumbnailBoundsCacheStats OutStats = Stats;
+		OutStats.NumCachedBounds = Bounds.Num();
+		OutStats.NumCachedViews  = Views.Num();
+		OutStats.NumPrecomputedBounds = PrecomputedBounds.Num();
+		return OutStats;
+	}
+}
@@ -0,0 +1,93 @@
+// Copyright Mans Isaksson. All Rights Reserved.
+
+#pragma once
+#include "CoreMinimal.h"
+#include "ThumbnailRequestHash.h"
+#include "ThumbnailGenerator.h"
+
+class UThumbnailPrecomputedBounds;
+
+namespace ThumbnailGenerator
+{
+	// Remembers the local bounds of thumbnail actors (ComputeBoundsKey) and the automatically framed views computed from them (ComputeViewKey),
+	// so that captures of the same actor with the same inputs skip the bounds calculation and the framing.
+	//
+	// A capture only uses the cache if its actor is fully described by the request, which FThumbnailGenerator signals by setting the capture key
+	// (SetCaptureKey) once the actor has been spawned. Actors handed to the caller by BeginGenerateActorThumbnail never get a capture key.
+	//
+	// The cache holds no object references. It is emptied when full, and must be reset when an asset or class the bounds might depend on changes.
+	//
+	// Bounds calculated ahead of time (UThumbnailPrecomputedBounds) are looked up before the cached bounds, and are kept when the cache is reset.
+	class FThumbnailBoundsCache
+	{
+	public:
+		// The result of CalculateThumbnailView for an automatically framed camera
+		struct FCachedView
+		{
+			FVector Location         = FVector::ZeroVector;
+			FRotator Rotation        = FRotator::ZeroRotator;
+			float FOV                = 90.f;
+			float OrthoWidth         = 512.f;
+			double SnapToFloorOffset = 0.0; // Subtracted from the actor's Z location when bSnapToFloor is set
+		};
+
+	private:
+		struct FBoundsEntry
+		{
+			FBox Bounds = FBox(EForceInit::ForceInit);
+			double Seconds = 0.0; // Time it took to compute the bounds
+		};
+
+		struct FViewEntry
+		{
+			FCachedView View;
+			double Seconds = 0.0; // Time it took to frame the view, including the bounds
+		};
+
+		TMap<FThumbnailRequestKey, FBoundsEntry> Bounds;
+		TMap<FThumbnailRequestKey, FViewEntry> Views;
+		TMap<FThumbnailRequestKey, FBox> PrecomputedBounds;
+		FThumbnailRequestKey CaptureKey;
+		FThumbnailBoundsCacheStats Stats;
+
+	public:
+
+		/** Sets the bounds key of the actor which is being captured, or an invalid key if the actor's bounds must not be cached. */
+		FORCEINLINE void SetCaptureKey(const FThumbnailRequestKey& InCaptureKey) { CaptureKey = InCaptureKey; }
+
+		/** @return The bounds key of the actor which is being captured, invalid if the bounds must not be cached. */
+		FORCEINLINE const FThumbnailRequestKey& GetCaptureKey() const { return CaptureKey; }
+
+		/** Replaces the precomputed bounds with the bounds of an asset generated by the ThumbnailPrecomputeBounds commandlet, nullptr to remove them. */
+		void SetPrecomputedBounds(const UThumbnailPrecomputedBounds* InPrecomputedBounds);
+
+		FORCEINLINE bool HasPrecomputedBounds() const { return PrecomputedBounds.Num() > 0; }
+
+		/** @return True and the bounds if the bounds for Key were precomputed. */
+		bool FindPrecomputedBounds(const FThumbnailRequestKey& Key, FBox& OutBounds);
+
+		/** @return True and the bounds if the bounds for Key are cached. */
+		bool FindBounds(const FThumbnailRequestKey& Key, FBox& OutBounds);
+
+		/**
+		* Remembers the local bounds of an actor.
+		*
+		* @param Key        The bounds key of the actor.
+		* @param InBounds   The bounds in actor space.
+		* @param Seconds    Time it took to compute the bounds, reported as time saved when the bounds are reused.
+		* @param MaxEntries The cache is emptied before adding more than this number of bounds.
+		*/
+		void AddBounds(const FThumbnailRequestKey& Key, const FBox& InBounds, double Seconds, int32 MaxEntries);
+
+		/** @return True and the view if a view for Key is cached. */
+		bool FindView(const FThumbnailRequestKey& Key, FCachedView& OutView);
+
+		/** Remembers an automatically framed view, same as AddBounds. */
+		void AddView(const FThumbnailRequestKey& Key, const FCachedView& View, double Seconds, int32 MaxEntries);
+
+		/** Forgets every cached bounds and view, the statistics and precomputed bounds are kept. */
+		void Reset();
+
+		FThumbnailBoundsCacheStats GetStats() const;
+	};
+}
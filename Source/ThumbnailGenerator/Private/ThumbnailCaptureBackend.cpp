@@ -0,0 +1,473 @@
+// Copyright Mans Isaksson. All Rights Reserved.
+
+#include "ThumbnailCaptureBackend.h"
+#include "ThumbnailGeneratorModule.h"
+#include "ThumbnailGeneratorStats.h"
+#include "ThumbnailAlphaKernels.h"
+#include "ThumbnailScratchBuffers.h"
+
+#include "Components/SceneCaptureComponent2D.h"
+#include "Components/PrimitiveComponent.h"
+#include "Engine/TextureRenderTarget2D.h"
+#include "Kismet/GameplayStatics.h"
+#include "Slate/WidgetRenderer.h"
+#include "Blueprint/UserWidget.h"
+#include "Misc/CommandLine.h"
+#include "TextureResource.h"
+
+namespace ThumbnailGenerator
+{
+	static int32 GetBytesPerPixel(EPixelFormat PixelFormat)
+	{
+		return PixelFormat == PF_B8G8R8A8 ? sizeof(FColor) : sizeof(FFloat16Color);
+	}
+
+	// Merges the inverse alpha plane of the alpha pass (one uint8 or FFloat16 per pixel) into the captured pixels,
+	// or makes them opaque if there is no alpha pass
+	static void ResolveAlpha(const FThumbnailCaptureParams& Params, void* Pixels, const void* AlphaPlane)
+	{
+		THUMBNAIL_STAGE_SCOPE(AlphaMerge);
+
+		const int32 NumPixels = Params.Width * Params.Height;
+		if (Params.PixelFormat == PF_B8G8R8A8)
+		{
+			if (AlphaPlane)
+				AlphaKernels::MergeAlpha((FColor*)Pixels, (const uint8*)AlphaPlane, NumPixels, Params.AlphaBlendMode);
+			else // On some platforms the default alpha is 0, not 255. Make sure to fix that here
+				AlphaKernels::SetOpaqueAlpha((FColor*)Pixels, NumPixels);
+		}
+		else if (Params.PixelFormat == PF_FloatRGBA)
+		{
+			if (AlphaPlane)
+				AlphaKernels::MergeAlpha((FFloat16Color*)Pixels, (const FFloat16*)AlphaPlane, NumPixels, Params.AlphaBlendMode);
+			else // On some platforms the default alpha is 0, not 1. Make sure to fix that here
+				AlphaKernels::SetOpaqueAlpha((FFloat16Color*)Pixels, NumPixels);
+		}
+	}
+
+	class FThumbnailSceneCaptureBackend : public IThumbnailCaptureBackend
+	{
+	private:
+		TWeakObjectPtr<USceneCaptureComponent2D> CaptureComponent; // Owned and kept alive by the FThumbnailGenerator
+		TSharedPtr<FWidgetRenderer> WidgetRenderer;
+		ESceneCaptureSource CaptureSource;
+		TSharedRef<FThumbnailScratchBuffers> ScratchBuffers;
+
+	public:
+
+		FThumbnailSceneCaptureBackend(USceneCaptureComponent2D* InCaptureComponent, const TSharedPtr<FWidgetRenderer>& InWidgetRenderer, ESceneCaptureSource InCaptureSource,
+			const TSharedRef<FThumbnailScratchBuffers>& InScratchBuffers)
+			: CaptureComponent(InCaptureComponent)
+			, WidgetRenderer(InWidgetRenderer)
+			, CaptureSource(InCaptureSource)
+			, ScratchBuffers(InScratchBuffers)
+		{}
+
+		virtual const TCHAR* GetBackendName() const override { return TEXT("SceneCapture"); }
+
+		virtual bool UsesRenderTargets() const override { return true; }
+
+		virtual bool CapturePixels(const FThumbnailCaptureParams& Params, void* OutPixels) override
+		{
+			if (!SetupCapture(Params))
+				return false;
+
+			TArray<uint8> AlphaPlane; // Inverse alpha of the alpha pass
+			if (Params.bCaptureAlpha)
+			{
+				THUMBNAIL_STAGE_SCOPE(AlphaCapture);
+				// I haven't been able to find a way of extracting the Alpha when capturing SCS_FinalColorHDR/SCS_FinalColorLDR.
+				// This is a bit of an ugly hack where we capture the scene again using SCS_SceneColorHDR
+				// and copy the alpha results into our main capture.
+				CaptureComponent->CaptureSource = ESceneCaptureSource::SCS_SceneColorHDR;
+				CaptureComponent->CaptureScene();
+				CaptureComponent->CaptureSource = CaptureSource;
+
+				// OutPixels is free until the main capture is read back, so the alpha pass is read into it and only its alpha is kept
+				if (!ReadRenderTargetPixels(Params.RenderTarget, OutPixels))
+					return false;
+
+				const int32 NumPixels = Params.Width * Params.Height;
+				if (Params.PixelFormat == PF_B8G8R8A8)
+				{
+					AlphaPlane = ScratchBuffers->Acquire(NumPixels * sizeof(uint8));
+					AlphaKernels::ExtractInverseAlpha((const FColor*)OutPixels, AlphaPlane.GetData(), NumPixels);
+				}
+				else
+				{
+					AlphaPlane = ScratchBuffers->Acquire(NumPixels * sizeof(FFloat16));
+					AlphaKernels::ExtractInverseAlpha((const FFloat16Color*)OutPixels, (FFloat16*)AlphaPlane.GetData(), NumPixels);
+				}
+			}
+
+			{
+				THUMBNAIL_STAGE_SCOPE(MainCapture);
+				CaptureComponent->CaptureScene();
+				CaptureComponent->TextureTarget = nullptr;
+			}
+
+			DrawThumbnailUI(Params);
+
+			const bool bReadPixels = ReadRenderTargetPixels(Params.RenderTarget, OutPixels);
+			if (bReadPixels)
+				ResolveAlpha(Params, OutPixels, Params.bCaptureAlpha ? AlphaPlane.GetData() : nullptr);
+
+			ScratchBuffers->Release(MoveTemp(AlphaPlane));
+			return bReadPixels;
+		}
+
+		virtual bool EnqueueCapture(const FThumbnailCaptureParams& Params, FThumbnailPendingCapture& OutCapture) override
+		{
+			if (!SetupCapture(Params))
+				return false;
+
+			if (Params.bCaptureAlpha && Params.AlphaRenderTarget)
+			{
+				THUMBNAIL_STAGE_SCOPE(AlphaCapture);
+				// Same as CapturePixels, but the alpha pass goes into its own render target so it can be read back at the same time as the main capture
+				CaptureComponent->TextureTarget = Params.AlphaRenderTarget;
+				CaptureComponent->CaptureSource = ESceneCaptureSource::SCS_SceneColorHDR;
+				CaptureComponent->CaptureScene();
+				CaptureComponent->CaptureSource = CaptureSource;
+				CaptureComponent->TextureTarget = Params.RenderTarget;
+
+				OutCapture.AlphaReadback = ThumbnailGenerator::CreateGPUReadback(Params.AlphaRenderTarget, &ScratchBuffers.Get());
+			}
+
+			{
+				THUMBNAIL_STAGE_SCOPE(MainCapture);
+				CaptureComponent->CaptureScene();
+				CaptureComponent->TextureTarget = nullptr;
+			}
+
+			DrawThumbnailUI(Params);
+
+			OutCapture.ColorReadback = ThumbnailGenerator::CreateGPUReadback(Params.RenderTarget, &ScratchBuffers.Get());
+			return OutCapture.ColorReadback.IsValid();
+		}
+
+	private:
+
+		bool SetupCapture(const FThumbnailCaptureParams& Params)
+		{
+			if (!CaptureComponent.IsValid())
+			{
+				UE_LOG(LogThumbnailGenerator, Error, TEXT("FThumbnailSceneCaptureBackend - Invalid capture component"));
+				return false;
+			}
+
+			if (!Params.RenderTarget)
+			{
+				UE_LOG(LogThumbnailGenerator, Error, TEXT("FThumbnailSceneCaptureBackend - Invalid render target"));
+				return false;
+			}
+
+			// The pixels are read back straight into the caller's buffer, which is sized from the params
+			if (Params.RenderTarget->SizeX != Params.Width || Params.RenderTarget->SizeY != Params.Height || Params.RenderTarget->GetFormat() != Params.PixelFormat)
+			{
+				UE_LOG(LogThumbnailGenerator, Error, TEXT("FThumbnailSceneCaptureBackend - Render target does not match the capture (%dx%d)"), Params.Width, Params.Height);
+				return false;
+			}
+
+			CaptureComponent->SetCameraView(Params.View);
+			CaptureComponent->PostProcessSettings    = Params.View.PostProcessSettings;
+			CaptureComponent->PostProcessBlendWeight = Params.View.PostProcessBlendWeight;
+			CaptureComponent->bCameraCutThisFrame    = true; // Reset view each capture
+			CaptureComponent->TextureTarget          = Params.RenderTarget;
+			return true;
+		}
+
+		void DrawThumbnailUI(const FThumbnailCaptureParams& Params)
+		{
+			// Render UI if specified
+			if (IsValid(Params.ThumbnailWidget) && WidgetRenderer.IsValid())
+			{
+				THUMBNAIL_STAGE_SCOPE(WidgetDraw);
+				WidgetRenderer->DrawWidget(Params.RenderTarget, Params.ThumbnailWidget->TakeWidget(), FVector2D(Params.RenderTarget->SizeX, Params.RenderTarget->SizeY), 0.f, false);
+			}
+		}
+	};
+
+	class FThumbnailCPUCaptureBackend : public IThumbnailCaptureBackend
+	{
+	private:
+		TSharedRef<FThumbnailScratchBuffers> ScratchBuffers;
+
+	public:
+
+		FThumbnailCPUCaptureBackend(const TSharedRef<FThumbnailScratchBuffers>& InScratchBuffers)
+			: ScratchBuffers(InScratchBuffers)
+		{}
+
+		virtual const TCHAR* GetBackendName() const override { return TEXT("CPU"); }
+
+		virtual bool UsesRenderTargets() const override { return false; }
+
+		virtual bool CapturePixels(const FThumbnailCaptureParams& Params, void* OutPixels) override
+		{
+			TArray<uint8> Coverage;
+			if (!Rasterize(Params, OutPixels, Coverage))
+				return false;
+
+			if (!Params.bCaptureAlpha)
+			{
+				ResolveAlpha(Params, OutPixels, nullptr);
+			}
+			else if (Params.PixelFormat == PF_B8G8R8A8)
+			{
+				// Same layout as the scene capture's inverse alpha plane, the scene alpha is 0 wherever geometry was drawn
+				for (uint8& Covered : Coverage)
+					Covered = Covered ? 255 : 0;
+				ResolveAlpha(Params, OutPixels, Coverage.GetData());
+			}
+			else
+			{
+				TArray<uint8> AlphaPlane = ScratchBuffers->Acquire(Coverage.Num() * sizeof(FFloat16));
+				FFloat16* const Alpha = (FFloat16*)AlphaPlane.GetData();
+				for (int32 Pixel = 0; Pixel < Coverage.Num(); Pixel++)
+					Alpha[Pixel] = FFloat16(Coverage[Pixel] ? 1.f : 0.f);
+				ResolveAlpha(Params, OutPixels, Alpha);
+				ScratchBuffers->Release(MoveTemp(AlphaPlane));
+			}
+
+			ScratchBuffers->Release(MoveTemp(Coverage));
+			return true;
+		}
+
+		virtual bool EnqueueCapture(const FThumbnailCaptureParams& Params, FThumbnailPendingCapture& OutCapture) override
+		{
+			if (!IsValidCapture(Params))
+				return false;
+
+			// Released by the capture pipeline once the capture has completed
+			FThumbnailPixelData Color;
+			Color.SizeX       = Params.Width;
+			Color.SizeY       = Params.Height;
+			Color.PixelFormat = Params.PixelFormat;
+			Color.Pixels      = ScratchBuffers->Acquire(Params.Width * Params.Height * GetBytesPerPixel(Params.PixelFormat));
+
+			TArray<uint8> Coverage;
+			if (!Rasterize(Params, Color.Pixels.GetData(), Coverage))
+			{
+				ScratchBuffers->Release(MoveTemp(Color.Pixels));
+				return false;
+			}
+
+			if (Params.bCaptureAlpha)
+			{
+				// Mimic the SCS_SceneColorHDR alpha pass, only the alpha channel is read
+				FThumbnailPixelData SceneAlpha;
+				SceneAlpha.SizeX       = Color.SizeX;
+				SceneAlpha.SizeY       = Color.SizeY;
+				SceneAlpha.PixelFormat = Color.PixelFormat;
+				SceneAlpha.Pixels      = ScratchBuffers->Acquire(Color.Pixels.Num());
+				FMemory::Memzero(SceneAlpha.Pixels.GetData(), SceneAlpha.Pixels.Num());
+
+				if (Params.PixelFormat == PF_B8G8R8A8)
+				{
+					FColor* const AlphaPixels = (FColor*)SceneAlpha.Pixels.GetData();
+					for (int32 Pixel = 0; Pixel < Coverage.Num(); Pixel++)
+						AlphaPixels[Pixel].A = Coverage[Pixel] ? 0 : 255;
+				}
+				else
+				{
+					FFloat16Color* const AlphaPixels = (FFloat16Color*)SceneAlpha.Pixels.GetData();
+					for (int32 Pixel = 0; Pixel < Coverage.Num(); Pixel++)
+						AlphaPixels[Pixel].A = FFloat16(Coverage[Pixel] ? 0.f : 1.f);
+				}
+
+				OutCapture.AlphaReadback = ThumbnailGenerator::CreateCPUReadback(MoveTemp(SceneAlpha), 1);
+			}
+
+			ScratchBuffers->Release(MoveTemp(Coverage));
+
+			// Pretend the readback takes a frame, so captures actually overlap in the pipeline
+			OutCapture.ColorReadback = ThumbnailGenerator::CreateCPUReadback(MoveTemp(Color), 1);
+			return true;
+		}
+
+	private:
+
+		static bool IsValidCapture(const FThumbnailCaptureParams& Params)
+		{
+			if (Params.Width <= 0 || Params.Height <= 0 || !IsValidPixelFormat(Params.PixelFormat))
+			{
+				UE_LOG(LogThumbnailGenerator, Error, TEXT("FThumbnailCPUCaptureBackend - Invalid capture size or format (%dx%d)"), Params.Width, Params.Height);
+				return false;
+			}
+			return true;
+		}
+
+		// Writes Params.Width * Params.Height pixels in Params.PixelFormat to OutPixels.
+		// OutCoverage is acquired from the scratch buffers and holds 1 for every pixel that was drawn, the caller releases it.
+		bool Rasterize(const FThumbnailCaptureParams& Params, void* OutPixels, TArray<uint8>& OutCoverage)
+		{
+			THUMBNAIL_STAGE_SCOPE(MainCapture);
+
+			if (!IsValidCapture(Params))
+				return false;
+
+			const int32 Width     = Params.Width;
+			const int32 Height    = Params.Height;
+			const int32 NumPixels = Width * Height;
+
+			FMatrix ViewMatrix, ProjectionMatrix, ViewProjectionMatrix;
+			UGameplayStatics::GetViewProjectionMatrix(Params.View, ViewMatrix, ProjectionMatrix, ViewProjectionMatrix);
+
+			TArray<uint8> ColorBytes = ScratchBuffers->Acquire(NumPixels * sizeof(FLinearColor));
+			TArray<uint8> DepthBytes = ScratchBuffers->Acquire(NumPixels * sizeof(float));
+			FLinearColor* const ColorBuffer = (FLinearColor*)ColorBytes.GetData();
+			float* const DepthBuffer        = (float*)DepthBytes.GetData();
+			for (int32 Pixel = 0; Pixel < NumPixels; Pixel++)
+			{
+				ColorBuffer[Pixel] = FLinearColor::Black;
+				DepthBuffer[Pixel] = -BIG_NUMBER; // Reversed Z, larger values are closer
+			}
+
+			OutCoverage = ScratchBuffers->Acquire(NumPixels);
+			FMemory::Memzero(OutCoverage.GetData(), NumPixels);
+
+			const FVector ViewDirection = Params.View.Rotation.Vector();
+
+			struct FScreenVertex { float X; float Y; float Z; };
+			const auto ProjectVertex = [&](const FVector& WorldPosition, FScreenVertex& OutVertex)->bool
+			{
+				const FVector4 ClipPosition = ViewProjectionMatrix.TransformFVector4(FVector4(WorldPosition, 1.f));
+				if (ClipPosition.W <= KINDA_SMALL_NUMBER)
+					return false;
+
+				const double InvW = 1.0 / ClipPosition.W;
+				OutVertex.X = float((ClipPosition.X * InvW * 0.5 + 0.5) * Width);
+				OutVertex.Y = float((0.5 - ClipPosition.Y * InvW * 0.5) * Height);
+				OutVertex.Z = float(ClipPosition.Z * InvW);
+				return true;
+			};
+
+			const auto RasterizeTriangle = [&](const FScreenVertex& A, const FScreenVertex& B, const FScreenVertex& C, const FLinearColor& Color)
+			{
+				const float Area = (B.X - A.X) * (C.Y - A.Y) - (B.Y - A.Y) * (C.X - A.X);
+				if (FMath::IsNearlyZero(Area))
+					return;
+
+				const int32 MinX = FMath::Clamp(FMath::FloorToInt(FMath::Min3(A.X, B.X, C.X)), 0, Width - 1);
+				const int32 MaxX = FMath::Clamp(FMath::CeilToInt(FMath::Max3(A.X, B.X, C.X)), 0, Width - 1);
+				const int32 MinY = FMath::Clamp(FMath::FloorToInt(FMath::Min3(A.Y, B.Y, C.Y)), 0, Height - 1);
+				const int32 MaxY = FMath::Clamp(FMath::CeilToInt(FMath::Max3(A.Y, B.Y, C.Y)), 0, Height - 1);
+
+				const float InvArea = 1.f / Area;
+				for (int32 Y = MinY; Y <= MaxY; Y++)
+				{
+					for (int32 X = MinX; X <= MaxX; X++)
+					{
+						const float PX = X + 0.5f;
+						const float PY = Y + 0.5f;
+
+						// Barycentric weights, both windings are accepted since faces aren't culled
+						const float W0 = ((B.X - PX) * (C.Y - PY) - (B.Y - PY) * (C.X - PX)) * InvArea;
+						const float W1 = ((C.X - PX) * (A.Y - PY) - (C.Y - PY) * (A.X - PX)) * InvArea;
+						const float W2 = 1.f - W0 - W1;
+						if (W0 < 0.f || W1 < 0.f || W2 < 0.f)
+							continue;
+
+						const int32 Pixel = X + Y * Width;
+						const float Depth = W0 * A.Z + W1 * B.Z + W2 * C.Z;
+						if (Depth <= DepthBuffer[Pixel])
+							continue;
+
+						DepthBuffer[Pixel] = Depth;
+						ColorBuffer[Pixel] = Color;
+						OutCoverage[Pixel] = 1;
+					}
+				}
+			};
+
+			// Corner indices of each face of a box, bit 2 selects Max.X, bit 1 Max.Y and bit 0 Max.Z
+			static const int32 FaceCorners[6][4] =
+			{
+				{ 0, 1, 3, 2 }, { 4, 5, 7, 6 }, // -X, +X
+				{ 0, 1, 5, 4 }, { 2, 3, 7, 6 }, // -Y, +Y
+				{ 0, 2, 6, 4 }, { 1, 3, 7, 5 }, // -Z, +Z
+			};
+			static const FVector FaceNormals[6] =
+			{
+				-FVector::ForwardVector, FVector::ForwardVector,
+				-FVector::RightVector,   FVector::RightVector,
+				-FVector::UpVector,      FVector::UpVector
+			};
+
+			if (IsValid(Params.Actor))
+			{
+				Params.Actor->ForEachComponent<UPrimitiveComponent>(false, [&](UPrimitiveComponent* PrimitiveComponent)
+				{
+					if (!PrimitiveComponent->IsRegistered() || !PrimitiveComponent->IsVisible())
+						return;
+
+					const FBox Box = PrimitiveComponent->Bounds.GetBox();
+					if (!Box.IsValid || Box.GetExtent().IsNearlyZero())
+						return;
+
+					// Component names are stable between runs, unlike FName indices or object addresses
+					const uint32 ColorSeed = FCrc::StrCrc32(*PrimitiveComponent->GetName());
+					const FLinearColor BaseColor = FLinearColor::MakeFromHSV8(uint8(ColorSeed), 160, 255);
+
+					FScreenVertex ScreenCorners[8];
+					for (int32 Corner = 0; Corner < 8; Corner++)
+					{
+						const FVector CornerLocation(
+							(Corner & 4) ? Box.Max.X : Box.Min.X,
+							(Corner & 2) ? Box.Max.Y : Box.Min.Y,
+							(Corner & 1) ? Box.Max.Z : Box.Min.Z
+						);
+
+						if (!ProjectVertex(CornerLocation, ScreenCorners[Corner]))
+							return; // Intersects the near plane, skip rather than clip
+					}
+
+					for (int32 Face = 0; Face < 6; Face++)
+					{
+						const float Shade = 0.3f + 0.7f * FMath::Max(0.f, float(FVector::DotProduct(FaceNormals[Face], -ViewDirection)));
+						const FLinearColor FaceColor = FLinearColor(BaseColor.R * Shade, BaseColor.G * Shade, BaseColor.B * Shade, 0.f);
+
+						const int32* Quad = FaceCorners[Face];
+						RasterizeTriangle(ScreenCorners[Quad[0]], ScreenCorners[Quad[1]], ScreenCorners[Quad[2]], FaceColor);
+						RasterizeTriangle(ScreenCorners[Quad[0]], ScreenCorners[Quad[2]], ScreenCorners[Quad[3]], FaceColor);
+					}
+				});
+			}
+
+			// Alpha is left at 0 like the scene capture does, it is resolved afterwards
+			if (Params.PixelFormat == PF_B8G8R8A8)
+			{
+				FColor* const Pixels = (FColor*)OutPixels;
+				for (int32 Pixel = 0; Pixel < NumPixels; Pixel++)
+					Pixels[Pixel] = ColorBuffer[Pixel].ToFColor(true);
+			}
+			else
+			{
+				FFloat16Color* const Pixels = (FFloat16Color*)OutPixels;
+				for (int32 Pixel = 0; Pixel < NumPixels; Pixel++)
+					Pixels[Pixel] = FFloat16Color(ColorBuffer[Pixel]);
+			}
+
+			ScratchBuffers->Release(MoveTemp(ColorBytes));
+			ScratchBuffers->Release(MoveTemp(DepthBytes));
+			return true;
+		}
+	};
+
+	TSharedRef<IThumbnailCaptureBackend> CreateSceneCaptureBackend(USceneCaptureComponent2D* CaptureComponent, const TSharedPtr<FWidgetRenderer>& WidgetRenderer, ESceneCaptureSource CaptureSource, 
+		const TSharedRef<FThumbnailScratchBuffers>& ScratchBuffers)
+	{
+		return MakeShared<FThumbnailSceneCaptureBackend>(CaptureComponent, WidgetRenderer, CaptureSource, ScratchBuffers);
+	}
+
+	TSharedRef<IThumbnailCaptureBackend> CreateCPUCaptureBackend(const TSharedRef<FThumbnailScratchBuffers>& ScratchBuffers)
+	{
+		return MakeShared<FThumbnailCPUCaptureBackend>(ScratchBuffers);
+	}
+
+	bool ShouldUseCPUCaptureBackend()
+	{
+		return !FApp::CanEverRender() || FParse::Param(FCommandLine::Get(), TEXT("ThumbnailCPUCapture"));
+	}
+}
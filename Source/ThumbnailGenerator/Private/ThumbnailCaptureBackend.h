@@ -0,0 +1,91 @@
+// Copyright Mans Isaksson. All Rights Reserved.
+
+#pragma once
+#include "CoreMinimal.h"
+#include "Camera/CameraTypes.h"
+#include "Engine/EngineTypes.h"
+#include "ThumbnailCapturePipeline.h"
+#include "ThumbnailGeneratorSettings.h"
+
+class AActor;
+class UUserWidget;
+class UTextureRenderTarget2D;
+class USceneCaptureComponent2D;
+class FWidgetRenderer;
+
+// Everything a backend needs to capture a single thumbnail
+struct FThumbnailCaptureParams
+{
+	FMinimalViewInfo View; // The framed view, AspectRatio is set to Width / Height
+	int32 Width  = 0;
+	int32 Height = 0;
+	EPixelFormat PixelFormat = PF_B8G8R8A8;
+
+	bool bCaptureAlpha = false;
+	EThumbnailAlphaBlendMode AlphaBlendMode = EThumbnailAlphaBlendMode::EReplace; // How CapturePixels merges the alpha pass into the main capture
+	UUserWidget* ThumbnailWidget = nullptr; // Instance of ThumbnailUI drawn on top of the capture, pooled by the FThumbnailGenerator
+
+	AActor* Actor = nullptr; // The framed thumbnail actor
+
+	// Only used by backends which render into render targets (see IThumbnailCaptureBackend::UsesRenderTargets)
+	UTextureRenderTarget2D* RenderTarget      = nullptr;
+	UTextureRenderTarget2D* AlphaRenderTarget = nullptr; // Only used by EnqueueCapture, CapturePixels reuses RenderTarget for the alpha pass
+};
+
+// Turns a framed thumbnail view into pixels. Everything before (spawning, simulation, framing) and after (alpha merge,
+// texture fill) is shared between backends, which makes it possible to run the whole pipeline without a GPU.
+class IThumbnailCaptureBackend
+{
+public:
+	virtual ~IThumbnailCaptureBackend() = default;
+
+	virtual const TCHAR* GetBackendName() const = 0;
+
+	/** @return True if the caller has to provide render targets in FThumbnailCaptureParams. */
+	virtual bool UsesRenderTargets() const = 0;
+
+	/**
+	* Captures the view and blocks until the pixels are available. The pixels are written straight into OutPixels with the
+	* alpha resolved (merged with the alpha pass using Params.AlphaBlendMode, or opaque), so OutPixels can be the locked mip
+	* of the thumbnail texture. OutPixels is also used as scratch memory and is left undefined if the capture fails.
+	*
+	* @param OutPixels Params.Width * Params.Height pixels in Params.PixelFormat.
+	*/
+	virtual bool CapturePixels(const FThumbnailCaptureParams& Params, void* OutPixels) = 0;
+
+	/** Captures the view without waiting for the pixels. The caller is responsible for setting OutCapture.OnCompleted. */
+	virtual bool EnqueueCapture(const FThumbnailCaptureParams& Params, FThumbnailPendingCapture& OutCapture) = 0;
+};
+
+namespace ThumbnailGenerator
+{
+	static FORCEINLINE bool IsValidPixelFormat(EPixelFormat PixelFormat) // Right now, we only support B8G8R8A8 and FloatRGBA
+	{
+		switch (PixelFormat)
+		{
+		case PF_B8G8R8A8: return true;
+		case PF_FloatRGBA: return true;
+		}
+		return false;
+	}
+
+	class FThumbnailScratchBuffers;
+
+	/**
+	* Captures using a USceneCaptureComponent2D registered in the thumbnail world.
+	*
+	* @param ScratchBuffers Pool used for the alpha plane and the pixels of pipelined readbacks.
+	*/
+	TSharedRef<IThumbnailCaptureBackend> CreateSceneCaptureBackend(USceneCaptureComponent2D* CaptureComponent, const TSharedPtr<FWidgetRenderer>& WidgetRenderer, ESceneCaptureSource CaptureSource, 
+		const TSharedRef<FThumbnailScratchBuffers>& ScratchBuffers);
+
+	/**
+	* Deterministic CPU stand-in which rasterizes the bounds of the actor's primitive components as flat shaded boxes.
+	* Works under -nullrhi, so spawning, framing and texture fill can be profiled and tested on machines without a GPU.
+	* The ThumbnailWidget is not drawn.
+	*/
+	TSharedRef<IThumbnailCaptureBackend> CreateCPUCaptureBackend(const TSharedRef<FThumbnailScratchBuffers>& ScratchBuffers);
+
+	/** @return True if the CPU backend should be used, either because rendering is unavailable or because -ThumbnailCPUCapture was passed on the command line. */
+	bool ShouldUseCPUCaptureBackend();
+}
@@ -0,0 +1,120 @@
+// Copyright Mans Isaksson. All Rights Reserved.
+
+#include "ThumbnailCapturePipeline.h"
+#include "ThumbnailGeneratorModule.h"
+#include "ThumbnailGeneratorStats.h"
+#include "ThumbnailScratchBuffers.h"
+
+namespace ThumbnailGenerator
+{
+	FThumbnailCapturePipeline::FThumbnailCapturePipeline(int32 InMaxInFlight, const TSharedPtr<FThumbnailScratchBuffers>& InScratchBuffers)
+		: ScratchBuffers(InScratchBuffers)
+		, MaxInFlight(FMath::Max(1, InMaxInFlight))
+	{
+		FreeSlots.Reserve(MaxInFlight);
+		for (int32 Slot = MaxInFlight - 1; Slot >= 0; Slot--)
+			FreeSlots.Add(Slot);
+	}
+
+	FThumbnailCapturePipeline::~FThumbnailCapturePipeline()
+	{
+		// Callbacks might reference the caller's state, so they have to run before the pipeline goes away
+		Flush();
+	}
+
+	int32 FThumbnailCapturePipeline::AcquireSlot()
+	{
+		Poll();
+
+		if (FreeSlots.Num() == 0)
+		{
+			NumStalls++;
+			CompleteOldest(true);
+		}
+
+		check(FreeSlots.Num() > 0);
+		return FreeSlots.Pop(EAllowShrinking::No);
+	}
+
+	void FThumbnailCapturePipeline::Enqueue(int32 Slot, FThumbnailPendingCapture&& Capture)
+	{
+		check(Slot >= 0 && Slot < MaxInFlight && !FreeSlots.Contains(Slot));
+
+		INC_DWORD_STAT(STAT_ThumbnailGenerator_CapturesInFlight);
+
+		FInFlightCapture& InFlightCapture = InFlightCaptures.EmplaceLast();
+		InFlightCapture.Slot    = Slot;
+		InFlightCapture.Capture = MoveTemp(Capture);
+	}
+
+	void FThumbnailCapturePipeline::ReleaseSlot(int32 Slot)
+	{
+		check(Slot >= 0 && Slot < MaxInFlight && !FreeSlots.Contains(Slot));
+		FreeSlots.Add(Slot);
+	}
+
+	int32 FThumbnailCapturePipeline::Poll()
+	{
+		int32 NumCompletedNow = 0;
+		while (!InFlightCaptures.IsEmpty())
+		{
+			const FThumbnailPendingCapture& Capture = InFlightCaptures.First().Capture;
+
+			// Poll both readbacks every time, polling is what advances them
+			const bool bColorReady = !Capture.ColorReadback.IsValid() || Capture.ColorReadback->Poll();
+			const bool bAlphaReady = !Capture.AlphaReadback.IsValid() || Capture.AlphaReadback->Poll();
+			if (!bColorReady || !bAlphaReady)
+				break;
+
+			CompleteOldest(false);
+			NumCompletedNow++;
+		}
+		return NumCompletedNow;
+	}
+
+	void FThumbnailCapturePipeline::Flush()
+	{
+		while (!InFlightCaptures.IsEmpty())
+			CompleteOldest(true);
+	}
+
+	void FThumbnailCapturePipeline::CompleteOldest(bool bWait)
+	{
+		FInFlightCapture InFlightCapture = MoveTemp(InFlightCaptures.First());
+		InFlightCaptures.PopFirst();
+
+		DEC_DWORD_STAT(STAT_ThumbnailGenerator_CapturesInFlight);
+
+		FThumbnailPendingCapture& Capture = InFlightCapture.Capture;
+
+		if (bWait)
+		{
+			if (Capture.AlphaReadback.IsValid())
+				Capture.AlphaReadback->Wait();
+
+			if (Capture.ColorReadback.IsValid())
+				Capture.ColorReadback->Wait();
+		}
+
+		FThumbnailPixelData ColorPixels;
+		FThumbnailPixelData AlphaPixels;
+		const bool bHasColor = Capture.ColorReadback.IsValid() && Capture.ColorReadback->Resolve(ColorPixels);
+		const bool bHasAlpha = Capture.AlphaReadback.IsValid() && Capture.AlphaReadback->Resolve(AlphaPixels);
+
+		if (!bHasColor)
+			UE_LOG(LogThumbnailGenerator, Error, TEXT("FThumbnailCapturePipeline - Failed to read back thumbnail capture"));
+
+		// The slot's render targets are no longer read from once the readbacks have been resolved
+		FreeSlots.Add(InFlightCapture.Slot);
+		NumCompleted++;
+
+		if (Capture.OnCompleted)
+			Capture.OnCompleted(bHasColor ? &ColorPixels : nullptr, bHasAlpha ? &AlphaPixels : nullptr);
+
+		if (ScratchBuffers.IsValid())
+		{
+			ScratchBuffers->Release(MoveTemp(ColorPixels.Pixels));
+			ScratchBuffers->Release(MoveTemp(AlphaPixels.Pixels));
+		}
+	}
+}
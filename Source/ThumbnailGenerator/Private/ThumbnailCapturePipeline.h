@@ -0,0 +1,82 @@
+// Copyright Mans Isaksson. All Rights Reserved.
+
+#pragma once
+#include "CoreMinimal.h"
+#include "Containers/Deque.h"
+#include "ThumbnailReadback.h"
+
+// A capture which has been submitted to the GPU and is waiting for its readback
+struct FThumbnailPendingCapture
+{
+	TUniquePtr<IThumbnailReadback> ColorReadback;
+	TUniquePtr<IThumbnailReadback> AlphaReadback; // Only set if the alpha was captured in a separate pass
+
+	// Called once the readbacks have completed. Color is nullptr if the readback failed, Alpha is nullptr if there is no alpha pass.
+	// The pixels are only valid during the call.
+	TFunction<void(FThumbnailPixelData* Color, FThumbnailPixelData* Alpha)> OnCompleted;
+};
+
+namespace ThumbnailGenerator
+{
+	class FThumbnailScratchBuffers;
+
+	// Keeps several captures in flight, so the next thumbnail can be spawned, simulated and captured while the readback of the
+	// previous one is still in progress. Each in-flight capture owns a slot, which the caller uses to pick a render target that
+	// isn't being read back. Captures are completed in the order they were enqueued.
+	//
+	// Only use from the game thread.
+	class FThumbnailCapturePipeline
+	{
+	private:
+		struct FInFlightCapture
+		{
+			int32 Slot = INDEX_NONE;
+			FThumbnailPendingCapture Capture;
+		};
+
+		TDeque<FInFlightCapture> InFlightCaptures;
+		TArray<int32> FreeSlots;
+
+		TSharedPtr<FThumbnailScratchBuffers> ScratchBuffers; // The read back pixels are released here once OnCompleted has run
+
+		int32 MaxInFlight  = 1;
+		int32 NumCompleted = 0;
+		int32 NumStalls    = 0; // Number of times a slot was requested while every slot had a capture in flight
+
+	public:
+
+		explicit FThumbnailCapturePipeline(int32 InMaxInFlight, const TSharedPtr<FThumbnailScratchBuffers>& InScratchBuffers = nullptr);
+
+		~FThumbnailCapturePipeline();
+
+		/**
+		* Returns a slot which has no capture in flight. Blocks on the oldest capture if every slot is in use.
+		* Must be followed by Enqueue with the returned slot.
+		*/
+		int32 AcquireSlot();
+
+		/** Adds a capture for a slot returned by AcquireSlot. */
+		void Enqueue(int32 Slot, FThumbnailPendingCapture&& Capture);
+
+		/** Returns a slot returned by AcquireSlot which won't be enqueued, e.g. because the capture failed. */
+		void ReleaseSlot(int32 Slot);
+
+		/** Completes the captures whose readbacks are ready, without blocking. @return Number of completed captures. */
+		int32 Poll();
+
+		/** Blocks until every capture in flight has been completed. */
+		void Flush();
+
+		FORCEINLINE int32 Num() const { return InFlightCaptures.Num(); }
+
+		FORCEINLINE int32 GetMaxInFlight() const { return MaxInFlight; }
+
+		FORCEINLINE int32 GetNumCompleted() const { return NumCompleted; }
+
+		FORCEINLINE int32 GetNumStalls() const { return NumStalls; }
+
+	private:
+
+		void CompleteOldest(bool bWait);
+	};
+}
@@ -0,0 +1,544 @@
+// Copyright Mans Isaksson. All Rights Reserved.
+
+#include "ThumbnailDiskCache.h"
+#include "ThumbnailGeneratorModule.h"
+#include "ThumbnailGeneratorSettings.h"
+
+#include "HAL/PlatformFileManager.h"
+#include "HAL/FileManager.h"
+#include "Async/MappedFileHandle.h"
+#include "Misc/Compression.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Misc/App.h"
+#include "Interfaces/IPluginManager.h"
+#include "UObject/Package.h"
+#include "IO/IoHash.h"
+
+namespace ThumbnailDiskCache
+{
+	constexpr uint32 IndexMagic   = 0x58444754; // 'TGDX'
+	constexpr uint32 RecordMagic  = 0x52444754; // 'TGDR'
+	constexpr uint32 IndexVersion = 1;
+	constexpr uint32 MinIndexSlots = 64;
+
+	// The index is written back after this many stores, or once it has been dirty for FlushInterval seconds
+	constexpr int32  FlushStoreThreshold = 32;
+	constexpr double FlushInterval       = 30.0;
+
+	const FName CompressionFormat = NAME_Oodle;
+
+	struct FIndexHeader
+	{
+		uint32 Magic         = IndexMagic;
+		uint32 Version       = IndexVersion;
+		uint32 NumSlots      = 0;
+		uint32 NumEntries    = 0;
+		uint64 DataFileSize  = 0;
+		uint64 AccessCounter = 0;
+	};
+
+	struct FRecordHeader
+	{
+		uint32     Magic            = RecordMagic;
+		uint32     PixelFormat      = 0;
+		FXxHash128 Key;
+		uint32     SizeX            = 0;
+		uint32     SizeY            = 0;
+		uint32     UncompressedSize = 0;
+		uint32     CompressedSize   = 0;
+	};
+
+	static TUniquePtr<FThumbnailDiskCache> SharedDiskCache;
+
+	static const FString& GetPluginVersion()
+	{
+		static const FString PluginVersion = []()->FString
+		{
+			const TSharedPtr<IPlugin> Plugin = IPluginManager::Get().FindPlugin(TEXT("ThumbnailGenerator"));
+			return Plugin.IsValid() ? FString::Printf(TEXT("%d_%s"), Plugin->GetDescriptor().Version, *Plugin->GetDescriptor().VersionName) : FString();
+		}();
+		return PluginVersion;
+	}
+}
+
+FThumbnailDiskCache::FThumbnailDiskCache(const FString& InCacheDirectory)
+	: CacheDirectory(InCacheDirectory)
+	, DataFilePath(InCacheDirectory / TEXT("Thumbnails.data"))
+	, IndexFilePath(InCacheDirectory / TEXT("Thumbnails.index"))
+{
+	static_assert(sizeof(FIndexEntry) == 40, "The index entry is memory mapped, its layout must not change without bumping IndexVersion");
+
+	FPlatformFileManager::Get().GetPlatformFile().CreateDirectoryTree(*CacheDirectory);
+	OpenIndex();
+}
+
+FThumbnailDiskCache::~FThumbnailDiskCache()
+{
+	Flush();
+	CloseIndex();
+	DataFile.Reset();
+}
+
+bool FThumbnailDiskCache::ComputeDiskCacheKey(FThumbnailRequestKey& OutKey, const UClass* ActorClass, const FThumbnailSettings& ThumbnailSettings, const TMap<FString, FString>& Properties,
+	const FInstancedPropertyBag* PropertyBag)
+{
+	if (!ActorClass)
+		return false;
+
+	const FThumbnailRequestKey RequestKey = ThumbnailGenerator::ComputeRequestKey(ActorClass, ThumbnailSettings, Properties, PropertyBag);
+
+	FXxHash128Builder Builder;
+	Builder.Update(&RequestKey.Hash, sizeof(FXxHash128));
+
+	// Blueprint classes are keyed on the saved state of their package (and the packages of their blueprint parents).
+	// Native classes and cooked content can only change with a new build, which is covered by the build version below.
+	for (const UClass* Class = ActorClass; Class && !Class->HasAnyClassFlags(CLASS_Native); Class = Class->GetSuperClass())
+	{
+		const UPackage* Package = Class->GetPackage();
+#if WITH_EDITOR
+		if (Package->IsDirty())
+			return false;
+#endif
+#if WITH_EDITORONLY_DATA
+		const FIoHash& SavedHash = Package->GetSavedHash();
+		Builder.Update(&SavedHash, sizeof(FIoHash));
+#endif
+	}
+
+	const FString BuildVersion = FApp::GetBuildVersion();
+	Builder.Update(*BuildVersion, BuildVersion.Len() * sizeof(TCHAR));
+
+	const FString& PluginVersion = ThumbnailDiskCache::GetPluginVersion();
+	Builder.Update(*PluginVersion, PluginVersion.Len() * sizeof(TCHAR));
+
+	OutKey = FThumbnailRequestKey{ Builder.Finalize() };
+	return true;
+}
+
+bool FThumbnailDiskCache::Load(const FThumbnailRequestKey& Key, FThumbnailDiskCacheData& OutData)
+{
+	QUICK_SCOPE_CYCLE_COUNTER(STAT_ThumbnailDiskCache_Load);
+
+	const FIndexEntry* FoundEntry = FindEntry(Key);
+	if (!FoundEntry)
+		return false;
+
+	const FIndexEntry Entry = *FoundEntry;
+	if (!OpenDataFile() || Entry.Offset + Entry.Size > DataFileSize || Entry.Size < sizeof(ThumbnailDiskCache::FRecordHeader))
+		return false;
+
+	TArray<uint8> Record;
+	Record.SetNumUninitialized(Entry.Size);
+	if (!DataFile->Seek(Entry.Offset) || !DataFile->Read(Record.GetData(), Entry.Size))
+	{
+		UE_LOG(LogThumbnailGenerator, Warning, TEXT("FThumbnailDiskCache::Load - Failed to read record %s"), *Key.ToString());
+		return false;
+	}
+
+	ThumbnailDiskCache::FRecordHeader Header;
+	FMemory::Memcpy(&Header, Record.GetData(), sizeof(Header));
+
+	const bool bIsValidRecord = Header.Magic == ThumbnailDiskCache::RecordMagic
+		&& Header.Key == Key.Hash
+		&& sizeof(Header) + Header.CompressedSize == Entry.Size
+		&& Header.PixelFormat < PF_MAX;
+
+	if (!bIsValidRecord)
+	{
+		UE_LOG(LogThumbnailGenerator, Warning, TEXT("FThumbnailDiskCache::Load - Corrupt record %s"), *Key.ToString());
+		return false;
+	}
+
+	OutData.SizeX       = Header.SizeX;
+	OutData.SizeY       = Header.SizeY;
+	OutData.PixelFormat = (EPixelFormat)Header.PixelFormat;
+	OutData.Pixels.SetNumUninitialized(Header.UncompressedSize);
+
+	if (!FCompression::UncompressMemory(ThumbnailDiskCache::CompressionFormat, OutData.Pixels.GetData(), Header.UncompressedSize, Record.GetData() + sizeof(Header), Header.CompressedSize))
+	{
+		UE_LOG(LogThumbnailGenerator, Warning, TEXT("FThumbnailDiskCache::Load - Failed to decompress record %s"), *Key.ToString());
+		return false;
+	}
+
+	FIndexEntry TouchedEntry = Entry;
+	TouchedEntry.LastAccessed = ++AccessCounter;
+	IndexOverlay.Add(Key, TouchedEntry);
+	MarkIndexDirty();
+
+	return true;
+}
+
+bool FThumbnailDiskCache::Store(const FThumbnailRequestKey& Key, const FThumbnailDiskCacheData& Data, int64 MaxSize)
+{
+	QUICK_SCOPE_CYCLE_COUNTER(STAT_ThumbnailDiskCache_Store);
+
+	if (Data.Pixels.Num() == 0 || !OpenDataFile())
+		return false;
+
+	int32 CompressedSize = FCompression::CompressMemoryBound(ThumbnailDiskCache::CompressionFormat, Data.Pixels.Num());
+
+	TArray<uint8> Record;
+	Record.SetNumUninitialized(sizeof(ThumbnailDiskCache::FRecordHeader) + CompressedSize);
+
+	if (!FCompression::CompressMemory(ThumbnailDiskCache::CompressionFormat, Record.GetData() + sizeof(ThumbnailDiskCache::FRecordHeader), CompressedSize, Data.Pixels.GetData(), Data.Pixels.Num()))
+	{
+		UE_LOG(LogThumbnailGenerator, Warning, TEXT("FThumbnailDiskCache::Store - Failed to compress thumbnail %s"), *Key.ToString());
+		return false;
+	}
+
+	Record.SetNum(sizeof(ThumbnailDiskCache::FRecordHeader) + CompressedSize, EAllowShrinking::No);
+
+	ThumbnailDiskCache::FRecordHeader Header;
+	Header.PixelFormat      = (uint32)Data.PixelFormat;
+	Header.Key              = Key.Hash;
+	Header.SizeX            = Data.SizeX;
+	Header.SizeY            = Data.SizeY;
+	Header.UncompressedSize = Data.Pixels.Num();
+	Header.CompressedSize   = CompressedSize;
+	FMemory::Memcpy(Record.GetData(), &Header, sizeof(Header));
+
+	if (!DataFile->SeekFromEnd(0))
+		return false;
+
+	const int64 Offset = DataFile->Tell();
+	if (!DataFile->Write(Record.GetData(), Record.Num()))
+	{
+		UE_LOG(LogThumbnailGenerator, Warning, TEXT("FThumbnailDiskCache::Store - Failed to write thumbnail %s"), *Key.ToString());
+		return false;
+	}
+
+	DataFileSize = Offset + Record.Num();
+
+	FIndexEntry NewEntry;
+	NewEntry.Key          = Key.Hash;
+	NewEntry.Offset       = Offset;
+	NewEntry.Size         = Record.Num();
+	NewEntry.LastAccessed = ++AccessCounter;
+	IndexOverlay.Add(Key, NewEntry);
+	MarkIndexDirty();
+	NumUnflushedStores++;
+
+	UE_LOG(LogThumbnailGenerator, Verbose, TEXT("FThumbnailDiskCache: Stored thumbnail %s (%d -> %d bytes)"), *Key.ToString(), Data.Pixels.Num(), CompressedSize);
+
+	// Compact down to 75% of the cap, so we don't end up rewriting the data file on every store
+	if (MaxSize > 0 && DataFileSize > uint64(MaxSize))
+		Compact(MaxSize / 4 * 3);
+	else
+		FlushIfNeeded();
+
+	return true;
+}
+
+void FThumbnailDiskCache::Flush()
+{
+	if (!bIndexDirty)
+		return;
+
+	if (DataFile.IsValid())
+		DataFile->Flush();
+
+	TArray<FIndexEntry> Entries;
+	GatherEntries(Entries);
+	WriteIndex(Entries);
+}
+
+void FThumbnailDiskCache::FlushIfNeeded()
+{
+	if (!bIndexDirty)
+		return;
+
+	if (NumUnflushedStores >= ThumbnailDiskCache::FlushStoreThreshold || FPlatformTime::Seconds() - FirstUnflushedTime >= ThumbnailDiskCache::FlushInterval)
+		Flush();
+}
+
+void FThumbnailDiskCache::Compact(int64 TargetSize)
+{
+	QUICK_SCOPE_CYCLE_COUNTER(STAT_ThumbnailDiskCache_Compact);
+
+	if (!OpenDataFile())
+		return;
+
+	TArray<FIndexEntry> Entries;
+	GatherEntries(Entries);
+
+	// Most recently used first
+	Entries.Sort([](const FIndexEntry& A, const FIndexEntry& B) { return A.LastAccessed > B.LastAccessed; });
+
+	IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+
+	const FString TempDataFilePath = DataFilePath + TEXT(".tmp");
+	TUniquePtr<IFileHandle> NewDataFile(PlatformFile.OpenWrite(*TempDataFilePath));
+	if (!NewDataFile.IsValid())
+	{
+		UE_LOG(LogThumbnailGenerator, Warning, TEXT("FThumbnailDiskCache::Compact - Failed to open %s"), *TempDataFilePath);
+		return;
+	}
+
+	TArray<FIndexEntry> KeptEntries;
+	TArray<uint8> Record;
+	uint64 NewDataFileSize = 0;
+
+	for (const FIndexEntry& Entry : Entries)
+	{
+		if (NewDataFileSize + Entry.Size > uint64(TargetSize))
+			break;
+
+		if (Entry.Offset + Entry.Size > DataFileSize)
+			continue;
+
+		Record.SetNumUninitialized(Entry.Size, EAllowShrinking::No);
+		if (!DataFile->Seek(Entry.Offset) || !DataFile->Read(Record.GetData(), Entry.Size) || !NewDataFile->Write(Record.GetData(), Entry.Size))
+			continue;
+
+		FIndexEntry& KeptEntry = KeptEntries.Add_GetRef(Entry);
+		KeptEntry.Offset = NewDataFileSize;
+		NewDataFileSize += Entry.Size;
+	}
+
+	NewDataFile.Reset();
+	DataFile.Reset();
+	CloseIndex();
+	IndexOverlay.Reset();
+
+	if (!IFileManager::Get().Move(*DataFilePath, *TempDataFilePath, true))
+	{
+		UE_LOG(LogThumbnailGenerator, Warning, TEXT("FThumbnailDiskCache::Compact - Failed to replace %s, clearing the cache"), *DataFilePath);
+		Reset();
+		return;
+	}
+
+	UE_LOG(LogThumbnailGenerator, Log, TEXT("FThumbnailDiskCache: Compacted cache from %d to %d thumbnails (%llu -> %llu bytes)"), Entries.Num(), KeptEntries.Num(), DataFileSize, NewDataFileSize);
+
+	DataFileSize = NewDataFileSize;
+	WriteIndex(KeptEntries);
+}
+
+void FThumbnailDiskCache::Clear()
+{
+	Reset();
+}
+
+FThumbnailDiskCache* FThumbnailDiskCache::Get()
+{
+	const UThumbnailGeneratorSettings* Settings = UThumbnailGeneratorSettings::Get();
+	if (!Settings->bEnableThumbnailDiskCache)
+		return nullptr;
+
+	if (!ThumbnailDiskCache::SharedDiskCache.IsValid())
+	{
+		ThumbnailDiskCache::SharedDiskCache = MakeUnique<FThumbnailDiskCache>(FPaths::ProjectSavedDir() / TEXT("ThumbnailCache"));
+
+		const int64 MaxSize = int64(Settings->MaxThumbnailDiskCacheSize) * 1000 * 1000;
+		if (ThumbnailDiskCache::SharedDiskCache->GetDataFileSize() > uint64(MaxSize))
+			ThumbnailDiskCache::SharedDiskCache->Compact(MaxSize / 4 * 3);
+	}
+
+	return ThumbnailDiskCache::SharedDiskCache.Get();
+}
+
+void FThumbnailDiskCache::Tick()
+{
+	if (ThumbnailDiskCache::SharedDiskCache.IsValid())
+		ThumbnailDiskCache::SharedDiskCache->FlushIfNeeded();
+}
+
+void FThumbnailDiskCache::Shutdown()
+{
+	ThumbnailDiskCache::SharedDiskCache.Reset();
+}
+
+void FThumbnailDiskCache::OpenIndex()
+{
+	CloseIndex();
+
+	IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+
+	const int64 ActualDataFileSize = PlatformFile.FileSize(*DataFilePath);
+	DataFileSize = ActualDataFileSize > 0 ? ActualDataFileSize : 0;
+
+	if (!PlatformFile.FileExists(*IndexFilePath))
+		return;
+
+	const auto ValidateHeader = [&](const ThumbnailDiskCache::FIndexHeader& Header, int64 IndexFileSize)
+	{
+		return Header.Magic == ThumbnailDiskCache::IndexMagic
+			&& Header.Version == ThumbnailDiskCache::IndexVersion
+			&& FMath::IsPowerOfTwo(Header.NumSlots)
+			&& IndexFileSize == int64(sizeof(ThumbnailDiskCache::FIndexHeader) + uint64(Header.NumSlots) * sizeof(FIndexEntry))
+			&& Header.DataFileSize <= DataFileSize;
+	};
+
+	const auto DiscardCorruptIndex = [&]()
+	{
+		UE_LOG(LogThumbnailGenerator, Warning, TEXT("FThumbnailDiskCache - Index file %s is out of date or corrupt, clearing the cache"), *IndexFilePath);
+		Reset();
+	};
+
+	MappedIndexFile.Reset(PlatformFile.OpenMapped(*IndexFilePath));
+	if (MappedIndexFile.IsValid())
+	{
+		const int64 IndexFileSize = MappedIndexFile->GetFileSize();
+		if (IndexFileSize >= int64(sizeof(ThumbnailDiskCache::FIndexHeader)))
+			MappedIndexRegion.Reset(MappedIndexFile->MapRegion(0, IndexFileSize));
+
+		if (!MappedIndexRegion.IsValid())
+			return DiscardCorruptIndex();
+
+		ThumbnailDiskCache::FIndexHeader Header;
+		FMemory::Memcpy(&Header, MappedIndexRegion->GetMappedPtr(), sizeof(Header));
+
+		if (!ValidateHeader(Header, IndexFileSize))
+			return DiscardCorruptIndex();
+
+		MappedEntries  = (const FIndexEntry*)(MappedIndexRegion->GetMappedPtr() + sizeof(Header));
+		NumMappedSlots = Header.NumSlots;
+		AccessCounter  = Header.AccessCounter;
+	}
+	else // Memory mapping is not supported on all platforms, fall back to reading the index into the overlay
+	{
+		TArray<uint8> IndexData;
+		if (!FFileHelper::LoadFileToArray(IndexData, *IndexFilePath) || IndexData.Num() < int32(sizeof(ThumbnailDiskCache::FIndexHeader)))
+			return DiscardCorruptIndex();
+
+		ThumbnailDiskCache::FIndexHeader Header;
+		FMemory::Memcpy(&Header, IndexData.GetData(), sizeof(Header));
+
+		if (!ValidateHeader(Header, IndexData.Num()))
+			return DiscardCorruptIndex();
+
+		const FIndexEntry* Entries = (const FIndexEntry*)(IndexData.GetData() + sizeof(Header));
+		for (uint32 Slot = 0; Slot < Header.NumSlots; Slot++)
+		{
+			if (Entries[Slot].Size > 0)
+				IndexOverlay.Add(FThumbnailRequestKey{ Entries[Slot].Key }, Entries[Slot]);
+		}
+
+		AccessCounter = Header.AccessCounter;
+	}
+}
+
+void FThumbnailDiskCache::CloseIndex()
+{
+	MappedEntries  = nullptr;
+	NumMappedSlots = 0;
+	MappedIndexRegion.Reset();
+	MappedIndexFile.Reset();
+}
+
+bool FThumbnailDiskCache::OpenDataFile()
+{
+	if (!DataFile.IsValid())
+	{
+		DataFile.Reset(FPlatformFileManager::Get().GetPlatformFile().OpenWrite(*DataFilePath, true, true));
+		if (!DataFile.IsValid())
+			UE_LOG(LogThumbnailGenerator, Warning, TEXT("FThumbnailDiskCache - Failed to open %s"), *DataFilePath);
+	}
+	return DataFile.IsValid();
+}
+
+const FThumbnailDiskCache::FIndexEntry* FThumbnailDiskCache::FindEntry(const FThumbnailRequestKey& Key) const
+{
+	if (const FIndexEntry* OverlayEntry = IndexOverlay.Find(Key))
+		return OverlayEntry;
+
+	if (!MappedEntries)
+		return nullptr;
+
+	// Linear probing, the table is never more than half full
+	const uint32 SlotMask = NumMappedSlots - 1;
+	for (uint32 Probe = 0, Slot = uint32(Key.Hash.HashLow) & SlotMask; Probe < NumMappedSlots; Probe++, Slot = (Slot + 1) & SlotMask)
+	{
+		const FIndexEntry& Entry = MappedEntries[Slot];
+		if (Entry.Size == 0)
+			return nullptr;
+
+		if (Entry.Key == Key.Hash)
+			return &Entry;
+	}
+
+	return nullptr;
+}
+
+void FThumbnailDiskCache::GatherEntries(TArray<FIndexEntry>& OutEntries) const
+{
+	OutEntries.Reserve(IndexOverlay.Num() + NumMappedSlots / 2);
+
+	for (uint32 Slot = 0; Slot < NumMappedSlots; Slot++)
+	{
+		const FIndexEntry& Entry = MappedEntries[Slot];
+		if (Entry.Size > 0 && !IndexOverlay.Contains(FThumbnailRequestKey{ Entry.Key }))
+			OutEntries.Add(Entry);
+	}
+
+	for (const TPair<FThumbnailRequestKey, FIndexEntry>& OverlayEntry : IndexOverlay)
+		OutEntries.Add(OverlayEntry.Value);
+}
+
+bool FThumbnailDiskCache::WriteIndex(const TArray<FIndexEntry>& Entries)
+{
+	QUICK_SCOPE_CYCLE_COUNTER(STAT_ThumbnailDiskCache_WriteIndex);
+
+	const uint32 NumSlots = FMath::RoundUpToPowerOfTwo(FMath::Max<uint32>(ThumbnailDiskCache::MinIndexSlots, Entries.Num() * 2));
+
+	ThumbnailDiskCache::FIndexHeader Header;
+	Header.NumSlots      = NumSlots;
+	Header.NumEntries    = Entries.Num();
+	Header.DataFileSize  = DataFileSize;
+	Header.AccessCounter = AccessCounter;
+
+	TArray<uint8> IndexData;
+	IndexData.SetNumZeroed(sizeof(Header) + NumSlots * sizeof(FIndexEntry));
+	FMemory::Memcpy(IndexData.GetData(), &Header, sizeof(Header));
+
+	FIndexEntry* Slots = (FIndexEntry*)(IndexData.GetData() + sizeof(Header));
+	const uint32 SlotMask = NumSlots - 1;
+	for (const FIndexEntry& Entry : Entries)
+	{
+		uint32 Slot = uint32(Entry.Key.HashLow) & SlotMask;
+		while (Slots[Slot].Size != 0)
+			Slot = (Slot + 1) & SlotMask;
+		Slots[Slot] = Entry;
+	}
+
+	// The mapped index must be released before the file can be replaced
+	CloseIndex();
+	IndexOverlay.Reset();
+	bIndexDirty        = false;
+	NumUnflushedStores = 0;
+
+	const FString TempIndexFilePath = IndexFilePath + TEXT(".tmp");
+	const bool bWritten = FFileHelper::SaveArrayToFile(IndexData, *TempIndexFilePath) && IFileManager::Get().Move(*IndexFilePath, *TempIndexFilePath, true);
+	if (!bWritten)
+	{
+		UE_LOG(LogThumbnailGenerator, Warning, TEXT("FThumbnailDiskCache - Failed to write index file %s"), *IndexFilePath);
+		Reset();
+		return false;
+	}
+
+	OpenIndex();
+	return true;
+}
+
+void FThumbnailDiskCache::Reset()
+{
+	CloseIndex();
+	DataFile.Reset();
+	IndexOverlay.Reset();
+
+	IFileManager::Get().Delete(*IndexFilePath, false, true, true);
+	IFileManager::Get().Delete(*DataFilePath, false, true, true);
+
+	DataFileSize       = 0;
+	AccessCounter      = 0;
+	bIndexDirty        = false;
+	NumUnflushedStores = 0;
+}
+
+void FThumbnailDiskCache::MarkIndexDirty()
+{
+	if (!bIndexDirty)
+		FirstUnflushedTime = FPlatformTime::Seconds();
+
+	bIndexDirty = true;
+}
@@ -0,0 +1,122 @@
+// Copyright Mans Isaksson. All Rights Reserved.
+
+#pragma once
+#include "CoreMinimal.h"
+#include "PixelFormat.h"
+#include "ThumbnailRequestHash.h"
+#include "ThumbnailReadback.h"
+
+class IFileHandle;
+class IMappedFileHandle;
+class IMappedFileRegion;
+
+// Pixel data of a thumbnail stored in the disk cache
+using FThumbnailDiskCacheData = FThumbnailPixelData;
+
+// Persistent thumbnail cache stored in Saved/ThumbnailCache.
+//
+// Thumbnails are stored as compressed records in an append-only data file. The index is an open-addressing hash table
+// which is memory mapped read-only when the cache is opened, so a lookup is a single probe into the mapped table.
+// Entries added or touched during the session are kept in an in-memory overlay and written back as a new index on Flush.
+// When the data file grows past the size cap, the least recently used records are dropped by rewriting the data file.
+//
+// Not thread safe, only use from the game thread.
+class FThumbnailDiskCache
+{
+private:
+	struct FIndexEntry
+	{
+		FXxHash128 Key;
+		uint64     Offset       = 0;
+		uint64     LastAccessed = 0;
+		uint32     Size         = 0; // Size of the record in the data file, 0 marks an empty slot
+		uint32     Padding      = 0;
+	};
+
+	FString CacheDirectory;
+	FString DataFilePath;
+	FString IndexFilePath;
+
+	TUniquePtr<IFileHandle>       DataFile;
+	TUniquePtr<IMappedFileHandle> MappedIndexFile;
+	TUniquePtr<IMappedFileRegion> MappedIndexRegion;
+
+	const FIndexEntry* MappedEntries = nullptr;
+	uint32 NumMappedSlots = 0;
+
+	TMap<FThumbnailRequestKey, FIndexEntry> IndexOverlay; // Entries added or touched since the index was last written
+
+	uint64 DataFileSize  = 0;
+	uint64 AccessCounter = 0;
+	bool   bIndexDirty   = false;
+
+	int32  NumUnflushedStores = 0;   // Thumbnails stored since the index was last written
+	double FirstUnflushedTime = 0.0; // When the index was first dirtied since it was last written
+
+public:
+
+	FThumbnailDiskCache(const FString& InCacheDirectory);
+
+	~FThumbnailDiskCache();
+
+	/**
+	* Computes the disk cache key of a thumbnail request. Unlike the in-memory request key this also includes the saved
+	* state of the actor class' packages and the plugin version, so stale thumbnails are never returned after a change.
+	*
+	* @param OutKey            The resulting key.
+	* @param ActorClass        The actor class the thumbnail is generated for.
+	* @param ThumbnailSettings The (merged) settings used for the capture.
+	* @param Properties        Property overrides applied to the actor.
+	* @param PropertyBag       Optional typed property overrides applied to the actor.
+	* @return                  False if the request can't be cached (e.g. the actor blueprint has unsaved changes).
+	*/
+	static bool ComputeDiskCacheKey(FThumbnailRequestKey& OutKey, const UClass* ActorClass, const FThumbnailSettings& ThumbnailSettings, const TMap<FString, FString>& Properties,
+		const FInstancedPropertyBag* PropertyBag = nullptr);
+
+	/** @return True if a thumbnail was found and decompressed into OutData. */
+	bool Load(const FThumbnailRequestKey& Key, FThumbnailDiskCacheData& OutData);
+
+	/** Compresses and appends a thumbnail to the cache. Compacts the cache if it grows past MaxSize (in bytes). */
+	bool Store(const FThumbnailRequestKey& Key, const FThumbnailDiskCacheData& Data, int64 MaxSize);
+
+	/** Writes the in-memory index overlay to disk. */
+	void Flush();
+
+	/** Flushes once enough thumbnails have been stored, or the index has been dirty for a while, so a crash only loses the most recent entries. */
+	void FlushIfNeeded();
+
+	/** Removes the least recently used records until the data file is smaller than TargetSize (in bytes). */
+	void Compact(int64 TargetSize);
+
+	/** Deletes all cached thumbnails. */
+	void Clear();
+
+	FORCEINLINE uint64 GetDataFileSize() const { return DataFileSize; }
+
+	/** @return The shared disk cache, nullptr if the disk cache is disabled in the project settings. */
+	static FThumbnailDiskCache* Get();
+
+	/** Flushes the shared disk cache if needed, without opening it. Called every frame by the module. */
+	static void Tick();
+
+	/** Flushes and closes the shared disk cache. */
+	static void Shutdown();
+
+private:
+
+	void OpenIndex();
+
+	void CloseIndex();
+
+	bool OpenDataFile();
+
+	const FIndexEntry* FindEntry(const FThumbnailRequestKey& Key) const;
+
+	void GatherEntries(TArray<FIndexEntry>& OutEntries) const;
+
+	bool WriteIndex(const TArray<FIndexEntry>& Entries);
+
+	void MarkIndexDirty();
+
+	void Reset();
+};
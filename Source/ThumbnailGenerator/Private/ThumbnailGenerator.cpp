@@ -7,7 +7,20 @@
 #include "ThumbnailScene/ThumbnailPreviewScene.h"
 #include "ThumbnailScene/ThumbnailBackgroundScene.h"
 #include "CacheProvider.h"
-
+#include "ThumbnailRequestHash.h"
+#include "ThumbnailDiskCache.h"
+#include "ThumbnailGeneratorTaskQueue.h"
+#include "ThumbnailCapturePipeline.h"
+#include "ThumbnailCaptureBackend.h"
+#include "ThumbnailScratchBuffers.h"
+#include "ThumbnailPropertyOverrides.h"
+#include "ThumbnailBoundsCache.h"
+#include "ThumbnailActorBounds.h"
+#include "ThumbnailAlphaKernels.h"
+#include "ThumbnailGeneratorStats.h"
+#include "ThumbnailPrecomputedBounds.h"
+
+#include "Algo/StableSort.h"
 #include "Components/SceneCaptureComponent2D.h"
 #include "Components/PostProcessComponent.h"
 #include "Components/SkeletalMeshComponent.h"
@@ -28,9 +41,11 @@
 #include "Engine/World.h"
 #include "EngineUtils.h"
 #include "UObject/StrongObjectPtr.h"
+#include "UObject/ObjectKey.h"
 #include "Slate/WidgetRenderer.h"
 #include "Blueprint/UserWidget.h"
 #include "GameDelegates.h"
+#include "Misc/CoreDelegates.h"
 #include "DrawDebugHelpers.h"
 #include "Kismet/GameplayStatics.h"
 #include "Styling/AppStyle.h"
@@ -60,80 +75,6 @@ namespace ThumbnailGenerator
 		}
 	}
 
-	template<typename T>
-	static FORCEINLINE T MixAlpha(const T& A1, const T& A2, EThumbnailAlphaBlendMode BlendMode)
-	{
-		switch (BlendMode)
-		{
-		case EThumbnailAlphaBlendMode::EReplace:
-			return A2;
-		case EThumbnailAlphaBlendMode::EAdd:
-			return A1 + A2;
-		case EThumbnailAlphaBlendMode::EMultiply:
-			return A1 * A2;
-		case EThumbnailAlphaBlendMode::ESubtract:
-			return A1 - A2;
-		}
-		return A2;
-	}
-
-	static FORCEINLINE bool IsValidPixelFormat(EPixelFormat PixelFormat) // Right now, we only support B8G8R8A8 and FloatRGBA
-	{
-		switch (PixelFormat)
-		{
-		case PF_B8G8R8A8: return true;
-		case PF_FloatRGBA: return true;
-		}
-		return false;
-	}
-
-	static TArray<uint8> ExtractAlpha(UTextureRenderTarget2D* TextureTarget, bool bInverseAlpha)
-	{
-		QUICK_SCOPE_CYCLE_COUNTER(STAT_ExtractAlpha);
-
-		TArray<uint8> OutAlpha;
-
-		FRenderTarget* const TextureRenderTarget = TextureTarget->GameThread_GetRenderTargetResource();
-		if (!TextureRenderTarget)
-		{
-			UE_LOG(LogThumbnailGenerator, Error, TEXT("ThumbnailGenerator::ExtractAlpha - Invalid TextureTarget"));
-			return OutAlpha;
-		}
-
-		const EPixelFormat PixelFormat = TextureTarget->GetFormat();
-		if (!IsValidPixelFormat(PixelFormat))
-		{
-			UE_LOG(LogThumbnailGenerator, Error, TEXT("ThumbnailGenerator::ExtractAlpha - Invalid Pixel Format"));
-			return OutAlpha;
-		}
-
-		if (PixelFormat == PF_B8G8R8A8)
-		{
-			TArray<FColor> SurfData;
-			TextureRenderTarget->ReadPixels(SurfData);
-
-			OutAlpha.Reserve(SurfData.Num());
-
-			for (const FColor &Data : SurfData)
-				OutAlpha.Add(bInverseAlpha ? 255 - Data.A : Data.A);
-		}
-		else if (PixelFormat == PF_FloatRGBA)
-		{
-			TArray<FFloat16Color> SurfData;
-			TextureRenderTarget->ReadFloat16Pixels(SurfData);
-				
-			OutAlpha.SetNumUninitialized(SurfData.Num() * 2);
-
-			for (int32 i = 0; i < SurfData.Num(); i++)
-			{
-				const FFloat16 Alpha = bInverseAlpha ? FFloat16(1.f - (float)SurfData[i].A) : SurfData[i].A;
-				FMemory::Memcpy(&OutAlpha[i * sizeof(FFloat16)], &Alpha, sizeof(FFloat16));
-			}
-		}
-
-		return OutAlpha;
-	}
-
 	static UTexture2D* ConstructTransientTexture2D(UObject* Outer, const FString& NewTexName, uint32 SizeX, uint32 SizeY, EPixelFormat PixelFormat)
 	{
 		QUICK_SCOPE_CYCLE_COUNTER(STAT_ConstructTransientTexture2D);
@@ -159,29 +100,13 @@ namespace ThumbnailGenerator
 		return Result;
 	}
 
-	static void FillTextureDataFromRenderTarget(UTexture2D* Texture2D, UTextureRenderTarget2D* TextureTarget, const TArray<uint8>& AlphaOverride, EThumbnailAlphaBlendMode AlphaBlendMode)
+	static FTexturePlatformData* ResizeTextureData(UTexture2D* Texture2D, int32 SizeX, int32 SizeY, EPixelFormat PixelFormat)
 	{
-		QUICK_SCOPE_CYCLE_COUNTER(STAT_FillTextureDataFromRenderTarget);
-
-		FRenderTarget* const TextureRenderTarget = TextureTarget->GameThread_GetRenderTargetResource();
-		if (!TextureRenderTarget)
-		{
-			UE_LOG(LogThumbnailGenerator, Error, TEXT("ThumbnailGenerator::FillTextureData - Invalid TextureTarget"));
-			return;
-		}
-
-		const EPixelFormat PixelFormat = TextureTarget->GetFormat();
-		if (!IsValidPixelFormat(PixelFormat))
-		{
-			UE_LOG(LogThumbnailGenerator, Error, TEXT("ThumbnailGenerator::FillTextureData - Invalid Pixel Format"));
-			return;
-		}
-
 		auto PlatformData = Texture2D->GetPlatformData();
 
-		if (Texture2D->GetSizeX() != TextureTarget->SizeX || Texture2D->GetSizeY() != TextureTarget->SizeY || Texture2D->GetPixelFormat() != PixelFormat)
+		if (Texture2D->GetSizeX() != SizeX || Texture2D->GetSizeY() != SizeY || Texture2D->GetPixelFormat() != PixelFormat)
 		{
-			UE_LOG(LogThumbnailGenerator, Log, TEXT("Resize Texture2D %s to fit dimentions %dx%d"), *Texture2D->GetName(), TextureTarget->SizeX, TextureTarget->SizeY);
+			UE_LOG(LogThumbnailGenerator, Log, TEXT("Resize Texture2D %s to fit dimentions %dx%d"), *Texture2D->GetName(), SizeX, SizeY);
 
 			Texture2D->ReleaseResource();
 
@@ -198,77 +123,131 @@ namespace ThumbnailGenerator
 
 			FTexture2DMipMap& Mip = PlatformData->Mips[0];
 
-			PlatformData->SizeX = TextureTarget->SizeX;
-			PlatformData->SizeY = TextureTarget->SizeY;
-			PlatformData->PixelFormat = TextureTarget->GetFormat();
+			PlatformData->SizeX = SizeX;
+			PlatformData->SizeY = SizeY;
+			PlatformData->PixelFormat = PixelFormat;
 
 			const auto BlockSize = PixelFormat == PF_B8G8R8A8 ? sizeof(FColor) : sizeof(FFloat16Color);
-			Mip.SizeX = TextureTarget->SizeX;
-			Mip.SizeY = TextureTarget->SizeY;
+			Mip.SizeX = SizeX;
+			Mip.SizeY = SizeY;
 			Mip.BulkData.Lock(LOCK_READ_WRITE);
-			Mip.BulkData.Realloc(TextureTarget->SizeX * TextureTarget->SizeY * BlockSize);
+			Mip.BulkData.Realloc(SizeX * SizeY * BlockSize);
 			Mip.BulkData.Unlock();
 		}
 
-		FTexture2DMipMap& mip = PlatformData->Mips[0];
-		uint32* const TextureData = (uint32*)mip.BulkData.Lock(LOCK_READ_WRITE);
-		const int32 TextureDataSize = mip.BulkData.GetBulkDataSize();
+		return PlatformData;
+	}
 
-		if (PixelFormat == PF_B8G8R8A8)
+	// Locks the first mip of a thumbnail texture, resized to fit the capture, so the capture backend can write straight into it.
+	// Must be followed by UnlockTextureData.
+	static void* LockTextureData(UTexture2D* Texture2D, int32 SizeX, int32 SizeY, EPixelFormat PixelFormat)
+	{
+		if (!IsValidPixelFormat(PixelFormat))
 		{
-			TArray<FColor> SurfData;
-			TextureRenderTarget->ReadPixels(SurfData);
+			UE_LOG(LogThumbnailGenerator, Error, TEXT("ThumbnailGenerator::LockTextureData - Invalid Pixel Format"));
+			return nullptr;
+		}
 
-			if (AlphaOverride.Num() > 0)
-			{
-				check(SurfData.Num() == AlphaOverride.Num());
+		auto PlatformData = ResizeTextureData(Texture2D, SizeX, SizeY, PixelFormat);
 
-				for (int32 Pixel = 0; Pixel < SurfData.Num(); Pixel++)
-					SurfData[Pixel].A = ThumbnailGenerator::MixAlpha(SurfData[Pixel].A, AlphaOverride[Pixel], AlphaBlendMode);
-			}
-			else // On some platforms the default alpha is 0, not 255. Make sure to fix that here
-			{
-				for (int32 Pixel = 0; Pixel < SurfData.Num(); Pixel++)
-					SurfData[Pixel].A = 255;
-			}
+		FTexture2DMipMap& Mip = PlatformData->Mips[0];
+		void* const TextureData = Mip.BulkData.Lock(LOCK_READ_WRITE);
 
-			check(TextureDataSize == SurfData.Num() * sizeof(FColor));
-			FMemory::Memcpy(TextureData, SurfData.GetData(), TextureDataSize);
-		}
-		else if (PixelFormat == PF_FloatRGBA)
+		const int64 ExpectedSize = int64(SizeX) * SizeY * (PixelFormat == PF_B8G8R8A8 ? sizeof(FColor) : sizeof(FFloat16Color));
+		check(Mip.BulkData.GetBulkDataSize() == ExpectedSize);
+
+		return TextureData;
+	}
+
+	static void UnlockTextureData(UTexture2D* Texture2D)
+	{
+		Texture2D->GetPlatformData()->Mips[0].BulkData.Unlock();
+	}
+
+	// Pipelined counterpart of the alpha handling in IThumbnailCaptureBackend::CapturePixels, Alpha is the read back alpha pass (nullptr if there is none)
+	static void ApplyCapturedAlpha(FThumbnailPixelData& Color, const FThumbnailPixelData* Alpha, EThumbnailAlphaBlendMode AlphaBlendMode)
+	{
+		THUMBNAIL_STAGE_SCOPE(AlphaMerge);
+
+		const int32 NumPixels = Color.SizeX * Color.SizeY;
+		const bool bHasAlpha = Alpha && Alpha->SizeX == Color.SizeX && Alpha->SizeY == Color.SizeY && Alpha->PixelFormat == Color.PixelFormat;
+
+		if (Color.PixelFormat == PF_B8G8R8A8)
 		{
-			TArray<FFloat16Color> SurfData;
-			TextureRenderTarget->ReadFloat16Pixels(SurfData);
+			check(Color.Pixels.Num() == NumPixels * sizeof(FColor));
+			FColor* const ColorPixels = (FColor*)Color.Pixels.GetData();
 
-			if (AlphaOverride.Num() > 0)
-			{
-				check(SurfData.Num() * sizeof(FFloat16) == AlphaOverride.Num());
+			if (bHasAlpha)
+				AlphaKernels::MergeInverseAlpha(ColorPixels, (const FColor*)Alpha->Pixels.GetData(), NumPixels, AlphaBlendMode);
+			else // On some platforms the default alpha is 0, not 255. Make sure to fix that here
+				AlphaKernels::SetOpaqueAlpha(ColorPixels, NumPixels);
+		}
+		else if (Color.PixelFormat == PF_FloatRGBA)
+		{
+			check(Color.Pixels.Num() == NumPixels * sizeof(FFloat16Color));
+			FFloat16Color* const ColorPixels = (FFloat16Color*)Color.Pixels.GetData();
 
-				for (int32 Pixel = 0; Pixel < SurfData.Num(); Pixel++)
-				{
-					FFloat16 NewAlpha;
-					FMemory::Memcpy(&NewAlpha, &AlphaOverride[Pixel * sizeof(FFloat16)], sizeof(FFloat16));
-					SurfData[Pixel].A = ThumbnailGenerator::MixAlpha(SurfData[Pixel].A, NewAlpha, AlphaBlendMode);
-				}
-			}
+			if (bHasAlpha)
+				AlphaKernels::MergeInverseAlpha(ColorPixels, (const FFloat16Color*)Alpha->Pixels.GetData(), NumPixels, AlphaBlendMode);
 			else // On some platforms the default alpha is 0, not 1. Make sure to fix that here
-			{
-				const FFloat16 OpaqueAlpha = FFloat16(1.f);
-				for (int32 Pixel = 0; Pixel < SurfData.Num(); Pixel++)
-				{
-					SurfData[Pixel].A = OpaqueAlpha;
-				}
-			}
+				AlphaKernels::SetOpaqueAlpha(ColorPixels, NumPixels);
+		}
+	}
+
+	// Copies the pixels of a thumbnail texture, used to store generated thumbnails in the disk cache.
+	// OutData.Pixels is acquired from ScratchBuffers and should be released once stored.
+	static bool ReadTextureData(UTexture2D* Texture2D, FThumbnailScratchBuffers& ScratchBuffers, FThumbnailPixelData& OutData)
+	{
+		QUICK_SCOPE_CYCLE_COUNTER(STAT_ReadTextureData);
+
+		const FTexturePlatformData* PlatformData = Texture2D->GetPlatformData();
+		if (!PlatformData || PlatformData->Mips.Num() == 0 || !IsValidPixelFormat(PlatformData->PixelFormat))
+			return false;
 
-			check(TextureDataSize == SurfData.Num() * sizeof(FFloat16Color));
-			FMemory::Memcpy(TextureData, SurfData.GetData(), TextureDataSize);
+		const FTexture2DMipMap& Mip = PlatformData->Mips[0];
+		const int64 DataSize = Mip.BulkData.GetBulkDataSize();
+		const void* TextureData = Mip.BulkData.LockReadOnly();
+		if (!TextureData || DataSize <= 0)
+		{
+			Mip.BulkData.Unlock();
+			return false;
 		}
 
-		mip.BulkData.Unlock();
+		OutData.SizeX       = PlatformData->SizeX;
+		OutData.SizeY       = PlatformData->SizeY;
+		OutData.PixelFormat = PlatformData->PixelFormat;
+		OutData.Pixels      = ScratchBuffers.Acquire(DataSize);
+		FMemory::Memcpy(OutData.Pixels.GetData(), TextureData, DataSize);
+
+		Mip.BulkData.Unlock();
+		return true;
+	}
+
+	// Fills a thumbnail texture with pixels loaded from the disk cache or read back by the capture pipeline
+	static bool FillTextureDataFromPixels(UTexture2D* Texture2D, const FThumbnailPixelData& Data)
+	{
+		THUMBNAIL_STAGE_SCOPE(TextureUpload);
+
+		if (!IsValidPixelFormat(Data.PixelFormat))
+			return false;
+
+		const int64 ExpectedSize = int64(Data.SizeX) * Data.SizeY * (Data.PixelFormat == PF_B8G8R8A8 ? sizeof(FColor) : sizeof(FFloat16Color));
+		if (ExpectedSize != Data.Pixels.Num())
+			return false;
+
+		auto PlatformData = ResizeTextureData(Texture2D, Data.SizeX, Data.SizeY, Data.PixelFormat);
+
+		FTexture2DMipMap& Mip = PlatformData->Mips[0];
+		void* const TextureData = Mip.BulkData.Lock(LOCK_READ_WRITE);
+		FMemory::Memcpy(TextureData, Data.Pixels.GetData(), Data.Pixels.Num());
+		Mip.BulkData.Unlock();
 
-		Texture2D->SRGB = PixelFormat == PF_B8G8R8A8;
+		Texture2D->SRGB = true;
+		Texture2D->CompressionSettings = TextureCompressionSettings::TC_EditorIcon;
+		Texture2D->LODGroup = TextureGroup::TEXTUREGROUP_UI;
 
 		Texture2D->UpdateResource();
+		return true;
 	}
 
 	static UTextureRenderTarget2D* CreateTextureTarget(UObject* Outer, int32 Width, int32 Height, ETextureRenderTargetFormat Format, const FLinearColor &ClearColor)
@@ -288,34 +267,209 @@ namespace ThumbnailGenerator
 		return nullptr;
 	}
 
-	struct FThumbnailGeneratorTaskQueue : public FTickableGameObject
+	static ETextureRenderTargetFormat GetRenderTargetFormat(const FThumbnailSettings& ThumbnailSettings)
+	{
+		return ThumbnailSettings.ThumbnailBitDepth == EThumbnailBitDepth::E8 ? ETextureRenderTargetFormat::RTF_RGBA8_SRGB : ETextureRenderTargetFormat::RTF_RGBA16f;
+	}
+
+	static UTextureRenderTarget2D* CreateThumbnailRenderTarget(const FThumbnailSettings& ThumbnailSettings)
+	{
+		return CreateTextureTarget(
+			GetTransientPackage(),
+			ThumbnailSettings.ThumbnailTextureWidth,
+			ThumbnailSettings.ThumbnailTextureHeight,
+			GetRenderTargetFormat(ThumbnailSettings),
+			FLinearColor(0.f, 0.f, 0.f, 1.f) // Important: When rendering with MSAA the alpha will no be touched, setting it as 0 would leave the whole image fully transparent
+		);
+	}
+
+	// Instanced subobjects can't be restored by copying the class defaults, the copy would point at the subobjects of the CDO
+	static bool IsInstancedReferenceProperty(const FProperty* Property)
+	{
+		return Property->HasAnyPropertyFlags(CPF_InstancedReference | CPF_ContainsInstancedReference);
+	}
+
+	static bool HasInstancedExposeOnSpawnProperties(const UClass* ActorClass)
+	{
+		for (TFieldIterator<FProperty> It(ActorClass); It; ++It)
+		{
+			if (It->HasAnyPropertyFlags(CPF_ExposeOnSpawn) && IsInstancedReferenceProperty(*It))
+				return true;
+		}
+
+		return false;
+	}
+
+	static bool ShouldPoolActorClass(const UClass* ActorClass)
+	{
+		const UThumbnailGeneratorSettings* Settings = UThumbnailGeneratorSettings::Get();
+		if (Settings->MaxPooledThumbnailActors <= 0)
+			return false;
+
+		for (const TSoftClassPtr<AActor>& PooledActorClass : Settings->PooledActorClasses)
+		{
+			// Super classes of a loaded class are always loaded, no need to resolve the soft pointer
+			const UClass* PooledActorClassPtr = PooledActorClass.Get();
+			if (PooledActorClassPtr && ActorClass->IsChildOf(PooledActorClassPtr))
+				return !HasInstancedExposeOnSpawnProperties(ActorClass);
+		}
+
+		return false;
+	}
+
+	// True if a value references Owner or one of its subobjects. Such a value can't be restored by copying the archetype's value,
+	// which would reference the subobjects of the archetype instead.
+	static bool ReferencesInnerObject(const FProperty* Property, const void* Value, const UObject* Owner)
 	{
-		TArray<TFunction<void()>> TaskQueue;
+		const auto IsInner = [Owner](const UObject* Object) { return Object && (Object == Owner || Object->IsIn(Owner)); };
+
+		if (const FObjectPropertyBase* ObjectProperty = CastField<const FObjectPropertyBase>(Property))
+			return IsInner(ObjectProperty->GetObjectPropertyValue(Value));
+
+		if (const FInterfaceProperty* InterfaceProperty = CastField<const FInterfaceProperty>(Property))
+			return IsInner(InterfaceProperty->GetPropertyValue(Value).GetObject());
+
+		if (const FStructProperty* StructProperty = CastField<const FStructProperty>(Property))
+		{
+			for (TFieldIterator<FProperty> It(StructProperty->Struct); It; ++It)
+			{
+				for (int32 ArrayIndex = 0; ArrayIndex < It->GetArrayDim(); ArrayIndex++)
+				{
+					if (ReferencesInnerObject(*It, It->ContainerPtrToValuePtr<void>(Value, ArrayIndex), Owner))
+						return true;
+				}
+			}
+			return false;
+		}
+
+		if (const FArrayProperty* ArrayProperty = CastField<const FArrayProperty>(Property))
+		{
+			FScriptArrayHelper ArrayHelper(ArrayProperty, Value);
+			for (int32 i = 0; i < ArrayHelper.Num(); i++)
+			{
+				if (ReferencesInnerObject(ArrayProperty->Inner, ArrayHelper.GetRawPtr(i), Owner))
+					return true;
+			}
+			return false;
+		}
+
+		if (const FSetProperty* SetProperty = CastField<const FSetProperty>(Property))
+		{
+			FScriptSetHelper SetHelper(SetProperty, Value);
+			for (FScriptSetHelper::FIterator It(SetHelper); It; ++It)
+			{
+				if (ReferencesInnerObject(SetProperty->ElementProp, SetHelper.GetElementPtr(It), Owner))
+					return true;
+			}
+			return false;
+		}
 
-		virtual void Tick(float DeltaTime) override
+		if (const FMapProperty* MapProperty = CastField<const FMapProperty>(Property))
 		{
-			if (TaskQueue.Num() > 0)
+			FScriptMapHelper MapHelper(MapProperty, Value);
+			for (FScriptMapHelper::FIterator It(MapHelper); It; ++It)
 			{
-				const auto Element = TaskQueue.Pop();
-				Element();
+				if (ReferencesInnerObject(MapProperty->KeyProp, MapHelper.GetKeyPtr(It), Owner) || ReferencesInnerObject(MapProperty->ValueProp, MapHelper.GetValuePtr(It), Owner))
+					return true;
 			}
+			return false;
 		}
 
-		virtual bool IsTickableInEditor() const override { return true; }
+		return false;
+	}
+
+	// The actor an actor or component belongs to, or for the component templates of a blueprint, the blueprint class
+	static const UObject* GetArchetypeOwner(const UObject* Object)
+	{
+		if (Object->IsA<AActor>())
+			return Object;
+
+		const AActor* OwnerActor = Object->GetTypedOuter<AActor>();
+		return OwnerActor ? static_cast<const UObject*>(OwnerActor) : Object->GetOuter();
+	}
 
-		virtual TStatId GetStatId() const override { RETURN_QUICK_DECLARE_CYCLE_STAT(FThumbnailGeneratorTaskQueue, STATGROUP_Tickables); }
+	// The properties of Object which no longer match its archetype and can be restored by copying the archetype's value
+	static void FindChangedProperties(const UObject* Object, const UObject* Archetype, TArray<const FProperty*>& OutProperties)
+	{
+		const UObject* const Owner          = GetArchetypeOwner(Object);
+		const UObject* const ArchetypeOwner = GetArchetypeOwner(Archetype);
 
-		static FThumbnailGeneratorTaskQueue& Get()
+		for (TFieldIterator<FProperty> It(Object->GetClass()); It; ++It)
 		{
-			static TUniquePtr<FThumbnailGeneratorTaskQueue> ThumbnailGeneratorTaskQueue = nullptr;
-			if (!ThumbnailGeneratorTaskQueue.IsValid())
+			const FProperty* const Property = *It;
+
+			// Transient properties are runtime state which the engine maintains (e.g. render and physics state). Instanced subobjects, such as the
+			// components, are restored on their own. Bound delegates are left alone, blueprint events are bound once when the actor is spawned.
+			if (Property->HasAnyPropertyFlags(CPF_Transient | CPF_DuplicateTransient | CPF_InstancedReference | CPF_ContainsInstancedReference) 
+				|| Property->IsA<FDelegateProperty>() || Property->IsA<FMulticastDelegateProperty>())
+				continue;
+
+			bool bIsIdentical = true;
+			bool bReferencesInnerObject = false;
+			for (int32 ArrayIndex = 0; ArrayIndex < Property->GetArrayDim(); ArrayIndex++)
 			{
-				ThumbnailGeneratorTaskQueue = MakeUnique<FThumbnailGeneratorTaskQueue>();
+				if (Property->Identical_InContainer(Object, Archetype, ArrayIndex))
+					continue;
+
+				bIsIdentical = false;
+				bReferencesInnerObject |= ReferencesInnerObject(Property, Property->ContainerPtrToValuePtr<void>(Object, ArrayIndex), Owner) 
+					|| ReferencesInnerObject(Property, Property->ContainerPtrToValuePtr<void>(Archetype, ArrayIndex), ArchetypeOwner);
 			}
 
-			return *ThumbnailGeneratorTaskQueue;
+			if (!bIsIdentical && !bReferencesInnerObject)
+				OutProperties.Add(Property);
 		}
-	};
+	}
+
+	/**
+	* Restores the actor and its components to the state they were spawned in, before the actor is returned to the pool. Every non-transient property which
+	* differs from its archetype (the class defaults, or the component template) is copied back, whether it was changed by a property override, a PreCapture callback,
+	* a thumbnail generator script or the actor itself. Components with changed properties are re-registered, the others keep their render state.
+	*
+	* @return False if the actor has components which aren't part of its class (e.g. added during the capture), such actors can't be reused.
+	*/
+	static bool RestoreArchetypeState(AActor* Actor)
+	{
+		TInlineComponentArray<UActorComponent*> Components(Actor);
+		for (const UActorComponent* Component : Components)
+		{
+			// Components created at runtime have the class defaults as their archetype, instead of a default subobject or a blueprint template
+			if (IsValid(Component) && Component->GetArchetype() == Component->GetClass()->GetDefaultObject())
+				return false;
+		}
+
+		TArray<const FProperty*> ChangedProperties;
+
+		FindChangedProperties(Actor, Actor->GetArchetype(), ChangedProperties);
+		for (const FProperty* Property : ChangedProperties)
+			Property->CopyCompleteValue_InContainer(Actor, Actor->GetArchetype());
+
+		for (UActorComponent* Component : Components)
+		{
+			if (!IsValid(Component))
+				continue;
+
+			const UObject* const Archetype = Component->GetArchetype();
+
+			ChangedProperties.Reset();
+			FindChangedProperties(Component, Archetype, ChangedProperties);
+			if (ChangedProperties.Num() == 0)
+				continue;
+
+			// The render and physics state are created from the properties, they are recreated once the properties have been restored
+			const bool bWasRegistered = Component->IsRegistered();
+			if (bWasRegistered)
+				Component->UnregisterComponent();
+
+			for (const FProperty* Property : ChangedProperties)
+				Property->CopyCompleteValue_InContainer(Component, Archetype);
+
+			if (bWasRegistered)
+				Component->RegisterComponent();
+		}
+
+		return true;
+	}
 };
 
 struct FHashableRenderTargetInfo
@@ -326,10 +480,10 @@ struct FHashableRenderTargetInfo
 	friend inline uint32 GetTypeHash(const FHashableRenderTargetInfo& O) 
 	{
 		return (uint32(O.Width) << 16) // first 16 bits
-			| (uint32(O.Height) & 0xfffffffe) // 17-31
-			| (O.BitDepth == EThumbnailBitDepth::E8 ? 0 : 1); // 32:nd bit
+			^ (uint32(O.Height) << 1)  // 17-31 (Height is clamped to 32767)
+			^ (O.BitDepth == EThumbnailBitDepth::E8 ? 0 : 1); // 32:nd bit
 	}
-	friend inline bool operator==(const FHashableRenderTargetInfo& A, const FHashableRenderTargetInfo& B) { return GetTypeHash(A) == GetTypeHash(B); }
+	friend inline bool operator==(const FHashableRenderTargetInfo& A, const FHashableRenderTargetInfo& B) { return A.Width == B.Width && A.Height == B.Height && A.BitDepth == B.BitDepth; }
 };
 
 struct FRenderTargetCache : public TCacheProvider<FHashableRenderTargetInfo, UTextureRenderTarget2D>
@@ -351,149 +505,993 @@ struct FRenderTargetCache : public TCacheProvider<FHashableRenderTargetInfo, UTe
 	virtual FString DebugCacheName() const override { return TEXT("Render Target Cache"); }
 
 	virtual void OnItemRemovedFromCache(UTextureRenderTarget2D* InRenderTarget) { InRenderTarget->MarkAsGarbage(); }
+
+	virtual void OnMemoryFootprintChanged() override { SET_MEMORY_STAT(STAT_ThumbnailGenerator_RenderTargetMemory, GetTotalMemoryFootprint()); }
 };
 
-FThumbnailGenerator::FThumbnailGenerator(bool bInvalidateOnPIEEnd)
-	: FThumbnailGenerator()
+struct FThumbnailResultCache : public TCacheProvider<FThumbnailRequestKey, UTexture2D>
 {
-#if WITH_EDITOR
-	if (bInvalidateOnPIEEnd)
+	struct FCachedThumbnail
 	{
-		EndPIEDelegateHandle = FEditorDelegates::EndPIE.AddLambda([this](bool)
-		{
-			InvalidateThumbnailWorld();
-		});
-	}
-#endif
-}
+		FName      ClassPath;
+		FObjectKey Thumbnail;
+	};
 
-FThumbnailGenerator::~FThumbnailGenerator()
-{
-#if WITH_EDITOR
-	if (EndPIEDelegateHandle.IsValid())
-	{
-		FEditorDelegates::EndPIE.Remove(EndPIEDelegateHandle);
-	}
-#endif
+	TMap<FThumbnailRequestKey, FCachedThumbnail> CachedThumbnails; // Used to find the owning class and thumbnail when a key is evicted
+	TMap<FName, TSet<FThumbnailRequestKey>>      ClassToKeys;      // Used for per class invalidation
+	TMap<FObjectKey, FThumbnailRequestKey>       ThumbnailToKey;   // Used to drop thumbnails which are released for reuse
 
-	if (RenderTargetCache.IsValid())
-		RenderTargetCache->ClearCache();
+	int64 Hits   = 0;
+	int64 Misses = 0;
 
-	for (UThumbnailGeneratorScript* ThumbnailGeneratorScript : ThumbnailGeneratorScripts)
+	virtual int32 MaxCacheSize() override { return UThumbnailGeneratorSettings::Get()->MaxThumbnailResultCacheSize * 1000 * 1000; }
+	virtual int32 GetItemDataFootprint(UTexture2D* InTexture) override { return InTexture->CalcTextureMemorySizeEnum(TMC_AllMips); }
+	virtual FString DebugCacheName() const override { return TEXT("Thumbnail Result Cache"); }
+
+	// Cached thumbnails are handed out to users, so they are never destroyed when evicted. The cache simply stops referencing them.
+	virtual void OnKeyRemovedFromCache(const FThumbnailRequestKey& Key) override
 	{
-		if (IsValid(ThumbnailGeneratorScript))
+		FCachedThumbnail CachedThumbnail;
+		if (!CachedThumbnails.RemoveAndCopyValue(Key, CachedThumbnail))
+			return;
+
+		if (TSet<FThumbnailRequestKey>* ClassKeys = ClassToKeys.Find(CachedThumbnail.ClassPath))
 		{
-			ThumbnailGeneratorScript->MarkAsGarbage();
+			ClassKeys->Remove(Key);
+			if (ClassKeys->Num() == 0)
+				ClassToKeys.Remove(CachedThumbnail.ClassPath);
 		}
+
+		const FThumbnailRequestKey* ThumbnailKey = ThumbnailToKey.Find(CachedThumbnail.Thumbnail);
+		if (ThumbnailKey && *ThumbnailKey == Key)
+			ThumbnailToKey.Remove(CachedThumbnail.Thumbnail);
 	}
-}
 
-UTexture2D* FThumbnailGenerator::GenerateActorThumbnail(TSubclassOf<AActor> ActorClass, const FThumbnailSettings& ThumbnailSettings, UTexture2D* ResourceObject, const TMap<FString, FString>& Properties)
-{
-	return FinishGenerateActorThumbnail(BeginGenerateActorThumbnail(ActorClass, ThumbnailSettings, Properties), ThumbnailSettings, ResourceObject);
-}
+	virtual void OnMemoryFootprintChanged() override { SET_MEMORY_STAT(STAT_ThumbnailGenerator_ResultCacheMemory, GetTotalMemoryFootprint()); }
 
-AActor* FThumbnailGenerator::BeginGenerateActorThumbnail(TSubclassOf<AActor> ActorClass, const FThumbnailSettings& ThumbnailSettings, const TMap<FString, FString>& Properties, bool bFinishSpawningActor)
-{
-	const auto EjectWithError = [&](const FString &Error)->AActor*
+	void AddThumbnail(const FThumbnailRequestKey& Key, const UClass* ActorClass, UTexture2D* Thumbnail)
 	{
-		const static FString FuncName = TEXT("FThumbnailGenerator::BeginGenerateActorThumbnail");
-		UE_LOG(LogThumbnailGenerator, Error, TEXT("%s - %s"), *FuncName , *Error);
+		CacheItem(Key, Thumbnail);
 
-		CleanupThumbnailCapture();
+		// CacheItem is a no-op when the cache is disabled or the thumbnail is invalid
+		if (!IsItemCached(Key))
+			return;
 
-		return nullptr;
-	};
+		const FName ClassPath = *ActorClass->GetPathName();
+		CachedThumbnails.Add(Key, FCachedThumbnail{ ClassPath, FObjectKey(Thumbnail) });
+		ClassToKeys.FindOrAdd(ClassPath).Add(Key);
+		ThumbnailToKey.Add(FObjectKey(Thumbnail), Key);
+	}
 
-	if (bIsCapturingThumbnail)
+	void InvalidateThumbnail(const UTexture2D* Thumbnail)
 	{
-		return EjectWithError("Called without first calling FinishGenerateActorThumbnail");
+		if (const FThumbnailRequestKey* Key = ThumbnailToKey.Find(FObjectKey(Thumbnail)))
+			RemoveCachedItem(FThumbnailRequestKey(*Key));
 	}
 
-	UClass* const ClassPtr = ActorClass.Get();
-
-	if (!IsValid(ClassPtr))
-		return EjectWithError("Invalid Actor Class");
+	void InvalidateClass(const UClass* ActorClass)
+	{
+		TSet<FThumbnailRequestKey> ClassKeys;
+		if (!ClassToKeys.RemoveAndCopyValue(*ActorClass->GetPathName(), ClassKeys))
+			return;
 
-	if (ThumbnailSettings.ThumbnailTextureWidth <= 0 || ThumbnailSettings.ThumbnailTextureHeight <= 0)
-		return EjectWithError(FString::Printf(TEXT("Invalid Texture Size (%dx%d)"), ThumbnailSettings.ThumbnailTextureWidth, ThumbnailSettings.ThumbnailTextureHeight));
+		for (const FThumbnailRequestKey& Key : ClassKeys)
+			RemoveCachedItem(Key);
 
-	if (!ThumbnailScene.IsValid())
-		InitializeThumbnailWorld(UThumbnailGeneratorSettings::Get()->BackgroundSceneSettings);
+		UE_LOG(LogThumbnailGenerator, Verbose, TEXT("%s: Invalidated %d thumbnails of class %s"), *DebugCacheName(), ClassKeys.Num(), *ActorClass->GetName());
+	}
+};
 
-	UWorld* const ThumbnailWorld = ThumbnailScene->GetThumbnailWorld();
-	if (!IsValid(ThumbnailWorld))
-		return EjectWithError("Invalid Preview World");
+namespace ThumbnailGenerator
+{
+	// Used by the overloads which only take text property overrides
+	static const FInstancedPropertyBag EmptyPropertyBag;
 
-	// Update scripts
+	// Splits SimulateSceneTime into fixed steps of 1 / SimulateSceneFramerate (the last one shorter if needed) and calls StepCallback(StepIndex, DeltaTime) for each.
+	// Returns false if StepCallback returned false, which stops the simulation.
+	static bool ForEachSimulationStep(const FThumbnailSettings& ThumbnailSettings, TFunctionRef<bool(int32, float)> StepCallback)
 	{
-		const auto AreScriptsDifferent = [](const TArray<UThumbnailGeneratorScript*> &ExistingScripts, const TArray<TSubclassOf<UThumbnailGeneratorScript>> &NewScripts)->bool
+		if (ThumbnailSettings.SimulateSceneFramerate <= 0.f)
+			return true;
+
+		int32 StepIndex = 0;
+		const auto StepSize = 1.f / ThumbnailSettings.SimulateSceneFramerate;
+		for (float time = ThumbnailSettings.SimulateSceneTime; time > 0.f; time -= StepSize)
 		{
-			if (ExistingScripts.Num() != NewScripts.Num())
-				return true;
+			const auto dt = StepSize + FMath::Min(0.f, time - StepSize);
+			if (!StepCallback(StepIndex++, dt))
+				return false;
+		}
 
-			// Make order matter since we expect this array not to change much. It is therefore 
-			// more important that the compare function is fast, rather than we avoid re-creating the ThumbnailGeneratorScripts
-			for (int32 i = 0; i < NewScripts.Num(); i++)
-			{
-				if (!IsValid(ExistingScripts[i]) || NewScripts[i].Get() != ExistingScripts[i]->GetClass())
-					return true;
-			}
+		return true;
+	}
 
-			return false;
-		};
+	static int32 GetNumSimulationSteps(const FThumbnailSettings& ThumbnailSettings)
+	{
+		if (ThumbnailSettings.SimulationMode == EThumbnailSceneSimulationMode::ENone)
+			return 0;
 
-		if (AreScriptsDifferent(ThumbnailGeneratorScripts, ThumbnailSettings.ThumbnailGeneratorScripts))
-		{
-			for (UThumbnailGeneratorScript* ThumbnailGeneratorScript : ThumbnailGeneratorScripts)
-			{
-				if (IsValid(ThumbnailGeneratorScript))
-				{
-					ThumbnailGeneratorScript->MarkAsGarbage();
-				}
+		int32 NumSteps = 0;
+		ForEachSimulationStep(ThumbnailSettings, [&](int32, float) { NumSteps++; return true; });
+		return NumSteps;
+	}
+
+	// Result of a queued async request which identical requests can subscribe to
+	struct FCoalescedThumbnailRequest
+	{
+		TWeakPtr<FThumbnailRequestState> Task;
+		TStrongObjectPtr<UTexture2D>     Thumbnail;
+		int32                            NumDeliveries = 0; // Subscribers which have been handed the thumbnail, see UThumbnailGeneration::DeliverCoalescedThumbnail
+
+		// Number of in-flight entries at which entries left behind by cancelled requests are purged
+		static constexpr int32 PurgeThreshold = 256;
+
+		static FThumbnailRequestKey MakeKey(const FThumbnailRequestKey& RequestKey, const FString& PreCaptureIdentity)
+		{
+			if (PreCaptureIdentity.IsEmpty())
+				return RequestKey;
+
+			FXxHash128Builder Builder;
+			Builder.Update(&RequestKey.Hash, sizeof(FXxHash128));
+			Builder.Update(*PreCaptureIdentity, PreCaptureIdentity.Len() * sizeof(TCHAR));
+			return FThumbnailRequestKey{ Builder.Finalize() };
+		}
+
+		// Requests are removed when their task starts, entries of cancelled tasks are replaced by the next identical request
+		static TMap<FThumbnailRequestKey, TSharedRef<FCoalescedThumbnailRequest>>& GetInFlightRequests()
+		{
+			static TMap<FThumbnailRequestKey, TSharedRef<FCoalescedThumbnailRequest>> InFlightRequests;
+			return InFlightRequests;
+		}
+	};
+}
+
+FThumbnailGenerator::FThumbnailGenerator(bool bInvalidateOnPIEEnd)
+	: FThumbnailGenerator()
+{
+#if WITH_EDITOR
+	if (bInvalidateOnPIEEnd)
+	{
+		EndPIEDelegateHandle = FEditorDelegates::EndPIE.AddLambda([this](bool)
+		{
+			InvalidateThumbnailWorld();
+		});
+	}
+
+	// Recompiling a blueprint re-instances its objects, any cached thumbnail, override plan, bounds or pooled actor might be out of date
+	ObjectsReplacedDelegateHandle = FCoreUObjectDelegates::OnObjectsReplaced.AddLambda([this](const TMap<UObject*, UObject*>& ReplacedObjects)
+	{
+		if (ReplacedObjects.Num() > 0)
+		{
+			ClearThumbnailResultCache();
+			ClearThumbnailBoundsCache();
+
+			if (PropertyOverrides.IsValid())
+				PropertyOverrides->Reset();
+
+			if (!bIsCapturingThumbnail)
+				DestroyPooledThumbnailActors();
+		}
+	});
+
+	// Editing an asset (a mesh, or a blueprint before it is compiled) might change the bounds of any thumbnail actor which uses it
+	ObjectPropertyChangedDelegateHandle = FCoreUObjectDelegates::OnObjectPropertyChanged.AddLambda([this](UObject* Object, FPropertyChangedEvent&)
+	{
+		if (Object && (Object->IsAsset() || Object->HasAnyFlags(RF_ClassDefaultObject)))
+			ClearThumbnailBoundsCache();
+	});
+#endif
+}
+
+FThumbnailGenerator::~FThumbnailGenerator()
+{
+#if WITH_EDITOR
+	if (EndPIEDelegateHandle.IsValid())
+	{
+		FEditorDelegates::EndPIE.Remove(EndPIEDelegateHandle);
+	}
+
+	if (ObjectsReplacedDelegateHandle.IsValid())
+	{
+		FCoreUObjectDelegates::OnObjectsReplaced.Remove(ObjectsReplacedDelegateHandle);
+	}
+
+	if (ObjectPropertyChangedDelegateHandle.IsValid())
+	{
+		FCoreUObjectDelegates::OnObjectPropertyChanged.Remove(ObjectPropertyChangedDelegateHandle);
+	}
+#endif
+
+	if (RenderTargetCache.IsValid())
+		RenderTargetCache->ClearCache();
+
+	if (MemoryTrimDelegateHandle.IsValid())
+		FCoreDelegates::GetMemoryTrimDelegate().Remove(MemoryTrimDelegateHandle);
+
+	if (ThumbnailResultCache.IsValid())
+		ThumbnailResultCache->ClearCache();
+
+	for (UThumbnailGeneratorScript* ThumbnailGeneratorScript : ThumbnailGeneratorScripts)
+	{
+		if (IsValid(ThumbnailGeneratorScript))
+		{
+			ThumbnailGeneratorScript->MarkAsGarbage();
+		}
+	}
+
+	TrimPooledResources();
+}
+
+UTexture2D* FThumbnailGenerator::GenerateActorThumbnail(TSubclassOf<AActor> ActorClass, const FThumbnailSettings& ThumbnailSettings, UTexture2D* ResourceObject, const TMap<FString, FString>& Properties)
+{
+	return GenerateActorThumbnailInternal(ActorClass, ThumbnailSettings, ResourceObject, Properties, ThumbnailGenerator::EmptyPropertyBag, nullptr);
+}
+
+UTexture2D* FThumbnailGenerator::GenerateActorThumbnail(TSubclassOf<AActor> ActorClass, const FThumbnailSettings& ThumbnailSettings, UTexture2D* ResourceObject, const FInstancedPropertyBag& PropertyBag)
+{
+	return GenerateActorThumbnailInternal(ActorClass, ThumbnailSettings, ResourceObject, TMap<FString, FString>(), PropertyBag, nullptr);
+}
+
+UTexture2D* FThumbnailGenerator::GenerateActorThumbnailInternal(TSubclassOf<AActor> ActorClass, const FThumbnailSettings& ThumbnailSettings, UTexture2D* ResourceObject, const TMap<FString, FString>& Properties, 
+	const FInstancedPropertyBag& PropertyBag, UTextureRenderTarget2D* RenderTarget, bool* bOutDiskCacheHit, bool bDiskCacheOnly)
+{
+	FThumbnailDiskCache* DiskCache = FThumbnailDiskCache::Get();
+
+	FThumbnailRequestKey DiskCacheKey;
+	const bool bUseDiskCache = DiskCache && FThumbnailDiskCache::ComputeDiskCacheKey(DiskCacheKey, ActorClass, ThumbnailSettings, Properties, &PropertyBag);
+
+	if (bUseDiskCache)
+	{
+		FThumbnailDiskCacheData CachedData;
+		if (DiskCache->Load(DiskCacheKey, CachedData))
+		{
+			UTexture2D* Thumbnail = IsValid(ResourceObject)
+				? ResourceObject
+				: AcquireThumbnailTexture(
+					FString::Printf(TEXT("%s_Thumbnail"), *ActorClass->GetName()),
+					CachedData.SizeX,
+					CachedData.SizeY,
+					CachedData.PixelFormat
+				);
+
+			if (Thumbnail && ThumbnailGenerator::FillTextureDataFromPixels(Thumbnail, CachedData))
+			{
+				if (bOutDiskCacheHit)
+					*bOutDiskCacheHit = true;
+
+				return Thumbnail;
 			}
+		}
+	}
+
+	if (bDiskCacheOnly)
+		return nullptr;
+
+	// When called from a batch the scene state and render target have already been set up for this request
+	const bool bUpdateSceneState = RenderTarget == nullptr;
+	AActor* const Actor = BeginGenerateActorThumbnailInternal(ActorClass, ThumbnailSettings, Properties, PropertyBag, true, bUpdateSceneState);
+	if (Actor)
+		CacheBoundsOfCurrentCapture(ActorClass, ThumbnailSettings, Properties, PropertyBag);
+
+	UTexture2D* Thumbnail = FinishGenerateActorThumbnailInternal(Actor, ThumbnailSettings, ResourceObject, false, RenderTarget);
+
+	if (bUseDiskCache && Thumbnail)
+	{
+		FThumbnailDiskCacheData ThumbnailData;
+		if (ThumbnailGenerator::ReadTextureData(Thumbnail, *GetScratchBuffers(), ThumbnailData))
+			DiskCache->Store(DiskCacheKey, ThumbnailData, int64(UThumbnailGeneratorSettings::Get()->MaxThumbnailDiskCacheSize) * 1000 * 1000);
+
+		GetScratchBuffers()->Release(MoveTemp(ThumbnailData.Pixels));
+	}
+
+	return Thumbnail;
+}
+
+bool FThumbnailGenerator::GenerateActorThumbnailPipelined(FThumbnailRequest& Request, ThumbnailGenerator::FThumbnailCapturePipeline& Pipeline, bool& bOutDiskCacheHit)
+{
+	const auto EjectWithError = [&](const FString &Error)->bool
+	{
+		const static FString FuncName = TEXT("FThumbnailGenerator::GenerateActorThumbnailPipelined");
+		UE_LOG(LogThumbnailGenerator, Error, TEXT("%s - %s"), *FuncName , *Error);
+		return false;
+	};
+
+	FThumbnailDiskCache* DiskCache = FThumbnailDiskCache::Get();
+
+	FThumbnailRequestKey DiskCacheKey;
+	const bool bUseDiskCache = DiskCache && FThumbnailDiskCache::ComputeDiskCacheKey(DiskCacheKey, Request.ActorClass, Request.ThumbnailSettings, Request.Properties, &Request.PropertyBag);
+
+	if (bUseDiskCache)
+	{
+		// Disk cache hits don't need a capture, so they are resolved right away
+		Request.Thumbnail = GenerateActorThumbnailInternal(Request.ActorClass, Request.ThumbnailSettings, Request.ResourceObject, Request.Properties, Request.PropertyBag, nullptr, &bOutDiskCacheHit, true);
+		if (bOutDiskCacheHit)
+			return true;
+	}
+
+	// Blocks on the oldest capture if every slot is in use
+	const int32 Slot = Pipeline.AcquireSlot();
+
+	UTextureRenderTarget2D* RenderTarget      = nullptr;
+	UTextureRenderTarget2D* AlphaRenderTarget = nullptr;
+	if (CaptureBackend->UsesRenderTargets())
+	{
+		RenderTarget      = FindOrCreatePipelineRenderTarget(Request.ThumbnailSettings, Slot * 2);
+		AlphaRenderTarget = Request.ThumbnailSettings.bCaptureAlpha ? FindOrCreatePipelineRenderTarget(Request.ThumbnailSettings, Slot * 2 + 1) : nullptr;
+		if (!RenderTarget || (Request.ThumbnailSettings.bCaptureAlpha && !AlphaRenderTarget))
+		{
+			Pipeline.ReleaseSlot(Slot);
+			return EjectWithError("Could not create a render target for thumbnail capture");
+		}
+	}
+
+	AActor* const Actor = BeginGenerateActorThumbnailInternal(Request.ActorClass, Request.ThumbnailSettings, Request.Properties, Request.PropertyBag, true, false);
+	if (Actor)
+		CacheBoundsOfCurrentCapture(Request.ActorClass, Request.ThumbnailSettings, Request.Properties, Request.PropertyBag);
+
+	if (!PrepareActorForCapture(Actor, Request.ThumbnailSettings, false))
+	{
+		Pipeline.ReleaseSlot(Slot);
+		return false;
+	}
+
+	const FString ThumbnailName = FString::Printf(TEXT("%s_Thumbnail"), *Request.ActorClass->GetName());
+	const int64 MaxDiskCacheSize = int64(UThumbnailGeneratorSettings::Get()->MaxThumbnailDiskCacheSize) * 1000 * 1000;
+
+	// The callback runs once the readback has completed, which at the latest is when the pipeline is flushed at the end of the batch
+	const bool bEnqueued = EnqueuePipelinedCapture(Request.ThumbnailSettings, RenderTarget, AlphaRenderTarget, Actor, Pipeline, Slot, 
+		[this, &Request, ThumbnailName, bUseDiskCache, DiskCacheKey, MaxDiskCacheSize](FThumbnailPixelData* Pixels)
+	{
+		if (!Pixels)
+			return;
+
+		UTexture2D* Thumbnail = IsValid(Request.ResourceObject)
+			? Request.ResourceObject
+			: AcquireThumbnailTexture(ThumbnailName, Pixels->SizeX, Pixels->SizeY, Pixels->PixelFormat);
+
+		if (!Thumbnail || !ThumbnailGenerator::FillTextureDataFromPixels(Thumbnail, *Pixels))
+		{
+			UE_LOG(LogThumbnailGenerator, Error, TEXT("FThumbnailGenerator::GenerateActorThumbnailPipelined - Failed to generate thumbnail texture"));
+			return;
+		}
+
+		Request.Thumbnail = Thumbnail;
+		INC_DWORD_STAT(STAT_ThumbnailGenerator_NumThumbnails);
+
+		FThumbnailDiskCache* DiskCache = FThumbnailDiskCache::Get();
+		if (bUseDiskCache && DiskCache)
+			DiskCache->Store(DiskCacheKey, *Pixels, MaxDiskCacheSize);
+	});
+
+	CleanupThumbnailCapture();
+
+	if (!bEnqueued)
+	{
+		Pipeline.ReleaseSlot(Slot);
+		return EjectWithError("Failed to read back thumbnail capture");
+	}
+
+	return true;
+}
+
+FThumbnailBatchStats FThumbnailGenerator::GenerateActorThumbnailsBatch(TArrayView<FThumbnailRequest> Requests)
+{
+	QUICK_SCOPE_CYCLE_COUNTER(STAT_GenerateActorThumbnailsBatch);
+
+	FThumbnailBatchStats Stats;
+	Stats.NumRequests = Requests.Num();
+
+	const double BatchStartTime = FPlatformTime::Seconds();
+
+	// Everything that requires a state change between two captures
+	struct FRequestGroupKey
+	{
+		FThumbnailRequestKey      SceneKey;
+		uint32                    ScriptsHash = 0;
+		FHashableRenderTargetInfo RenderTargetInfo;
+
+		bool HasSameScene(const FRequestGroupKey& Other) const { return SceneKey == Other.SceneKey; }
+		bool HasSameScripts(const FRequestGroupKey& Other) const { return ScriptsHash == Other.ScriptsHash; }
+		bool HasSameRenderTarget(const FRequestGroupKey& Other) const { return RenderTargetInfo == Other.RenderTargetInfo; }
+	};
+
+	TArray<FRequestGroupKey> GroupKeys;
+	TArray<int32> SortedRequests;
+	GroupKeys.SetNum(Requests.Num());
+	SortedRequests.Reserve(Requests.Num());
+
+	for (int32 i = 0; i < Requests.Num(); i++)
+	{
+		const FThumbnailSettings& RequestSettings = Requests[i].ThumbnailSettings;
+		Requests[i].Thumbnail = nullptr;
+
+		FRequestGroupKey& GroupKey = GroupKeys[i];
+		GroupKey.SceneKey         = ThumbnailGenerator::ComputeSceneStateKey(RequestSettings);
+		GroupKey.RenderTargetInfo = FHashableRenderTargetInfo{ uint16(RequestSettings.ThumbnailTextureWidth), uint16(RequestSettings.ThumbnailTextureHeight), RequestSettings.ThumbnailBitDepth };
+		for (const TSubclassOf<UThumbnailGeneratorScript>& ScriptClass : RequestSettings.ThumbnailGeneratorScripts)
+			GroupKey.ScriptsHash = HashCombine(GroupKey.ScriptsHash, GetTypeHash(ScriptClass.Get()));
+
+		SortedRequests.Add(i);
+	}
+
+	// Scene updates are the most expensive (sky light recapture), followed by script re-creation and render target lookups.
+	// The sort is stable so requests within a group keep their order.
+	Algo::StableSort(SortedRequests, [&](int32 A, int32 B)
+	{
+		const FRequestGroupKey& KeyA = GroupKeys[A];
+		const FRequestGroupKey& KeyB = GroupKeys[B];
+
+		if (KeyA.SceneKey.Hash.HashHigh != KeyB.SceneKey.Hash.HashHigh)
+			return KeyA.SceneKey.Hash.HashHigh < KeyB.SceneKey.Hash.HashHigh;
+		if (KeyA.SceneKey.Hash.HashLow != KeyB.SceneKey.Hash.HashLow)
+			return KeyA.SceneKey.Hash.HashLow < KeyB.SceneKey.Hash.HashLow;
+		if (KeyA.ScriptsHash != KeyB.ScriptsHash)
+			return KeyA.ScriptsHash < KeyB.ScriptsHash;
+		return GetTypeHash(KeyA.RenderTargetInfo) < GetTypeHash(KeyB.RenderTargetInfo);
+	});
+
+	Stats.GroupingTime = FPlatformTime::Seconds() - BatchStartTime;
+
+	if (Requests.Num() > 0 && !ThumbnailScene.IsValid())
+		InitializeThumbnailWorld(UThumbnailGeneratorSettings::Get()->BackgroundSceneSettings);
+
+	// Several captures are kept in flight so the next actor can be spawned and captured while earlier captures are read back
+	const int32 MaxCapturesInFlight = UThumbnailGeneratorSettings::Get()->MaxCapturesInFlight;
+	TUniquePtr<ThumbnailGenerator::FThumbnailCapturePipeline> Pipeline = MaxCapturesInFlight > 1
+		? MakeUnique<ThumbnailGenerator::FThumbnailCapturePipeline>(MaxCapturesInFlight, GetScratchBuffers())
+		: nullptr;
+
+	const uint32 NumScratchAllocationsBefore = GetScratchBuffers()->GetNumAllocations();
+
+	const FRequestGroupKey* PreviousKey = nullptr;
+	UTextureRenderTarget2D* RenderTarget = nullptr;
+	const bool bUsesRenderTargets = !CaptureBackend.IsValid() || CaptureBackend->UsesRenderTargets();
+
+	for (const int32 RequestIndex : SortedRequests)
+	{
+		FThumbnailRequest& Request = Requests[RequestIndex];
+		const FRequestGroupKey& GroupKey = GroupKeys[RequestIndex];
+
+		if (!IsValid(Request.ActorClass.Get()) || Request.ThumbnailSettings.ThumbnailTextureWidth <= 0 || Request.ThumbnailSettings.ThumbnailTextureHeight <= 0)
+		{
+			// Let the regular path report the error
+			Request.Thumbnail = GenerateActorThumbnailInternal(Request.ActorClass, Request.ThumbnailSettings, Request.ResourceObject, Request.Properties, Request.PropertyBag, nullptr);
+			PreviousKey = nullptr;
+			continue;
+		}
+
+		const double StateChangeStartTime = FPlatformTime::Seconds();
+
+		const bool bSceneChanged        = !PreviousKey || !PreviousKey->HasSameScene(GroupKey);
+		const bool bScriptsChanged      = !PreviousKey || !PreviousKey->HasSameScripts(GroupKey);
+		const bool bRenderTargetChanged = !PreviousKey || !PreviousKey->HasSameRenderTarget(GroupKey);
+
+		if (bSceneChanged || bScriptsChanged || bRenderTargetChanged)
+			Stats.NumGroups++;
+
+		if (bScriptsChanged && UpdateThumbnailGeneratorScripts(Request.ThumbnailSettings))
+			Stats.NumScriptUpdates++;
+
+		if (bSceneChanged)
+		{
+			ThumbnailScene->UpdateScene(Request.ThumbnailSettings);
+			Stats.NumSceneUpdates++;
+		}
+
+		// The pipeline picks a render target per slot
+		if (!Pipeline.IsValid() && bUsesRenderTargets && (bRenderTargetChanged || !IsValid(RenderTarget)))
+			RenderTarget = FindOrCreateRenderTarget(Request.ThumbnailSettings);
+
+		PreviousKey = &GroupKey;
+
+		const double CaptureStartTime = FPlatformTime::Seconds();
+		Stats.StateChangeTime += CaptureStartTime - StateChangeStartTime;
+
+		bool bDiskCacheHit = false;
+		if (Pipeline.IsValid())
+		{
+			GenerateActorThumbnailPipelined(Request, *Pipeline, bDiskCacheHit);
+		}
+		else
+		{
+			Request.Thumbnail = RenderTarget || !bUsesRenderTargets
+				? GenerateActorThumbnailInternal(Request.ActorClass, Request.ThumbnailSettings, Request.ResourceObject, Request.Properties, Request.PropertyBag, RenderTarget, &bDiskCacheHit)
+				: nullptr;
+		}
+
+		Stats.CaptureTime      += FPlatformTime::Seconds() - CaptureStartTime;
+		Stats.NumDiskCacheHits += bDiskCacheHit ? 1 : 0;
+	}
+
+	if (Pipeline.IsValid())
+	{
+		const double FlushStartTime = FPlatformTime::Seconds();
+		Pipeline->Flush();
+		Stats.CaptureTime       += FPlatformTime::Seconds() - FlushStartTime;
+		Stats.NumPipelineStalls  = Pipeline->GetNumStalls();
+	}
+
+	for (const FThumbnailRequest& Request : Requests)
+		Stats.NumFailed += Request.Thumbnail ? 0 : 1;
+
+	// Persist the thumbnails stored by the batch right away, rather than waiting for the next periodic flush
+	if (FThumbnailDiskCache* DiskCache = FThumbnailDiskCache::Get())
+		DiskCache->Flush();
+
+	Stats.NumScratchAllocations = int32(ScratchBuffers->GetNumAllocations() - NumScratchAllocationsBefore);
+	Stats.TotalTime             = FPlatformTime::Seconds() - BatchStartTime;
+
+	UE_LOG(LogThumbnailGenerator, Log, TEXT("Generated %d thumbnails (%d failed, %d from disk cache) in %d groups: %d scene updates, %d script updates, %d pipeline stalls, %d scratch allocations. Total %.2f ms (grouping %.2f ms, state changes %.2f ms, capture %.2f ms, %.3f ms/thumbnail)"),
+		Stats.NumRequests, Stats.NumFailed, Stats.NumDiskCacheHits, Stats.NumGroups, Stats.NumSceneUpdates, Stats.NumScriptUpdates, Stats.NumPipelineStalls, Stats.NumScratchAllocations,
+		Stats.TotalTime * 1000.0, Stats.GroupingTime * 1000.0, Stats.StateChangeTime * 1000.0, Stats.CaptureTime * 1000.0,
+		Stats.NumRequests > 0 ? Stats.TotalTime * 1000.0 / Stats.NumRequests : 0.0);
+
+	return Stats;
+}
+
+AActor* FThumbnailGenerator::BeginGenerateActorThumbnail(TSubclassOf<AActor> ActorClass, const FThumbnailSettings& ThumbnailSettings, const TMap<FString, FString>& Properties, bool bFinishSpawningActor)
+{
+	return BeginGenerateActorThumbnailInternal(ActorClass, ThumbnailSettings, Properties, ThumbnailGenerator::EmptyPropertyBag, bFinishSpawningActor, true);
+}
+
+AActor* FThumbnailGenerator::BeginGenerateActorThumbnail(TSubclassOf<AActor> ActorClass, const FThumbnailSettings& ThumbnailSettings, const FInstancedPropertyBag& PropertyBag, bool bFinishSpawningActor)
+{
+	return BeginGenerateActorThumbnailInternal(ActorClass, ThumbnailSettings, TMap<FString, FString>(), PropertyBag, bFinishSpawningActor, true);
+}
+
+AActor* FThumbnailGenerator::BeginGenerateActorThumbnailInternal(TSubclassOf<AActor> ActorClass, const FThumbnailSettings& ThumbnailSettings, const TMap<FString, FString>& Properties, const FInstancedPropertyBag& PropertyBag,
+	bool bFinishSpawningActor, bool bUpdateSceneState, bool bAllowActorPooling)
+{
+	CurrentRequestTraceId = ++NextRequestTraceId;
+	THUMBNAIL_REQUEST_TRACE_SCOPE("Begin", CurrentRequestTraceId, ActorClass.Get());
+	THUMBNAIL_STAGE_SCOPE(Begin);
+
+	const auto EjectWithError = [&](const FString &Error)->AActor*
+	{
+		const static FString FuncName = TEXT("FThumbnailGenerator::BeginGenerateActorThumbnail");
+		UE_LOG(LogThumbnailGenerator, Error, TEXT("%s - %s"), *FuncName , *Error);
+
+		CleanupThumbnailCapture();
+
+		return nullptr;
+	};
+
+	if (bIsCapturingThumbnail)
+	{
+		return EjectWithError("Called without first calling FinishGenerateActorThumbnail");
+	}
+
+	UClass* const ClassPtr = ActorClass.Get();
+
+	if (!IsValid(ClassPtr))
+		return EjectWithError("Invalid Actor Class");
+
+	if (ThumbnailSettings.ThumbnailTextureWidth <= 0 || ThumbnailSettings.ThumbnailTextureHeight <= 0)
+		return EjectWithError(FString::Printf(TEXT("Invalid Texture Size (%dx%d)"), ThumbnailSettings.ThumbnailTextureWidth, ThumbnailSettings.ThumbnailTextureHeight));
+
+	if (!ThumbnailScene.IsValid())
+		InitializeThumbnailWorld(UThumbnailGeneratorSettings::Get()->BackgroundSceneSettings);
+
+	UWorld* const ThumbnailWorld = ThumbnailScene->GetThumbnailWorld();
+	if (!IsValid(ThumbnailWorld))
+		return EjectWithError("Invalid Preview World");
+
+	if (bUpdateSceneState)
+	{
+		THUMBNAIL_STAGE_SCOPE(UpdateScene);
+		UpdateThumbnailGeneratorScripts(ThumbnailSettings);
+		ThumbnailScene->UpdateScene(ThumbnailSettings);
+	}
+
+	PrepareThumbnailCapture();
+
+	const bool bPoolActor = bAllowActorPooling && ThumbnailGenerator::ShouldPoolActorClass(ClassPtr);
+
+	AActor* SpawnedActor = bPoolActor ? AcquirePooledThumbnailActor(ClassPtr) : nullptr;
+	if (!SpawnedActor)
+	{
+		THUMBNAIL_STAGE_SCOPE(SpawnActor);
+
+		FActorSpawnParameters SpawnParams;
+		SpawnParams.bNoFail                        = true;
+		SpawnParams.bDeferConstruction             = true;
+		SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+
+		SpawnedActor = ThumbnailWorld->SpawnActor<AActor>(ActorClass.Get(), SpawnParams);
+	}
+
+	if (!IsValid(SpawnedActor))
+		return EjectWithError("Failed to spawn thumbnail actor");
+
+	if (bPoolActor)
+	{
+		ActivePooledActor = FPooledThumbnailActor();
+		ActivePooledActor.Actor = SpawnedActor;
+	}
+
+	{
+		THUMBNAIL_STAGE_SCOPE(ImportProperties);
+
+		TArray<const FProperty*> OverriddenProperties;
+		PropertyOverrides->Apply(SpawnedActor, Properties, bPoolActor ? &OverriddenProperties : nullptr);
+		PropertyOverrides->Apply(SpawnedActor, PropertyBag, bPoolActor ? &OverriddenProperties : nullptr);
+
+		// Instanced subobjects can't be restored from the class defaults, see ThumbnailGenerator::RestoreArchetypeState
+		if (bPoolActor && OverriddenProperties.ContainsByPredicate(&ThumbnailGenerator::IsInstancedReferenceProperty))
+			ActivePooledActor.bCanReuse = false;
+	}
+
+	if (bFinishSpawningActor)
+		FinishSpawningThumbnailActor(SpawnedActor);
+
+	return SpawnedActor;
+}
+
+void FThumbnailGenerator::CacheBoundsOfCurrentCapture(TSubclassOf<AActor> ActorClass, const FThumbnailSettings& ThumbnailSettings, const TMap<FString, FString>& Properties, const FInstancedPropertyBag& PropertyBag)
+{
+	// Only called when nothing but the request touches the actor between spawning and capturing it
+	if (BoundsCache.IsValid() && (UThumbnailGeneratorSettings::Get()->MaxThumbnailBoundsCacheSize > 0 || BoundsCache->HasPrecomputedBounds()))
+		BoundsCache->SetCaptureKey(ThumbnailGenerator::ComputeBoundsKey(ActorClass, ThumbnailSettings, Properties, &PropertyBag));
+}
+
+UTexture2D* FThumbnailGenerator::FinishGenerateActorThumbnail(AActor* Actor, const FThumbnailSettings& ThumbnailSettings, UTexture2D* ResourceObject, bool bFinishSpawningActor)
+{
+	return FinishGenerateActorThumbnailInternal(Actor, ThumbnailSettings, ResourceObject, bFinishSpawningActor, nullptr);
+}
+
+bool FThumbnailGenerator::CalculateActorThumbnailBounds(TSubclassOf<AActor> ActorClass, const FThumbnailSettings& ThumbnailSettings, FThumbnailPrecomputedActorBounds& OutBounds)
+{
+	AActor* const Actor = BeginGenerateActorThumbnailInternal(ActorClass, ThumbnailSettings, TMap<FString, FString>(), FInstancedPropertyBag(), true, true);
+	if (!Actor || !PrepareActorForCapture(Actor, ThumbnailSettings, false))
+		return false;
+
+	const FThumbnailRequestKey BoundsKey = ThumbnailGenerator::ComputeBoundsKey(ActorClass, ThumbnailSettings, TMap<FString, FString>());
+
+	OutBounds.ActorClass    = ActorClass.Get();
+	OutBounds.BoundsKeyHigh = BoundsKey.Hash.HashHigh;
+	OutBounds.BoundsKeyLow  = BoundsKey.Hash.HashLow;
+
+	if (!ThumbnailGenerator::GetActorSuppliedBounds(Actor, OutBounds.Bounds))
+		OutBounds.Bounds = ThumbnailGenerator::CalcActorLocalBounds(Actor, ThumbnailSettings, false);
+
+	CleanupThumbnailCapture();
+
+	return true;
+}
+
+TArray<UTexture2D*> FThumbnailGenerator::GenerateActorThumbnailViews(TSubclassOf<AActor> ActorClass, const FThumbnailSettings& ThumbnailSettings, TConstArrayView<FRotator> CameraOrbitRotations, 
+	const TMap<FString, FString>& Properties)
+{
+	TArray<UTexture2D*> Thumbnails;
+	Thumbnails.Reserve(CameraOrbitRotations.Num());
+
+	const bool bCaptured = CaptureActorViews(ActorClass, ThumbnailSettings, CameraOrbitRotations, Properties, 
+		[&](int32 ViewIndex, const FThumbnailSettings& ViewSettings, UTextureRenderTarget2D* RenderTarget, AActor* Actor)
+	{
+		UTexture2D* const Thumbnail = CaptureThumbnail(ViewSettings, RenderTarget, Actor, nullptr);
+		Thumbnails.Add(Thumbnail);
+		return Thumbnail != nullptr;
+	});
+
+	if (!bCaptured)
+	{
+		for (UTexture2D* Thumbnail : Thumbnails)
+			ReleaseThumbnail(Thumbnail);
+
+		Thumbnails.Reset();
+	}
+
+	return Thumbnails;
+}
+
+UTexture2D* FThumbnailGenerator::GenerateActorThumbnailAtlas(TSubclassOf<AActor> ActorClass, const FThumbnailSettings& ThumbnailSettings, TConstArrayView<FRotator> CameraOrbitRotations, 
+	FThumbnailAtlasLayout& OutLayout, int32 NumColumns, const TMap<FString, FString>& Properties)
+{
+	const auto EjectWithError = [&](const FString &Error)->UTexture2D*
+	{
+		const static FString FuncName = TEXT("FThumbnailGenerator::GenerateActorThumbnailAtlas");
+		UE_LOG(LogThumbnailGenerator, Error, TEXT("%s - %s"), *FuncName , *Error);
+		return nullptr;
+	};
+
+	if (!ActorClass)
+		return EjectWithError("Invalid actor class");
+
+	if (CameraOrbitRotations.Num() == 0)
+		return EjectWithError("No camera orbit rotations");
+
+	OutLayout = FThumbnailAtlasLayout::Make(CameraOrbitRotations.Num(), ThumbnailSettings.ThumbnailTextureWidth, ThumbnailSettings.ThumbnailTextureHeight, NumColumns);
+
+	uint8* AtlasData = nullptr;
+	UTexture2D* const AtlasTexture = BeginThumbnailAtlas(FString::Printf(TEXT("%s_Atlas"), *ActorClass->GetName()), ThumbnailSettings, OutLayout, AtlasData);
+	if (!AtlasTexture)
+		return nullptr;
+
+	const bool bCaptured = CaptureActorViews(ActorClass, ThumbnailSettings, CameraOrbitRotations, Properties, 
+		[&](int32 ViewIndex, const FThumbnailSettings& ViewSettings, UTextureRenderTarget2D* RenderTarget, AActor* Actor)
+	{
+		return CaptureThumbnailAtlasTile(ViewSettings, RenderTarget, Actor, OutLayout, ViewIndex, AtlasData);
+	});
+
+	return FinishThumbnailAtlas(AtlasTexture, bCaptured);
+}
+
+UTexture2D* FThumbnailGenerator::GenerateActorThumbnailFlipbook(TSubclassOf<AActor> ActorClass, const FThumbnailSettings& ThumbnailSettings, int32 StepsPerFrame, bool bFrameEachFrame, 
+	FThumbnailAtlasLayout& OutLayout, int32 NumColumns, const TMap<FString, FString>& Properties)
+{
+	const auto EjectWithError = [&](const FString &Error)->UTexture2D*
+	{
+		const static FString FuncName = TEXT("FThumbnailGenerator::GenerateActorThumbnailFlipbook");
+		UE_LOG(LogThumbnailGenerator, Error, TEXT("%s - %s"), *FuncName , *Error);
+		return nullptr;
+	};
+
+	if (!ActorClass)
+		return EjectWithError("Invalid actor class");
+
+	if (ThumbnailSettings.SimulationMode == EThumbnailSceneSimulationMode::ENone)
+		return EjectWithError("A flipbook requires a simulation mode");
+
+	StepsPerFrame = FMath::Max(1, StepsPerFrame);
+
+	const int32 NumSteps  = ThumbnailGenerator::GetNumSimulationSteps(ThumbnailSettings);
+	const int32 NumFrames = NumSteps / StepsPerFrame;
+	if (NumFrames == 0)
+		return EjectWithError(FString::Printf(TEXT("The simulation (%d steps) is shorter than a frame (%d steps)"), NumSteps, StepsPerFrame));
+
+	OutLayout = FThumbnailAtlasLayout::Make(NumFrames, ThumbnailSettings.ThumbnailTextureWidth, ThumbnailSettings.ThumbnailTextureHeight, NumColumns);
+	OutLayout.FrameRate = ThumbnailSettings.SimulateSceneFramerate / StepsPerFrame;
+
+	uint8* AtlasData = nullptr;
+	UTexture2D* const AtlasTexture = BeginThumbnailAtlas(FString::Printf(TEXT("%s_Flipbook"), *ActorClass->GetName()), ThumbnailSettings, OutLayout, AtlasData);
+	if (!AtlasTexture)
+		return nullptr;
+
+	// The frames are captured in the middle of the simulation, so the capture gets no bounds key. 
+	// Their bounds would otherwise end up in the bounds cache of regular captures of the same actor.
+	AActor* const Actor = BeginGenerateActorThumbnailInternal(ActorClass, ThumbnailSettings, Properties, ThumbnailGenerator::EmptyPropertyBag, true, true);
+	if (!Actor)
+		return FinishThumbnailAtlas(AtlasTexture, false);
+
+	UTextureRenderTarget2D* RenderTarget = nullptr;
+	if (CaptureBackend->UsesRenderTargets())
+	{
+		RenderTarget = FindOrCreateRenderTarget(ThumbnailSettings);
+		if (!RenderTarget)
+		{
+			CleanupThumbnailCapture();
+			FinishThumbnailAtlas(AtlasTexture, false);
+			return EjectWithError("Could not create a render target for thumbnail capture");
+		}
+	}
+
+	const auto CalculateFrameBounds = [&]()->FBox
+	{
+		THUMBNAIL_STAGE_SCOPE(Bounds);
+
+		if (ThumbnailSettings.bOverride_CustomActorBounds)
+			return ThumbnailSettings.CustomActorBounds;
+
+		FBox FrameBounds(EForceInit::ForceInit);
+		if (!ThumbnailGenerator::GetActorSuppliedBounds(Actor, FrameBounds))
+			FrameBounds = ThumbnailGenerator::CalcActorLocalBounds(Actor, ThumbnailSettings, ThumbnailSettings.bDebugBounds);
 
-			ThumbnailGeneratorScripts.Empty();
+		return FrameBounds;
+	};
+
+	// Snapping to the floor moves the actor, so it is done once before the simulation instead of while the frames are framed
+	FThumbnailSettings FrameSettings = ThumbnailSettings;
+	FrameSettings.bSnapToFloor = false;
+
+	// Unless each frame is framed on its own, the view of the first frame is used for every frame so the camera holds still
+	TOptional<FMinimalViewInfo> SharedView;
+	int32 FrameIndex = 0;
+
+	const bool bSimulated = PrepareActorForCapture(Actor, ThumbnailSettings, false, [&](int32 StepIndex)
+	{
+		if (!IsValid(Actor))
+			return false;
 
-			for (const TSubclassOf<UThumbnailGeneratorScript>& ThumbnailGeneratorScript : ThumbnailSettings.ThumbnailGeneratorScripts)
+		if (StepIndex == INDEX_NONE)
+		{
+			if (ThumbnailSettings.bSnapToFloor)
 			{
-				if (ThumbnailGeneratorScript.Get())
-					ThumbnailGeneratorScripts.Add(NewObject<UThumbnailGeneratorScript>(GetThumbnailWorld(), ThumbnailGeneratorScript.Get()));
+				const FBox WorldBounds = ThumbnailGenerator::CenterBoundsOnFocusPoint(Actor, CalculateFrameBounds()).TransformBy(Actor->GetActorTransform());
+				if (WorldBounds.IsValid)
+					Actor->AddActorWorldOffset(FVector(0.0, 0.0, -WorldBounds.Min.Z));
 			}
+			return true;
 		}
+
+		if ((StepIndex + 1) % StepsPerFrame != 0 || FrameIndex >= NumFrames)
+			return true;
+
+		if (bFrameEachFrame || !SharedView.IsSet())
+		{
+			FrameSettings.CustomActorBounds           = CalculateFrameBounds();
+			FrameSettings.bOverride_CustomActorBounds = true;
+
+			if (!bFrameEachFrame)
+				SharedView = CalculateThumbnailView(FrameSettings, Actor);
+		}
+
+		if (!CaptureThumbnailAtlasTile(FrameSettings, RenderTarget, Actor, OutLayout, FrameIndex, AtlasData, SharedView.GetPtrOrNull()))
+			return false;
+
+		FrameIndex++;
+		return true;
+	});
+
+	// PrepareActorForCapture cleans up after itself if it fails
+	if (!bSimulated)
+	{
+		FinishThumbnailAtlas(AtlasTexture, false);
+		return EjectWithError(FString::Printf(TEXT("Failed to capture frame %d"), FrameIndex));
 	}
 
-	ThumbnailScene->UpdateScene(ThumbnailSettings);
+	CleanupThumbnailCapture();
+
+	return FinishThumbnailAtlas(AtlasTexture, FrameIndex == NumFrames);
+}
 
-	PrepareThumbnailCapture();
+UTexture2D* FThumbnailGenerator::BeginThumbnailAtlas(const FString& Name, const FThumbnailSettings& ThumbnailSettings, const FThumbnailAtlasLayout& Layout, uint8*& OutAtlasData)
+{
+	const auto EjectWithError = [&](const FString &Error)->UTexture2D*
+	{
+		const static FString FuncName = TEXT("FThumbnailGenerator::BeginThumbnailAtlas");
+		UE_LOG(LogThumbnailGenerator, Error, TEXT("%s - %s"), *FuncName , *Error);
+		return nullptr;
+	};
 
-	FActorSpawnParameters SpawnParams;
-	SpawnParams.bNoFail                        = true;
-	SpawnParams.bDeferConstruction             = true;
-	SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+	const int32 MaxAtlasSize = int32(GetMax2DTextureDimension());
+	if (Layout.GetAtlasWidth() > MaxAtlasSize || Layout.GetAtlasHeight() > MaxAtlasSize)
+		return EjectWithError(FString::Printf(TEXT("The atlas (%dx%d) is larger than the max texture size (%d)"), Layout.GetAtlasWidth(), Layout.GetAtlasHeight(), MaxAtlasSize));
 
-	AActor* const SpawnedActor = ThumbnailWorld->SpawnActor<AActor>(ActorClass.Get(), SpawnParams);
+	const EPixelFormat PixelFormat = ThumbnailSettings.ThumbnailBitDepth == EThumbnailBitDepth::E8 ? PF_B8G8R8A8 : PF_FloatRGBA;
+	const int64 BytesPerPixel      = PixelFormat == PF_B8G8R8A8 ? sizeof(FColor) : sizeof(FFloat16Color);
 
-	if (!IsValid(SpawnedActor))
-		return EjectWithError("Failed to spawn thumbnail actor");
+	UTexture2D* const AtlasTexture = AcquireThumbnailTexture(Name, Layout.GetAtlasWidth(), Layout.GetAtlasHeight(), PixelFormat);
+	if (!AtlasTexture)
+		return EjectWithError("Failed to construct Texture2D object");
 
-	UClass* SpawnedActorClass = SpawnedActor->GetClass();
-	for (const TPair<FString, FString>& SerializedProperty : Properties)
+	OutAtlasData = static_cast<uint8*>(ThumbnailGenerator::LockTextureData(AtlasTexture, Layout.GetAtlasWidth(), Layout.GetAtlasHeight(), PixelFormat));
+	if (!OutAtlasData)
 	{
-		if (FProperty* Property = FindFProperty<FProperty>(SpawnedActorClass, *SerializedProperty.Key))
-			Property->ImportText_Direct(*SerializedProperty.Value, Property->ContainerPtrToValuePtr<void>(SpawnedActor), SpawnedActor, 0);
+		ReleaseThumbnail(AtlasTexture);
+		return EjectWithError("Failed to lock the atlas texture");
 	}
 
-	if (bFinishSpawningActor)
+	// Unused tiles are left transparent
+	FMemory::Memzero(OutAtlasData, BytesPerPixel * Layout.GetAtlasWidth() * Layout.GetAtlasHeight());
+
+	return AtlasTexture;
+}
+
+bool FThumbnailGenerator::CaptureThumbnailAtlasTile(const FThumbnailSettings& ThumbnailSettings, UTextureRenderTarget2D* RenderTarget, AActor* Actor, const FThumbnailAtlasLayout& Layout, 
+	int32 TileIndex, uint8* AtlasData, const FMinimalViewInfo* View)
+{
+	THUMBNAIL_STAGE_SCOPE(Capture);
+
+	const FThumbnailCaptureParams CaptureParams = MakeCaptureParams(ThumbnailSettings, Actor, RenderTarget, nullptr, View);
+	const int64 BytesPerPixel = CaptureParams.PixelFormat == PF_B8G8R8A8 ? sizeof(FColor) : sizeof(FFloat16Color);
+	const int64 TileRowBytes  = Layout.TileWidth * BytesPerPixel;
+	const int64 AtlasRowBytes = Layout.GetAtlasWidth() * BytesPerPixel;
+
+	// Each tile is captured into a scratch buffer and copied into its place in the atlas
+	const ThumbnailGenerator::FScopedCaptureAllocations CaptureAllocations(*GetScratchBuffers());
+	TArray<uint8> TilePixels = GetScratchBuffers()->Acquire(TileRowBytes * Layout.TileHeight);
+
+	const bool bCaptured = CaptureBackend->CapturePixels(CaptureParams, TilePixels.GetData());
+
+	FlushThumbnailDebugLines();
+
+	if (bCaptured)
+	{
+		const FIntPoint TileOffset = Layout.GetTileOffset(TileIndex);
+		uint8* const TileData = AtlasData + TileOffset.Y * AtlasRowBytes + TileOffset.X * BytesPerPixel;
+		for (int32 Row = 0; Row < Layout.TileHeight; Row++)
+			FMemory::Memcpy(TileData + Row * AtlasRowBytes, TilePixels.GetData() + Row * TileRowBytes, TileRowBytes);
+	}
+	else
 	{
-		SpawnedActor->FinishSpawning(FTransform::Identity);
+		UE_LOG(LogThumbnailGenerator, Error, TEXT("FThumbnailGenerator::CaptureThumbnailAtlasTile - %s capture backend failed to capture tile %d"), CaptureBackend->GetBackendName(), TileIndex);
 	}
 
-	return SpawnedActor;
+	GetScratchBuffers()->Release(MoveTemp(TilePixels));
+
+	return bCaptured;
 }
 
-UTexture2D* FThumbnailGenerator::FinishGenerateActorThumbnail(AActor* Actor, const FThumbnailSettings& ThumbnailSettings, UTexture2D* ResourceObject, bool bFinishSpawningActor)
+UTexture2D* FThumbnailGenerator::FinishThumbnailAtlas(UTexture2D* AtlasTexture, bool bCaptured)
+{
+	ThumbnailGenerator::UnlockTextureData(AtlasTexture);
+
+	if (!bCaptured)
+	{
+		ReleaseThumbnail(AtlasTexture);
+		return nullptr;
+	}
+
+	AtlasTexture->SRGB = true;
+	AtlasTexture->CompressionSettings = TextureCompressionSettings::TC_EditorIcon;
+	AtlasTexture->LODGroup = TextureGroup::TEXTUREGROUP_UI;
+
+	{
+		THUMBNAIL_STAGE_SCOPE(TextureUpload);
+		AtlasTexture->UpdateResource();
+	}
+
+	INC_DWORD_STAT(STAT_ThumbnailGenerator_NumThumbnails);
+
+	return AtlasTexture;
+}
+
+TArray<FRotator> FThumbnailGenerator::MakeTurntableRotations(int32 NumViews, const FRotator& StartRotation)
+{
+	TArray<FRotator> Rotations;
+	Rotations.Reserve(FMath::Max(0, NumViews));
+
+	for (int32 ViewIndex = 0; ViewIndex < NumViews; ViewIndex++)
+		Rotations.Add(FRotator(StartRotation.Pitch, StartRotation.Yaw + 360.0 * ViewIndex / NumViews, StartRotation.Roll));
+
+	return Rotations;
+}
+
+bool FThumbnailGenerator::CaptureActorViews(TSubclassOf<AActor> ActorClass, const FThumbnailSettings& ThumbnailSettings, TConstArrayView<FRotator> CameraOrbitRotations, const TMap<FString, FString>& Properties,
+	TFunctionRef<bool(int32 ViewIndex, const FThumbnailSettings& ViewSettings, UTextureRenderTarget2D* RenderTarget, AActor* Actor)> CaptureView)
+{
+	const auto EjectWithError = [&](const FString &Error)->bool
+	{
+		CleanupThumbnailCapture();
+
+		const static FString FuncName = TEXT("FThumbnailGenerator::CaptureActorViews");
+		UE_LOG(LogThumbnailGenerator, Error, TEXT("%s - %s"), *FuncName , *Error);
+		return false;
+	};
+
+	AActor* const Actor = BeginGenerateActorThumbnailInternal(ActorClass, ThumbnailSettings, Properties, ThumbnailGenerator::EmptyPropertyBag, true, true);
+	if (!Actor)
+		return false;
+
+	CacheBoundsOfCurrentCapture(ActorClass, ThumbnailSettings, Properties, ThumbnailGenerator::EmptyPropertyBag);
+
+	if (!PrepareActorForCapture(Actor, ThumbnailSettings, false))
+		return false;
+
+	UTextureRenderTarget2D* RenderTarget = nullptr;
+	if (CaptureBackend->UsesRenderTargets())
+	{
+		RenderTarget = FindOrCreateRenderTarget(ThumbnailSettings);
+		if (!RenderTarget)
+			return EjectWithError("Could not create a render target for thumbnail capture");
+	}
+
+	// The views only differ in the camera rotation, so the bounds are calculated once and handed to the framing of every view
+	FThumbnailSettings ViewSettings = ThumbnailSettings;
+	ViewSettings.CustomActorBounds           = CalculateThumbnailBounds(ThumbnailSettings, Actor);
+	ViewSettings.bOverride_CustomActorBounds = true;
+
+	for (int32 ViewIndex = 0; ViewIndex < CameraOrbitRotations.Num(); ViewIndex++)
+	{
+		ViewSettings.CameraOrbitRotation = CameraOrbitRotations[ViewIndex];
+
+		if (!IsValid(Actor))
+			return EjectWithError("The thumbnail actor has been destroyed");
+
+		if (!CaptureView(ViewIndex, ViewSettings, RenderTarget, Actor))
+			return EjectWithError(FString::Printf(TEXT("Failed to capture view %d"), ViewIndex));
+	}
+
+	CleanupThumbnailCapture();
+
+	return true;
+}
+
+UTexture2D* FThumbnailGenerator::FinishGenerateActorThumbnailInternal(AActor* Actor, const FThumbnailSettings& ThumbnailSettings, UTexture2D* ResourceObject, bool bFinishSpawningActor, UTextureRenderTarget2D* RenderTarget)
 {
+	THUMBNAIL_REQUEST_TRACE_SCOPE("Finish", CurrentRequestTraceId, IsValid(Actor) ? Actor->GetClass() : nullptr);
+	THUMBNAIL_STAGE_SCOPE(Finish);
+
 	const auto EjectWithError = [&](const FString &Error)->UTexture2D*
 	{
 		if (IsValid(Actor))
@@ -506,6 +1504,42 @@ UTexture2D* FThumbnailGenerator::FinishGenerateActorThumbnail(AActor* Actor, con
 		return nullptr;
 	};
 
+	if (!PrepareActorForCapture(Actor, ThumbnailSettings, bFinishSpawningActor))
+		return nullptr;
+
+	if (!RenderTarget && CaptureBackend->UsesRenderTargets())
+	{
+		RenderTarget = FindOrCreateRenderTarget(ThumbnailSettings);
+
+		if (!RenderTarget)
+			return EjectWithError("Could not create a render target for thumbnail capture");
+	}
+
+	UTexture2D* const Thumbnail = CaptureThumbnail(ThumbnailSettings, RenderTarget, Actor, ResourceObject);
+	if (!Thumbnail)
+	{
+		return EjectWithError("Failed to generate thumbnail texture");
+	}
+
+	CleanupThumbnailCapture();
+
+	return Thumbnail;
+}
+
+bool FThumbnailGenerator::PrepareActorForCapture(AActor* Actor, const FThumbnailSettings& ThumbnailSettings, bool bFinishSpawningActor, const TFunction<bool(int32)>& OnSimulationStep)
+{
+	const auto EjectWithError = [&](const FString &Error)->bool
+	{
+		if (IsValid(Actor))
+			Actor->Destroy();
+
+		CleanupThumbnailCapture();
+
+		const static FString FuncName = TEXT("FThumbnailGenerator::FinishGenerateActorThumbnail");
+		UE_LOG(LogThumbnailGenerator, Error, TEXT("%s - %s"), *FuncName , *Error);
+		return false;
+	};
+
 	if (!bIsCapturingThumbnail)
 	{
 		return EjectWithError("Called without first calling BeginGenerateActorThumbnail");
@@ -515,9 +1549,13 @@ UTexture2D* FThumbnailGenerator::FinishGenerateActorThumbnail(AActor* Actor, con
 		return EjectWithError(TEXT("Invalid actor"));
 
 	if (bFinishSpawningActor)
-	{
-		Actor->FinishSpawning(FTransform::Identity);
-	}
+		FinishSpawningThumbnailActor(Actor);
+
+	// Components which have begun play can't be simulated again, simulated actors are never reused
+	if (ThumbnailSettings.SimulationMode != EThumbnailSceneSimulationMode::ENone && Actor == ActivePooledActor.Actor)
+		ActivePooledActor.bCanReuse = false;
+
+	THUMBNAIL_STAGE_SCOPE(PreCapture);
 
 	if (Actor->Implements<UThumbnailActorInterface>())
 	{
@@ -544,6 +1582,8 @@ UTexture2D* FThumbnailGenerator::FinishGenerateActorThumbnail(AActor* Actor, con
 
 	// Simulate scene
 	{
+		THUMBNAIL_STAGE_SCOPE(Simulation);
+
 		const auto GetActorComponents = [&]()
 		{
 			TArray<UActorComponent*> Components;
@@ -551,14 +1591,17 @@ UTexture2D* FThumbnailGenerator::FinishGenerateActorThumbnail(AActor* Actor, con
 			return Components;
 		};
 
-		const auto SimulatedTick = [&ThumbnailSettings](const TFunction<void(float)>& TickCallback)
+		// Returns false if OnSimulationStep aborted the simulation
+		const auto SimulatedTick = [&ThumbnailSettings, &OnSimulationStep](const TFunction<void(float)>& TickCallback)
 		{
-			const auto StepSize = 1.f / ThumbnailSettings.SimulateSceneFramerate;
-			for (float time = ThumbnailSettings.SimulateSceneTime; time > 0.f; time -= StepSize)
+			if (OnSimulationStep && !OnSimulationStep(INDEX_NONE))
+				return false;
+
+			return ThumbnailGenerator::ForEachSimulationStep(ThumbnailSettings, [&](int32 StepIndex, float DeltaTime)
 			{
-				const auto dt = StepSize + FMath::Min(0.f, time - StepSize);
-				TickCallback(dt);
-			}
+				TickCallback(DeltaTime);
+				return !OnSimulationStep || OnSimulationStep(StepIndex);
+			});
 		};
 
 		const auto DispatchComponentsBeginPlay = [](const TArray<UActorComponent*> &Components)
@@ -576,6 +1619,7 @@ UTexture2D* FThumbnailGenerator::FinishGenerateActorThumbnail(AActor* Actor, con
 			}
 		};
 
+		bool bSimulated = true;
 		switch (ThumbnailSettings.SimulationMode)
 		{
 		case EThumbnailSceneSimulationMode::EActor:
@@ -587,7 +1631,7 @@ UTexture2D* FThumbnailGenerator::FinishGenerateActorThumbnail(AActor* Actor, con
 
 			Actor->DispatchBeginPlay();
 
-			SimulatedTick([&](float DeltaTime)
+			bSimulated = SimulatedTick([&](float DeltaTime)
 			{
 				for (UActorComponent* Component : SpawnedComponents)
 				{
@@ -605,7 +1649,7 @@ UTexture2D* FThumbnailGenerator::FinishGenerateActorThumbnail(AActor* Actor, con
 			const auto SpawnedComponents = GetActorComponents();
 			DispatchComponentsBeginPlay(SpawnedComponents);
 
-			SimulatedTick([&](float DeltaTime)
+			bSimulated = SimulatedTick([&](float DeltaTime)
 			{
 				for (UActorComponent* Component : SpawnedComponents)
 				{
@@ -631,7 +1675,7 @@ UTexture2D* FThumbnailGenerator::FinishGenerateActorThumbnail(AActor* Actor, con
 			const auto SpawnedComponents = GetActorComponents().FilterByPredicate([&](auto* Component) { return IsTickable(Component); });
 			DispatchComponentsBeginPlay(SpawnedComponents);
 
-			SimulatedTick([&](float DeltaTime)
+			bSimulated = SimulatedTick([&](float DeltaTime)
 			{
 				for (UActorComponent* Component : SpawnedComponents)
 				{
@@ -646,8 +1690,72 @@ UTexture2D* FThumbnailGenerator::FinishGenerateActorThumbnail(AActor* Actor, con
 		default:
 			break;
 		}
+
+		if (!bSimulated)
+			return EjectWithError("Aborted the simulation of the thumbnail actor");
+	}
+
+	return true;
+}
+
+bool FThumbnailGenerator::UpdateThumbnailGeneratorScripts(const FThumbnailSettings& ThumbnailSettings)
+{
+	const auto AreScriptsDifferent = [](const TArray<UThumbnailGeneratorScript*> &ExistingScripts, const TArray<TSubclassOf<UThumbnailGeneratorScript>> &NewScripts)->bool
+	{
+		if (ExistingScripts.Num() != NewScripts.Num())
+			return true;
+
+		// Make order matter since we expect this array not to change much. It is therefore 
+		// more important that the compare function is fast, rather than we avoid re-creating the ThumbnailGeneratorScripts
+		for (int32 i = 0; i < NewScripts.Num(); i++)
+		{
+			if (!IsValid(ExistingScripts[i]) || NewScripts[i].Get() != ExistingScripts[i]->GetClass())
+				return true;
+		}
+
+		return false;
+	};
+
+	if (!AreScriptsDifferent(ThumbnailGeneratorScripts, ThumbnailSettings.ThumbnailGeneratorScripts))
+		return false;
+
+	// Scripts are pooled rather than destroyed, so switching back and forth between script sets doesn't create new objects
+	for (UThumbnailGeneratorScript* ThumbnailGeneratorScript : ThumbnailGeneratorScripts)
+	{
+		if (IsValid(ThumbnailGeneratorScript))
+		{
+			PooledThumbnailGeneratorScripts.Add(ThumbnailGeneratorScript);
+		}
+	}
+
+	ThumbnailGeneratorScripts.Reset();
+
+	for (const TSubclassOf<UThumbnailGeneratorScript>& ThumbnailGeneratorScript : ThumbnailSettings.ThumbnailGeneratorScripts)
+	{
+		if (!ThumbnailGeneratorScript.Get())
+			continue;
+
+		const int32 PooledIndex = PooledThumbnailGeneratorScripts.IndexOfByPredicate([&](const UThumbnailGeneratorScript* PooledScript)
+		{
+			return IsValid(PooledScript) && PooledScript->GetClass() == ThumbnailGeneratorScript.Get() && PooledScript->GetWorld() == GetThumbnailWorld();
+		});
+
+		if (PooledIndex != INDEX_NONE)
+		{
+			ThumbnailGeneratorScripts.Add(PooledThumbnailGeneratorScripts[PooledIndex]);
+			PooledThumbnailGeneratorScripts.RemoveAt(PooledIndex, EAllowShrinking::No);
+		}
+		else
+		{
+			ThumbnailGeneratorScripts.Add(NewObject<UThumbnailGeneratorScript>(GetThumbnailWorld(), ThumbnailGeneratorScript.Get()));
+		}
 	}
 
+	return true;
+}
+
+UTextureRenderTarget2D* FThumbnailGenerator::FindOrCreateRenderTarget(const FThumbnailSettings& ThumbnailSettings)
+{
 	const auto RenderTargetWidth  = uint16(ThumbnailSettings.ThumbnailTextureWidth);
 	const auto RenderTargetHeight = uint16(ThumbnailSettings.ThumbnailTextureHeight);
 	const auto RenderBitDepth     = ThumbnailSettings.ThumbnailBitDepth;
@@ -655,31 +1763,34 @@ UTexture2D* FThumbnailGenerator::FinishGenerateActorThumbnail(AActor* Actor, con
 	UTextureRenderTarget2D* RenderTarget = RenderTargetCache->GetCachedItem(RenderTargetInfo);
 	if (!RenderTarget)
 	{
-		RenderTarget = ThumbnailGenerator::CreateTextureTarget(
-			GetTransientPackage(),
-			RenderTargetWidth,
-			RenderTargetHeight,
-			RenderBitDepth == EThumbnailBitDepth::E8 ? ETextureRenderTargetFormat::RTF_RGBA8_SRGB : ETextureRenderTargetFormat::RTF_RGBA16f,
-			FLinearColor(0.f, 0.f, 0.f, 1.f) // Important: When rendering with MSAA the alpha will no be touched, setting it as 0 would leave the whole image fully transparent
-		);
-
+		RenderTarget = ThumbnailGenerator::CreateThumbnailRenderTarget(ThumbnailSettings);
 		if (!ensure(RenderTarget))
-		{
-			return EjectWithError("Could not create a render target for thumbnail capture");
-		}
+			return nullptr;
 
 		RenderTargetCache->CacheItem(RenderTargetInfo, RenderTarget);
 	}
 
-	UTexture2D* const Thumbnail = CaptureThumbnail(ThumbnailSettings, RenderTarget, Actor, ResourceObject);
-	if (!Thumbnail)
+	return RenderTarget;
+}
+
+UTextureRenderTarget2D* FThumbnailGenerator::FindOrCreatePipelineRenderTarget(const FThumbnailSettings& ThumbnailSettings, int32 Index)
+{
+	if (Index >= PipelineRenderTargets.Num())
+		PipelineRenderTargets.SetNum(Index + 1);
+
+	// Only replaced once the slot has been released, at which point the readback of the previous capture has been resolved
+	TObjectPtr<UTextureRenderTarget2D>& RenderTarget = PipelineRenderTargets[Index];
+	if (!IsValid(RenderTarget)
+		|| RenderTarget->SizeX != ThumbnailSettings.ThumbnailTextureWidth
+		|| RenderTarget->SizeY != ThumbnailSettings.ThumbnailTextureHeight
+		|| RenderTarget->RenderTargetFormat != ThumbnailGenerator::GetRenderTargetFormat(ThumbnailSettings))
 	{
-		return EjectWithError("Failed to generate thumbnail texture");
+		RenderTarget = ThumbnailGenerator::CreateThumbnailRenderTarget(ThumbnailSettings);
+		if (!ensure(RenderTarget))
+			return nullptr;
 	}
 
-	CleanupThumbnailCapture();
-
-	return Thumbnail;
+	return RenderTarget;
 }
 
 void FThumbnailGenerator::InitializeThumbnailWorld(const FThumbnailBackgroundSceneSettings &BackgroundSceneSettings)
@@ -718,8 +1829,27 @@ void FThumbnailGenerator::InitializeThumbnailWorld(const FThumbnailBackgroundSce
 	if (!RenderTargetCache.IsValid())
 		RenderTargetCache = MakeShareable(new FRenderTargetCache);
 
+	if (!PropertyOverrides.IsValid())
+		PropertyOverrides = MakeShared<ThumbnailGenerator::FThumbnailPropertyOverrides>();
+
+	if (!BoundsCache.IsValid())
+	{
+		BoundsCache = MakeShared<ThumbnailGenerator::FThumbnailBoundsCache>();
+
+		// Uncooked builds calculate the bounds, the precomputed bounds might be out of date with the actor blueprints
+		if (FPlatformProperties::RequiresCookedData())
+			BoundsCache->SetPrecomputedBounds(UThumbnailGeneratorSettings::Get()->PrecomputedThumbnailBounds.LoadSynchronous());
+	}
+
 	if (!WidgetRenderer.IsValid())
 		WidgetRenderer = MakeShareable(new FWidgetRenderer(false, false));
+
+	if (ThumbnailGenerator::ShouldUseCPUCaptureBackend())
+		CaptureBackend = ThumbnailGenerator::CreateCPUCaptureBackend(GetScratchBuffers());
+	else
+		CaptureBackend = ThumbnailGenerator::CreateSceneCaptureBackend(CaptureComponent, WidgetRenderer, GetCaptureSource(), GetScratchBuffers());
+
+	UE_LOG(LogThumbnailGenerator, Log, TEXT("Thumbnail capture backend: %s"), CaptureBackend->GetBackendName());
 }
 
 void FThumbnailGenerator::InvalidateThumbnailWorld()
@@ -730,11 +1860,36 @@ void FThumbnailGenerator::InvalidateThumbnailWorld()
 		CaptureComponent = nullptr;
 	}
 
+	CaptureBackend.Reset();
+
+	// Pooled widgets and scripts belong to the thumbnail world
+	for (UUserWidget* Widget : PooledThumbnailWidgets)
+	{
+		if (IsValid(Widget))
+			Widget->MarkAsGarbage();
+	}
+	PooledThumbnailWidgets.Empty();
+
+	for (UThumbnailGeneratorScript* ThumbnailGeneratorScript : PooledThumbnailGeneratorScripts)
+	{
+		if (IsValid(ThumbnailGeneratorScript))
+			ThumbnailGeneratorScript->MarkAsGarbage();
+	}
+	PooledThumbnailGeneratorScripts.Empty();
+
+	// Batches are flushed before they return, so no readback of these is pending
+	PipelineRenderTargets.Empty();
+
+	DestroyPooledThumbnailActors();
+	ActivePooledActor = FPooledThumbnailActor();
+	bActivePooledActorNeedsReset = false;
+
 	if (ThumbnailScene.IsValid())
 		ThumbnailScene.Reset();
 
 	bIsCapturingThumbnail = false;
-	ThumbnailSceneActors.Empty();
+	SpawnedThumbnailActors.Empty();
+	ActorSpawnedDelegateHandle.Reset();
 }
 
 UWorld* FThumbnailGenerator::GetThumbnailWorld() const
@@ -747,126 +1902,55 @@ ESceneCaptureSource FThumbnailGenerator::GetCaptureSource() const
 	return IsFeatureLevelSupported(GMaxRHIShaderPlatform, ERHIFeatureLevel::SM5) ? ESceneCaptureSource::SCS_FinalColorHDR : ESceneCaptureSource::SCS_FinalColorLDR;
 }
 
-UTexture2D* FThumbnailGenerator::CaptureThumbnail(const FThumbnailSettings& ThumbnailSettings, UTextureRenderTarget2D* RenderTarget, AActor* Actor, UTexture2D* ResourceObject)
+FMinimalViewInfo FThumbnailGenerator::CalculateThumbnailView(const FThumbnailSettings& ThumbnailSettings, AActor* Actor)
 {
-	QUICK_SCOPE_CYCLE_COUNTER(STAT_CaptureThumbnail);
+	THUMBNAIL_STAGE_SCOPE(Framing);
 
 	const bool bIsPerspective = ThumbnailSettings.ProjectionType == ECameraProjectionMode::Perspective;
 	const bool bAutoFrameCamera = !(ThumbnailSettings.bOverride_CustomCameraLocation ||
 									ThumbnailSettings.bOverride_CustomCameraRotation ||
 									(!bIsPerspective && ThumbnailSettings.bOverride_CustomOrthoWidth));
 
-	FMinimalViewInfo CaptureComponentView;
-	CaptureComponentView.ProjectionMode = ThumbnailSettings.ProjectionType;
-
-	if (bAutoFrameCamera)
-	{
-		const auto CameraRotation = ThumbnailSettings.CameraRotationOffset.Quaternion() * ThumbnailSettings.CameraOrbitRotation.Quaternion();
+	FMinimalViewInfo ThumbnailView;
+	ThumbnailView.ProjectionMode = ThumbnailSettings.ProjectionType;
 
-		const float AspectRatio = ThumbnailSettings.ThumbnailTextureWidth > 0 && ThumbnailSettings.ThumbnailTextureHeight > 0 
-			? (float)ThumbnailSettings.ThumbnailTextureWidth / (float)ThumbnailSettings.ThumbnailTextureHeight
-			: 1.f;
+	// Debug bounds are drawn while the bounds are calculated, so they are never cached
+	const int32 MaxBoundsCacheSize = UThumbnailGeneratorSettings::Get()->MaxThumbnailBoundsCacheSize;
+	const FThumbnailRequestKey BoundsKey = BoundsCache.IsValid() && MaxBoundsCacheSize > 0 && !ThumbnailSettings.bDebugBounds ? BoundsCache->GetCaptureKey() : FThumbnailRequestKey();
+	const FThumbnailRequestKey ViewKey = bAutoFrameCamera && BoundsKey.IsValid() 
+		? ThumbnailGenerator::ComputeViewKey(BoundsKey, ThumbnailSettings, Actor->GetActorTransform()) 
+		: FThumbnailRequestKey();
 
-		const static auto CalcActorLocalThumbnailBounds = [](AActor* InActor, const FThumbnailSettings& InThumbnailSettings, bool bDrawDebug)->FBox
+	ThumbnailGenerator::FThumbnailBoundsCache::FCachedView CachedView;
+	if (ViewKey.IsValid() && BoundsCache->FindView(ViewKey, CachedView))
+	{
+		if (ThumbnailSettings.bSnapToFloor)
 		{
-			const static TFunction<bool(UActorComponent*, const TSet<UClass*>&)> IsBlacklisted = [](UActorComponent* InComponent, const TSet<UClass*>& Blacklist)->bool
-			{
-				for (UClass* BlacklistedClass : Blacklist)
-				{
-					if (InComponent->IsA(BlacklistedClass))
-						return true;
-				}
-
-				// Check if our owner is blacklisted, useful for components that are auto-generated such as the Text3DComponent
-				if (UActorComponent* PrimitiveParentComponent = Cast<UActorComponent>(InComponent->GetOuter()))
-				{
-					return IsBlacklisted(PrimitiveParentComponent, Blacklist);
-				}
-
-				return false;
-			};
-
-			const static auto CalcPrimitiveBounds = [](UPrimitiveComponent* InPrimitiveComponent)->FBox
-			{
-				FBox OutBounds(EForceInit::ForceInit);
-				if (InPrimitiveComponent->bUseAttachParentBound && InPrimitiveComponent->GetAttachParent() != nullptr)
-					return OutBounds;
-
-				const static auto CalcSkinnedMeshLocalBounds = [](USkinnedMeshComponent* SkinnedMeshComponent)->FBox
-				{
-					const auto LODIndex = 0;
-
-					const USkeletalMesh* SkeletalMesh = Cast<USkeletalMesh>(SkinnedMeshComponent->GetSkinnedAsset());
-					if (!IsValid(SkeletalMesh) 
-						|| !SkeletalMesh->GetResourceForRendering()
-						|| !SkeletalMesh->GetResourceForRendering()->LODRenderData.IsValidIndex(LODIndex))
-						return SkinnedMeshComponent->CalcBounds(FTransform::Identity).GetBox();
-
-					const FSkeletalMeshLODRenderData& SkelMeshLODData = SkeletalMesh->GetResourceForRendering()->LODRenderData[LODIndex];
-					const FSkinWeightVertexBuffer* SkinWeightBuffer = SkinnedMeshComponent->GetSkinWeightBuffer(LODIndex);
-					if (!SkinWeightBuffer)
-						return SkinnedMeshComponent->CalcBounds(FTransform::Identity).GetBox();
-
-					TArray<FVector3f> VertexPositions;
-					TArray<FMatrix44f> CachedRefToLocals;
-					SkinnedMeshComponent->CacheRefToLocalMatrices(CachedRefToLocals);
-					USkinnedMeshComponent::ComputeSkinnedPositions(SkinnedMeshComponent, VertexPositions, CachedRefToLocals, SkelMeshLODData, *SkinWeightBuffer);
-
-					FBox Bounds(EForceInit::ForceInit);
-					for (const FVector3f& Position : VertexPositions)
-						Bounds += FVector(Position.X, Position.Y, Position.Z);
-
-					return Bounds;
-				};
-
-				if (USkinnedMeshComponent* SkinnedMeshComponent = Cast<USkeletalMeshComponent>(InPrimitiveComponent))
-					OutBounds = CalcSkinnedMeshLocalBounds(SkinnedMeshComponent);
-				else
-					OutBounds = InPrimitiveComponent->CalcBounds(FTransform::Identity).GetBox();
-
-				const FTransform& ActorTransform = InPrimitiveComponent->GetOwner()->GetActorTransform();
-				const FTransform& ComponentTransform = InPrimitiveComponent->GetComponentTransform();
-				const FTransform ComponentActorSpaceTransform = ComponentTransform.GetRelativeTransform(ActorTransform);
-
-				return OutBounds.TransformBy(ComponentActorSpaceTransform);
-			};
+			const FVector ActorLocaton = Actor->GetActorLocation();
+			Actor->SetActorLocation(FVector(ActorLocaton.X, ActorLocaton.Y, ActorLocaton.Z - CachedView.SnapToFloorOffset));
+		}
 
-			FBox Box(EForceInit::ForceInit);
-			for (UActorComponent* ActorComponent : InActor->GetComponents())
-			{
-				UPrimitiveComponent* PrimComp = Cast<UPrimitiveComponent>(ActorComponent);
-				if (PrimComp && PrimComp->IsRegistered()
-					&& (PrimComp->IsVisible() || InThumbnailSettings.bIncludeHiddenComponentsInBounds)
-					&& !IsBlacklisted(PrimComp, InThumbnailSettings.ComponentBoundsBlacklist))
-				{
-					const FBox PrimitiveBounds = CalcPrimitiveBounds(PrimComp);
-					Box += PrimitiveBounds;
+		ThumbnailView.Location   = CachedView.Location;
+		ThumbnailView.Rotation   = CachedView.Rotation;
+		ThumbnailView.FOV        = CachedView.FOV;
+		ThumbnailView.OrthoWidth = CachedView.OrthoWidth;
+	}
+	else if (bAutoFrameCamera)
+	{
+		const uint64 FramingStartCycles = FPlatformTime::Cycles64();
 
-					if (bDrawDebug)
-					{
-						const FTransform& ActorTransform = InActor->GetActorTransform();
-						DrawDebugBox(
-							PrimComp->GetWorld(), 
-							ActorTransform.TransformPosition(PrimitiveBounds.GetCenter()), 
-							PrimitiveBounds.GetExtent() * ActorTransform.GetScale3D(), 
-							ActorTransform.GetRotation(), 
-							FColor::Red, 
-							true,
-							-1.f, 
-							-1
-						);
-					}
-				}
-			}
+		const auto CameraRotation = ThumbnailSettings.CameraRotationOffset.Quaternion() * ThumbnailSettings.CameraOrbitRotation.Quaternion();
 
-			return Box;
-		};
+		const float AspectRatio = ThumbnailSettings.ThumbnailTextureWidth > 0 && ThumbnailSettings.ThumbnailTextureHeight > 0 
+			? (float)ThumbnailSettings.ThumbnailTextureWidth / (float)ThumbnailSettings.ThumbnailTextureHeight
+			: 1.f;
 
 		const FTransform& ActorTransform = Actor->GetActorTransform();
 
-		const FBox    LocalBoundingBox  = ThumbnailSettings.bOverride_CustomActorBounds ? ThumbnailSettings.CustomActorBounds : CalcActorLocalThumbnailBounds(Actor, ThumbnailSettings, ThumbnailSettings.bDebugBounds);
-		const FVector LocalBoundsExtent = LocalBoundingBox.GetExtent();
-		const FVector LocalBoundsOrigin = LocalBoundingBox.GetCenter();
+		const FBox    LocalBoundingBox  = CalculateThumbnailBounds(ThumbnailSettings, Actor);
+		const FBox    FramedBoundingBox = ThumbnailGenerator::CenterBoundsOnFocusPoint(Actor, LocalBoundingBox);
+		const FVector LocalBoundsExtent = FramedBoundingBox.GetExtent();
+		const FVector LocalBoundsOrigin = FramedBoundingBox.GetCenter();
 		const FVector LocalBoundsMin    = LocalBoundsOrigin - LocalBoundsExtent;
 		const FVector LocalBoundsMax    = LocalBoundsOrigin + LocalBoundsExtent;
 
@@ -884,6 +1968,7 @@ UTexture2D* FThumbnailGenerator::CaptureThumbnail(const FThumbnailSettings& Thum
 			ActorTransform.TransformPosition({ LocalBoundsMax.X, LocalBoundsMin.Y, LocalBoundsMax.Z }),
 		};
 
+		float SnapToFloorOffset = 0.f;
 		if (ThumbnailSettings.bSnapToFloor)
 		{
 			float MinZLocation = BIG_NUMBER;
@@ -900,6 +1985,8 @@ UTexture2D* FThumbnailGenerator::CaptureThumbnail(const FThumbnailSettings& Thum
 			{
 				Vertex.Z -= MinZLocation;
 			}
+
+			SnapToFloorOffset = MinZLocation;
 		}
 
 		if (ThumbnailSettings.bDebugBounds)
@@ -1118,8 +2205,8 @@ UTexture2D* FThumbnailGenerator::CaptureThumbnail(const FThumbnailSettings& Thum
 				? ThumbnailSettings.CameraDistanceOverride
 				: AutoLocation.X + ThumbnailSettings.CameraDistanceOffset;
 
-			CaptureComponentView.Location = CameraRotation.RotateVector(AutoLocation);
-			CaptureComponentView.FOV      = ThumbnailSettings.CameraFOV;
+			ThumbnailView.Location = CameraRotation.RotateVector(AutoLocation);
+			ThumbnailView.FOV      = ThumbnailSettings.CameraFOV;
 		}
 		else
 		{
@@ -1178,151 +2265,649 @@ UTexture2D* FThumbnailGenerator::CaptureThumbnail(const FThumbnailSettings& Thum
 			};
 
 			const FOrthographicView OrthographicView = CalculateOrthographicView(AspectRatio, ThumbnailSettings, BoundsVerticesInCameraSpace);
-			CaptureComponentView.OrthoWidth = ThumbnailSettings.bOverride_OrthoWidthOverride 
+			ThumbnailView.OrthoWidth = ThumbnailSettings.bOverride_OrthoWidthOverride 
 				? ThumbnailSettings.OrthoWidthOverride
 				: OrthographicView.OrthoWidth + ThumbnailSettings.OrthoWidthOffset;
-			CaptureComponentView.Location   = CameraRotation.RotateVector(OrthographicView.CameraLocation);
+			ThumbnailView.Location   = CameraRotation.RotateVector(OrthographicView.CameraLocation);
 		}
 
-		CaptureComponentView.Location += CameraRotation.RotateVector(ThumbnailSettings.CameraPositionOffset);
-		CaptureComponentView.Rotation = CameraRotation.Rotator();
+		ThumbnailView.Location += CameraRotation.RotateVector(ThumbnailSettings.CameraPositionOffset);
+		ThumbnailView.Rotation = CameraRotation.Rotator();
+
+		if (ViewKey.IsValid())
+		{
+			CachedView.Location          = ThumbnailView.Location;
+			CachedView.Rotation          = ThumbnailView.Rotation;
+			CachedView.FOV               = ThumbnailView.FOV;
+			CachedView.OrthoWidth        = ThumbnailView.OrthoWidth;
+			CachedView.SnapToFloorOffset = SnapToFloorOffset;
+			BoundsCache->AddView(ViewKey, CachedView, FPlatformTime::ToSeconds64(FPlatformTime::Cycles64() - FramingStartCycles), MaxBoundsCacheSize);
+		}
 	}
 	else
 	{
-		CaptureComponentView.Location = ThumbnailSettings.CustomCameraLocation;
-		CaptureComponentView.Rotation = ThumbnailSettings.CustomCameraRotation;
-		CaptureComponentView.OrthoWidth = ThumbnailSettings.CustomOrthoWidth;
+		ThumbnailView.Location = ThumbnailSettings.CustomCameraLocation;
+		ThumbnailView.Rotation = ThumbnailSettings.CustomCameraRotation;
+		ThumbnailView.OrthoWidth = ThumbnailSettings.CustomOrthoWidth;
 	}
 	
-	CaptureComponentView.PostProcessBlendWeight = 1.f;
-	CaptureComponentView.PostProcessSettings    = ThumbnailSettings.PostProcessingSettings;
+	ThumbnailView.PostProcessBlendWeight = 1.f;
+	ThumbnailView.PostProcessSettings    = ThumbnailSettings.PostProcessingSettings;
+
+	// The Vignette effect is current broken on mobile so make sure to disable it
+	#if (PLATFORM_ANDROID || PLATFORM_IOS)
+	ThumbnailView.PostProcessSettings.bOverride_VignetteIntensity = true;
+	ThumbnailView.PostProcessSettings.VignetteIntensity           = 0.f;
+	#endif
+
+	ThumbnailView.AspectRatio = ThumbnailSettings.ThumbnailTextureWidth > 0 && ThumbnailSettings.ThumbnailTextureHeight > 0 
+		? (float)ThumbnailSettings.ThumbnailTextureWidth / (float)ThumbnailSettings.ThumbnailTextureHeight
+		: 1.f;
+
+	return ThumbnailView;
+}
+
+FBox FThumbnailGenerator::CalculateThumbnailBounds(const FThumbnailSettings& ThumbnailSettings, AActor* Actor)
+{
+	THUMBNAIL_STAGE_SCOPE(Bounds);
+
+	if (ThumbnailSettings.bOverride_CustomActorBounds)
+		return ThumbnailSettings.CustomActorBounds;
+
+	// Fast path, the actor knows its own bounds
+	FBox SuppliedBounds(EForceInit::ForceInit);
+	if (ThumbnailGenerator::GetActorSuppliedBounds(Actor, SuppliedBounds))
+		return SuppliedBounds;
+
+	// Debug bounds are drawn while the bounds are calculated, so they are never cached or precomputed
+	const int32 MaxBoundsCacheSize = UThumbnailGeneratorSettings::Get()->MaxThumbnailBoundsCacheSize;
+	const FThumbnailRequestKey CaptureKey = BoundsCache.IsValid() && !ThumbnailSettings.bDebugBounds ? BoundsCache->GetCaptureKey() : FThumbnailRequestKey();
+	const FThumbnailRequestKey BoundsKey = MaxBoundsCacheSize > 0 ? CaptureKey : FThumbnailRequestKey();
+
+	FBox CachedBounds(EForceInit::ForceInit);
+	if (CaptureKey.IsValid() && BoundsCache->FindPrecomputedBounds(CaptureKey, CachedBounds))
+		return CachedBounds;
+
+	if (BoundsKey.IsValid() && BoundsCache->FindBounds(BoundsKey, CachedBounds))
+		return CachedBounds;
+
+	const uint64 BoundsStartCycles = FPlatformTime::Cycles64();
+	const FBox Bounds = ThumbnailGenerator::CalcActorLocalBounds(Actor, ThumbnailSettings, ThumbnailSettings.bDebugBounds);
+
+	if (BoundsKey.IsValid())
+		BoundsCache->AddBounds(BoundsKey, Bounds, FPlatformTime::ToSeconds64(FPlatformTime::Cycles64() - BoundsStartCycles), MaxBoundsCacheSize);
+
+	return Bounds;
+}
+
+void FThumbnailGenerator::FlushThumbnailDebugLines()
+{
+	// Clear any debug lines drawn by our thumbnail actor
+	constexpr const UWorld::ELineBatcherType LineBatchersToFlush[] = 
+	{ 
+		UWorld::ELineBatcherType::World,
+		UWorld::ELineBatcherType::WorldPersistent,
+		UWorld::ELineBatcherType::Foreground,
+		UWorld::ELineBatcherType::ForegroundPersistent
+	};
+	ThumbnailScene->GetThumbnailWorld()->FlushLineBatchers(LineBatchersToFlush);
+}
+
+FThumbnailCaptureParams FThumbnailGenerator::MakeCaptureParams(const FThumbnailSettings& ThumbnailSettings, AActor* Actor, UTextureRenderTarget2D* RenderTarget, UTextureRenderTarget2D* AlphaRenderTarget, 
+	const FMinimalViewInfo* View)
+{
+	FThumbnailCaptureParams Params;
+	Params.View              = View ? *View : CalculateThumbnailView(ThumbnailSettings, Actor);
+	Params.Width             = ThumbnailSettings.ThumbnailTextureWidth;
+	Params.Height            = ThumbnailSettings.ThumbnailTextureHeight;
+	Params.PixelFormat       = ThumbnailSettings.ThumbnailBitDepth == EThumbnailBitDepth::E8 ? PF_B8G8R8A8 : PF_FloatRGBA;
+	Params.bCaptureAlpha     = ThumbnailSettings.bCaptureAlpha;
+	Params.AlphaBlendMode    = ThumbnailSettings.AlphaBlendMode;
+	Params.ThumbnailWidget   = FindOrCreateThumbnailWidget(ThumbnailSettings.ThumbnailUI);
+	Params.Actor             = Actor;
+	Params.RenderTarget      = RenderTarget;
+	Params.AlphaRenderTarget = AlphaRenderTarget;
+	return Params;
+}
+
+UTexture2D* FThumbnailGenerator::CaptureThumbnail(const FThumbnailSettings& ThumbnailSettings, UTextureRenderTarget2D* RenderTarget, AActor* Actor, UTexture2D* ResourceObject)
+{
+	THUMBNAIL_STAGE_SCOPE(Capture);
+
+	const FThumbnailCaptureParams CaptureParams = MakeCaptureParams(ThumbnailSettings, Actor, RenderTarget, nullptr);
+
+	UTexture2D* ThumbnailTexture = IsValid(ResourceObject) 
+		? ResourceObject
+		: AcquireThumbnailTexture(
+			FString::Printf(TEXT("%s_Thumbnail"), *Actor->GetName()), 
+			CaptureParams.Width, 
+			CaptureParams.Height,
+			CaptureParams.PixelFormat
+		);
+
+	if (!ThumbnailTexture)
+	{
+		FlushThumbnailDebugLines();
+		UE_LOG(LogThumbnailGenerator, Error, TEXT("CaptureThumbnail - Failed to construct Texture2D object"));
+		return nullptr;
+	}
+
+	const ThumbnailGenerator::FScopedCaptureAllocations CaptureAllocations(*GetScratchBuffers());
+	bool bCaptured = false;
+	if (ThumbnailTexture != ResourceObject)
+	{
+		// The backend writes the capture, with its alpha resolved, straight into the texture's mip. No intermediate copy of the image is made.
+		if (void* const TextureData = ThumbnailGenerator::LockTextureData(ThumbnailTexture, CaptureParams.Width, CaptureParams.Height, CaptureParams.PixelFormat))
+		{
+			bCaptured = CaptureBackend->CapturePixels(CaptureParams, TextureData);
+			ThumbnailGenerator::UnlockTextureData(ThumbnailTexture);
+		}
+	}
+	else
+	{
+		// The caller's texture is only resized and written once the capture has succeeded, a failed capture leaves it untouched
+		const int64 NumBytes = int64(CaptureParams.Width) * CaptureParams.Height * (CaptureParams.PixelFormat == PF_B8G8R8A8 ? sizeof(FColor) : sizeof(FFloat16Color));
+		TArray<uint8> Pixels = GetScratchBuffers()->Acquire(NumBytes);
+
+		if (CaptureBackend->CapturePixels(CaptureParams, Pixels.GetData()))
+		{
+			if (void* const TextureData = ThumbnailGenerator::LockTextureData(ThumbnailTexture, CaptureParams.Width, CaptureParams.Height, CaptureParams.PixelFormat))
+			{
+				FMemory::Memcpy(TextureData, Pixels.GetData(), NumBytes);
+				ThumbnailGenerator::UnlockTextureData(ThumbnailTexture);
+				bCaptured = true;
+			}
+		}
+
+		GetScratchBuffers()->Release(MoveTemp(Pixels));
+	}
+
+	FlushThumbnailDebugLines();
+
+	if (!bCaptured)
+	{
+		// A texture acquired for this capture goes back to the pool
+		if (ThumbnailTexture != ResourceObject)
+			ReleaseThumbnail(ThumbnailTexture);
+
+		UE_LOG(LogThumbnailGenerator, Error, TEXT("CaptureThumbnail - %s capture backend failed to capture the thumbnail"), CaptureBackend->GetBackendName());
+		return nullptr;
+	}
+
+	ThumbnailTexture->SRGB = true;
+	ThumbnailTexture->CompressionSettings = TextureCompressionSettings::TC_EditorIcon;
+	ThumbnailTexture->LODGroup = TextureGroup::TEXTUREGROUP_UI;
+
+	{
+		THUMBNAIL_STAGE_SCOPE(TextureUpload);
+		ThumbnailTexture->UpdateResource();
+	}
+
+	INC_DWORD_STAT(STAT_ThumbnailGenerator_NumThumbnails);
+
+	return ThumbnailTexture;
+}
+
+bool FThumbnailGenerator::EnqueuePipelinedCapture(const FThumbnailSettings& ThumbnailSettings, UTextureRenderTarget2D* RenderTarget, UTextureRenderTarget2D* AlphaRenderTarget, AActor* Actor,
+	ThumbnailGenerator::FThumbnailCapturePipeline& Pipeline, int32 Slot, TFunction<void(FThumbnailPixelData*)>&& OnPixelsReady)
+{
+	THUMBNAIL_STAGE_SCOPE(Capture);
+
+	const FThumbnailCaptureParams CaptureParams = MakeCaptureParams(ThumbnailSettings, Actor, RenderTarget, AlphaRenderTarget);
+
+	// The pixels are acquired when the capture is enqueued and released by the pipeline once it has completed
+	const ThumbnailGenerator::FScopedCaptureAllocations CaptureAllocations(*GetScratchBuffers());
+	FThumbnailPendingCapture PendingCapture;
+	const bool bCaptured = CaptureBackend->EnqueueCapture(CaptureParams, PendingCapture);
+
+	FlushThumbnailDebugLines();
+
+	if (!bCaptured)
+		return false;
+
+	const EThumbnailAlphaBlendMode AlphaBlendMode = ThumbnailSettings.AlphaBlendMode;
+	const uint32 RequestTraceId = CurrentRequestTraceId;
+	UClass* const ActorClass = Actor->GetClass();
+	PendingCapture.OnCompleted = [AlphaBlendMode, RequestTraceId, ActorClass, OnPixelsReady = MoveTemp(OnPixelsReady)](FThumbnailPixelData* Color, FThumbnailPixelData* Alpha)
+	{
+		THUMBNAIL_REQUEST_TRACE_SCOPE("Complete", RequestTraceId, ActorClass);
+
+		if (Color)
+			ThumbnailGenerator::ApplyCapturedAlpha(*Color, Alpha, AlphaBlendMode);
+
+		OnPixelsReady(Color);
+	};
+
+	Pipeline.Enqueue(Slot, MoveTemp(PendingCapture));
+	return true;
+}
+
+void FThumbnailGenerator::PrepareThumbnailCapture()
+{
+	UWorld* World = GetThumbnailWorld();
+	check(World != nullptr);
+
+	// Everything spawned from here on (the thumbnail actor, actors spawned by it, by scripts or by the UI) is destroyed by CleanupThumbnailCapture
+	SpawnedThumbnailActors.Reset();
+	ActorSpawnedDelegateHandle = World->AddOnActorSpawnedHandler(FOnActorSpawned::FDelegate::CreateRaw(this, &FThumbnailGenerator::OnThumbnailActorSpawned));
+
+	bIsCapturingThumbnail = true;
+}
+
+void FThumbnailGenerator::OnThumbnailActorSpawned(AActor* Actor)
+{
+	SpawnedThumbnailActors.Add(Actor);
+}
+
+void FThumbnailGenerator::CleanupThumbnailCapture()
+{
+	if (BoundsCache.IsValid())
+		BoundsCache->SetCaptureKey(FThumbnailRequestKey());
+
+	if (!bIsCapturingThumbnail)
+	{
+		return;
+	}
+
+	THUMBNAIL_STAGE_SCOPE(Cleanup);
+
+	UWorld* World = GetThumbnailWorld();
+	check(World != nullptr);
+
+	World->RemoveOnActorSpawnedHandler(ActorSpawnedDelegateHandle);
+	ActorSpawnedDelegateHandle.Reset();
+
+	ReleasePooledThumbnailActor();
+
+	// Child actors of a pooled actor are kept along with it
+	const auto IsPooledActor = [&](const AActor* Actor)
+	{
+		return PooledThumbnailActors.ContainsByPredicate([&](const FPooledThumbnailActor& PooledActor)
+		{
+			return Actor == PooledActor.Actor || Actor->IsOwnedBy(PooledActor.Actor) || Actor->IsAttachedTo(PooledActor.Actor);
+		});
+	};
+
+	if (SpawnedThumbnailActors.Num() > 0)
+	{
+		// The scene may spawn its actors (e.g. the sky sphere) on demand
+		const TSet<TObjectPtr<AActor>> PersistentActors = ThumbnailScene->GetPersistentActors();
+
+		for (AActor* Actor : SpawnedThumbnailActors)
+		{
+			if (IsValid(Actor) && !IsPooledActor(Actor) && !PersistentActors.Contains(Actor))
+			{
+				Actor->Destroy();
+			}
+		}
+	}
+
+	SpawnedThumbnailActors.Reset();
+
+	bIsCapturingThumbnail = false;
+}
+
+void FThumbnailGenerator::AddReferencedObjects(FReferenceCollector& Collector)
+{
+	Collector.AddReferencedObject(CaptureComponent);
+	Collector.AddReferencedObjects(ThumbnailGeneratorScripts);
+	Collector.AddReferencedObjects(SpawnedThumbnailActors);
+	Collector.AddReferencedObjects(PooledThumbnailTextures);
+	Collector.AddReferencedObjects(PooledThumbnailWidgets);
+	Collector.AddReferencedObjects(PooledThumbnailGeneratorScripts);
+	Collector.AddReferencedObjects(PipelineRenderTargets);
+	Collector.AddReferencedObject(ActivePooledActor.Actor);
+
+	if (PropertyOverrides.IsValid())
+		PropertyOverrides->AddReferencedObjects(Collector);
+
+	for (FPooledThumbnailActor& PooledActor : PooledThumbnailActors)
+		Collector.AddReferencedObject(PooledActor.Actor);
+}
+
+UTexture2D* FThumbnailGenerator::FindCachedThumbnail(TSubclassOf<AActor> ActorClass, const FThumbnailSettings& ThumbnailSettings, const TMap<FString, FString>& Properties)
+{
+	if (!ActorClass || UThumbnailGeneratorSettings::Get()->MaxThumbnailResultCacheSize <= 0)
+		return nullptr;
+
+	return FindCachedThumbnail(ThumbnailGenerator::ComputeRequestKey(ActorClass, ThumbnailSettings, Properties));
+}
+
+void FThumbnailGenerator::AddCachedThumbnail(TSubclassOf<AActor> ActorClass, const FThumbnailSettings& ThumbnailSettings, const TMap<FString, FString>& Properties, UTexture2D* Thumbnail)
+{
+	if (!ActorClass || !IsValid(Thumbnail) || UThumbnailGeneratorSettings::Get()->MaxThumbnailResultCacheSize <= 0)
+		return;
+
+	AddCachedThumbnail(ThumbnailGenerator::ComputeRequestKey(ActorClass, ThumbnailSettings, Properties), ActorClass, Thumbnail);
+}
+
+void FThumbnailGenerator::InvalidateCachedThumbnails(TSubclassOf<AActor> ActorClass)
+{
+	if (ActorClass && ThumbnailResultCache.IsValid())
+		ThumbnailResultCache->InvalidateClass(ActorClass);
+}
+
+void FThumbnailGenerator::ClearThumbnailResultCache()
+{
+	if (ThumbnailResultCache.IsValid())
+		ThumbnailResultCache->ClearCache();
+}
+
+FThumbnailResultCacheStats FThumbnailGenerator::GetThumbnailResultCacheStats() const
+{
+	FThumbnailResultCacheStats Stats;
+	if (ThumbnailResultCache.IsValid())
+	{
+		Stats.Hits                = ThumbnailResultCache->Hits;
+		Stats.Misses              = ThumbnailResultCache->Misses;
+		Stats.NumCachedThumbnails = ThumbnailResultCache->NumCachedItems();
+		Stats.MemoryFootprint     = int64(ThumbnailResultCache->GetTotalMemoryFootprint());
+	}
+	return Stats;
+}
+
+void FThumbnailGenerator::ClearThumbnailBoundsCache()
+{
+	if (BoundsCache.IsValid())
+		BoundsCache->Reset();
+}
+
+FThumbnailBoundsCacheStats FThumbnailGenerator::GetThumbnailBoundsCacheStats() const
+{
+	return BoundsCache.IsValid() ? BoundsCache->GetStats() : FThumbnailBoundsCacheStats();
+}
+
+void FThumbnailGenerator::ReleaseThumbnail(UTexture2D* Thumbnail)
+{
+	if (!IsValid(Thumbnail))
+		return;
+
+	// Textures owned by the caller (ResourceObject) or saved as assets are never reused
+	int32* NumHandouts = ThumbnailTextureHandouts.Find(Thumbnail);
+	if (!NumHandouts)
+		return;
+
+	// Other holders still use the texture
+	if (--(*NumHandouts) > 0)
+		return;
+
+	ThumbnailTextureHandouts.Remove(Thumbnail);
+
+	if (ThumbnailResultCache.IsValid())
+		ThumbnailResultCache->InvalidateThumbnail(Thumbnail);
+
+	const FTexturePlatformData* PlatformData = Thumbnail->GetPlatformData();
+	if (Thumbnail->GetPackage() != GetTransientPackage() || !PlatformData || !ThumbnailGenerator::IsValidPixelFormat(PlatformData->PixelFormat))
+		return;
+
+	const int64 MaxPoolSize = int64(UThumbnailGeneratorSettings::Get()->MaxPooledThumbnailTextureSize) * 1000 * 1000;
+	const int64 TextureSize = Thumbnail->CalcTextureMemorySizeEnum(TMC_AllMips);
+	if (TextureSize > MaxPoolSize || PooledThumbnailTextures.Contains(Thumbnail))
+		return;
+
+	UpdatePooledThumbnailTextureMemory();
+
+	// Make room by dropping the oldest textures, they are collected by the next GC
+	while (PooledThumbnailTextures.Num() > 0 && PooledThumbnailTextureMemory + TextureSize > MaxPoolSize)
+	{
+		PooledThumbnailTextureMemory -= PooledThumbnailTextures[0]->CalcTextureMemorySizeEnum(TMC_AllMips);
+		PooledThumbnailTextures.RemoveAt(0, EAllowShrinking::No);
+	}
+
+	PooledThumbnailTextures.Add(Thumbnail);
+	PooledThumbnailTextureMemory += TextureSize;
+	SET_MEMORY_STAT(STAT_ThumbnailGenerator_TexturePoolMemory, PooledThumbnailTextureMemory);
+}
+
+void FThumbnailGenerator::AddThumbnailHandout(UTexture2D* Thumbnail)
+{
+	if (int32* NumHandouts = Thumbnail ? ThumbnailTextureHandouts.Find(Thumbnail) : nullptr)
+		(*NumHandouts)++;
+}
+
+void FThumbnailGenerator::UpdatePooledThumbnailTextureMemory()
+{
+	// Pooled textures can be destroyed from the outside (e.g. MarkAsGarbage), so the memory is summed over the textures which are still around
+	PooledThumbnailTextures.RemoveAll([](const TObjectPtr<UTexture2D>& PooledTexture) { return !IsValid(PooledTexture); });
+
+	PooledThumbnailTextureMemory = 0;
+	for (UTexture2D* PooledTexture : PooledThumbnailTextures)
+		PooledThumbnailTextureMemory += PooledTexture->CalcTextureMemorySizeEnum(TMC_AllMips);
+
+	SET_MEMORY_STAT(STAT_ThumbnailGenerator_TexturePoolMemory, PooledThumbnailTextureMemory);
+}
+
+void FThumbnailGenerator::TrimPooledResources()
+{
+	PooledThumbnailTextures.Empty();
+	UpdatePooledThumbnailTextureMemory();
+
+	// Widgets and scripts are cheap, but they are created again on the next capture that needs them
+	for (UUserWidget* Widget : PooledThumbnailWidgets)
+	{
+		if (IsValid(Widget))
+			Widget->MarkAsGarbage();
+	}
+	PooledThumbnailWidgets.Empty();
+
+	for (UThumbnailGeneratorScript* ThumbnailGeneratorScript : PooledThumbnailGeneratorScripts)
+	{
+		if (IsValid(ThumbnailGeneratorScript))
+			ThumbnailGeneratorScript->MarkAsGarbage();
+	}
+	PooledThumbnailGeneratorScripts.Empty();
+
+	// Batches are flushed before they return, so no readback of these is pending
+	PipelineRenderTargets.Empty();
+
+	DestroyPooledThumbnailActors();
+
+	if (PropertyOverrides.IsValid())
+		PropertyOverrides->Reset();
+
+	ClearThumbnailBoundsCache();
+
+	if (ScratchBuffers.IsValid())
+		ScratchBuffers->Trim();
+}
+
+UTexture2D* FThumbnailGenerator::AcquireThumbnailTexture(const FString& Name, int32 SizeX, int32 SizeY, EPixelFormat PixelFormat)
+{
+	// Textures which are never released are collected once their holders drop them, forget about them every now and then
+	if (ThumbnailTextureHandouts.Num() >= NextThumbnailHandoutsPurge)
+	{
+		for (auto It = ThumbnailTextureHandouts.CreateIterator(); It; ++It)
+		{
+			if (!It->Key.ResolveObjectPtr())
+				It.RemoveCurrent();
+		}
+		NextThumbnailHandoutsPurge = FMath::Max(256, ThumbnailTextureHandouts.Num() * 2);
+	}
+
+	UTexture2D* Texture = nullptr;
+	for (int32 i = 0; i < PooledThumbnailTextures.Num(); i++)
+	{
+		UTexture2D* PooledTexture = PooledThumbnailTextures[i];
+		if (!IsValid(PooledTexture) || PooledTexture->GetSizeX() != SizeX || PooledTexture->GetSizeY() != SizeY || PooledTexture->GetPixelFormat() != PixelFormat)
+			continue;
+
+		PooledThumbnailTextures.RemoveAt(i, EAllowShrinking::No);
+		UpdatePooledThumbnailTextureMemory();
+		Texture = PooledTexture;
+		break;
+	}
+
+	if (!Texture)
+		Texture = ThumbnailGenerator::ConstructTransientTexture2D(GetTransientPackage(), Name, SizeX, SizeY, PixelFormat);
+
+	// Handed out once, to the caller which acquired it
+	if (Texture)
+		ThumbnailTextureHandouts.Add(Texture, 1);
+
+	return Texture;
+}
+
+UUserWidget* FThumbnailGenerator::FindOrCreateThumbnailWidget(TSubclassOf<UUserWidget> WidgetClass)
+{
+	if (!WidgetClass.Get() || WidgetClass->HasAnyClassFlags(CLASS_Abstract))
+		return nullptr;
+
+	// ThumbnailUI doesn't receive any per-thumbnail data, so a single instance per class can be drawn for every capture
+	for (UUserWidget* PooledWidget : PooledThumbnailWidgets)
+	{
+		if (IsValid(PooledWidget) && PooledWidget->GetClass() == WidgetClass.Get())
+			return PooledWidget;
+	}
+
+	UUserWidget* Widget = CreateWidget(GetThumbnailWorld(), WidgetClass);
+	if (Widget)
+		PooledThumbnailWidgets.Add(Widget);
+
+	return Widget;
+}
+
+AActor* FThumbnailGenerator::AcquirePooledThumbnailActor(UClass* ActorClass)
+{
+	UWorld* const ThumbnailWorld = GetThumbnailWorld();
+
+	const int32 PooledIndex = PooledThumbnailActors.IndexOfByPredicate([&](const FPooledThumbnailActor& PooledActor)
+	{
+		return IsValid(PooledActor.Actor) && PooledActor.Actor->GetClass() == ActorClass && PooledActor.Actor->GetWorld() == ThumbnailWorld;
+	});
+
+	if (PooledIndex == INDEX_NONE)
+		return nullptr;
 
-	// The Vignette effect is current broken on mobile so make sure to disable it
-	#if (PLATFORM_ANDROID || PLATFORM_IOS)
-	CaptureComponentView.PostProcessSettings.bOverride_VignetteIntensity = true;
-	CaptureComponentView.PostProcessSettings.VignetteIntensity           = 0.f;
-	#endif
+	THUMBNAIL_STAGE_SCOPE(SpawnActor);
 
-	CaptureComponent->SetCameraView(CaptureComponentView);
-	CaptureComponent->PostProcessSettings    = CaptureComponentView.PostProcessSettings;
-	CaptureComponent->PostProcessBlendWeight = CaptureComponentView.PostProcessBlendWeight;
-	CaptureComponent->bCameraCutThisFrame    = true; // Reset view each capture
-	CaptureComponent->TextureTarget          = RenderTarget;
+	const FPooledThumbnailActor PooledActor = MoveTemp(PooledThumbnailActors[PooledIndex]);
+	PooledThumbnailActors.RemoveAt(PooledIndex, EAllowShrinking::No);
 
-	TArray<uint8> AlphaOverride;
-	if (ThumbnailSettings.bCaptureAlpha)
-	{
-		QUICK_SCOPE_CYCLE_COUNTER(STAT_CaptureAlpha);
-		// I haven't been able to find a way of extracting the Alpha when capturing SCS_FinalColorHDR/SCS_FinalColorLDR.
-		// This is a bit of an ugly hack where we capture the scene again using SCS_SceneColorHDR
-		// and copy the alpha results into our main capture.
-		CaptureComponent->CaptureSource = ESceneCaptureSource::SCS_SceneColorHDR; 
-		CaptureComponent->CaptureScene();
-		CaptureComponent->CaptureSource = GetCaptureSource();
+	// The actor was restored to its spawned state when it was released, see ReleasePooledThumbnailActor.
+	// It is reset once the new property overrides have been applied, see FinishSpawningThumbnailActor
+	bActivePooledActorNeedsReset = true;
+	INC_DWORD_STAT(STAT_ThumbnailGenerator_PooledActorsReused);
+
+	return PooledActor.Actor;
+}
+
+void FThumbnailGenerator::FinishSpawningThumbnailActor(AActor* Actor)
+{
+	THUMBNAIL_STAGE_SCOPE(FinishSpawning);
 
-		AlphaOverride = ThumbnailGenerator::ExtractAlpha(RenderTarget, true);
+	if (!bActivePooledActorNeedsReset || Actor != ActivePooledActor.Actor)
+	{
+		Actor->FinishSpawning(FTransform::Identity);
+		return;
 	}
 
-	CaptureComponent->CaptureScene();
+	// A reused actor has already finished spawning, it only needs to catch up with its new properties
+	bActivePooledActorNeedsReset = false;
 
-	// Clear any debug lines drawn by our thumbnail actor
-	constexpr const UWorld::ELineBatcherType LineBatchersToFlush[] = 
-	{ 
-		UWorld::ELineBatcherType::World,
-		UWorld::ELineBatcherType::WorldPersistent,
-		UWorld::ELineBatcherType::Foreground,
-		UWorld::ELineBatcherType::ForegroundPersistent
-	};
-	ThumbnailScene->GetThumbnailWorld()->FlushLineBatchers(LineBatchersToFlush);
+	Actor->SetActorTransform(FTransform::Identity);
 
-	CaptureComponent->TextureTarget = nullptr;
+	const bool bHasReset = Actor->Implements<UThumbnailActorInterface>() && IThumbnailActorInterface::Execute_ResetThumbnailActor(Actor);
+	if (!IsValid(Actor))
+		return;
 
-	// Render UI if specified
-	if (ThumbnailSettings.ThumbnailUI.Get() != nullptr)
+	if (bHasReset)
 	{
-		if (UUserWidget* UserWidget = CreateWidget(CaptureComponent->GetWorld(), ThumbnailSettings.ThumbnailUI))
+		// The reset is responsible for the render state of the components it changes while they are registered (e.g. through their setters).
+		// Only the components it has unregistered or added are registered here.
+		TInlineComponentArray<UActorComponent*> Components(Actor);
+		for (UActorComponent* Component : Components)
 		{
-			WidgetRenderer->DrawWidget(RenderTarget, UserWidget->TakeWidget(), FVector2D(RenderTarget->SizeX, RenderTarget->SizeY), 0.f, false);
-			UserWidget->MarkAsGarbage();
+			if (IsValid(Component) && !Component->IsRegistered() && Component->bAutoRegister)
+				Component->RegisterComponent();
 		}
 	}
+	else
+	{
+		Actor->RerunConstructionScripts();
+	}
 
-	UTexture2D* ThumbnailTexture = IsValid(ResourceObject) 
-		? ResourceObject
-		: ThumbnailGenerator::ConstructTransientTexture2D(
-			GetTransientPackage(), 
-			FString::Printf(TEXT("%s_Thumbnail"), *Actor->GetName()), 
-			RenderTarget->SizeX, 
-			RenderTarget->SizeY,
-			RenderTarget->GetFormat()
-		);
+	Actor->SetActorHiddenInGame(false);
+}
 
-	if (!ThumbnailTexture)
+void FThumbnailGenerator::ReleasePooledThumbnailActor()
+{
+	const FPooledThumbnailActor ReleasedActor = MoveTemp(ActivePooledActor);
+	ActivePooledActor = FPooledThumbnailActor();
+	bActivePooledActorNeedsReset = false;
+
+	AActor* const Actor = ReleasedActor.Actor;
+	if (!IsValid(Actor))
+		return;
+
+	if (!ReleasedActor.bCanReuse || Actor->GetWorld() != GetThumbnailWorld() || !ThumbnailGenerator::RestoreArchetypeState(Actor))
 	{
-		UE_LOG(LogThumbnailGenerator, Error, TEXT("CaptureThumbnail - Failed to construct Texture2D object"));
-		return nullptr;
+		Actor->Destroy();
+		return;
 	}
 
-	ThumbnailGenerator::FillTextureDataFromRenderTarget(ThumbnailTexture, RenderTarget, AlphaOverride, ThumbnailSettings.AlphaBlendMode);
+	// Hidden actors are not rendered by the scene capture, idle actors must not show up in the thumbnails of other actors
+	Actor->SetActorHiddenInGame(true);
 
-	ThumbnailTexture->SRGB = true;
-	ThumbnailTexture->CompressionSettings = TextureCompressionSettings::TC_EditorIcon;
-	ThumbnailTexture->LODGroup = TextureGroup::TEXTUREGROUP_UI;
+	PooledThumbnailActors.Add(ReleasedActor);
 
-	return ThumbnailTexture;
+	const int32 MaxPooledActors = FMath::Max(0, UThumbnailGeneratorSettings::Get()->MaxPooledThumbnailActors);
+	while (PooledThumbnailActors.Num() > MaxPooledActors)
+	{
+		if (IsValid(PooledThumbnailActors[0].Actor))
+			PooledThumbnailActors[0].Actor->Destroy();
+
+		PooledThumbnailActors.RemoveAt(0, EAllowShrinking::No);
+	}
 }
 
-void FThumbnailGenerator::PrepareThumbnailCapture()
+void FThumbnailGenerator::DestroyPooledThumbnailActors()
 {
-	UWorld* World = GetThumbnailWorld();
-	check(World != nullptr);
-
-	ThumbnailSceneActors.Reset();
-	for (TActorIterator<AActor> It(World); It; ++It)
+	for (const FPooledThumbnailActor& PooledActor : PooledThumbnailActors)
 	{
-		ThumbnailSceneActors.Add(*It);
+		if (IsValid(PooledActor.Actor))
+			PooledActor.Actor->Destroy();
 	}
 
-	ThumbnailSceneActors.Append(ThumbnailScene->GetPersistentActors());
-
-	bIsCapturingThumbnail = true;
+	PooledThumbnailActors.Empty();
 }
 
-void FThumbnailGenerator::CleanupThumbnailCapture()
+TSharedRef<ThumbnailGenerator::FThumbnailScratchBuffers> FThumbnailGenerator::GetScratchBuffers()
 {
-	if (!bIsCapturingThumbnail)
+	if (!ScratchBuffers.IsValid())
 	{
-		return;
+		ScratchBuffers = MakeShared<ThumbnailGenerator::FThumbnailScratchBuffers>();
+		MemoryTrimDelegateHandle = FCoreDelegates::GetMemoryTrimDelegate().AddRaw(this, &FThumbnailGenerator::TrimPooledResources);
 	}
+	return ScratchBuffers.ToSharedRef();
+}
 
-	UWorld* World = GetThumbnailWorld();
-	check(World != nullptr);
+UTexture2D* FThumbnailGenerator::FindCachedThumbnail(const FThumbnailRequestKey& RequestKey)
+{
+	if (!ThumbnailResultCache.IsValid())
+		ThumbnailResultCache = MakeShareable(new FThumbnailResultCache);
 
-	TSet<TObjectPtr<AActor>> AllActors;
-	for (TActorIterator<AActor> It(World); It; ++It)
+	UTexture2D* Thumbnail = ThumbnailResultCache->GetCachedItem(RequestKey);
+	if (Thumbnail)
 	{
-		AllActors.Add(*It);
-	}
+		ThumbnailResultCache->Hits++;
 
-	TSet<TObjectPtr<AActor>> NewActors = AllActors.Difference(ThumbnailSceneActors);
-	for (TObjectPtr<AActor> Actor : NewActors)
+		// Every hit is another holder of the cached texture, which has to release it before the texture can be reused
+		AddThumbnailHandout(Thumbnail);
+	}
+	else
 	{
-		if (IsValid(Actor))
-		{
-			Actor->Destroy();
-		}
+		ThumbnailResultCache->Misses++;
 	}
 
-	ThumbnailSceneActors.Reset();
-
-	bIsCapturingThumbnail = false;
+	return Thumbnail;
 }
 
-void FThumbnailGenerator::AddReferencedObjects(FReferenceCollector& Collector)
+void FThumbnailGenerator::AddCachedThumbnail(const FThumbnailRequestKey& RequestKey, const UClass* ActorClass, UTexture2D* Thumbnail)
 {
-	Collector.AddReferencedObject(CaptureComponent);
-	Collector.AddReferencedObjects(ThumbnailGeneratorScripts);
-	Collector.AddReferencedObjects(ThumbnailSceneActors);
+	if (!ThumbnailResultCache.IsValid())
+		ThumbnailResultCache = MakeShareable(new FThumbnailResultCache);
+
+	ThumbnailResultCache->AddThumbnail(RequestKey, ActorClass, Thumbnail);
 }
 
 FString FThumbnailGenerator::GetReferencerName() const
@@ -1331,33 +2916,281 @@ FString FThumbnailGenerator::GetReferencerName() const
 }
 
 
+/*
+* FThumbnailRequestHandle
+*/
+
+EThumbnailRequestState FThumbnailRequestHandle::GetState() const
+{
+	return RequestState.IsValid() ? RequestState->State : EThumbnailRequestState::EInvalid;
+}
+
+bool FThumbnailRequestHandle::Cancel()
+{
+	return RequestState.IsValid() && ThumbnailGenerator::FThumbnailGeneratorTaskQueue::Get().CancelTask(RequestState.ToSharedRef());
+}
+
+bool FThumbnailRequestHandle::SetPriority(EThumbnailRequestPriority Priority)
+{
+	return RequestState.IsValid() && ThumbnailGenerator::FThumbnailGeneratorTaskQueue::Get().SetTaskPriority(RequestState.ToSharedRef(), Priority);
+}
+
+/*
+* FThumbnailAtlasLayout
+*/
+
+FThumbnailAtlasLayout FThumbnailAtlasLayout::Make(int32 NumTiles, int32 TileWidth, int32 TileHeight, int32 NumColumns)
+{
+	FThumbnailAtlasLayout Layout;
+	Layout.NumTiles   = FMath::Max(0, NumTiles);
+	Layout.NumColumns = NumColumns > 0 ? FMath::Min(NumColumns, FMath::Max(1, Layout.NumTiles)) : FMath::Max(1, FMath::CeilToInt32(FMath::Sqrt(float(Layout.NumTiles))));
+	Layout.NumRows    = FMath::Max(1, FMath::DivideAndRoundUp(Layout.NumTiles, Layout.NumColumns));
+	Layout.TileWidth  = TileWidth;
+	Layout.TileHeight = TileHeight;
+	return Layout;
+}
+
+FBox2D FThumbnailAtlasLayout::GetTileUVs(int32 TileIndex) const
+{
+	if (NumColumns <= 0 || NumRows <= 0)
+		return FBox2D(FVector2D::ZeroVector, FVector2D::ZeroVector);
+
+	const FVector2D TileSize(1.0 / NumColumns, 1.0 / NumRows);
+	const FVector2D Min((TileIndex % NumColumns) * TileSize.X, (TileIndex / NumColumns) * TileSize.Y);
+	return FBox2D(Min, Min + TileSize);
+}
+
 /*
 * UThumbnailGeneration 
 */
 
 UTexture2D* UThumbnailGeneration::GenerateThumbnail(TSubclassOf<AActor> ActorClass, const FThumbnailSettings& ThumbnailSettings, 
 	UTexture2D* ResourceObject, const TMap<FString, FString>& Properties)
+{
+	return GenerateThumbnailInternal(ActorClass, ThumbnailSettings, ResourceObject, Properties, ThumbnailGenerator::EmptyPropertyBag);
+}
+
+UTexture2D* UThumbnailGeneration::GenerateThumbnail(TSubclassOf<AActor> ActorClass, const FThumbnailSettings& ThumbnailSettings, UTexture2D* ResourceObject, const FInstancedPropertyBag& PropertyBag)
+{
+	return GenerateThumbnailInternal(ActorClass, ThumbnailSettings, ResourceObject, TMap<FString, FString>(), PropertyBag);
+}
+
+UTexture2D* UThumbnailGeneration::GenerateThumbnailInternal(TSubclassOf<AActor> ActorClass, const FThumbnailSettings& ThumbnailSettings, UTexture2D* ResourceObject, 
+	const TMap<FString, FString>& Properties, const FInstancedPropertyBag& PropertyBag)
+{
+	const FThumbnailSettings MergedThumbnailSettings = FThumbnailSettings::MergeThumbnailSettings(UThumbnailGeneratorSettings::Get()->DefaultThumbnailSettings, ThumbnailSettings);
+
+	// Thumbnails rendered into a user supplied resource object are never cached, the user owns that texture
+	const bool bUseResultCache = ActorClass && ResourceObject == nullptr && UThumbnailGeneratorSettings::Get()->MaxThumbnailResultCacheSize > 0;
+	if (!bUseResultCache)
+		return GThumbnailGenerator->GenerateActorThumbnailInternal(ActorClass, MergedThumbnailSettings, ResourceObject, Properties, PropertyBag, nullptr);
+
+	const FThumbnailRequestKey RequestKey = ThumbnailGenerator::ComputeRequestKey(ActorClass, MergedThumbnailSettings, Properties, &PropertyBag);
+	if (UTexture2D* CachedThumbnail = GThumbnailGenerator->FindCachedThumbnail(RequestKey))
+		return CachedThumbnail;
+
+	UTexture2D* Thumbnail = GThumbnailGenerator->GenerateActorThumbnailInternal(ActorClass, MergedThumbnailSettings, nullptr, Properties, PropertyBag, nullptr);
+	GThumbnailGenerator->AddCachedThumbnail(RequestKey, ActorClass, Thumbnail);
+	return Thumbnail;
+}
+
+TArray<UTexture2D*> UThumbnailGeneration::GenerateThumbnailViews(TSubclassOf<AActor> ActorClass, const FThumbnailSettings& ThumbnailSettings, const TArray<FRotator>& CameraOrbitRotations, 
+	const TMap<FString, FString>& Properties)
+{
+	const FThumbnailSettings MergedThumbnailSettings = FThumbnailSettings::MergeThumbnailSettings(UThumbnailGeneratorSettings::Get()->DefaultThumbnailSettings, ThumbnailSettings);
+	return GThumbnailGenerator->GenerateActorThumbnailViews(ActorClass, MergedThumbnailSettings, CameraOrbitRotations, Properties);
+}
+
+UTexture2D* UThumbnailGeneration::GenerateThumbnailAtlas(TSubclassOf<AActor> ActorClass, const FThumbnailSettings& ThumbnailSettings, const TArray<FRotator>& CameraOrbitRotations, 
+	FThumbnailAtlasLayout& OutLayout, int32 NumColumns, const TMap<FString, FString>& Properties)
+{
+	const FThumbnailSettings MergedThumbnailSettings = FThumbnailSettings::MergeThumbnailSettings(UThumbnailGeneratorSettings::Get()->DefaultThumbnailSettings, ThumbnailSettings);
+	return GThumbnailGenerator->GenerateActorThumbnailAtlas(ActorClass, MergedThumbnailSettings, CameraOrbitRotations, OutLayout, NumColumns, Properties);
+}
+
+TArray<FRotator> UThumbnailGeneration::MakeTurntableRotations(int32 NumViews, FRotator StartRotation)
+{
+	return FThumbnailGenerator::MakeTurntableRotations(NumViews, StartRotation);
+}
+
+UTexture2D* UThumbnailGeneration::GenerateThumbnailFlipbook(TSubclassOf<AActor> ActorClass, const FThumbnailSettings& ThumbnailSettings, int32 StepsPerFrame, bool bFrameEachFrame, 
+	FThumbnailAtlasLayout& OutLayout, int32 NumColumns, const TMap<FString, FString>& Properties)
 {
 	const FThumbnailSettings MergedThumbnailSettings = FThumbnailSettings::MergeThumbnailSettings(UThumbnailGeneratorSettings::Get()->DefaultThumbnailSettings, ThumbnailSettings);
-	return GThumbnailGenerator->GenerateActorThumbnail(ActorClass, MergedThumbnailSettings, ResourceObject, Properties);
+	return GThumbnailGenerator->GenerateActorThumbnailFlipbook(ActorClass, MergedThumbnailSettings, StepsPerFrame, bFrameEachFrame, OutLayout, NumColumns, Properties);
+}
+
+void UThumbnailGeneration::GetThumbnailAtlasTileUVs(const FThumbnailAtlasLayout& Layout, int32 TileIndex, FVector2D& OutUVMin, FVector2D& OutUVMax)
+{
+	const FBox2D TileUVs = Layout.GetTileUVs(TileIndex);
+	OutUVMin = TileUVs.Min;
+	OutUVMax = TileUVs.Max;
+}
+
+FThumbnailRequestHandle UThumbnailGeneration::GenerateThumbnailAsync(UClass* ActorClass, const FGenerateThumbnailCallbackNative& Callback, const FThumbnailSettings& ThumbnailSettings,
+	const FPreCaptureThumbnailNative& PreCaptureThumbnail, UTexture2D* ResourceObject, const TMap<FString, FString>& Properties, EThumbnailRequestPriority Priority)
+{
+	// We can't tell whether two native PreCapture delegates do the same thing, so such requests are never coalesced
+	return GenerateThumbnailAsyncInternal(ActorClass, Callback, ThumbnailSettings, PreCaptureThumbnail, FString(), ResourceObject, Properties, ThumbnailGenerator::EmptyPropertyBag, Priority);
+}
+
+FThumbnailRequestHandle UThumbnailGeneration::GenerateThumbnailAsync(UClass* ActorClass, const FGenerateThumbnailCallbackNative& Callback, const FThumbnailSettings& ThumbnailSettings,
+	const FPreCaptureThumbnailNative& PreCaptureThumbnail, UTexture2D* ResourceObject, const FInstancedPropertyBag& PropertyBag, EThumbnailRequestPriority Priority)
+{
+	return GenerateThumbnailAsyncInternal(ActorClass, Callback, ThumbnailSettings, PreCaptureThumbnail, FString(), ResourceObject, TMap<FString, FString>(), PropertyBag, Priority);
 }
 
-void UThumbnailGeneration::GenerateThumbnailAsync(UClass* ActorClass, const FGenerateThumbnailCallbackNative& Callback, const FThumbnailSettings& ThumbnailSettings,
-	const FPreCaptureThumbnailNative& PreCaptureThumbnail, UTexture2D* ResourceObject, const TMap<FString, FString>& Properties)
+FThumbnailRequestHandle UThumbnailGeneration::GenerateThumbnailAsyncInternal(UClass* ActorClass, const FGenerateThumbnailCallbackNative& Callback, const FThumbnailSettings& ThumbnailSettings,
+	const FPreCaptureThumbnailNative& PreCaptureThumbnail, const FString& PreCaptureIdentity, UTexture2D* ResourceObject, const TMap<FString, FString>& Properties, 
+	const FInstancedPropertyBag& PropertyBag, EThumbnailRequestPriority Priority)
 {
+	ThumbnailGenerator::FThumbnailGeneratorTaskQueue& TaskQueue = ThumbnailGenerator::FThumbnailGeneratorTaskQueue::Get();
+
+	// A bound PreCaptureThumbnail delegate can change the actor in ways we can't hash, so such requests are never cached.
+	// Identical requests can still share a single capture if they use the same PreCapture function.
+	const bool bUseResultCache = ActorClass && ResourceObject == nullptr && !PreCaptureThumbnail.IsBound() && UThumbnailGeneratorSettings::Get()->MaxThumbnailResultCacheSize > 0;
+	const bool bCanCoalesce    = ActorClass && ResourceObject == nullptr && (!PreCaptureThumbnail.IsBound() || !PreCaptureIdentity.IsEmpty());
+
+	FThumbnailRequestKey RequestKey;
+	if (bUseResultCache || bCanCoalesce)
+	{
+		const FThumbnailSettings MergedThumbnailSettings = FThumbnailSettings::MergeThumbnailSettings(UThumbnailGeneratorSettings::Get()->DefaultThumbnailSettings, ThumbnailSettings);
+		RequestKey = ThumbnailGenerator::ComputeRequestKey(ActorClass, MergedThumbnailSettings, Properties, &PropertyBag);
+	}
+
+	// Cache hits are returned immediately, without waiting for the task queue
+	if (bUseResultCache)
+	{
+		if (UTexture2D* CachedThumbnail = GThumbnailGenerator->FindCachedThumbnail(RequestKey))
+		{
+			Callback.ExecuteIfBound(CachedThumbnail);
+
+			TSharedPtr<FThumbnailRequestState> CompletedRequest = MakeShared<FThumbnailRequestState>();
+			CompletedRequest->State = EThumbnailRequestState::EDone;
+			return FThumbnailRequestHandle(CompletedRequest);
+		}
+	}
+
+	FThumbnailRequestKey CoalescingKey;
+	TSharedPtr<ThumbnailGenerator::FCoalescedThumbnailRequest> CoalescedRequest;
+	if (bCanCoalesce)
+	{
+		CoalescingKey = ThumbnailGenerator::FCoalescedThumbnailRequest::MakeKey(RequestKey, PreCaptureIdentity);
+
+		auto& InFlightRequests = ThumbnailGenerator::FCoalescedThumbnailRequest::GetInFlightRequests();
+		if (const TSharedRef<ThumbnailGenerator::FCoalescedThumbnailRequest>* InFlightRequest = InFlightRequests.Find(CoalescingKey))
+		{
+			const TSharedPtr<FThumbnailRequestState> SharedTask = (*InFlightRequest)->Task.Pin();
+			if (SharedTask.IsValid() && SharedTask->State == EThumbnailRequestState::EQueued)
+			{
+				TSharedRef<ThumbnailGenerator::FCoalescedThumbnailRequest> InFlight = *InFlightRequest;
+				return TaskQueue.AddSubscriber(SharedTask.ToSharedRef(), Priority, [InFlight, Callback]()
+				{
+					Callback.ExecuteIfBound(DeliverCoalescedThumbnail(*InFlight));
+				});
+			}
+		}
+
+		CoalescedRequest = MakeShared<ThumbnailGenerator::FCoalescedThumbnailRequest>();
+	}
+
 	TStrongObjectPtr<UClass> StrongClassPtr(ActorClass);
 	TStrongObjectPtr<UTexture2D> StrongResourceObject(ResourceObject);
-	ThumbnailGenerator::FThumbnailGeneratorTaskQueue::Get().TaskQueue.Add([StrongClassPtr, ThumbnailSettings, StrongResourceObject, Properties, Callback, PreCaptureThumbnail]()
+
+	// Keeps the objects referenced by the typed overrides alive while the request is queued
+	const TSharedPtr<ThumbnailGenerator::FReferencedPropertyBag> StrongPropertyBag = PropertyBag.IsValid() ? MakeShared<ThumbnailGenerator::FReferencedPropertyBag>(PropertyBag) : nullptr;
+
+	// Coalesced requests report their result through the shared request, the subscribers invoke the callbacks
+	const FGenerateThumbnailCallbackNative TaskCallback = bCanCoalesce ? FGenerateThumbnailCallbackNative() : Callback;
+
+	TSharedRef<FThumbnailRequestState> Task = TaskQueue.AddTask(Priority, [StrongClassPtr, ThumbnailSettings, StrongResourceObject, Properties, StrongPropertyBag, TaskCallback, PreCaptureThumbnail, bUseResultCache, RequestKey, CoalescingKey, CoalescedRequest]()
 	{
+		// Requests made from here on start a new capture, since this one might already be using stale inputs
+		if (CoalescedRequest.IsValid())
+		{
+			auto& InFlightRequests = ThumbnailGenerator::FCoalescedThumbnailRequest::GetInFlightRequests();
+			const TSharedRef<ThumbnailGenerator::FCoalescedThumbnailRequest>* InFlightRequest = InFlightRequests.Find(CoalescingKey);
+			if (InFlightRequest && &InFlightRequest->Get() == CoalescedRequest.Get())
+				InFlightRequests.Remove(CoalescingKey);
+		}
+
+		const auto FinishRequest = [&](UTexture2D* Thumbnail)
+		{
+			if (CoalescedRequest.IsValid())
+				CoalescedRequest->Thumbnail.Reset(Thumbnail);
+
+			TaskCallback.ExecuteIfBound(Thumbnail);
+		};
+
 		const FThumbnailSettings MergedThumbnailSettings = FThumbnailSettings::MergeThumbnailSettings(UThumbnailGeneratorSettings::Get()->DefaultThumbnailSettings, ThumbnailSettings);
-		AActor* ThumbnailActor = GThumbnailGenerator->BeginGenerateActorThumbnail(StrongClassPtr.Get(), MergedThumbnailSettings, Properties);
-		PreCaptureThumbnail.ExecuteIfBound(ThumbnailActor);
 
-		UTexture2D* Thumbnail = GThumbnailGenerator->FinishGenerateActorThumbnail(ThumbnailActor, MergedThumbnailSettings, StrongResourceObject.Get());
-		Callback.ExecuteIfBound(Thumbnail);
+		// An identical request might have been completed while this one was waiting in the queue
+		if (bUseResultCache)
+		{
+			if (UTexture2D* CachedThumbnail = GThumbnailGenerator->ThumbnailResultCache.IsValid() ? GThumbnailGenerator->ThumbnailResultCache->GetCachedItem(RequestKey) : nullptr)
+			{
+				GThumbnailGenerator->AddThumbnailHandout(CachedThumbnail);
+				FinishRequest(CachedThumbnail);
+				return;
+			}
+		}
+
+		const FInstancedPropertyBag& PropertyBag = StrongPropertyBag.IsValid() ? StrongPropertyBag->PropertyBag : ThumbnailGenerator::EmptyPropertyBag;
+
+		UTexture2D* Thumbnail = nullptr;
+		if (PreCaptureThumbnail.IsBound())
+		{
+			// The delegate can change the actor in any way, so it always gets an actor of its own
+			AActor* ThumbnailActor = GThumbnailGenerator->BeginGenerateActorThumbnailInternal(StrongClassPtr.Get(), MergedThumbnailSettings, Properties, PropertyBag, true, true, false);
+			PreCaptureThumbnail.Execute(ThumbnailActor);
+
+			Thumbnail = GThumbnailGenerator->FinishGenerateActorThumbnail(ThumbnailActor, MergedThumbnailSettings, StrongResourceObject.Get());
+		}
+		else // Without a PreCapture delegate the request can go through the disk cache
+		{
+			Thumbnail = GThumbnailGenerator->GenerateActorThumbnailInternal(StrongClassPtr.Get(), MergedThumbnailSettings, StrongResourceObject.Get(), Properties, PropertyBag, nullptr);
+		}
+
+		if (bUseResultCache)
+			GThumbnailGenerator->AddCachedThumbnail(RequestKey, StrongClassPtr.Get(), Thumbnail);
+
+		FinishRequest(Thumbnail);
+	});
+
+	if (!bCanCoalesce)
+		return FThumbnailRequestHandle(Task);
+
+	CoalescedRequest->Task = Task;
+
+	auto& InFlightRequests = ThumbnailGenerator::FCoalescedThumbnailRequest::GetInFlightRequests();
+	if (InFlightRequests.Num() >= ThumbnailGenerator::FCoalescedThumbnailRequest::PurgeThreshold)
+	{
+		// Drop entries left behind by cancelled requests
+		for (auto It = InFlightRequests.CreateIterator(); It; ++It)
+		{
+			const TSharedPtr<FThumbnailRequestState> InFlightTask = It->Value->Task.Pin();
+			if (!InFlightTask.IsValid() || InFlightTask->State != EThumbnailRequestState::EQueued)
+				It.RemoveCurrent();
+		}
+	}
+	InFlightRequests.Add(CoalescingKey, CoalescedRequest.ToSharedRef());
+
+	TSharedRef<ThumbnailGenerator::FCoalescedThumbnailRequest> InFlight = CoalescedRequest.ToSharedRef();
+	return TaskQueue.AddSubscriber(Task, Priority, [InFlight, Callback]()
+	{
+		Callback.ExecuteIfBound(DeliverCoalescedThumbnail(*InFlight));
 	});
 }
 
+UTexture2D* UThumbnailGeneration::DeliverCoalescedThumbnail(ThumbnailGenerator::FCoalescedThumbnailRequest& Request)
+{
+	// The capture hands the thumbnail out once, every further subscriber is another holder which has to release it
+	if (Request.NumDeliveries++ > 0)
+		GThumbnailGenerator->AddThumbnailHandout(Request.Thumbnail.Get());
+
+	return Request.Thumbnail.Get();
+}
+
 UWorld* UThumbnailGeneration::GetThumbnailWorld()
 {
 	return GThumbnailGenerator->GetThumbnailWorld();
@@ -1382,6 +3215,41 @@ UTexture2D* UThumbnailGeneration::SaveThumbnail(UTexture2D* Thumbnail, const FDi
 	return nullptr;
 }
 
+void UThumbnailGeneration::InvalidateCachedThumbnails(TSubclassOf<AActor> ActorClass)
+{
+	GThumbnailGenerator->InvalidateCachedThumbnails(ActorClass);
+}
+
+void UThumbnailGeneration::ClearThumbnailResultCache()
+{
+	GThumbnailGenerator->ClearThumbnailResultCache();
+}
+
+FThumbnailResultCacheStats UThumbnailGeneration::GetThumbnailResultCacheStats()
+{
+	return GThumbnailGenerator->GetThumbnailResultCacheStats();
+}
+
+void UThumbnailGeneration::ReleaseThumbnail(UTexture2D* Thumbnail)
+{
+	GThumbnailGenerator->ReleaseThumbnail(Thumbnail);
+}
+
+bool UThumbnailGeneration::CancelThumbnailRequest(FThumbnailRequestHandle& RequestHandle)
+{
+	return RequestHandle.Cancel();
+}
+
+bool UThumbnailGeneration::SetThumbnailRequestPriority(FThumbnailRequestHandle& RequestHandle, EThumbnailRequestPriority Priority)
+{
+	return RequestHandle.SetPriority(Priority);
+}
+
+EThumbnailRequestState UThumbnailGeneration::GetThumbnailRequestState(const FThumbnailRequestHandle& RequestHandle)
+{
+	return RequestHandle.GetState();
+}
+
 AActor* UThumbnailGeneration::K2_BeginGenerateThumbnail(UClass* ActorClass, const FThumbnailSettings& ThumbnailSettings)
 {
 	return GThumbnailGenerator->BeginGenerateActorThumbnail(ActorClass, ThumbnailSettings, TMap<FString, FString>(), false);
@@ -1392,16 +3260,21 @@ UTexture2D* UThumbnailGeneration::K2_FinishGenerateThumbnail(AActor* Actor, cons
 	return GThumbnailGenerator->FinishGenerateActorThumbnail(Actor, ThumbnailSettings, nullptr, false);
 }
 
-void UThumbnailGeneration::K2_GenerateThumbnailAsync(UClass* ActorClass, FThumbnailSettings ThumbnailSettings, 
-	TMap<FString, FString> Properties, FGenerateThumbnailCallback Callback, FPreCaptureThumbnail PreCaptureThumbnail)
+FThumbnailRequestHandle UThumbnailGeneration::K2_GenerateThumbnailAsync(UClass* ActorClass, FThumbnailSettings ThumbnailSettings, TMap<FString, FString> Properties, 
+	const FInstancedPropertyBag& PropertyBag, FGenerateThumbnailCallback Callback, FPreCaptureThumbnail PreCaptureThumbnail, EThumbnailRequestPriority Priority)
 {
-	GenerateThumbnailAsync(
+	// The PreCapture event is only bound if it is used by the node. Requests using the same event function can share a capture.
+	const bool bHasPreCapture = PreCaptureThumbnail.IsBound();
+	return GenerateThumbnailAsyncInternal(
 		ActorClass,
 		FGenerateThumbnailCallbackNative::CreateUFunction(Callback.GetUObject(), Callback.GetFunctionName()),
 		ThumbnailSettings,
-		FPreCaptureThumbnailNative::CreateUFunction(PreCaptureThumbnail.GetUObject(), PreCaptureThumbnail.GetFunctionName()),
+		bHasPreCapture ? FPreCaptureThumbnailNative::CreateUFunction(PreCaptureThumbnail.GetUObject(), PreCaptureThumbnail.GetFunctionName()) : FPreCaptureThumbnailNative(),
+		bHasPreCapture ? FString::Printf(TEXT("%s:%s"), *PreCaptureThumbnail.GetUObject()->GetPathName(), *PreCaptureThumbnail.GetFunctionName().ToString()) : FString(),
 		nullptr,
-		Properties
+		Properties,
+		PropertyBag,
+		Priority
 	);
 }
 
@@ -1409,7 +3282,7 @@ void UThumbnailGeneration::K2_FinishSpawningThumbnailActor(AActor* Actor)
 {
 	if (IsValid(Actor))
 	{
-		Actor->FinishSpawning(FTransform::Identity);
+		GThumbnailGenerator->FinishSpawningThumbnailActor(Actor);
 	}
 }
 
@@ -1418,6 +3291,76 @@ FThumbnailSettings UThumbnailGeneration::K2_FinalizeThumbnailSettings(FThumbnail
 	return FThumbnailSettings::MergeThumbnailSettings(UThumbnailGeneratorSettings::Get()->DefaultThumbnailSettings, ThumbnailSettings);
 }
 
+FInstancedPropertyBag UThumbnailGeneration::K2_MakeThumbnailPropertyBag(UClass* ActorClass, const TArray<FName>& PropertyNames)
+{
+	FInstancedPropertyBag PropertyBag;
+	if (!IsValid(ActorClass))
+		return PropertyBag;
+
+	TArray<FPropertyBagPropertyDesc, TInlineAllocator<32>> PropertyDescs;
+	PropertyDescs.Reserve(PropertyNames.Num());
+	for (const FName PropertyName : PropertyNames)
+	{
+		if (const FProperty* Property = FindFProperty<FProperty>(ActorClass, PropertyName))
+			PropertyDescs.Emplace(PropertyName, Property);
+	}
+
+	// Bags with the same layout share their struct, so only the first bag of a layout creates one
+	PropertyBag.AddProperties(PropertyDescs);
+	return PropertyBag;
+}
+
+DEFINE_FUNCTION(UThumbnailGeneration::execK2_SetPropertyBagValue)
+{
+	P_GET_STRUCT_REF(FInstancedPropertyBag, PropertyBag);
+	P_GET_PROPERTY(FNameProperty, PropertyName);
+
+	Stack.StepCompiledIn<FProperty>(NULL);
+
+	auto* Property        = Stack.MostRecentProperty;
+	auto* PropertyValAddr = (void*)Stack.MostRecentPropertyAddress;
+
+	P_FINISH;
+
+	P_NATIVE_BEGIN;
+	ThumbnailGenerator::SetPropertyBagValue(PropertyBag, PropertyName, Property, PropertyValAddr);
+	P_NATIVE_END;
+}
+
+DEFINE_FUNCTION(UThumbnailGeneration::execK2_SetPropertyBagArrayValue)
+{
+	P_GET_STRUCT_REF(FInstancedPropertyBag, PropertyBag);
+	P_GET_PROPERTY(FNameProperty, PropertyName);
+
+	Stack.StepCompiledIn<FArrayProperty>(NULL);
+
+	auto* Property        = Stack.MostRecentProperty;
+	auto* PropertyValAddr = (void*)Stack.MostRecentPropertyAddress;
+
+	P_FINISH;
+
+	P_NATIVE_BEGIN;
+	ThumbnailGenerator::SetPropertyBagValue(PropertyBag, PropertyName, Property, PropertyValAddr);
+	P_NATIVE_END;
+}
+
+DEFINE_FUNCTION(UThumbnailGeneration::execK2_SetPropertyBagSetValue)
+{
+	P_GET_STRUCT_REF(FInstancedPropertyBag, PropertyBag);
+	P_GET_PROPERTY(FNameProperty, PropertyName);
+
+	Stack.StepCompiledIn<FSetProperty>(NULL);
+
+	auto* Property        = Stack.MostRecentProperty;
+	auto* PropertyValAddr = (void*)Stack.MostRecentPropertyAddress;
+
+	P_FINISH;
+
+	P_NATIVE_BEGIN;
+	ThumbnailGenerator::SetPropertyBagValue(PropertyBag, PropertyName, Property, PropertyValAddr);
+	P_NATIVE_END;
+}
+
 DEFINE_FUNCTION(UThumbnailGeneration::execK2_ExportPropertyText)
 {
 	Stack.StepCompiledIn<FProperty>(NULL);
@@ -2,11 +2,55 @@
 
 #include "ThumbnailGeneratorModule.h"
 #include "ThumbnailGenerator.h"
+#include "ThumbnailDiskCache.h"
+#include "ThumbnailGeneratorStats.h"
 
 #include "Misc/CoreDelegates.h"
 
 DEFINE_LOG_CATEGORY(LogThumbnailGenerator);
 
+DEFINE_STAT(STAT_ThumbnailGenerator_Begin);
+DEFINE_STAT(STAT_ThumbnailGenerator_UpdateScene);
+DEFINE_STAT(STAT_ThumbnailGenerator_SpawnActor);
+DEFINE_STAT(STAT_ThumbnailGenerator_ImportProperties);
+DEFINE_STAT(STAT_ThumbnailGenerator_FinishSpawning);
+DEFINE_STAT(STAT_ThumbnailGenerator_Finish);
+DEFINE_STAT(STAT_ThumbnailGenerator_PreCapture);
+DEFINE_STAT(STAT_ThumbnailGenerator_Simulation);
+DEFINE_STAT(STAT_ThumbnailGenerator_Cleanup);
+DEFINE_STAT(STAT_ThumbnailGenerator_Capture);
+DEFINE_STAT(STAT_ThumbnailGenerator_Bounds);
+DEFINE_STAT(STAT_ThumbnailGenerator_Framing);
+DEFINE_STAT(STAT_ThumbnailGenerator_AlphaCapture);
+DEFINE_STAT(STAT_ThumbnailGenerator_MainCapture);
+DEFINE_STAT(STAT_ThumbnailGenerator_WidgetDraw);
+DEFINE_STAT(STAT_ThumbnailGenerator_Readback);
+DEFINE_STAT(STAT_ThumbnailGenerator_AlphaMerge);
+DEFINE_STAT(STAT_ThumbnailGenerator_TextureUpload);
+DEFINE_STAT(STAT_ThumbnailGenerator_NumThumbnails);
+DEFINE_STAT(STAT_ThumbnailGenerator_CapturesInFlight);
+DEFINE_STAT(STAT_ThumbnailGenerator_ScratchAllocations);
+DEFINE_STAT(STAT_ThumbnailGenerator_CaptureAllocations);
+DEFINE_STAT(STAT_ThumbnailGenerator_PooledActorsReused);
+DEFINE_STAT(STAT_ThumbnailGenerator_BoundsCacheHits);
+DEFINE_STAT(STAT_ThumbnailGenerator_BoundsCacheMisses);
+DEFINE_STAT(STAT_ThumbnailGenerator_ViewCacheHits);
+DEFINE_STAT(STAT_ThumbnailGenerator_ViewCacheMisses);
+DEFINE_STAT(STAT_ThumbnailGenerator_PrecomputedBoundsHits);
+DEFINE_STAT(STAT_ThumbnailGenerator_ActorSuppliedBounds);
+DEFINE_STAT(STAT_ThumbnailGenerator_BoundsCacheTimeSaved);
+DEFINE_STAT(STAT_ThumbnailGenerator_RenderTargetMemory);
+DEFINE_STAT(STAT_ThumbnailGenerator_ResultCacheMemory);
+DEFINE_STAT(STAT_ThumbnailGenerator_ReadbackMemory);
+DEFINE_STAT(STAT_ThumbnailGenerator_TexturePoolMemory);
+DEFINE_STAT(STAT_ThumbnailGenerator_ScratchMemory);
+
+CSV_DEFINE_CATEGORY(ThumbnailGenerator, true);
+
+#if CPUPROFILERTRACE_ENABLED
+UE_TRACE_CHANNEL_DEFINE(ThumbnailGeneratorChannel);
+#endif
+
 #if WITH_EDITOR
 FThumbnailGeneratorModule::FSaveThumbnailDelegate FThumbnailGeneratorModule::SaveThumbnailDelegate;
 #endif
@@ -27,6 +71,13 @@ void FThumbnailGeneratorModule::StartupModule()
 {
 	FCoreDelegates::OnPreExit.AddRaw(this, &FThumbnailGeneratorModule::Cleanup);
 
+	// The disk cache is written to by the synchronous and the async paths alike, its index is flushed independently of either
+	DiskCacheTickerHandle = FTSTicker::GetCoreTicker().AddTicker(TEXT("ThumbnailDiskCache"), 0.f, [](float)
+	{
+		FThumbnailDiskCache::Tick();
+		return true;
+	});
+
 	if (GThumbnailGenerator == nullptr)
 	{
 		GThumbnailGenerator = new FThumbnailGenerator(true);
@@ -41,11 +92,19 @@ void FThumbnailGeneratorModule::ShutdownModule()
 
 void FThumbnailGeneratorModule::Cleanup()
 {
+	if (DiskCacheTickerHandle.IsValid())
+	{
+		FTSTicker::GetCoreTicker().RemoveTicker(DiskCacheTickerHandle);
+		DiskCacheTickerHandle.Reset();
+	}
+
 	if (GThumbnailGenerator != nullptr)
 	{
 		delete GThumbnailGenerator;
 		GThumbnailGenerator = nullptr;
 	}
+
+	FThumbnailDiskCache::Shutdown();
 }
 
 IMPLEMENT_MODULE(FThumbnailGeneratorModule, ThumbnailGenerator)
\ No newline at end of file
@@ -46,6 +46,8 @@ FThumbnailSettings::FThumbnailSettings()
 	bSnapToFloor = false;
 	ComponentBoundsBlacklist = { UParticleSystemComponent::StaticClass() };
 	bIncludeHiddenComponentsInBounds = false;
+	BoundsMode = EThumbnailBoundsMode::EExact;
+	BoundsSampleCount = 4096;
 
 	DirectionalLightRotation = FRotator(-45.f, 30.f, 0.f);
 	DirectionalLightIntensity = 1.0f;
@@ -0,0 +1,75 @@
+// Copyright Mans Isaksson. All Rights Reserved.
+
+#pragma once
+#include "CoreMinimal.h"
+#include "Stats/Stats.h"
+#include "ProfilingDebugging/CsvProfiler.h"
+#include "ProfilingDebugging/CpuProfilerTrace.h"
+
+// Per-stage instrumentation of thumbnail generation.
+// "stat ThumbnailGenerator" shows the stages, "-csvCategories=ThumbnailGenerator" records them in CSV profiles and
+// "-trace=cpu,ThumbnailGenerator" tags every stage in Unreal Insights with the id of the request it belongs to.
+
+DECLARE_STATS_GROUP(TEXT("ThumbnailGenerator"), STATGROUP_ThumbnailGenerator, STATCAT_Advanced);
+
+// BeginGenerateActorThumbnail
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Begin Thumbnail"), STAT_ThumbnailGenerator_Begin, STATGROUP_ThumbnailGenerator, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Update Scene"), STAT_ThumbnailGenerator_UpdateScene, STATGROUP_ThumbnailGenerator, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Spawn Actor"), STAT_ThumbnailGenerator_SpawnActor, STATGROUP_ThumbnailGenerator, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Import Properties"), STAT_ThumbnailGenerator_ImportProperties, STATGROUP_ThumbnailGenerator, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Finish Spawning"), STAT_ThumbnailGenerator_FinishSpawning, STATGROUP_ThumbnailGenerator, );
+
+// FinishGenerateActorThumbnail
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Finish Thumbnail"), STAT_ThumbnailGenerator_Finish, STATGROUP_ThumbnailGenerator, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Pre Capture"), STAT_ThumbnailGenerator_PreCapture, STATGROUP_ThumbnailGenerator, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Simulation"), STAT_ThumbnailGenerator_Simulation, STATGROUP_ThumbnailGenerator, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Cleanup"), STAT_ThumbnailGenerator_Cleanup, STATGROUP_ThumbnailGenerator, );
+
+// CaptureThumbnail
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Capture Thumbnail"), STAT_ThumbnailGenerator_Capture, STATGROUP_ThumbnailGenerator, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Bounds"), STAT_ThumbnailGenerator_Bounds, STATGROUP_ThumbnailGenerator, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Framing"), STAT_ThumbnailGenerator_Framing, STATGROUP_ThumbnailGenerator, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Alpha Capture"), STAT_ThumbnailGenerator_AlphaCapture, STATGROUP_ThumbnailGenerator, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Main Capture"), STAT_ThumbnailGenerator_MainCapture, STATGROUP_ThumbnailGenerator, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Widget Draw"), STAT_ThumbnailGenerator_WidgetDraw, STATGROUP_ThumbnailGenerator, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Readback"), STAT_ThumbnailGenerator_Readback, STATGROUP_ThumbnailGenerator, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Alpha Merge"), STAT_ThumbnailGenerator_AlphaMerge, STATGROUP_ThumbnailGenerator, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Texture Upload"), STAT_ThumbnailGenerator_TextureUpload, STATGROUP_ThumbnailGenerator, );
+
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Thumbnails Generated"), STAT_ThumbnailGenerator_NumThumbnails, STATGROUP_ThumbnailGenerator, );
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Captures In Flight"), STAT_ThumbnailGenerator_CapturesInFlight, STATGROUP_ThumbnailGenerator, );
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Scratch Allocations"), STAT_ThumbnailGenerator_ScratchAllocations, STATGROUP_ThumbnailGenerator, );
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Scratch Allocations (Last Capture)"), STAT_ThumbnailGenerator_CaptureAllocations, STATGROUP_ThumbnailGenerator, );
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Pooled Actors Reused"), STAT_ThumbnailGenerator_PooledActorsReused, STATGROUP_ThumbnailGenerator, );
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Bounds Cache Hits"), STAT_ThumbnailGenerator_BoundsCacheHits, STATGROUP_ThumbnailGenerator, );
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Bounds Cache Misses"), STAT_ThumbnailGenerator_BoundsCacheMisses, STATGROUP_ThumbnailGenerator, );
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("View Cache Hits"), STAT_ThumbnailGenerator_ViewCacheHits, STATGROUP_ThumbnailGenerator, );
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("View Cache Misses"), STAT_ThumbnailGenerator_ViewCacheMisses, STATGROUP_ThumbnailGenerator, );
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Precomputed Bounds Hits"), STAT_ThumbnailGenerator_PrecomputedBoundsHits, STATGROUP_ThumbnailGenerator, );
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Actor Supplied Bounds"), STAT_ThumbnailGenerator_ActorSuppliedBounds, STATGROUP_ThumbnailGenerator, );
+DECLARE_FLOAT_ACCUMULATOR_STAT_EXTERN(TEXT("Bounds Cache Time Saved (ms)"), STAT_ThumbnailGenerator_BoundsCacheTimeSaved, STATGROUP_ThumbnailGenerator, );
+
+DECLARE_MEMORY_STAT_EXTERN(TEXT("Render Target Cache"), STAT_ThumbnailGenerator_RenderTargetMemory, STATGROUP_ThumbnailGenerator, );
+DECLARE_MEMORY_STAT_EXTERN(TEXT("Result Cache"), STAT_ThumbnailGenerator_ResultCacheMemory, STATGROUP_ThumbnailGenerator, );
+DECLARE_MEMORY_STAT_EXTERN(TEXT("Readback Pixels"), STAT_ThumbnailGenerator_ReadbackMemory, STATGROUP_ThumbnailGenerator, );
+DECLARE_MEMORY_STAT_EXTERN(TEXT("Texture Pool"), STAT_ThumbnailGenerator_TexturePoolMemory, STATGROUP_ThumbnailGenerator, );
+DECLARE_MEMORY_STAT_EXTERN(TEXT("Free Scratch Buffers"), STAT_ThumbnailGenerator_ScratchMemory, STATGROUP_ThumbnailGenerator, );
+
+CSV_DECLARE_CATEGORY_EXTERN(ThumbnailGenerator);
+
+#if CPUPROFILERTRACE_ENABLED
+UE_TRACE_CHANNEL_EXTERN(ThumbnailGeneratorChannel);
+#endif
+
+// Times a stage with the stat group, the CSV profiler and a trace event
+#define THUMBNAIL_STAGE_SCOPE(Stage) \
+	SCOPE_CYCLE_COUNTER(STAT_ThumbnailGenerator_##Stage); \
+	CSV_SCOPED_TIMING_STAT(ThumbnailGenerator, Stage); \
+	TRACE_CPUPROFILER_EVENT_SCOPE_ON_CHANNEL_STR("ThumbnailGenerator::" #Stage, ThumbnailGeneratorChannel)
+
+// Opens a trace scope named after a request, so all stages of one thumbnail can be found in Insights.
+// The name is only formatted while the channel is enabled.
+#define THUMBNAIL_REQUEST_TRACE_SCOPE(Label, RequestId, ActorClass) \
+	TRACE_CPUPROFILER_EVENT_SCOPE_TEXT_ON_CHANNEL(UE_TRACE_CHANNELEXPR_IS_ENABLED(ThumbnailGeneratorChannel) \
+		? *FString::Printf(TEXT("Thumbnail #%u %s (%s)"), RequestId, TEXT(Label), *GetNameSafe(ActorClass)) \
+		: TEXT(""), ThumbnailGeneratorChannel)
@@ -0,0 +1,262 @@
+// Copyright Mans Isaksson. All Rights Reserved.
+
+#include "ThumbnailGeneratorTaskQueue.h"
+#include "ThumbnailGeneratorModule.h"
+
+#include "HAL/IConsoleManager.h"
+
+namespace ThumbnailGenerator
+{
+	static FORCEINLINE int32 GetQueueIndex(EThumbnailRequestPriority Priority)
+	{
+		return FMath::Clamp((int32)Priority, 0, (int32)EThumbnailRequestPriority::EMAX - 1);
+	}
+
+	TSharedRef<FThumbnailRequestState> FThumbnailGeneratorTaskQueue::AddTask(EThumbnailRequestPriority Priority, TFunction<void()>&& Task)
+	{
+		FTaskRef NewTask = MakeShared<FThumbnailRequestState>();
+		NewTask->Task       = MoveTemp(Task);
+		NewTask->QueuedTime = FPlatformTime::Seconds();
+		NewTask->Priority   = (EThumbnailRequestPriority)GetQueueIndex(Priority);
+
+		TaskQueues[GetQueueIndex(Priority)].EmplaceLast(NewTask);
+		NumQueuedTasks++;
+
+		return NewTask;
+	}
+
+	bool FThumbnailGeneratorTaskQueue::CancelTask(const TSharedRef<FThumbnailRequestState>& Task)
+	{
+		if (Task->State != EThumbnailRequestState::EQueued)
+			return false;
+
+		Task->State = EThumbnailRequestState::ECancelled;
+		Task->Task.Reset();
+
+		if (const TSharedPtr<FThumbnailRequestState> SharedTask = Task->SharedTask.Pin())
+		{
+			const bool bHasQueuedSubscribers = SharedTask->Subscribers.ContainsByPredicate([](const TSharedRef<FThumbnailRequestState>& Subscriber)
+			{
+				return Subscriber->State == EThumbnailRequestState::EQueued;
+			});
+
+			// Nobody is waiting for the shared task anymore
+			if (bHasQueuedSubscribers)
+				UpdateSharedTaskPriority(SharedTask.ToSharedRef());
+			else
+				CancelTask(SharedTask.ToSharedRef());
+
+			return true;
+		}
+
+		// The queue entry is left in place and skipped when popped
+		Task->Subscribers.Empty();
+		NumQueuedTasks--;
+
+		return true;
+	}
+
+	bool FThumbnailGeneratorTaskQueue::SetTaskPriority(const TSharedRef<FThumbnailRequestState>& Task, EThumbnailRequestPriority Priority)
+	{
+		if (Task->State != EThumbnailRequestState::EQueued)
+			return false;
+
+		if (const TSharedPtr<FThumbnailRequestState> SharedTask = Task->SharedTask.Pin())
+		{
+			Task->Priority = (EThumbnailRequestPriority)GetQueueIndex(Priority);
+			UpdateSharedTaskPriority(SharedTask.ToSharedRef());
+			return true;
+		}
+
+		const int32 QueueIndex = GetQueueIndex(Priority);
+		if (GetQueueIndex(Task->Priority) == QueueIndex)
+			return true;
+
+		// The entry in the old queue becomes stale, since its priority no longer matches that queue
+		Task->Priority = (EThumbnailRequestPriority)QueueIndex;
+		TaskQueues[QueueIndex].EmplaceLast(Task);
+
+		return true;
+	}
+
+	TSharedRef<FThumbnailRequestState> FThumbnailGeneratorTaskQueue::AddSubscriber(const TSharedRef<FThumbnailRequestState>& SharedTask, EThumbnailRequestPriority Priority, TFunction<void()>&& OnSharedTaskDone)
+	{
+		check(SharedTask->State == EThumbnailRequestState::EQueued);
+
+		if (SharedTask->Subscribers.Num() > 0)
+			Stats.CoalescedRequests++;
+
+		TSharedRef<FThumbnailRequestState> Subscriber = MakeShared<FThumbnailRequestState>();
+		Subscriber->Task       = MoveTemp(OnSharedTaskDone);
+		Subscriber->QueuedTime = FPlatformTime::Seconds();
+		Subscriber->Priority   = (EThumbnailRequestPriority)GetQueueIndex(Priority);
+		Subscriber->SharedTask = SharedTask;
+
+		SharedTask->Subscribers.Add(Subscriber);
+
+		if (GetQueueIndex(Priority) < GetQueueIndex(SharedTask->Priority))
+			SetTaskPriority(SharedTask, Priority);
+
+		return Subscriber;
+	}
+
+	void FThumbnailGeneratorTaskQueue::UpdateSharedTaskPriority(const TSharedRef<FThumbnailRequestState>& SharedTask)
+	{
+		int32 HighestPriority = (int32)EThumbnailRequestPriority::EMAX - 1;
+		for (const TSharedRef<FThumbnailRequestState>& Subscriber : SharedTask->Subscribers)
+		{
+			if (Subscriber->State == EThumbnailRequestState::EQueued)
+				HighestPriority = FMath::Min(HighestPriority, GetQueueIndex(Subscriber->Priority));
+		}
+
+		SetTaskPriority(SharedTask, (EThumbnailRequestPriority)HighestPriority);
+	}
+
+	void FThumbnailGeneratorTaskQueue::Tick(float DeltaTime)
+	{
+		if (Num() == 0)
+		{
+			// Only cancelled or re-prioritized entries can be left
+			for (TDeque<FTaskRef>& TaskQueue : TaskQueues)
+				TaskQueue.Reset();
+
+			BudgetDebt = 0.0;
+			return;
+		}
+
+		const double FrameBudget = UThumbnailGeneratorSettings::Get()->AsyncFrameBudget / 1000.0;
+
+		// Pay back the time of previous overruns before starting any new work
+		const double AvailableBudget = FrameBudget - BudgetDebt;
+		if (FrameBudget > 0.0 && AvailableBudget <= 0.0)
+		{
+			BudgetDebt -= FrameBudget;
+			Stats.TicksPaidBack++;
+			return;
+		}
+		BudgetDebt = 0.0;
+
+		const double StartTime = FPlatformTime::Seconds();
+		double ElapsedTime = 0.0;
+		int32 NumExecuted = 0;
+
+		while (TSharedPtr<FThumbnailRequestState> Task = PopNextTask())
+		{
+			const double TaskStartTime = FPlatformTime::Seconds();
+			const double QueueWaitTime = TaskStartTime - Task->QueuedTime;
+			Stats.TotalQueueWaitTime += QueueWaitTime;
+			Stats.MaxQueueWaitTime    = FMath::Max(Stats.MaxQueueWaitTime, QueueWaitTime);
+
+			// Release anything captured by the task as soon as it has run, handles might keep the state alive for a long time
+			TFunction<void()> TaskFunction = MoveTemp(Task->Task);
+			TArray<TSharedRef<FThumbnailRequestState>> Subscribers = MoveTemp(Task->Subscribers);
+
+			Task->State = EThumbnailRequestState::ERunning;
+			for (const TSharedRef<FThumbnailRequestState>& Subscriber : Subscribers)
+			{
+				if (Subscriber->State == EThumbnailRequestState::EQueued)
+					Subscriber->State = EThumbnailRequestState::ERunning;
+			}
+
+			TaskFunction();
+			TaskFunction.Reset();
+			Task->State = EThumbnailRequestState::EDone;
+
+			// Fan the result out to every request that was coalesced into this task
+			for (const TSharedRef<FThumbnailRequestState>& Subscriber : Subscribers)
+			{
+				if (Subscriber->State != EThumbnailRequestState::ERunning)
+					continue;
+
+				TFunction<void()> SubscriberFunction = MoveTemp(Subscriber->Task);
+				SubscriberFunction();
+				Subscriber->State = EThumbnailRequestState::EDone;
+			}
+
+			const double TaskDuration = FPlatformTime::Seconds() - TaskStartTime;
+			AverageTaskDuration = Stats.TasksExecuted == 0 ? TaskDuration : FMath::Lerp(AverageTaskDuration, TaskDuration, 0.2);
+
+			NumExecuted++;
+			Stats.TasksExecuted++;
+
+			ElapsedTime = FPlatformTime::Seconds() - StartTime;
+
+			// A budget of 0 means one task per frame
+			if (FrameBudget <= 0.0)
+				break;
+
+			if (ElapsedTime >= AvailableBudget)
+			{
+				BudgetDebt = ElapsedTime - AvailableBudget;
+				break;
+			}
+
+			// Don't start a task which will most likely not fit in what is left of the budget
+			if (ElapsedTime + AverageTaskDuration > AvailableBudget)
+				break;
+		}
+
+		if (NumExecuted > 0)
+		{
+			Stats.TicksWithWork++;
+			Stats.TotalTaskTime += ElapsedTime;
+			Stats.MaxFrameTime   = FMath::Max(Stats.MaxFrameTime, ElapsedTime);
+		}
+	}
+
+	TSharedPtr<FThumbnailRequestState> FThumbnailGeneratorTaskQueue::PopNextTask()
+	{
+		for (int32 QueueIndex = 0; QueueIndex < UE_ARRAY_COUNT(TaskQueues); QueueIndex++)
+		{
+			TDeque<FTaskRef>& TaskQueue = TaskQueues[QueueIndex];
+			while (!TaskQueue.IsEmpty())
+			{
+				FTaskRef Task = MoveTemp(TaskQueue.First());
+				TaskQueue.PopFirst();
+
+				// Skip cancelled tasks and entries left behind when a task changed priority
+				if (Task->State == EThumbnailRequestState::EQueued && GetQueueIndex(Task->Priority) == QueueIndex)
+				{
+					NumQueuedTasks--;
+					return Task;
+				}
+			}
+		}
+		return nullptr;
+	}
+
+	FThumbnailGeneratorTaskQueue& FThumbnailGeneratorTaskQueue::Get()
+	{
+		static TUniquePtr<FThumbnailGeneratorTaskQueue> ThumbnailGeneratorTaskQueue = nullptr;
+		if (!ThumbnailGeneratorTaskQueue.IsValid())
+		{
+			ThumbnailGeneratorTaskQueue = MakeUnique<FThumbnailGeneratorTaskQueue>();
+		}
+
+		return *ThumbnailGeneratorTaskQueue;
+	}
+
+	static FAutoConsoleCommand DumpTaskQueueStatsCommand(
+		TEXT("ThumbnailGenerator.TaskQueueStats"),
+		TEXT("Logs frame time statistics of the async thumbnail task queue. Pass 'reset' to reset the statistics."),
+		FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args)
+		{
+			FThumbnailGeneratorTaskQueue& TaskQueue = FThumbnailGeneratorTaskQueue::Get();
+			if (Args.Num() > 0 && Args[0] == TEXT("reset"))
+			{
+				TaskQueue.ResetStats();
+				return;
+			}
+
+			const FThumbnailTaskQueueStats& Stats = TaskQueue.GetStats();
+			UE_LOG(LogThumbnailGenerator, Display, TEXT("Thumbnail task queue: Budget %.2f ms, %d queued"), UThumbnailGeneratorSettings::Get()->AsyncFrameBudget, TaskQueue.Num());
+			UE_LOG(LogThumbnailGenerator, Display, TEXT("  Tasks executed: %lld over %lld frames (%.2f tasks/frame), %lld frames paying back overruns"),
+				Stats.TasksExecuted, Stats.TicksWithWork, Stats.TicksWithWork > 0 ? double(Stats.TasksExecuted) / Stats.TicksWithWork : 0.0, Stats.TicksPaidBack);
+			UE_LOG(LogThumbnailGenerator, Display, TEXT("  Frame time: avg %.3f ms, max %.3f ms"),
+				Stats.TicksWithWork > 0 ? Stats.TotalTaskTime * 1000.0 / Stats.TicksWithWork : 0.0, Stats.MaxFrameTime * 1000.0);
+			UE_LOG(LogThumbnailGenerator, Display, TEXT("  Coalesced requests (captures saved): %lld"), Stats.CoalescedRequests);
+			UE_LOG(LogThumbnailGenerator, Display, TEXT("  Queue wait: avg %.3f ms, max %.3f ms"),
+				Stats.TasksExecuted > 0 ? Stats.TotalQueueWaitTime * 1000.0 / Stats.TasksExecuted : 0.0, Stats.MaxQueueWaitTime * 1000.0);
+		})
+	);
+}
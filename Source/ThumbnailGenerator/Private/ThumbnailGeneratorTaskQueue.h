@@ -0,0 +1,91 @@
+// Copyright Mans Isaksson. All Rights Reserved.
+
+#pragma once
+#include "CoreMinimal.h"
+#include "Tickable.h"
+#include "Containers/Deque.h"
+#include "ThumbnailGeneratorSettings.h"
+#include "ThumbnailGenerator.h"
+
+// Shared state of a queued request, referenced by the queue and by any FThumbnailRequestHandle
+struct FThumbnailRequestState
+{
+	TFunction<void()>         Task;
+	double                    QueuedTime = 0.0;
+	EThumbnailRequestPriority Priority   = EThumbnailRequestPriority::ENormal;
+	EThumbnailRequestState    State      = EThumbnailRequestState::EQueued;
+
+	// Requests which have been coalesced into another task. Their Task is run right after the shared task has finished.
+	TWeakPtr<FThumbnailRequestState>           SharedTask;
+	TArray<TSharedRef<FThumbnailRequestState>> Subscribers;
+};
+
+namespace ThumbnailGenerator
+{
+	// Frame time statistics of the task queue, used to tune AsyncFrameBudget
+	struct FThumbnailTaskQueueStats
+	{
+		int64  TicksWithWork      = 0; // Frames in which at least one task was executed
+		int64  TicksPaidBack      = 0; // Frames skipped to pay back the debt of an overrun
+		int64  TasksExecuted      = 0;
+		int64  CoalescedRequests  = 0; // Requests which were served by another identical request, i.e. captures saved
+		double TotalTaskTime      = 0.0; // Seconds
+		double MaxFrameTime       = 0.0; // Seconds spent on tasks in a single frame
+		double TotalQueueWaitTime = 0.0; // Seconds between a task being queued and it starting
+		double MaxQueueWaitTime   = 0.0;
+	};
+
+	// Runs asynchronous thumbnail requests on the game thread.
+	// Each frame, tasks are executed in priority order (FIFO within each priority) until the frame budget (AsyncFrameBudget) is used up.
+	// If a task overruns the budget the overrun is carried over as debt, which is paid back by doing less work on the following frames.
+	//
+	// Cancelling and re-prioritizing tasks is O(1): the task state is updated in place and stale queue entries are skipped when popped.
+	struct FThumbnailGeneratorTaskQueue : public FTickableGameObject
+	{
+	private:
+		using FTaskRef = TSharedRef<FThumbnailRequestState>;
+
+		TDeque<FTaskRef> TaskQueues[(int32)EThumbnailRequestPriority::EMAX];
+
+		int32 NumQueuedTasks = 0;
+
+		double BudgetDebt          = 0.0; // Seconds
+		double AverageTaskDuration = 0.0; // Exponential moving average, used to avoid starting tasks that are likely to overrun
+
+		FThumbnailTaskQueueStats Stats;
+
+	public:
+
+		TSharedRef<FThumbnailRequestState> AddTask(EThumbnailRequestPriority Priority, TFunction<void()>&& Task);
+
+		// Removes a queued task, releasing anything captured by it. Returns false if the task is no longer queued.
+		bool CancelTask(const TSharedRef<FThumbnailRequestState>& Task);
+
+		// Moves a queued task to the back of another priority. Returns false if the task is no longer queued.
+		bool SetTaskPriority(const TSharedRef<FThumbnailRequestState>& Task, EThumbnailRequestPriority Priority);
+
+		// Adds a request which will be completed by an already queued task, the task runs with the highest priority of its subscribers.
+		// Cancelling every subscriber cancels the shared task.
+		TSharedRef<FThumbnailRequestState> AddSubscriber(const TSharedRef<FThumbnailRequestState>& SharedTask, EThumbnailRequestPriority Priority, TFunction<void()>&& OnSharedTaskDone);
+
+		FORCEINLINE int32 Num() const { return NumQueuedTasks; }
+
+		FORCEINLINE const FThumbnailTaskQueueStats& GetStats() const { return Stats; }
+
+		FORCEINLINE void ResetStats() { Stats = FThumbnailTaskQueueStats(); }
+
+		// ~Begin: FTickableGameObject Interface
+		virtual void Tick(float DeltaTime) override;
+		virtual bool IsTickableInEditor() const override { return true; }
+		virtual TStatId GetStatId() const override { RETURN_QUICK_DECLARE_CYCLE_STAT(FThumbnailGeneratorTaskQueue, STATGROUP_Tickables); }
+		// ~End: FTickableGameObject Interface
+
+		static FThumbnailGeneratorTaskQueue& Get();
+
+	private:
+
+		TSharedPtr<FThumbnailRequestState> PopNextTask();
+
+		void UpdateSharedTaskPriority(const TSharedRef<FThumbnailRequestState>& SharedTask);
+	};
+}
@@ -0,0 +1,409 @@
+// Copyright Mans Isaksson. All Rights Reserved.
+
+#include "ThumbnailPropertyOverrides.h"
+#include "ThumbnailGeneratorModule.h"
+
+#include "GameFramework/Actor.h"
+#include "UObject/UObjectGlobals.h"
+#include "UObject/UnrealType.h"
+
+namespace ThumbnailGenerator
+{
+	// Offset of a value which failed to parse, the override is skipped
+	static constexpr int32 InvalidValueOffset = -2;
+
+	static void HashString(FXxHash128Builder& Builder, const FString& Value)
+	{
+		const int32 Len = Value.Len();
+		Builder.Update(&Len, sizeof(Len));
+		Builder.Update(*Value, Len * sizeof(TCHAR));
+	}
+
+	static bool CanCacheValue(const FProperty* Property)
+	{
+		if (Property->GetArrayDim() != 1)
+			return false;
+
+		// Object paths are resolved relative to the actor the value is imported into (e.g. its subobjects), so they can't be shared between actors
+		TArray<const FStructProperty*> EncounteredStructProps;
+		return !Property->ContainsObjectReference(EncounteredStructProps);
+	}
+
+	// Enums are copied through their underlying integer
+	static const FNumericProperty* GetNumericProperty(const FProperty* Property)
+	{
+		if (const FEnumProperty* EnumProperty = CastField<FEnumProperty>(Property))
+			return EnumProperty->GetUnderlyingProperty();
+
+		return CastField<FNumericProperty>(Property);
+	}
+
+	FThumbnailPropertyOverrides::ECopyMode FThumbnailPropertyOverrides::GetCopyMode(const FProperty* DestProperty, const FProperty* SourceProperty)
+	{
+		if (!DestProperty || !SourceProperty || DestProperty->GetArrayDim() != 1 || SourceProperty->GetArrayDim() != 1)
+			return ECopyMode::Invalid;
+
+		// Native bitfields share a byte with other bools, they can't be copied as a whole
+		if (DestProperty->IsA<FBoolProperty>() && SourceProperty->IsA<FBoolProperty>())
+			return ECopyMode::Bool;
+
+		if (DestProperty->SameType(SourceProperty))
+			return ECopyMode::Copy;
+
+		// Hard object and class references of different classes, soft references would have to be resolved
+		if (DestProperty->GetClass() == SourceProperty->GetClass() && (DestProperty->IsA<FObjectProperty>() || DestProperty->IsA<FClassProperty>()))
+			return ECopyMode::Object;
+
+		const FNumericProperty* DestNumeric   = GetNumericProperty(DestProperty);
+		const FNumericProperty* SourceNumeric = GetNumericProperty(SourceProperty);
+		if (DestNumeric && SourceNumeric)
+		{
+			if (DestNumeric->IsInteger() && SourceNumeric->IsInteger())
+				return ECopyMode::Integer;
+
+			if (DestNumeric->IsFloatingPoint() && SourceNumeric->IsFloatingPoint())
+				return ECopyMode::Float;
+		}
+
+		return ECopyMode::Invalid;
+	}
+
+	bool FThumbnailPropertyOverrides::CopyValue(ECopyMode CopyMode, const FProperty* DestProperty, void* Dest, const FProperty* SourceProperty, const void* Source)
+	{
+		switch (CopyMode)
+		{
+		case ECopyMode::Copy:
+			DestProperty->CopyCompleteValue(Dest, Source);
+			return true;
+
+		case ECopyMode::Bool:
+			CastFieldChecked<const FBoolProperty>(DestProperty)->SetPropertyValue(Dest, CastFieldChecked<const FBoolProperty>(SourceProperty)->GetPropertyValue(Source));
+			return true;
+
+		case ECopyMode::Object:
+		{
+			const FObjectPropertyBase* DestObjectProperty = CastFieldChecked<const FObjectPropertyBase>(DestProperty);
+			UObject* const Object = CastFieldChecked<const FObjectPropertyBase>(SourceProperty)->GetObjectPropertyValue(Source);
+
+			if (Object && !Object->IsA(DestObjectProperty->PropertyClass))
+				return false;
+
+			const FClassProperty* DestClassProperty = CastField<const FClassProperty>(DestProperty);
+			if (Object && DestClassProperty && !CastChecked<UClass>(Object)->IsChildOf(DestClassProperty->MetaClass))
+				return false;
+
+			DestObjectProperty->SetObjectPropertyValue(Dest, Object);
+			return true;
+		}
+
+		case ECopyMode::Integer:
+			GetNumericProperty(DestProperty)->SetIntPropertyValue(Dest, GetNumericProperty(SourceProperty)->GetSignedIntPropertyValue(Source));
+			return true;
+
+		case ECopyMode::Float:
+			GetNumericProperty(DestProperty)->SetFloatingPointPropertyValue(Dest, GetNumericProperty(SourceProperty)->GetFloatingPointPropertyValue(Source));
+			return true;
+
+		default:
+			return false;
+		}
+	}
+
+	FThumbnailPropertyOverrides::FThumbnailPropertyOverrides()
+	{
+		PreGarbageCollectDelegateHandle = FCoreUObjectDelegates::GetPreGarbageCollectDelegate().AddRaw(this, &FThumbnailPropertyOverrides::RemoveGarbagePlans);
+	}
+
+	FThumbnailPropertyOverrides::~FThumbnailPropertyOverrides()
+	{
+		FCoreUObjectDelegates::GetPreGarbageCollectDelegate().Remove(PreGarbageCollectDelegateHandle);
+	}
+
+	FThumbnailPropertyOverrides::FParsedValues::~FParsedValues()
+	{
+		// The properties are owned by the actor class, if it has been destroyed the values can only be freed. A class marked as garbage
+		// is still intact until the garbage collector destroys it, see RemoveGarbagePlans.
+		if (ActorClass.IsValid(true))
+		{
+			for (int32 i = 0; i < Properties.Num(); i++)
+			{
+				if (Properties[i] && Offsets[i] >= 0)
+					Properties[i]->DestroyValue(Data + Offsets[i]);
+			}
+		}
+
+		FMemory::Free(Data);
+	}
+
+	void FThumbnailPropertyOverrides::Apply(AActor* Actor, const TMap<FString, FString>& Properties, TArray<const FProperty*>* OutAppliedProperties)
+	{
+		if (Properties.Num() == 0)
+			return;
+
+		UClass* const ActorClass = Actor->GetClass();
+
+		// The plan depends on the class and the property names, the parsed values on the plan and the value strings
+		FXxHash128Builder PlanBuilder;
+		FXxHash128Builder ValuesBuilder;
+		PlanBuilder.Update(&ActorClass, sizeof(ActorClass));
+		for (const TPair<FString, FString>& Property : Properties)
+		{
+			HashString(PlanBuilder, Property.Key);
+			HashString(ValuesBuilder, Property.Value);
+		}
+
+		const FThumbnailRequestKey PlanKey   = FThumbnailRequestKey{ PlanBuilder.Finalize() };
+		const FThumbnailRequestKey ValuesKey = FThumbnailRequestKey{ ValuesBuilder.Finalize() };
+
+		FPlan& Plan = FindOrCreatePlan(ActorClass, Properties, PlanKey);
+
+		const TSharedRef<FParsedValues>* FoundValues = Plan.ParsedValues.Find(ValuesKey);
+		if (!FoundValues)
+		{
+			if (Plan.ParsedValues.Num() >= MaxParsedValuesPerPlan)
+				Plan.ParsedValues.Reset();
+
+			FoundValues = &Plan.ParsedValues.Add(ValuesKey, ParseValues(Plan, Actor, Properties));
+		}
+
+		const FParsedValues& Values = FoundValues->Get();
+
+		int32 Index = 0;
+		for (const TPair<FString, FString>& Property : Properties)
+		{
+			FProperty* const OverriddenProperty = Plan.Properties[Index];
+			const int32 ValueOffset             = Values.Offsets[Index];
+			Index++;
+
+			if (!OverriddenProperty || ValueOffset == InvalidValueOffset)
+				continue;
+
+			void* const Value = OverriddenProperty->ContainerPtrToValuePtr<void>(Actor);
+			if (ValueOffset >= 0)
+				OverriddenProperty->CopySingleValue(Value, Values.Data + ValueOffset);
+			else
+				OverriddenProperty->ImportText_Direct(*Property.Value, Value, Actor, PPF_None);
+
+			if (OutAppliedProperties)
+				OutAppliedProperties->Add(OverriddenProperty);
+		}
+	}
+
+	void FThumbnailPropertyOverrides::Apply(AActor* Actor, const FInstancedPropertyBag& PropertyBag, TArray<const FProperty*>* OutAppliedProperties)
+	{
+		const UPropertyBag* const BagStruct = PropertyBag.GetPropertyBagStruct();
+		if (!BagStruct)
+			return;
+
+		const FBagPlan& Plan = FindOrCreateBagPlan(Actor->GetClass(), BagStruct);
+		const uint8* const BagMemory = PropertyBag.GetValue().GetMemory();
+
+		const TConstArrayView<FPropertyBagPropertyDesc> PropertyDescs = BagStruct->GetPropertyDescs();
+		for (int32 i = 0; i < PropertyDescs.Num(); i++)
+		{
+			const FProperty* const ActorProperty = Plan.ActorProperties[i];
+			if (!ActorProperty)
+				continue;
+
+			const FProperty* const BagProperty = PropertyDescs[i].CachedProperty;
+			if (!CopyValue(Plan.CopyModes[i], ActorProperty, ActorProperty->ContainerPtrToValuePtr<void>(Actor), BagProperty, BagProperty->ContainerPtrToValuePtr<void>(BagMemory)))
+			{
+				UE_LOG(LogThumbnailGenerator, Warning, TEXT("FThumbnailPropertyOverrides - The value of '%s' can't be assigned to %s::%s, the override is ignored"),
+					*PropertyDescs[i].Name.ToString(), *Plan.ActorClass->GetName(), *ActorProperty->GetName());
+				continue;
+			}
+
+			if (OutAppliedProperties)
+				OutAppliedProperties->Add(ActorProperty);
+		}
+	}
+
+	void FThumbnailPropertyOverrides::Reset()
+	{
+		Plans.Empty();
+		BagPlans.Empty();
+	}
+
+	int32 FThumbnailPropertyOverrides::GetNumParsedValues() const
+	{
+		int32 NumParsedValues = 0;
+		for (const TPair<FThumbnailRequestKey, FPlan>& Plan : Plans)
+			NumParsedValues += Plan.Value.ParsedValues.Num();
+
+		return NumParsedValues;
+	}
+
+	void FThumbnailPropertyOverrides::AddReferencedObjects(FReferenceCollector& Collector)
+	{
+		for (TPair<FThumbnailRequestKey, FPlan>& Plan : Plans)
+		{
+			Collector.AddReferencedObject(Plan.Value.ActorClass);
+		}
+
+		for (TPair<TPair<const UClass*, const UPropertyBag*>, FBagPlan>& Plan : BagPlans)
+		{
+			Collector.AddReferencedObject(Plan.Value.ActorClass);
+			Collector.AddReferencedObject(Plan.Value.PropertyBag);
+		}
+	}
+
+	FThumbnailPropertyOverrides::FPlan& FThumbnailPropertyOverrides::FindOrCreatePlan(UClass* ActorClass, const TMap<FString, FString>& Properties, const FThumbnailRequestKey& PlanKey)
+	{
+		// The class is referenced by the plan, but may still be destroyed if it is marked as garbage
+		FPlan* Plan = Plans.Find(PlanKey);
+		if (Plan && Plan->ActorClass == ActorClass)
+			return *Plan;
+
+		if (!Plan && Plans.Num() >= MaxPlans)
+			Plans.Reset();
+
+		Plan = &Plans.Add(PlanKey);
+		Plan->ActorClass = ActorClass;
+		Plan->Properties.Reset(Properties.Num());
+
+		for (const TPair<FString, FString>& Property : Properties)
+		{
+			FProperty* const OverriddenProperty = FindFProperty<FProperty>(ActorClass, *Property.Key);
+			if (!OverriddenProperty)
+				UE_LOG(LogThumbnailGenerator, Warning, TEXT("FThumbnailPropertyOverrides - %s has no property named '%s', the override is ignored"), *ActorClass->GetName(), *Property.Key);
+
+			Plan->Properties.Add(OverriddenProperty);
+		}
+
+		return *Plan;
+	}
+
+	TSharedRef<FThumbnailPropertyOverrides::FParsedValues> FThumbnailPropertyOverrides::ParseValues(const FPlan& Plan, AActor* Actor, const TMap<FString, FString>& Properties)
+	{
+		TSharedRef<FParsedValues> Values = MakeShared<FParsedValues>();
+		Values->ActorClass = Plan.ActorClass.Get();
+		Values->Properties = Plan.Properties;
+		Values->Offsets.Init(INDEX_NONE, Plan.Properties.Num());
+
+		// All values share one allocation
+		int32 DataSize      = 0;
+		int32 DataAlignment = 1;
+		for (int32 i = 0; i < Plan.Properties.Num(); i++)
+		{
+			const FProperty* const OverriddenProperty = Plan.Properties[i];
+			if (!OverriddenProperty || !CanCacheValue(OverriddenProperty))
+				continue;
+
+			DataSize           = Align(DataSize, OverriddenProperty->GetMinAlignment());
+			Values->Offsets[i] = DataSize;
+			DataSize          += OverriddenProperty->GetElementSize();
+			DataAlignment      = FMath::Max(DataAlignment, OverriddenProperty->GetMinAlignment());
+		}
+
+		Values->Data = (uint8*)FMemory::Malloc(FMath::Max(DataSize, 1), DataAlignment);
+
+		// The text is imported on top of the class defaults, the same as when it is imported into a newly spawned actor, so values which
+		// only specify some members of a struct keep the defaults of the others
+		const UObject* const ClassDefaults = Plan.ActorClass->GetDefaultObject();
+
+		int32 Index = 0;
+		for (const TPair<FString, FString>& Property : Properties)
+		{
+			FProperty* const OverriddenProperty = Plan.Properties[Index];
+			int32& ValueOffset                  = Values->Offsets[Index];
+			Index++;
+
+			if (!OverriddenProperty || ValueOffset < 0)
+				continue;
+
+			void* const Value = Values->Data + ValueOffset;
+			OverriddenProperty->InitializeValue(Value);
+			OverriddenProperty->CopyCompleteValue(Value, OverriddenProperty->ContainerPtrToValuePtr<void>(ClassDefaults));
+
+			if (!OverriddenProperty->ImportText_Direct(*Property.Value, Value, Actor, PPF_None))
+			{
+				UE_LOG(LogThumbnailGenerator, Warning, TEXT("FThumbnailPropertyOverrides - Failed to import '%s' into %s::%s, the override is ignored"),
+					*Property.Value, *Plan.ActorClass->GetName(), *Property.Key);
+
+				OverriddenProperty->DestroyValue(Value);
+				ValueOffset = InvalidValueOffset;
+			}
+		}
+
+		return Values;
+	}
+
+	void FThumbnailPropertyOverrides::RemoveGarbagePlans()
+	{
+		// The plans keep their classes reachable, a class is only destroyed once something has marked it as garbage
+		for (auto It = Plans.CreateIterator(); It; ++It)
+		{
+			if (!IsValid(It->Value.ActorClass))
+				It.RemoveCurrent();
+		}
+
+		for (auto It = BagPlans.CreateIterator(); It; ++It)
+		{
+			if (!IsValid(It->Value.ActorClass) || !IsValid(It->Value.PropertyBag))
+				It.RemoveCurrent();
+		}
+	}
+
+	FThumbnailPropertyOverrides::FBagPlan& FThumbnailPropertyOverrides::FindOrCreateBagPlan(UClass* ActorClass, const UPropertyBag* PropertyBag)
+	{
+		const TPair<const UClass*, const UPropertyBag*> PlanKey(ActorClass, PropertyBag);
+
+		// Bags with the same layout share their UPropertyBag, so the plan is reused by every bag made for the same properties
+		FBagPlan* Plan = BagPlans.Find(PlanKey);
+		if (Plan && Plan->ActorClass == ActorClass && Plan->PropertyBag == PropertyBag)
+			return *Plan;
+
+		if (!Plan && BagPlans.Num() >= MaxPlans)
+			BagPlans.Reset();
+
+		Plan = &BagPlans.Add(PlanKey);
+		Plan->ActorClass  = ActorClass;
+		Plan->PropertyBag = PropertyBag;
+
+		for (const FPropertyBagPropertyDesc& PropertyDesc : PropertyBag->GetPropertyDescs())
+		{
+			const FProperty* const ActorProperty = FindFProperty<FProperty>(ActorClass, PropertyDesc.Name);
+			const ECopyMode CopyMode             = GetCopyMode(ActorProperty, PropertyDesc.CachedProperty);
+
+			if (!ActorProperty)
+			{
+				UE_LOG(LogThumbnailGenerator, Warning, TEXT("FThumbnailPropertyOverrides - %s has no property named '%s', the override is ignored"), *ActorClass->GetName(), *PropertyDesc.Name.ToString());
+			}
+			else if (CopyMode == ECopyMode::Invalid)
+			{
+				UE_LOG(LogThumbnailGenerator, Warning, TEXT("FThumbnailPropertyOverrides - %s::%s is a %s, which can't be set from a %s, the override is ignored"),
+					*ActorClass->GetName(), *ActorProperty->GetName(), *ActorProperty->GetCPPType(), PropertyDesc.CachedProperty ? *PropertyDesc.CachedProperty->GetCPPType() : TEXT("None"));
+			}
+
+			Plan->ActorProperties.Add(CopyMode != ECopyMode::Invalid ? ActorProperty : nullptr);
+			Plan->CopyModes.Add(CopyMode);
+		}
+
+		return *Plan;
+	}
+
+	void SetPropertyBagValue(FInstancedPropertyBag& PropertyBag, FName PropertyName, const FProperty* ValueProperty, const void* Value)
+	{
+		const FPropertyBagPropertyDesc* PropertyDesc = PropertyBag.FindPropertyDescByName(PropertyName);
+		if (!PropertyDesc || !PropertyDesc->CachedProperty || !ValueProperty)
+		{
+			UE_LOG(LogThumbnailGenerator, Warning, TEXT("SetPropertyBagValue - The property bag has no property named '%s'"), *PropertyName.ToString());
+			return;
+		}
+
+		const FProperty* const BagProperty = PropertyDesc->CachedProperty;
+		void* const Dest = BagProperty->ContainerPtrToValuePtr<void>(PropertyBag.GetMutableValue().GetMemory());
+
+		const FThumbnailPropertyOverrides::ECopyMode CopyMode = FThumbnailPropertyOverrides::GetCopyMode(BagProperty, ValueProperty);
+		if (!FThumbnailPropertyOverrides::CopyValue(CopyMode, BagProperty, Dest, ValueProperty, Value))
+		{
+			UE_LOG(LogThumbnailGenerator, Warning, TEXT("SetPropertyBagValue - A %s can't be assigned to '%s' (%s)"),
+				*ValueProperty->GetCPPType(), *PropertyName.ToString(), *BagProperty->GetCPPType());
+		}
+	}
+
+	void FReferencedPropertyBag::AddReferencedObjects(FReferenceCollector& Collector)
+	{
+		Collector.AddPropertyReferencesWithStructARO(FInstancedPropertyBag::StaticStruct(), &PropertyBag);
+	}
+}
@@ -0,0 +1,156 @@
+// Copyright Mans Isaksson. All Rights Reserved.
+
+#pragma once
+#include "CoreMinimal.h"
+#include "ThumbnailRequestHash.h"
+#include "UObject/GCObject.h"
+#include "StructUtils/PropertyBag.h"
+
+class FProperty;
+
+namespace ThumbnailGenerator
+{
+	// Applies property overrides (property name -> ImportText value, see FThumbnailRequest::Properties) to thumbnail actors.
+	//
+	// The property names are resolved once per actor class and set of names (a plan), and the values are parsed once per set of
+	// value strings, so that applying the same overrides again copies the parsed values instead of parsing text. Unknown properties
+	// are reported once when the plan is created, values which fail to parse once when they are first parsed.
+	//
+	// Values which reference objects are imported on every call, object paths are resolved relative to the actor the value is imported
+	// into and the parsed values would not be visible to the garbage collector. The cache holds on to the actor classes until it is reset,
+	// the plans of classes marked as garbage (e.g. unloaded or hot-reloaded) are removed before they are destroyed, while their
+	// properties can still free the parsed values.
+	//
+	// Typed overrides (FInstancedPropertyBag) are bound to the actor's properties once per actor class and bag layout, their values
+	// are copied without going through text.
+	class FThumbnailPropertyOverrides
+	{
+	public:
+		// How a value of one property is copied into another
+		enum class ECopyMode : uint8
+		{
+			Invalid, // Incompatible types, the value is skipped
+			Copy,    // Same type
+			Bool,    // Bools, which might be bitfields
+			Object,  // Object references of different classes, the object is set if it is of the destination class
+			Integer, // Integer and enum properties of different sizes
+			Float,   // Floating point properties of different sizes
+		};
+
+		/** @return How values of SourceProperty can be copied into DestProperty. */
+		static ECopyMode GetCopyMode(const FProperty* DestProperty, const FProperty* SourceProperty);
+
+		/** Copies a value which was matched with GetCopyMode. @return False if the value could not be set. */
+		static bool CopyValue(ECopyMode CopyMode, const FProperty* DestProperty, void* Dest, const FProperty* SourceProperty, const void* Source);
+
+		FThumbnailPropertyOverrides();
+		~FThumbnailPropertyOverrides();
+
+		UE_NONCOPYABLE(FThumbnailPropertyOverrides);
+
+	private:
+		// Parsed values of a plan's properties for one set of value strings
+		struct FParsedValues
+		{
+			TWeakObjectPtr<UClass> ActorClass;
+			TArray<FProperty*> Properties; // Same as the plan, used to destroy the values
+			TArray<int32> Offsets;         // Offset of each value in Data, INDEX_NONE if the value is imported on every call
+			uint8* Data = nullptr;
+
+			~FParsedValues();
+		};
+
+		struct FPlan
+		{
+			TObjectPtr<UClass> ActorClass = nullptr;
+			TArray<FProperty*> Properties; // In the order of the overrides, nullptr for unknown properties
+			TMap<FThumbnailRequestKey, TSharedRef<FParsedValues>> ParsedValues;
+		};
+
+		// The actor properties bound to the properties of a property bag layout
+		struct FBagPlan
+		{
+			TObjectPtr<UClass> ActorClass              = nullptr;
+			TObjectPtr<const UPropertyBag> PropertyBag = nullptr;
+			TArray<const FProperty*> ActorProperties; // In the order of the bag's properties, nullptr for unknown or incompatible properties
+			TArray<ECopyMode> CopyModes;
+		};
+
+		// The caches are emptied when full
+		static constexpr int32 MaxPlans               = 256;
+		static constexpr int32 MaxParsedValuesPerPlan = 256;
+
+		TMap<FThumbnailRequestKey, FPlan> Plans;
+		TMap<TPair<const UClass*, const UPropertyBag*>, FBagPlan> BagPlans;
+
+		FDelegateHandle PreGarbageCollectDelegateHandle;
+
+	public:
+
+		/**
+		* Sets the overridden properties of Actor.
+		*
+		* @param Actor                The actor to apply the overrides to.
+		* @param Properties           Property values in format Pair<Name, Value>, where the value is in ImportText format.
+		* @param OutAppliedProperties Optional, receives the properties which were set.
+		*/
+		void Apply(AActor* Actor, const TMap<FString, FString>& Properties, TArray<const FProperty*>* OutAppliedProperties = nullptr);
+
+		/**
+		* Sets the overridden properties of Actor to the values of a property bag, matched by name.
+		*
+		* @param Actor                The actor to apply the overrides to.
+		* @param PropertyBag          Property values to copy to the actor.
+		* @param OutAppliedProperties Optional, receives the properties which were set.
+		*/
+		void Apply(AActor* Actor, const FInstancedPropertyBag& PropertyBag, TArray<const FProperty*>* OutAppliedProperties = nullptr);
+
+		/** Forgets every plan and parsed value. Must be called before a cached actor class is re-instanced. */
+		void Reset();
+
+		FORCEINLINE int32 GetNumPlans() const { return Plans.Num(); }
+		FORCEINLINE int32 GetNumBagPlans() const { return BagPlans.Num(); }
+
+		/** @return The number of sets of value strings parsed for the plans. */
+		int32 GetNumParsedValues() const;
+
+		void AddReferencedObjects(FReferenceCollector& Collector);
+
+	private:
+
+		FPlan& FindOrCreatePlan(UClass* ActorClass, const TMap<FString, FString>& Properties, const FThumbnailRequestKey& PlanKey);
+
+		static TSharedRef<FParsedValues> ParseValues(const FPlan& Plan, AActor* Actor, const TMap<FString, FString>& Properties);
+
+		FBagPlan& FindOrCreateBagPlan(UClass* ActorClass, const UPropertyBag* PropertyBag);
+
+		// Removes the plans of actor classes which are about to be destroyed
+		void RemoveGarbagePlans();
+	};
+
+	/**
+	* Sets a property of a property bag, used by the Blueprint nodes to fill the bag without exporting the value as text.
+	*
+	* @param PropertyBag   The bag to set the value in, must already contain the property.
+	* @param PropertyName  Name of the property in the bag.
+	* @param ValueProperty The type of Value.
+	* @param Value         The value to copy.
+	*/
+	void SetPropertyBagValue(FInstancedPropertyBag& PropertyBag, FName PropertyName, const FProperty* ValueProperty, const void* Value);
+
+	// Keeps the objects referenced by a property bag alive, e.g. while a request is waiting in the task queue
+	class FReferencedPropertyBag : public FGCObject
+	{
+	public:
+		FInstancedPropertyBag PropertyBag;
+
+		explicit FReferencedPropertyBag(const FInstancedPropertyBag& InPropertyBag)
+			: PropertyBag(InPropertyBag)
+		{}
+
+		// ~Begin: FGCObject Interface
+		virtual void AddReferencedObjects(FReferenceCollector& Collector) override;
+		virtual FString GetReferencerName() const override { return TEXT("FReferencedPropertyBag"); }
+		// ~End: FGCObject Interface
+	};
+}
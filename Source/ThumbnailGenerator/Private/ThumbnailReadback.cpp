@@ -0,0 +1,245 @@
+// Copyright Mans Isaksson. All Rights Reserved.
+
+#include "ThumbnailReadback.h"
+#include "ThumbnailGeneratorModule.h"
+#include "ThumbnailGeneratorStats.h"
+#include "ThumbnailScratchBuffers.h"
+
+#include "Engine/TextureRenderTarget2D.h"
+#include "RHIGPUReadback.h"
+#include "RenderingThread.h"
+#include "TextureResource.h"
+
+namespace ThumbnailGenerator
+{
+	// State shared between the game thread and the render thread
+	struct FGPUReadbackState
+	{
+		TUniquePtr<FRHIGPUTextureReadback> Readback;
+		FThumbnailPixelData Pixels;
+		TAtomic<bool> bCopyEnqueued { false }; // Set on the render thread, the readback can't be polled before the copy has been enqueued
+		TAtomic<bool> bResolved { false };
+		bool bSucceeded = false; // Written on the render thread before bResolved is set
+		bool bResolveEnqueued = false;
+		int64 TrackedMemory = 0; // Size of the pixels, reported in STAT_ThumbnailGenerator_ReadbackMemory while the readback is alive
+	};
+
+	// Copies the rows out of the staging buffer, which can only be mapped on the render thread. The copy has to have completed.
+	static void ResolveGPUReadback_RenderThread(FGPUReadbackState& State)
+	{
+		FThumbnailPixelData& Pixels = State.Pixels;
+		const int32 BytesPerPixel = GPixelFormats[Pixels.PixelFormat].BlockBytes;
+		const int32 RowSize       = Pixels.SizeX * BytesPerPixel;
+
+		int32 RowPitchInPixels = 0;
+		if (const uint8* Data = (const uint8*)State.Readback->Lock(RowPitchInPixels))
+		{
+			Pixels.Pixels.SetNumUninitialized(RowSize * Pixels.SizeY, EAllowShrinking::No); // Already sized if acquired from the scratch buffers
+			for (int32 Row = 0; Row < Pixels.SizeY; Row++)
+				FMemory::Memcpy(&Pixels.Pixels[Row * RowSize], Data + int64(Row) * RowPitchInPixels * BytesPerPixel, RowSize);
+
+			State.Readback->Unlock();
+			State.bSucceeded = true;
+		}
+
+		State.bResolved = true;
+	}
+
+	class FThumbnailGPUReadback : public IThumbnailReadback
+	{
+	private:
+		TSharedRef<FGPUReadbackState, ESPMode::ThreadSafe> State;
+
+	public:
+
+		FThumbnailGPUReadback(UTextureRenderTarget2D* RenderTarget, FThumbnailScratchBuffers* ScratchBuffers)
+			: State(MakeShared<FGPUReadbackState, ESPMode::ThreadSafe>())
+		{
+			State->Readback           = MakeUnique<FRHIGPUTextureReadback>(TEXT("ThumbnailReadback"));
+			State->Pixels.SizeX       = RenderTarget->SizeX;
+			State->Pixels.SizeY       = RenderTarget->SizeY;
+			State->Pixels.PixelFormat = RenderTarget->GetFormat();
+			State->TrackedMemory      = int64(State->Pixels.SizeX) * State->Pixels.SizeY * GPixelFormats[State->Pixels.PixelFormat].BlockBytes;
+			INC_MEMORY_STAT_BY(STAT_ThumbnailGenerator_ReadbackMemory, State->TrackedMemory);
+
+			// The pool can only be used from the game thread, so the pixels are acquired up front and only written on the render thread
+			if (ScratchBuffers)
+				State->Pixels.Pixels = ScratchBuffers->Acquire(State->TrackedMemory);
+
+			FTextureRenderTargetResource* Resource = RenderTarget->GameThread_GetRenderTargetResource();
+			ENQUEUE_RENDER_COMMAND(ThumbnailEnqueueReadback)([State = State, Resource](FRHICommandListImmediate& RHICmdList)
+			{
+				if (!Resource || !Resource->GetRenderTargetTexture())
+				{
+					// Nothing to copy, resolve as failed
+					State->bResolved = true;
+					return;
+				}
+
+				State->Readback->EnqueueCopy(RHICmdList, Resource->GetRenderTargetTexture());
+				State->bCopyEnqueued = true;
+			});
+		}
+
+		virtual ~FThumbnailGPUReadback()
+		{
+			DEC_MEMORY_STAT_BY(STAT_ThumbnailGenerator_ReadbackMemory, State->TrackedMemory);
+
+			// The readback has to be released on the render thread, after any pending copy or resolve command
+			ENQUEUE_RENDER_COMMAND(ThumbnailReleaseReadback)([State = State](FRHICommandListImmediate&) {});
+		}
+
+		virtual bool Poll() override
+		{
+			if (State->bResolved)
+				return true;
+
+			if (State->bResolveEnqueued || !State->bCopyEnqueued || !State->Readback->IsReady())
+				return false;
+
+			// Staging buffers can only be mapped on the render thread, copy the rows out there without waiting for it
+			State->bResolveEnqueued = true;
+			ENQUEUE_RENDER_COMMAND(ThumbnailResolveReadback)([State = State](FRHICommandListImmediate&)
+			{
+				ResolveGPUReadback_RenderThread(*State);
+			});
+
+			return false;
+		}
+
+		virtual void Wait() override
+		{
+			THUMBNAIL_STAGE_SCOPE(Readback);
+			if (State->bResolved)
+				return;
+
+			// Instead of polling until the copy is done, the render thread blocks on the GPU once and resolves straight after
+			if (!State->bResolveEnqueued)
+			{
+				State->bResolveEnqueued = true;
+				ENQUEUE_RENDER_COMMAND(ThumbnailWaitReadback)([State = State](FRHICommandListImmediate& RHICmdList)
+				{
+					// Already resolved as failed if there was nothing to copy
+					if (State->bResolved)
+						return;
+
+					if (!State->Readback->IsReady())
+						RHICmdList.BlockUntilGPUIdle();
+
+					ResolveGPUReadback_RenderThread(*State);
+				});
+			}
+
+			FlushRenderingCommands();
+		}
+
+		virtual bool Resolve(FThumbnailPixelData& OutPixels) override
+		{
+			if (!State->bResolved || !State->bSucceeded)
+				return false;
+
+			OutPixels = MoveTemp(State->Pixels);
+			return true;
+		}
+	};
+
+	class FThumbnailCPUReadback : public IThumbnailReadback
+	{
+	private:
+		FThumbnailPixelData Pixels;
+		int32 NumPollsToWait = 0;
+
+	public:
+
+		FThumbnailCPUReadback(FThumbnailPixelData&& InPixels, int32 InNumPollsToWait)
+			: Pixels(MoveTemp(InPixels))
+			, NumPollsToWait(InNumPollsToWait)
+		{}
+
+		virtual bool Poll() override
+		{
+			if (NumPollsToWait <= 0)
+				return true;
+
+			NumPollsToWait--;
+			return false;
+		}
+
+		virtual void Wait() override
+		{
+			NumPollsToWait = 0;
+		}
+
+		virtual bool Resolve(FThumbnailPixelData& OutPixels) override
+		{
+			if (NumPollsToWait > 0 || Pixels.Pixels.Num() == 0)
+				return false;
+
+			OutPixels = MoveTemp(Pixels);
+			return true;
+		}
+	};
+
+	TUniquePtr<IThumbnailReadback> CreateGPUReadback(UTextureRenderTarget2D* RenderTarget, FThumbnailScratchBuffers* ScratchBuffers)
+	{
+		if (!RenderTarget || !RenderTarget->GameThread_GetRenderTargetResource())
+		{
+			UE_LOG(LogThumbnailGenerator, Error, TEXT("ThumbnailGenerator::CreateGPUReadback - Invalid TextureTarget"));
+			return nullptr;
+		}
+
+		return MakeUnique<FThumbnailGPUReadback>(RenderTarget, ScratchBuffers);
+	}
+
+	bool ReadRenderTargetPixels(UTextureRenderTarget2D* RenderTarget, void* OutPixels)
+	{
+		THUMBNAIL_STAGE_SCOPE(Readback);
+
+		FTextureRenderTargetResource* const Resource = RenderTarget ? RenderTarget->GameThread_GetRenderTargetResource() : nullptr;
+		if (!Resource || !OutPixels)
+		{
+			UE_LOG(LogThumbnailGenerator, Error, TEXT("ThumbnailGenerator::ReadRenderTargetPixels - Invalid TextureTarget"));
+			return false;
+		}
+
+		const int32 SizeX         = RenderTarget->SizeX;
+		const int32 SizeY         = RenderTarget->SizeY;
+		const int32 BytesPerPixel = GPixelFormats[RenderTarget->GetFormat()].BlockBytes;
+
+		// Same stall as FRenderTarget::ReadPixels, but the rows are copied from the staging texture straight into OutPixels
+		bool bSuccess = false;
+		ENQUEUE_RENDER_COMMAND(ThumbnailReadRenderTargetPixels)([Resource, OutPixels, SizeX, SizeY, BytesPerPixel, &bSuccess](FRHICommandListImmediate& RHICmdList)
+		{
+			FRHITexture* const Texture = Resource->GetRenderTargetTexture();
+			if (!Texture)
+				return;
+
+			FRHIGPUTextureReadback Readback(TEXT("ThumbnailReadRenderTargetPixels"));
+			Readback.EnqueueCopy(RHICmdList, Texture);
+			RHICmdList.BlockUntilGPUIdle();
+
+			const int32 RowSize = SizeX * BytesPerPixel;
+
+			int32 RowPitchInPixels = 0;
+			if (const uint8* Data = (const uint8*)Readback.Lock(RowPitchInPixels))
+			{
+				for (int32 Row = 0; Row < SizeY; Row++)
+					FMemory::Memcpy((uint8*)OutPixels + int64(Row) * RowSize, Data + int64(Row) * RowPitchInPixels * BytesPerPixel, RowSize);
+
+				Readback.Unlock();
+				bSuccess = true;
+			}
+		});
+		FlushRenderingCommands();
+
+		if (!bSuccess)
+			UE_LOG(LogThumbnailGenerator, Error, TEXT("ThumbnailGenerator::ReadRenderTargetPixels - Failed to read back %s"), *RenderTarget->GetName());
+
+		return bSuccess;
+	}
+
+	TUniquePtr<IThumbnailReadback> CreateCPUReadback(FThumbnailPixelData&& Pixels, int32 NumPollsToWait)
+	{
+		return MakeUnique<FThumbnailCPUReadback>(MoveTemp(Pixels), NumPollsToWait);
+	}
+}
@@ -0,0 +1,65 @@
+// Copyright Mans Isaksson. All Rights Reserved.
+
+#pragma once
+#include "CoreMinimal.h"
+#include "PixelFormat.h"
+
+class UTextureRenderTarget2D;
+class FRHIGPUTextureReadback;
+
+// Tightly packed pixels of a captured thumbnail (B8G8R8A8 or FloatRGBA)
+struct FThumbnailPixelData
+{
+	int32 SizeX = 0;
+	int32 SizeY = 0;
+	EPixelFormat PixelFormat = PF_Unknown;
+	TArray<uint8> Pixels;
+};
+
+// Copy of a captured image from the GPU to the CPU, which completes asynchronously.
+// Only use from the game thread.
+class IThumbnailReadback
+{
+public:
+	virtual ~IThumbnailReadback() = default;
+
+	/** @return True once the pixels can be resolved without blocking. Polling advances the readback. */
+	virtual bool Poll() = 0;
+
+	/** Blocks until the pixels are available. */
+	virtual void Wait() = 0;
+
+	/** Moves the pixels into OutPixels, only valid once Poll has returned true (or after Wait). */
+	virtual bool Resolve(FThumbnailPixelData& OutPixels) = 0;
+};
+
+namespace ThumbnailGenerator
+{
+	class FThumbnailScratchBuffers;
+
+	/**
+	* Enqueues a copy of the current contents of the render target. The copy is scheduled after any capture or
+	* widget draw that has already been enqueued for the render target, so the render target can be reused as soon
+	* as the readback has been resolved.
+	*
+	* @param RenderTarget   The render target to read back.
+	* @param ScratchBuffers Optional pool the resolved pixels are acquired from, the caller is expected to release them once done.
+	*/
+	TUniquePtr<IThumbnailReadback> CreateGPUReadback(UTextureRenderTarget2D* RenderTarget, FThumbnailScratchBuffers* ScratchBuffers = nullptr);
+
+	/**
+	* Copies the current contents of the render target straight into OutPixels and blocks until done.
+	* Unlike FRenderTarget::ReadPixels no intermediate CPU copy of the image is allocated.
+	*
+	* @param OutPixels SizeX * SizeY tightly packed pixels in the render target's format.
+	*/
+	bool ReadRenderTargetPixels(UTextureRenderTarget2D* RenderTarget, void* OutPixels);
+
+	/**
+	* Creates a readback of pixels which are already on the CPU, used as a stand-in for the GPU readback in headless runs and tests.
+	*
+	* @param Pixels         The pixels to return when resolved.
+	* @param NumPollsToWait Number of calls to Poll that return false before the readback is ready, simulating GPU latency.
+	*/
+	TUniquePtr<IThumbnailReadback> CreateCPUReadback(FThumbnailPixelData&& Pixels, int32 NumPollsToWait = 0);
+}
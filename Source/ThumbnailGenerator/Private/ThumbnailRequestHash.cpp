@@ -0,0 +1,234 @@
+// Copyright Mans Isaksson. All Rights Reserved.
+
+#include "ThumbnailRequestHash.h"
+#include "ThumbnailGeneratorSettings.h"
+
+#include "Serialization/ArchiveUObject.h"
+#include "StructUtils/PropertyBag.h"
+#include "UObject/SoftObjectPtr.h"
+#include "UObject/LazyObjectPtr.h"
+#include "UObject/WeakObjectPtr.h"
+
+namespace ThumbnailGenerator
+{
+	// Feeds everything that is serialized into it to a xxHash128 builder.
+	// Object references are replaced by their path names so that the hash does not depend on memory addresses.
+	class FThumbnailHashArchive : public FArchiveUObject
+	{
+	public:
+		FXxHash128Builder Builder;
+
+		FThumbnailHashArchive()
+		{
+			SetIsSaving(true);
+			SetIsPersistent(false);
+		}
+
+		void HashString(const FString& Value)
+		{
+			const int32 Len = Value.Len();
+			Builder.Update(&Len, sizeof(Len));
+			Builder.Update(*Value, Len * sizeof(TCHAR));
+		}
+
+		virtual void Serialize(void* Data, int64 Num) override
+		{
+			Builder.Update(Data, Num);
+		}
+
+		virtual FArchive& operator<<(FName& Value) override
+		{
+			HashString(Value.ToString());
+			return *this;
+		}
+
+		virtual FArchive& operator<<(UObject*& Value) override
+		{
+			HashString(Value ? Value->GetPathName() : FString());
+			return *this;
+		}
+
+		virtual FArchive& operator<<(FObjectPtr& Value) override
+		{
+			UObject* Object = Value.Get();
+			return *this << Object;
+		}
+
+		virtual FArchive& operator<<(FWeakObjectPtr& Value) override
+		{
+			UObject* Object = Value.Get();
+			return *this << Object;
+		}
+
+		virtual FArchive& operator<<(FLazyObjectPtr& Value) override
+		{
+			UObject* Object = Value.Get();
+			return *this << Object;
+		}
+
+		virtual FArchive& operator<<(FSoftObjectPath& Value) override
+		{
+			HashString(Value.ToString());
+			return *this;
+		}
+
+		virtual FArchive& operator<<(FSoftObjectPtr& Value) override
+		{
+			FSoftObjectPath SoftObjectPath = Value.ToSoftObjectPath();
+			return *this << SoftObjectPath;
+		}
+
+		virtual FString GetArchiveName() const override { return TEXT("FThumbnailHashArchive"); }
+	};
+
+	static void HashPropertyOverrides(FThumbnailHashArchive& HashArchive, const TMap<FString, FString>& Properties, const FInstancedPropertyBag* PropertyBag)
+	{
+		// Sort the properties so that the same set of overrides always produces the same key
+		TArray<const TPair<FString, FString>*, TInlineAllocator<32>> SortedProperties;
+		SortedProperties.Reserve(Properties.Num());
+		for (const TPair<FString, FString>& Property : Properties)
+			SortedProperties.Add(&Property);
+
+		SortedProperties.Sort([](const TPair<FString, FString>& A, const TPair<FString, FString>& B) { return A.Key < B.Key; });
+
+		for (const TPair<FString, FString>* Property : SortedProperties)
+		{
+			HashArchive.HashString(Property->Key);
+			HashArchive.HashString(Property->Value);
+		}
+
+		// An empty bag doesn't change the key, so requests without typed overrides keep their cached thumbnails
+		if (const UPropertyBag* BagStruct = PropertyBag ? PropertyBag->GetPropertyBagStruct() : nullptr)
+		{
+			for (const FPropertyBagPropertyDesc& PropertyDesc : BagStruct->GetPropertyDescs())
+			{
+				HashArchive.HashString(PropertyDesc.Name.ToString());
+				HashArchive.HashString(PropertyDesc.CachedProperty ? PropertyDesc.CachedProperty->GetCPPType() : FString());
+				HashArchive.HashString(PropertyDesc.ValueTypeObject ? PropertyDesc.ValueTypeObject->GetPathName() : FString());
+			}
+
+			BagStruct->SerializeBin(HashArchive, const_cast<uint8*>(PropertyBag->GetValue().GetMemory()));
+		}
+	}
+
+	FThumbnailRequestKey ComputeRequestKey(const UClass* ActorClass, const FThumbnailSettings& ThumbnailSettings, const TMap<FString, FString>& Properties, const FInstancedPropertyBag* PropertyBag)
+	{
+		QUICK_SCOPE_CYCLE_COUNTER(STAT_ComputeRequestKey);
+
+		FThumbnailHashArchive HashArchive;
+
+		HashArchive.HashString(ActorClass ? ActorClass->GetPathName() : FString());
+
+		FThumbnailSettings::StaticStruct()->SerializeBin(HashArchive, (void*)&ThumbnailSettings);
+
+		HashPropertyOverrides(HashArchive, Properties, PropertyBag);
+
+		return FThumbnailRequestKey{ HashArchive.Builder.Finalize() };
+	}
+
+	FThumbnailRequestKey ComputeSceneStateKey(const FThumbnailSettings& ThumbnailSettings)
+	{
+		FThumbnailHashArchive HashArchive;
+
+		FThumbnailSettings& Settings = const_cast<FThumbnailSettings&>(ThumbnailSettings);
+		HashArchive << Settings.DirectionalLightRotation;
+		HashArchive << Settings.DirectionalLightIntensity;
+		HashArchive << Settings.DirectionalLightColor;
+		HashArchive << Settings.DirectionalFillLightRotation;
+		HashArchive << Settings.DirectionalFillLightIntensity;
+		HashArchive << Settings.DirectionalFillLightColor;
+		HashArchive << Settings.SkyLightIntensity;
+		HashArchive << Settings.SkyLightColor;
+		HashArchive << Settings.bShowEnvironment;
+		HashArchive << Settings.bEnvironmentAffectLighting;
+		HashArchive << Settings.EnvironmentColor;
+		HashArchive << Settings.EnvironmentRotation;
+		HashArchive.HashString(Settings.EnvironmentCubeMap.ToString());
+		HashArchive.HashString(Settings.ThumbnailSkySphere.ToString());
+
+		return FThumbnailRequestKey{ HashArchive.Builder.Finalize() };
+	}
+
+	FThumbnailRequestKey ComputeBoundsKey(const UClass* ActorClass, const FThumbnailSettings& ThumbnailSettings, const TMap<FString, FString>& Properties, const FInstancedPropertyBag* PropertyBag)
+	{
+		QUICK_SCOPE_CYCLE_COUNTER(STAT_ComputeBoundsKey);
+
+		FThumbnailHashArchive HashArchive;
+
+		HashArchive.HashString(ActorClass ? ActorClass->GetPathName() : FString());
+
+		HashPropertyOverrides(HashArchive, Properties, PropertyBag);
+
+		FThumbnailSettings& Settings = const_cast<FThumbnailSettings&>(ThumbnailSettings);
+		uint8 SimulationMode = uint8(Settings.SimulationMode);
+		HashArchive << SimulationMode;
+		HashArchive << Settings.SimulateSceneTime;
+		HashArchive << Settings.SimulateSceneFramerate;
+		HashArchive << Settings.ComponentsToSimulate;
+		HashArchive << Settings.ThumbnailGeneratorScripts;
+		HashArchive << Settings.bIncludeHiddenComponentsInBounds;
+
+		uint8 BoundsMode = uint8(Settings.BoundsMode);
+		HashArchive << BoundsMode;
+		if (Settings.BoundsMode == EThumbnailBoundsMode::ESampled)
+			HashArchive << Settings.BoundsSampleCount;
+
+		bool bCustomActorTransform = Settings.bOverride_CustomActorTransform;
+		HashArchive << bCustomActorTransform;
+		if (bCustomActorTransform)
+			HashArchive << Settings.CustomActorTransform;
+
+		// Set order isn't stable, sort the classes by name
+		TArray<FString, TInlineAllocator<8>> BlacklistedClasses;
+		for (const UClass* BlacklistedClass : Settings.ComponentBoundsBlacklist)
+			BlacklistedClasses.Add(BlacklistedClass ? BlacklistedClass->GetPathName() : FString());
+
+		BlacklistedClasses.Sort();
+		for (const FString& BlacklistedClass : BlacklistedClasses)
+			HashArchive.HashString(BlacklistedClass);
+
+		return FThumbnailRequestKey{ HashArchive.Builder.Finalize() };
+	}
+
+	FThumbnailRequestKey ComputeViewKey(const FThumbnailRequestKey& BoundsKey, const FThumbnailSettings& ThumbnailSettings, const FTransform& ActorTransform)
+	{
+		FThumbnailHashArchive HashArchive;
+
+		HashArchive.Builder.Update(&BoundsKey.Hash, sizeof(BoundsKey.Hash));
+
+		FTransform Transform = ActorTransform;
+		HashArchive << Transform;
+
+		FThumbnailSettings& Settings = const_cast<FThumbnailSettings&>(ThumbnailSettings);
+		uint8 CameraFitMode = uint8(Settings.CameraFitMode);
+		HashArchive << Settings.ThumbnailTextureWidth;
+		HashArchive << Settings.ThumbnailTextureHeight;
+		HashArchive << Settings.ProjectionType;
+		HashArchive << Settings.CameraFOV;
+		HashArchive << Settings.CameraOrbitRotation;
+		HashArchive << Settings.CameraRotationOffset;
+		HashArchive << Settings.CameraPositionOffset;
+		HashArchive << CameraFitMode;
+		HashArchive << Settings.CameraDistanceOffset;
+		HashArchive << Settings.OrthoWidthOffset;
+		HashArchive << Settings.bSnapToFloor;
+
+		// Overrides which are not set don't affect the view
+		bool bOverrides[] =
+		{
+			Settings.bOverride_CameraDistanceOverride,
+			Settings.bOverride_OrthoWidthOverride,
+			Settings.bOverride_CustomActorBounds,
+		};
+		HashArchive.Serialize(bOverrides, sizeof(bOverrides));
+
+		if (Settings.bOverride_CameraDistanceOverride)
+			HashArchive << Settings.CameraDistanceOverride;
+		if (Settings.bOverride_OrthoWidthOverride)
+			HashArchive << Settings.OrthoWidthOverride;
+		if (Settings.bOverride_CustomActorBounds)
+			HashArchive << Settings.CustomActorBounds;
+
+		return FThumbnailRequestKey{ HashArchive.Builder.Finalize() };
+	}
+}
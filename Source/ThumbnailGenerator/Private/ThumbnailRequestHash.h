@@ -0,0 +1,53 @@
+// Copyright Mans Isaksson. All Rights Reserved.
+
+#pragma once
+#include "CoreMinimal.h"
+#include "Hash/xxhash.h"
+
+struct FThumbnailSettings;
+struct FInstancedPropertyBag;
+
+// Stable 128-bit key identifying the inputs of a thumbnail request (actor class, merged settings and property overrides).
+// Object references are hashed by path name, so keys stay stable between sessions as long as the inputs do.
+struct FThumbnailRequestKey
+{
+	FXxHash128 Hash;
+
+	FORCEINLINE bool IsValid() const { return Hash.HashLow != 0 || Hash.HashHigh != 0; }
+
+	FString ToString() const { return FString::Printf(TEXT("%016llx%016llx"), Hash.HashHigh, Hash.HashLow); }
+
+	friend FORCEINLINE uint32 GetTypeHash(const FThumbnailRequestKey& Key) { return uint32(Key.Hash.HashLow); }
+	friend FORCEINLINE bool operator==(const FThumbnailRequestKey& A, const FThumbnailRequestKey& B) { return A.Hash.HashLow == B.Hash.HashLow && A.Hash.HashHigh == B.Hash.HashHigh; }
+	friend FORCEINLINE bool operator!=(const FThumbnailRequestKey& A, const FThumbnailRequestKey& B) { return !(A == B); }
+};
+
+namespace ThumbnailGenerator
+{
+	/**
+	* Computes the request key for a thumbnail request.
+	*
+	* @param ActorClass        The actor class the thumbnail is generated for.
+	* @param ThumbnailSettings The (merged) settings used for the capture.
+	* @param Properties        Property overrides applied to the actor. Key order does not affect the result.
+	* @param PropertyBag       Optional typed property overrides applied to the actor. Hashed by layout and value, bags which only differ in property order get different keys.
+	*/
+	FThumbnailRequestKey ComputeRequestKey(const UClass* ActorClass, const FThumbnailSettings& ThumbnailSettings, const TMap<FString, FString>& Properties, const FInstancedPropertyBag* PropertyBag = nullptr);
+
+	/**
+	* Computes a key of the settings which are applied to the thumbnail scene by FThumbnailSceneInterface::UpdateScene (lights, environment and sky sphere).
+	* Requests with the same scene state key can be captured without updating the scene in between.
+	*/
+	FThumbnailRequestKey ComputeSceneStateKey(const FThumbnailSettings& ThumbnailSettings);
+
+	/**
+	* Computes a key of the inputs which determine the local bounds of a thumbnail actor: the actor class, the property overrides, and the settings
+	* applied to the actor before its bounds are calculated (simulation, scripts, custom actor transform and which components are included).
+	*/
+	FThumbnailRequestKey ComputeBoundsKey(const UClass* ActorClass, const FThumbnailSettings& ThumbnailSettings, const TMap<FString, FString>& Properties, const FInstancedPropertyBag* PropertyBag = nullptr);
+
+	/**
+	* Computes a key of the inputs of an automatically framed thumbnail view: the bounds key, the camera settings and the actor's transform at capture time.
+	*/
+	FThumbnailRequestKey ComputeViewKey(const FThumbnailRequestKey& BoundsKey, const FThumbnailSettings& ThumbnailSettings, const FTransform& ActorTransform);
+}
@@ -0,0 +1,91 @@
+// Copyright Mans Isaksson. All Rights Reserved.
+
+#include "ThumbnailScratchBuffers.h"
+#include "ThumbnailGeneratorModule.h"
+#include "ThumbnailGeneratorStats.h"
+
+namespace ThumbnailGenerator
+{
+	FThumbnailScratchBuffers::~FThumbnailScratchBuffers()
+	{
+		Trim();
+	}
+
+	int32 FThumbnailScratchBuffers::GetSizeClass(int64 NumBytes)
+	{
+		return FMath::Max(MinSizeClass, int32(FMath::CeilLogTwo64(uint64(FMath::Max<int64>(NumBytes, 1)))));
+	}
+
+	TArray<uint8> FThumbnailScratchBuffers::Acquire(int64 NumBytes)
+	{
+		check(NumBytes >= 0);
+
+		const int32 SizeClass = GetSizeClass(NumBytes);
+		if (SizeClass > MaxSizeClass)
+		{
+			UE_LOG(LogThumbnailGenerator, Error, TEXT("FThumbnailScratchBuffers::Acquire - Requested buffer is too large (%lld bytes)"), NumBytes);
+			return TArray<uint8>();
+		}
+
+		TArray<uint8> Buffer;
+
+		// Prefer the exact size class, but rather hand out a larger buffer than allocate a new one
+		for (int32 FreeClass = SizeClass; FreeClass < FreeBuffers.Num(); FreeClass++)
+		{
+			if (FreeBuffers[FreeClass].Num() > 0)
+			{
+				Buffer = FreeBuffers[FreeClass].Pop(EAllowShrinking::No);
+				FreeMemory -= Buffer.GetAllocatedSize();
+				DEC_MEMORY_STAT_BY(STAT_ThumbnailGenerator_ScratchMemory, Buffer.GetAllocatedSize());
+				break;
+			}
+		}
+
+		if (Buffer.Max() < NumBytes)
+		{
+			Buffer.Empty(int32(1ll << SizeClass));
+			NumAllocations++;
+			INC_DWORD_STAT(STAT_ThumbnailGenerator_ScratchAllocations);
+		}
+
+		Buffer.SetNumUninitialized(int32(NumBytes), EAllowShrinking::No);
+		return Buffer;
+	}
+
+	void FThumbnailScratchBuffers::Release(TArray<uint8>&& Buffer)
+	{
+		if (Buffer.Max() == 0)
+			return;
+
+		// Bucket by the largest class the buffer can serve, so a buffer that is reused never has to grow
+		const int32 SizeClass = FMath::Min(MaxSizeClass, int32(FMath::FloorLog2_64(uint64(Buffer.Max()))));
+		if (SizeClass < MinSizeClass)
+			return;
+
+		if (FreeBuffers.Num() <= SizeClass)
+			FreeBuffers.SetNum(SizeClass + 1);
+
+		FreeMemory += Buffer.GetAllocatedSize();
+		INC_MEMORY_STAT_BY(STAT_ThumbnailGenerator_ScratchMemory, Buffer.GetAllocatedSize());
+
+		Buffer.Reset();
+		FreeBuffers[SizeClass].Add(MoveTemp(Buffer));
+	}
+
+	void FThumbnailScratchBuffers::Trim()
+	{
+		if (FreeMemory > 0)
+			UE_LOG(LogThumbnailGenerator, Verbose, TEXT("FThumbnailScratchBuffers::Trim - Freeing %lld bytes"), FreeMemory);
+
+		DEC_MEMORY_STAT_BY(STAT_ThumbnailGenerator_ScratchMemory, FreeMemory);
+		FreeMemory = 0;
+		FreeBuffers.Empty();
+	}
+
+	FScopedCaptureAllocations::~FScopedCaptureAllocations()
+	{
+		const uint32 NumCaptureAllocations = ScratchBuffers.GetNumAllocations() - NumAllocationsBefore;
+		SET_DWORD_STAT(STAT_ThumbnailGenerator_CaptureAllocations, NumCaptureAllocations);
+		CSV_CUSTOM_STAT(ThumbnailGenerator, CaptureAllocations, int32(NumCaptureAllocations), ECsvCustomStatOp::Set);
+	}
+}
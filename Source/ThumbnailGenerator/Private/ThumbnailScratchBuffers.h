@@ -0,0 +1,75 @@
+// Copyright Mans Isaksson. All Rights Reserved.
+
+#pragma once
+#include "CoreMinimal.h"
+
+namespace ThumbnailGenerator
+{
+	// Pool of byte buffers used for intermediate pixels (alpha planes, readbacks, disk cache copies), so that once the pool has
+	// grown to fit the largest render target, generating thumbnails doesn't allocate.
+	//
+	// Buffers are bucketed in power of two size classes and never shrink. Acquired buffers are handed out as plain arrays and
+	// returned with Release, a buffer which is never released is simply freed by its owner and reallocated on the next miss.
+	// Trim frees the buffers which are not in use.
+	//
+	// Only use from the game thread. An acquired buffer may be written by the render thread as long as it isn't resized.
+	class FThumbnailScratchBuffers
+	{
+	private:
+		static constexpr int32 MinSizeClass = 16; // 64 KiB, smaller requests share the smallest class
+		static constexpr int32 MaxSizeClass = 30; // TArray<uint8> is indexed with int32
+
+		TArray<TArray<TArray<uint8>>> FreeBuffers; // Indexed by size class
+		int64 FreeMemory        = 0;
+		uint32 NumAllocations   = 0;
+
+	public:
+
+		FThumbnailScratchBuffers() = default;
+
+		~FThumbnailScratchBuffers();
+
+		FThumbnailScratchBuffers(const FThumbnailScratchBuffers&) = delete;
+		FThumbnailScratchBuffers& operator=(const FThumbnailScratchBuffers&) = delete;
+
+		/**
+		* Returns a buffer of NumBytes uninitialized bytes, reusing a free buffer of the same or a larger size class if there is one.
+		* Hand it back with Release once done to avoid allocating it again for the next capture.
+		*/
+		TArray<uint8> Acquire(int64 NumBytes);
+
+		/** Returns a buffer to the pool. Buffers which were not acquired from the pool are accepted as well. */
+		void Release(TArray<uint8>&& Buffer);
+
+		/** Frees every buffer which is currently not in use. */
+		void Trim();
+
+		/** @return Number of buffers allocated since the pool was created, i.e. the number of times Acquire couldn't reuse a buffer. */
+		FORCEINLINE uint32 GetNumAllocations() const { return NumAllocations; }
+
+		/** @return Size of the buffers which are currently not in use. */
+		FORCEINLINE int64 GetFreeMemory() const { return FreeMemory; }
+
+	private:
+
+		static int32 GetSizeClass(int64 NumBytes);
+	};
+
+	// Reports the number of scratch buffers allocated while in scope as the allocations of one capture,
+	// in "stat ThumbnailGenerator" and the ThumbnailGenerator CSV category
+	class FScopedCaptureAllocations
+	{
+	private:
+		const FThumbnailScratchBuffers& ScratchBuffers;
+		const uint32 NumAllocationsBefore;
+
+	public:
+
+		explicit FScopedCaptureAllocations(const FThumbnailScratchBuffers& InScratchBuffers)
+			: ScratchBuffers(InScratchBuffers)
+			, NumAllocationsBefore(InScratchBuffers.GetNumAllocations())
+		{}
+
+		~FScopedCaptureAllocations();
+	};
+}
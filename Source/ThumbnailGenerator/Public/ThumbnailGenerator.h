@@ -5,16 +5,151 @@
 #include "CoreMinimal.h"
 #include "Tickable.h"
 #include "UObject/GCObject.h"
+#include "UObject/ObjectKey.h"
+#include "PixelFormat.h"
+#include "StructUtils/PropertyBag.h"
 #include "ThumbnailGeneratorSettings.h"
 #include "ThumbnailGenerator.generated.h"
 
 class UTexture2D;
+class UTextureRenderTarget2D;
 class UStaticMeshComponent;
 class UMaterialInstanceConstant;
 class USceneCaptureComponent2D;
+class UUserWidget;
 
 class UThumbnailGeneratorScript;
 
+struct FThumbnailRequestKey;
+struct FThumbnailPixelData;
+struct FThumbnailCaptureParams;
+
+namespace ThumbnailGenerator { class FThumbnailCapturePipeline; class FThumbnailScratchBuffers; class FThumbnailPropertyOverrides; class FThumbnailBoundsCache; struct FCoalescedThumbnailRequest; }
+
+// Statistics about the thumbnail result cache
+USTRUCT(BlueprintType)
+struct THUMBNAILGENERATOR_API FThumbnailResultCacheStats
+{
+	GENERATED_BODY()
+
+	// Number of requests which were served from the cache
+	UPROPERTY(BlueprintReadOnly, Category = "Thumbnail Generator")
+	int64 Hits = 0;
+
+	// Number of cacheable requests which had to generate a new thumbnail
+	UPROPERTY(BlueprintReadOnly, Category = "Thumbnail Generator")
+	int64 Misses = 0;
+
+	// Number of thumbnails currently in the cache
+	UPROPERTY(BlueprintReadOnly, Category = "Thumbnail Generator")
+	int32 NumCachedThumbnails = 0;
+
+	// Estimated memory used by the cached thumbnails (in bytes)
+	UPROPERTY(BlueprintReadOnly, Category = "Thumbnail Generator")
+	int64 MemoryFootprint = 0;
+};
+
+// Layout of the tiles of a thumbnail atlas (sprite sheet), see FThumbnailGenerator::GenerateActorThumbnailAtlas and GenerateActorThumbnailFlipbook.
+// Tiles are laid out row by row starting in the top left corner, tiles past NumTiles are left transparent.
+USTRUCT(BlueprintType)
+struct THUMBNAILGENERATOR_API FThumbnailAtlasLayout
+{
+	GENERATED_BODY()
+
+	UPROPERTY(BlueprintReadOnly, Category = "Thumbnail Generator")
+	int32 NumTiles = 0;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Thumbnail Generator")
+	int32 NumColumns = 0;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Thumbnail Generator")
+	int32 NumRows = 0;
+
+	// Size of a tile in pixels
+	UPROPERTY(BlueprintReadOnly, Category = "Thumbnail Generator")
+	int32 TileWidth = 0;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Thumbnail Generator")
+	int32 TileHeight = 0;
+
+	// Playback rate of a flipbook in frames per second, 0 for atlases which aren't animated
+	UPROPERTY(BlueprintReadOnly, Category = "Thumbnail Generator")
+	float FrameRate = 0.f;
+
+	/**
+	* @param NumTiles   Number of tiles in the atlas.
+	* @param TileWidth  Width of a tile in pixels.
+	* @param TileHeight Height of a tile in pixels.
+	* @param NumColumns Number of tiles per row, 0 to lay the tiles out in a square.
+	*/
+	static FThumbnailAtlasLayout Make(int32 NumTiles, int32 TileWidth, int32 TileHeight, int32 NumColumns = 0);
+
+	FORCEINLINE int32 GetAtlasWidth() const { return NumColumns * TileWidth; }
+	FORCEINLINE int32 GetAtlasHeight() const { return NumRows * TileHeight; }
+
+	/** @return The top left pixel of a tile. */
+	FORCEINLINE FIntPoint GetTileOffset(int32 TileIndex) const { return FIntPoint((TileIndex % NumColumns) * TileWidth, (TileIndex / NumColumns) * TileHeight); }
+
+	/** @return The UV rectangle of a tile (the sub-UV of a flipbook frame). */
+	FBox2D GetTileUVs(int32 TileIndex) const;
+};
+
+// A single request of a thumbnail batch, see FThumbnailGenerator::GenerateActorThumbnailsBatch
+struct FThumbnailRequest
+{
+	// The type of actor which will be spawned for thumbnail generation.
+	TSubclassOf<AActor> ActorClass;
+
+	// The ThumbnailSettings used for this capture (not merged with the default settings).
+	FThumbnailSettings ThumbnailSettings;
+
+	// Property values to apply to the actor before thumbnail generation (In format Pair<Name, Value>, where the value is applied using Property->ImportText)
+	TMap<FString, FString> Properties;
+
+	// Typed property values to apply to the actor before thumbnail generation, matched by name and applied after Properties
+	FInstancedPropertyBag PropertyBag;
+
+	// Optional pointer to a UTexture2D object to use for the generated thumbnail (if nullptr a new UTexture2D will be created)
+	UTexture2D* ResourceObject = nullptr;
+
+	// Set by the batch, nullptr if a thumbnail could not be generated.
+	UTexture2D* Thumbnail = nullptr;
+};
+
+// Timings and state transitions of a thumbnail batch
+struct FThumbnailBatchStats
+{
+	int32 NumRequests           = 0;
+	int32 NumFailed             = 0;
+	int32 NumGroups             = 0; // Runs of requests sharing scene settings, scripts and render target size
+	int32 NumSceneUpdates       = 0;
+	int32 NumScriptUpdates      = 0;
+	int32 NumDiskCacheHits      = 0;
+	int32 NumPipelineStalls     = 0; // Times a capture had to wait for an earlier capture's readback, see UThumbnailGeneratorSettings::MaxCapturesInFlight
+	int32 NumScratchAllocations = 0; // Scratch buffers allocated during the batch, 0 once the buffers have grown to fit the largest thumbnail
+	double GroupingTime         = 0.0; // Seconds spent sorting the requests
+	double StateChangeTime      = 0.0; // Seconds spent updating the scene, scripts and render targets
+	double CaptureTime          = 0.0; // Seconds spent generating thumbnails
+	double TotalTime            = 0.0;
+};
+
+// Statistics about the bounds cache, see UThumbnailGeneratorSettings::MaxThumbnailBoundsCacheSize
+struct FThumbnailBoundsCacheStats
+{
+	int64 BoundsHits      = 0;
+	int64 BoundsMisses    = 0;
+	int64 ViewHits        = 0; // Automatically framed views which were reused, the bounds are not looked up for these
+	int64 ViewMisses      = 0;
+	int64 PrecomputedHits = 0; // Bounds taken from UThumbnailGeneratorSettings::PrecomputedThumbnailBounds, not counted as hits or misses
+	int32 NumCachedBounds = 0;
+	int32 NumCachedViews  = 0;
+	int32 NumPrecomputedBounds = 0;
+	double TimeSaved      = 0.0; // Seconds, the time it took to compute the entries which were reused
+
+	FORCEINLINE double GetBoundsHitRate() const { return BoundsHits + BoundsMisses > 0 ? double(BoundsHits) / double(BoundsHits + BoundsMisses) : 0.0; }
+	FORCEINLINE double GetViewHitRate() const { return ViewHits + ViewMisses > 0 ? double(ViewHits) / double(ViewHits + ViewMisses) : 0.0; }
+};
+
 // The FThumbnailGenerator can be used to generate thumbnails for your actors.
 // This object manages the underlying scene used for thumbnail generation and various render resources required to capture the thumbnail.
 class THUMBNAILGENERATOR_API FThumbnailGenerator : public FGCObject
@@ -23,17 +158,54 @@ private:
 
 	TSharedPtr<class FThumbnailSceneInterface> ThumbnailScene;
 	TSharedPtr<struct FRenderTargetCache>      RenderTargetCache;
+	TSharedPtr<struct FThumbnailResultCache>   ThumbnailResultCache;
 	TSharedPtr<class FWidgetRenderer>          WidgetRenderer;
+	TSharedPtr<class IThumbnailCaptureBackend> CaptureBackend;
+
+	TSharedPtr<ThumbnailGenerator::FThumbnailScratchBuffers> ScratchBuffers;
+	TSharedPtr<ThumbnailGenerator::FThumbnailPropertyOverrides> PropertyOverrides;
+	TSharedPtr<ThumbnailGenerator::FThumbnailBoundsCache> BoundsCache;
+	FDelegateHandle MemoryTrimDelegateHandle;
 
 	TObjectPtr<class USceneCaptureComponent2D> CaptureComponent = nullptr;
 	TArray<TObjectPtr<UThumbnailGeneratorScript>> ThumbnailGeneratorScripts;
+
+	// Objects kept for reuse, so that repeated captures don't create new UObjects once warmed up
+	TArray<TObjectPtr<UTexture2D>> PooledThumbnailTextures; // Handed back with ReleaseThumbnail, oldest first
+	TArray<TObjectPtr<UUserWidget>> PooledThumbnailWidgets; // One instance per ThumbnailUI class
+	TArray<TObjectPtr<UThumbnailGeneratorScript>> PooledThumbnailGeneratorScripts; // Scripts which are not used by the current settings
+	TArray<TObjectPtr<UTextureRenderTarget2D>> PipelineRenderTargets; // Owned by the slots of the capture pipeline, see FindOrCreatePipelineRenderTarget
+	int64 PooledThumbnailTextureMemory = 0;
+
+	// Textures created by the generator, and how many holders (callers, result cache hits, coalesced subscribers) haven't released them yet.
+	// A texture is only pooled once its last holder releases it, textures which aren't in here (ResourceObjects, assets) are never pooled.
+	TMap<TObjectKey<UTexture2D>, int32> ThumbnailTextureHandouts;
+	int32 NextThumbnailHandoutsPurge = 256;
+
+	// A thumbnail actor of UThumbnailGeneratorSettings::PooledActorClasses, kept in the thumbnail world between captures
+	struct FPooledThumbnailActor
+	{
+		TObjectPtr<AActor> Actor = nullptr;
+		bool bCanReuse = true; // False once the actor has been simulated, or had instanced properties overridden
+	};
+
+	TArray<FPooledThumbnailActor> PooledThumbnailActors; // Idle actors, hidden in the thumbnail world, least recently used first
+	FPooledThumbnailActor ActivePooledActor;             // The actor of the current capture if it is returned to the pool by CleanupThumbnailCapture
+	bool bActivePooledActorNeedsReset = false;           // Set while a reused actor waits for FinishSpawningThumbnailActor
 	
-	TSet<TObjectPtr<AActor>> ThumbnailSceneActors;
+	TArray<TObjectPtr<AActor>> SpawnedThumbnailActors; // Actors spawned in the thumbnail world since PrepareThumbnailCapture
+	FDelegateHandle ActorSpawnedDelegateHandle;
 
 	bool bIsCapturingThumbnail = false;
 
+	// Ids used to tag the trace events of each thumbnail, see ThumbnailGeneratorStats.h
+	uint32 NextRequestTraceId    = 0;
+	uint32 CurrentRequestTraceId = 0;
+
 #if WITH_EDITOR
 	FDelegateHandle EndPIEDelegateHandle;
+	FDelegateHandle ObjectsReplacedDelegateHandle;
+	FDelegateHandle ObjectPropertyChangedDelegateHandle;
 #endif
 
 public:
@@ -46,6 +218,7 @@ public:
 
 	/** 
 	* Synchronously generates a thumbnail for the supplied Actor Class.
+	* If the disk cache is enabled in the project settings, a previously generated thumbnail is loaded from disk instead of being captured.
 	* 
 	* @param ActorClass        The type of actor which will be spawned for thumbnail generation.
 	* @param ThumbnailSettings The ThumbnailSettings can be used to override individual Thumbnail Settings for this capture.
@@ -55,8 +228,20 @@ public:
 	*/
 	UTexture2D* GenerateActorThumbnail(TSubclassOf<AActor> ActorClass, const FThumbnailSettings& ThumbnailSettings, UTexture2D* ResourceObject = nullptr, const TMap<FString, FString>& Properties = TMap<FString, FString>());
 
+	/**
+	* Synchronously generates a thumbnail for the supplied Actor Class, with property values which are copied to the actor without going through text.
+	*
+	* @param ActorClass        The type of actor which will be spawned for thumbnail generation.
+	* @param ThumbnailSettings The ThumbnailSettings can be used to override individual Thumbnail Settings for this capture.
+	* @param ResourceObject    Optional pointer to a UTexture2D object to use for the generated thumbnail (if nullptr a new UTexture2D will be created)
+	* @param PropertyBag       Property values to apply to the actor before thumbnail generation, matched with the actor's properties by name.
+	* @return                  Returns the generated UTexture2D object. Nullptr of a thumbnail could not be generated.
+	*/
+	UTexture2D* GenerateActorThumbnail(TSubclassOf<AActor> ActorClass, const FThumbnailSettings& ThumbnailSettings, UTexture2D* ResourceObject, const FInstancedPropertyBag& PropertyBag);
+
 	/**
 	* Sets up thumbnail generation for the supplied Actor Class. This function can be useful if you wish to execute some custom logic on the Actor before capturing the thumbnail.
+	* Actors of UThumbnailGeneratorSettings::PooledActorClasses are reused from an earlier capture instead of being spawned.
 	* IMPORTANT: Do not call this again before calling FinishGenerateActorThumbnail.
 	* 
 	* @param ActorClass           The type of actor which will be spawned for thumbnail generation.
@@ -67,6 +252,17 @@ public:
 	*/
 	AActor* BeginGenerateActorThumbnail(TSubclassOf<AActor> ActorClass, const FThumbnailSettings& ThumbnailSettings, const TMap<FString, FString>& Properties = TMap<FString, FString>(), bool bFinishSpawningActor = true);
 
+	/**
+	* Same as BeginGenerateActorThumbnail, with property values which are copied to the actor without going through text.
+	* 
+	* @param ActorClass           The type of actor which will be spawned for thumbnail generation.
+	* @param ThumbnailSettings    The ThumbnailSettings can be used to override individual Thumbnail Settings for this capture.
+	* @param PropertyBag          Property values to apply to the actor before thumbnail generation, matched with the actor's properties by name.
+	* @param bFinishSpawningActor Whether to call FinishSpawning on the spawned Actor. If false the actor will be defered spawned without FinishSpawn being called.
+	* @return                     Returns a pointer to the spawned actor. Nullptr if actor failed to spawn.
+	*/
+	AActor* BeginGenerateActorThumbnail(TSubclassOf<AActor> ActorClass, const FThumbnailSettings& ThumbnailSettings, const FInstancedPropertyBag& PropertyBag, bool bFinishSpawningActor = true);
+
 	/**
 	* Finish the thumbnail generation setup by BeginGenerateActorThumbnail.
 	* IMPORTANT: Do not call this before calling BeginGenerateActorThumbnail.
@@ -79,6 +275,69 @@ public:
 	*/
 	UTexture2D* FinishGenerateActorThumbnail(AActor* Actor, const FThumbnailSettings& ThumbnailSettings, UTexture2D* ResourceObject = nullptr, bool bFinishSpawningActor = false);
 
+	/**
+	* Synchronously generates thumbnails for a batch of requests.
+	* The requests are processed grouped by scene settings, thumbnail generator scripts and render target size, so that
+	* updating the thumbnail scene, re-creating scripts and looking up render targets happens once per group instead of once per thumbnail.
+	* The generated thumbnails are written to FThumbnailRequest::Thumbnail.
+	*
+	* @param Requests The requests to generate, their order is preserved in the results.
+	* @return         Timings and number of state changes of the batch.
+	*/
+	FThumbnailBatchStats GenerateActorThumbnailsBatch(TArrayView<FThumbnailRequest> Requests);
+
+	/**
+	* Synchronously generates thumbnails of the supplied Actor Class from several camera angles (e.g. a turntable, see MakeTurntableRotations).
+	* The actor is spawned, has its properties applied, is simulated and has its bounds calculated once. Only the framing and the capture are done per view.
+	*
+	* @param ActorClass           The type of actor which will be spawned for thumbnail generation.
+	* @param ThumbnailSettings    The ThumbnailSettings can be used to override individual Thumbnail Settings for this capture.
+	* @param CameraOrbitRotations One thumbnail is generated per rotation, which replaces the CameraOrbitRotation of ThumbnailSettings.
+	* @param Properties           Property values to apply to the actor before thumbnail generation (In format Pair<Name, Value>, where the value is applied using Property->ImportText)
+	* @return                     One thumbnail per rotation, in the same order. Empty if the thumbnails could not be generated.
+	*/
+	TArray<UTexture2D*> GenerateActorThumbnailViews(TSubclassOf<AActor> ActorClass, const FThumbnailSettings& ThumbnailSettings, TConstArrayView<FRotator> CameraOrbitRotations, 
+		const TMap<FString, FString>& Properties = TMap<FString, FString>());
+
+	/**
+	* Same as GenerateActorThumbnailViews, with each view captured into a tile of a single atlas texture (a sprite sheet) instead of a texture of its own.
+	* The tiles are the size of the thumbnail (ThumbnailTextureWidth x ThumbnailTextureHeight).
+	*
+	* @param ActorClass           The type of actor which will be spawned for thumbnail generation.
+	* @param ThumbnailSettings    The ThumbnailSettings can be used to override individual Thumbnail Settings for this capture.
+	* @param CameraOrbitRotations One tile is captured per rotation, which replaces the CameraOrbitRotation of ThumbnailSettings.
+	* @param OutLayout            Receives the layout of the tiles.
+	* @param NumColumns           Number of tiles per row, 0 to lay the tiles out in a square.
+	* @param Properties           Property values to apply to the actor before thumbnail generation (In format Pair<Name, Value>, where the value is applied using Property->ImportText)
+	* @return                     The atlas texture. Nullptr if the atlas could not be generated.
+	*/
+	UTexture2D* GenerateActorThumbnailAtlas(TSubclassOf<AActor> ActorClass, const FThumbnailSettings& ThumbnailSettings, TConstArrayView<FRotator> CameraOrbitRotations, 
+		FThumbnailAtlasLayout& OutLayout, int32 NumColumns = 0, const TMap<FString, FString>& Properties = TMap<FString, FString>());
+
+	/**
+	* Synchronously generates an animated flipbook of the supplied Actor Class, capturing every StepsPerFrame:th step of the scene simulation into a tile of a single atlas texture.
+	* The number of frames follows from SimulateSceneTime, SimulateSceneFramerate and StepsPerFrame, the simulation mode must not be None.
+	* The tiles are the size of the thumbnail (ThumbnailTextureWidth x ThumbnailTextureHeight) in the format of ThumbnailBitDepth.
+	*
+	* @param ActorClass        The type of actor which will be spawned for thumbnail generation.
+	* @param ThumbnailSettings The ThumbnailSettings can be used to override individual Thumbnail Settings for this capture.
+	* @param StepsPerFrame     Number of simulated steps between two frames.
+	* @param bFrameEachFrame   Whether to frame the camera on each frame, rather than capturing every frame with the view of the first one. Snap To Floor is applied before the simulation.
+	* @param OutLayout         Receives the layout of the frames, with the frame rate of the flipbook.
+	* @param NumColumns        Number of frames per row, 0 to lay the frames out in a square.
+	* @param Properties        Property values to apply to the actor before thumbnail generation (In format Pair<Name, Value>, where the value is applied using Property->ImportText)
+	* @return                  The flipbook atlas texture. Nullptr if the flipbook could not be generated.
+	*/
+	UTexture2D* GenerateActorThumbnailFlipbook(TSubclassOf<AActor> ActorClass, const FThumbnailSettings& ThumbnailSettings, int32 StepsPerFrame, bool bFrameEachFrame, 
+		FThumbnailAtlasLayout& OutLayout, int32 NumColumns = 0, const TMap<FString, FString>& Properties = TMap<FString, FString>());
+
+	/**
+	* @param NumViews      Number of views around the actor.
+	* @param StartRotation Camera orbit rotation of the first view, the following views are turned around the yaw axis.
+	* @return              NumViews camera orbit rotations evenly spaced around the actor.
+	*/
+	static TArray<FRotator> MakeTurntableRotations(int32 NumViews, const FRotator& StartRotation = FRotator::ZeroRotator);
+
 	/** 
 	* Creates the underlying world used for thumbnail generation (Gets called automatically on "Generate Thumbnail"). 
 	* Might want to call this if the assets required for thumbnail generation causes hitching when loaded for the first time.
@@ -113,14 +372,155 @@ public:
 	*/
 	FORCEINLINE USceneCaptureComponent2D* GetThumbnailCaptureComponent() const { return CaptureComponent;  }
 
+	/**
+	* Looks up a previously generated thumbnail in the result cache. The result cache is disabled unless MaxThumbnailResultCacheSize is set in the project settings.
+	*
+	* @param ActorClass        The actor class the thumbnail was generated for.
+	* @param ThumbnailSettings The (merged) ThumbnailSettings the thumbnail was generated with.
+	* @param Properties        The property values which were applied to the actor.
+	* @return                  The cached thumbnail, nullptr if no matching thumbnail is cached.
+	*/
+	UTexture2D* FindCachedThumbnail(TSubclassOf<AActor> ActorClass, const FThumbnailSettings& ThumbnailSettings, const TMap<FString, FString>& Properties = TMap<FString, FString>());
+
+	/**
+	* Adds a generated thumbnail to the result cache, replacing any thumbnail previously cached for the same inputs.
+	*
+	* @param ActorClass        The actor class the thumbnail was generated for.
+	* @param ThumbnailSettings The (merged) ThumbnailSettings the thumbnail was generated with.
+	* @param Properties        The property values which were applied to the actor.
+	* @param Thumbnail         The generated thumbnail.
+	*/
+	void AddCachedThumbnail(TSubclassOf<AActor> ActorClass, const FThumbnailSettings& ThumbnailSettings, const TMap<FString, FString>& Properties, UTexture2D* Thumbnail);
+
+	/**
+	* Removes all cached thumbnails generated for the supplied actor class.
+	*
+	* @param ActorClass The actor class to invalidate. Thumbnails of child classes are not affected.
+	*/
+	void InvalidateCachedThumbnails(TSubclassOf<AActor> ActorClass);
+
+	/** Removes all thumbnails from the result cache. */
+	void ClearThumbnailResultCache();
+
+	/** @return Hit/miss counters and memory usage of the result cache. */
+	FThumbnailResultCacheStats GetThumbnailResultCacheStats() const;
+
+	/** Forgets the cached actor bounds and camera views, e.g. after changing an asset which is used by thumbnail actors outside of the editor. */
+	void ClearThumbnailBoundsCache();
+
+	/** @return Hit/miss counters and the time saved by the bounds cache. */
+	FThumbnailBoundsCacheStats GetThumbnailBoundsCacheStats() const;
+
+	/**
+	* Spawns and prepares an actor the same way a capture would (scripts, IThumbnailActorInterface and simulation), and calculates its local bounds without capturing a thumbnail.
+	* Used by the ThumbnailPrecomputeBounds commandlet to precompute the bounds of actor blueprints, see UThumbnailGeneratorSettings::PrecomputedThumbnailBounds.
+	* IMPORTANT: Do not call this between BeginGenerateActorThumbnail and FinishGenerateActorThumbnail.
+	*
+	* @param ActorClass        The type of actor to calculate the bounds of.
+	* @param ThumbnailSettings The (merged) ThumbnailSettings the bounds are calculated with.
+	* @param OutBounds         Receives the bounds in actor space and the bounds key they are valid for.
+	* @return                  False if the actor could not be spawned.
+	*/
+	bool CalculateActorThumbnailBounds(TSubclassOf<AActor> ActorClass, const FThumbnailSettings& ThumbnailSettings, struct FThumbnailPrecomputedActorBounds& OutBounds);
+
+	/**
+	* Hands a generated thumbnail back to the generator once it is no longer used, the caller must not use the texture after it has been released.
+	* Once every caller which has been handed the texture (result cache hits and coalesced async requests share a texture) has released it, the
+	* texture is removed from the result cache and the next thumbnail with the same size and bit depth reuses it instead of creating a new UTexture2D.
+	* Only thumbnails created by the generator are pooled, see UThumbnailGeneratorSettings::MaxPooledThumbnailTextureSize.
+	*
+	* @param Thumbnail The thumbnail to release.
+	*/
+	void ReleaseThumbnail(UTexture2D* Thumbnail);
+
+	/**
+	* Frees the pooled thumbnail textures, widgets, scripts and actors, the cached property overrides and bounds, and the scratch buffers used for captures and readbacks, which are currently not in use.
+	* Called automatically when the platform is low on memory (FCoreDelegates::GetMemoryTrimDelegate).
+	*/
+	void TrimPooledResources();
+
 private:
 
+	TSharedRef<ThumbnailGenerator::FThumbnailScratchBuffers> GetScratchBuffers();
+
+	UTexture2D* AcquireThumbnailTexture(const FString& Name, int32 SizeX, int32 SizeY, EPixelFormat PixelFormat);
+
+	// Counts another holder of a texture created by the generator, for textures which are handed out more than once
+	void AddThumbnailHandout(UTexture2D* Thumbnail);
+
+	void UpdatePooledThumbnailTextureMemory();
+
+	UUserWidget* FindOrCreateThumbnailWidget(TSubclassOf<UUserWidget> WidgetClass);
+
+	AActor* AcquirePooledThumbnailActor(UClass* ActorClass);
+
+	void FinishSpawningThumbnailActor(AActor* Actor);
+
+	void ReleasePooledThumbnailActor();
+
+	void DestroyPooledThumbnailActors();
+
+	UTexture2D* FindCachedThumbnail(const FThumbnailRequestKey& RequestKey);
+
+	void AddCachedThumbnail(const FThumbnailRequestKey& RequestKey, const UClass* ActorClass, UTexture2D* Thumbnail);
+
+	friend class UThumbnailGeneration;
+
+	UTexture2D* GenerateActorThumbnailInternal(TSubclassOf<AActor> ActorClass, const FThumbnailSettings& ThumbnailSettings, UTexture2D* ResourceObject, const TMap<FString, FString>& Properties, 
+		const FInstancedPropertyBag& PropertyBag, UTextureRenderTarget2D* RenderTarget, bool* bOutDiskCacheHit = nullptr, bool bDiskCacheOnly = false);
+
+	bool GenerateActorThumbnailPipelined(FThumbnailRequest& Request, ThumbnailGenerator::FThumbnailCapturePipeline& Pipeline, bool& bOutDiskCacheHit);
+
+	AActor* BeginGenerateActorThumbnailInternal(TSubclassOf<AActor> ActorClass, const FThumbnailSettings& ThumbnailSettings, const TMap<FString, FString>& Properties, const FInstancedPropertyBag& PropertyBag,
+		bool bFinishSpawningActor, bool bUpdateSceneState, bool bAllowActorPooling = true);
+
+	UTexture2D* FinishGenerateActorThumbnailInternal(AActor* Actor, const FThumbnailSettings& ThumbnailSettings, UTexture2D* ResourceObject, bool bFinishSpawningActor, UTextureRenderTarget2D* RenderTarget);
+
+	void CacheBoundsOfCurrentCapture(TSubclassOf<AActor> ActorClass, const FThumbnailSettings& ThumbnailSettings, const TMap<FString, FString>& Properties, const FInstancedPropertyBag& PropertyBag);
+
+	bool CaptureActorViews(TSubclassOf<AActor> ActorClass, const FThumbnailSettings& ThumbnailSettings, TConstArrayView<FRotator> CameraOrbitRotations, const TMap<FString, FString>& Properties,
+		TFunctionRef<bool(int32 ViewIndex, const FThumbnailSettings& ViewSettings, UTextureRenderTarget2D* RenderTarget, AActor* Actor)> CaptureView);
+
+	// OnSimulationStep is called with INDEX_NONE before the first simulated step and with the index of the step after each step, returning false aborts the capture
+	bool PrepareActorForCapture(AActor* Actor, const FThumbnailSettings& ThumbnailSettings, bool bFinishSpawningActor, const TFunction<bool(int32)>& OnSimulationStep = nullptr);
+
+	bool UpdateThumbnailGeneratorScripts(const FThumbnailSettings& ThumbnailSettings);
+
+	UTextureRenderTarget2D* FindOrCreateRenderTarget(const FThumbnailSettings& ThumbnailSettings);
+
+	// Render target of a capture pipeline slot (two per slot, color and alpha), kept out of the render target cache so it can't be evicted while its readback is pending
+	UTextureRenderTarget2D* FindOrCreatePipelineRenderTarget(const FThumbnailSettings& ThumbnailSettings, int32 Index);
+
+	FMinimalViewInfo CalculateThumbnailView(const FThumbnailSettings& ThumbnailSettings, AActor* Actor);
+
+	FBox CalculateThumbnailBounds(const FThumbnailSettings& ThumbnailSettings, AActor* Actor);
+
+	// Acquires the atlas texture and locks it for writing, the atlas must be finished with FinishThumbnailAtlas
+	UTexture2D* BeginThumbnailAtlas(const FString& Name, const FThumbnailSettings& ThumbnailSettings, const FThumbnailAtlasLayout& Layout, uint8*& OutAtlasData);
+
+	bool CaptureThumbnailAtlasTile(const FThumbnailSettings& ThumbnailSettings, UTextureRenderTarget2D* RenderTarget, AActor* Actor, const FThumbnailAtlasLayout& Layout, 
+		int32 TileIndex, uint8* AtlasData, const FMinimalViewInfo* View = nullptr);
+
+	// Unlocks and uploads the atlas, or releases it if not every tile was captured
+	UTexture2D* FinishThumbnailAtlas(UTexture2D* AtlasTexture, bool bCaptured);
+
+	// View is used as is instead of framing the actor, if set
+	FThumbnailCaptureParams MakeCaptureParams(const FThumbnailSettings& ThumbnailSettings, AActor* Actor, UTextureRenderTarget2D* RenderTarget, UTextureRenderTarget2D* AlphaRenderTarget, 
+		const FMinimalViewInfo* View = nullptr);
+
+	void FlushThumbnailDebugLines();
+
 	UTexture2D* CaptureThumbnail(const FThumbnailSettings& ThumbnailSettings, UTextureRenderTarget2D* RenderTarget, AActor* Actor, UTexture2D* ResourceObject);
 
+	bool EnqueuePipelinedCapture(const FThumbnailSettings& ThumbnailSettings, UTextureRenderTarget2D* RenderTarget, UTextureRenderTarget2D* AlphaRenderTarget, AActor* Actor,
+		ThumbnailGenerator::FThumbnailCapturePipeline& Pipeline, int32 Slot, TFunction<void(FThumbnailPixelData*)>&& OnPixelsReady);
+
 	void PrepareThumbnailCapture();
 
 	void CleanupThumbnailCapture();
 
+	void OnThumbnailActorSpawned(AActor* Actor);
+
 	// ~Begin: FGCObject Interface
 	virtual void AddReferencedObjects(FReferenceCollector& Collector);
 	virtual FString GetReferencerName() const override;
@@ -130,6 +530,54 @@ private:
 
 extern THUMBNAILGENERATOR_API FThumbnailGenerator* GThumbnailGenerator;
 
+UENUM(BlueprintType)
+enum class EThumbnailRequestState : uint8
+{
+	EInvalid	UMETA(DisplayName = "Invalid"),
+	EQueued		UMETA(DisplayName = "Queued"),
+	ERunning	UMETA(DisplayName = "Running"),
+	EDone		UMETA(DisplayName = "Done"),
+	ECancelled	UMETA(DisplayName = "Cancelled"),
+};
+
+// Handle to an asynchronous thumbnail request, can be used to cancel or re-prioritize the request while it is queued.
+USTRUCT(BlueprintType)
+struct THUMBNAILGENERATOR_API FThumbnailRequestHandle
+{
+	GENERATED_BODY()
+
+private:
+	TSharedPtr<struct FThumbnailRequestState> RequestState;
+
+public:
+
+	FThumbnailRequestHandle() = default;
+
+	FThumbnailRequestHandle(const TSharedPtr<struct FThumbnailRequestState>& InRequestState)
+		: RequestState(InRequestState)
+	{}
+
+	/** @return Whether this handle refers to a request. */
+	FORCEINLINE bool IsValid() const { return RequestState.IsValid(); }
+
+	/** @return The current state of the request. */
+	EThumbnailRequestState GetState() const;
+
+	/** 
+	* Cancels the request if it has not started yet. The callback of a cancelled request is never called.
+	* 
+	* @return True if the request was cancelled.
+	*/
+	bool Cancel();
+
+	/** 
+	* Changes the priority of a queued request. The request is moved to the back of the new priority.
+	* 
+	* @return True if the request is still queued.
+	*/
+	bool SetPriority(EThumbnailRequestPriority Priority);
+};
+
 UCLASS(meta=(ScriptName="ThumbnailGeneration"))
 class THUMBNAILGENERATOR_API UThumbnailGeneration : public UObject
 {
@@ -149,6 +597,80 @@ public:
 	static UTexture2D* GenerateThumbnail(TSubclassOf<AActor> ActorClass, const FThumbnailSettings& ThumbnailSettings = FThumbnailSettings(), 
 		UTexture2D* ResourceObject = nullptr, const TMap<FString, FString>& Properties = TMap<FString, FString>());
 
+	/** 
+	* Synchronously generates a thumbnail for the supplied Actor Class using the global thumbnail generator, with property values which are copied to the actor without going through text.
+	* 
+	* @param ActorClass        The type of actor which will be spawned for thumbnail generation.
+	* @param ThumbnailSettings The ThumbnailSettings can be used to override individual Thumbnail Settings for this capture.
+	* @param ResourceObject    Optional pointer to a UTexture2D object to use for the generated thumbnail (if nullptr a new UTexture2D will be created)
+	* @param PropertyBag       Property values to apply to the actor before thumbnail generation, matched with the actor's properties by name.
+	* @return                  Returns the generated UTexture2D object. Nullptr of a thumbnail could not be generated.
+	*/
+	static UTexture2D* GenerateThumbnail(TSubclassOf<AActor> ActorClass, const FThumbnailSettings& ThumbnailSettings, UTexture2D* ResourceObject, const FInstancedPropertyBag& PropertyBag);
+
+	/**
+	* Synchronously generates thumbnails of the supplied Actor Class from several camera angles using the global thumbnail generator.
+	* The actor is spawned, simulated and has its bounds calculated once, only the framing and the capture are done per view.
+	* 
+	* @param ActorClass           The type of actor which will be spawned for thumbnail generation.
+	* @param ThumbnailSettings    The ThumbnailSettings can be used to override individual Thumbnail Settings for this capture.
+	* @param CameraOrbitRotations One thumbnail is generated per rotation, which replaces the Camera Orbit Rotation of the Thumbnail Settings (see Make Turntable Rotations).
+	* @param Properties           Property values to apply to the actor before thumbnail generation (In format Pair<Name, Value>, where the value is applied using Property->ImportText)
+	* @return                     One thumbnail per rotation, in the same order. Empty if the thumbnails could not be generated.
+	*/
+	UFUNCTION(BlueprintCallable, Category = "Thumbnail Generator", meta = (AutoCreateRefTerm = "ThumbnailSettings,Properties"))
+	static TArray<UTexture2D*> GenerateThumbnailViews(TSubclassOf<AActor> ActorClass, const FThumbnailSettings& ThumbnailSettings, const TArray<FRotator>& CameraOrbitRotations, 
+		const TMap<FString, FString>& Properties);
+
+	/**
+	* Same as Generate Thumbnail Views, with each view captured into a tile of a single atlas texture (a sprite sheet).
+	* 
+	* @param ActorClass           The type of actor which will be spawned for thumbnail generation.
+	* @param ThumbnailSettings    The ThumbnailSettings can be used to override individual Thumbnail Settings for this capture.
+	* @param CameraOrbitRotations One tile is captured per rotation, which replaces the Camera Orbit Rotation of the Thumbnail Settings (see Make Turntable Rotations).
+	* @param OutLayout            Receives the layout of the tiles.
+	* @param NumColumns           Number of tiles per row, 0 to lay the tiles out in a square.
+	* @param Properties           Property values to apply to the actor before thumbnail generation (In format Pair<Name, Value>, where the value is applied using Property->ImportText)
+	* @return                     The atlas texture. Nullptr if the atlas could not be generated.
+	*/
+	UFUNCTION(BlueprintCallable, Category = "Thumbnail Generator", meta = (AutoCreateRefTerm = "ThumbnailSettings,Properties"))
+	static UTexture2D* GenerateThumbnailAtlas(TSubclassOf<AActor> ActorClass, const FThumbnailSettings& ThumbnailSettings, const TArray<FRotator>& CameraOrbitRotations, 
+		FThumbnailAtlasLayout& OutLayout, int32 NumColumns, const TMap<FString, FString>& Properties);
+
+	/**
+	* @param NumViews      Number of views around the actor.
+	* @param StartRotation Camera orbit rotation of the first view, the following views are turned around the yaw axis.
+	* @return              NumViews camera orbit rotations evenly spaced around the actor.
+	*/
+	UFUNCTION(BlueprintPure, Category = "Thumbnail Generator")
+	static TArray<FRotator> MakeTurntableRotations(int32 NumViews = 8, FRotator StartRotation = FRotator::ZeroRotator);
+
+	/**
+	* Synchronously generates an animated flipbook of the supplied Actor Class using the global thumbnail generator.
+	* Every Steps Per Frame:th step of the scene simulation is captured into a tile of a single atlas texture, the simulation mode must not be None.
+	* 
+	* @param ActorClass        The type of actor which will be spawned for thumbnail generation.
+	* @param ThumbnailSettings The ThumbnailSettings can be used to override individual Thumbnail Settings for this capture.
+	* @param StepsPerFrame     Number of simulated steps between two frames.
+	* @param bFrameEachFrame   Whether to frame the camera on each frame, rather than capturing every frame with the view of the first one. Snap To Floor is applied before the simulation.
+	* @param OutLayout         Receives the layout of the frames, with the frame rate of the flipbook.
+	* @param NumColumns        Number of frames per row, 0 to lay the frames out in a square.
+	* @param Properties        Property values to apply to the actor before thumbnail generation (In format Pair<Name, Value>, where the value is applied using Property->ImportText)
+	* @return                  The flipbook atlas texture. Nullptr if the flipbook could not be generated.
+	*/
+	UFUNCTION(BlueprintCallable, Category = "Thumbnail Generator", meta = (AutoCreateRefTerm = "ThumbnailSettings,Properties"))
+	static UTexture2D* GenerateThumbnailFlipbook(TSubclassOf<AActor> ActorClass, const FThumbnailSettings& ThumbnailSettings, int32 StepsPerFrame, bool bFrameEachFrame, 
+		FThumbnailAtlasLayout& OutLayout, int32 NumColumns, const TMap<FString, FString>& Properties);
+
+	/**
+	* @param Layout    The layout of a thumbnail atlas.
+	* @param TileIndex The tile (view or frame) to get the UVs of.
+	* @param OutUVMin  Top left UV of the tile.
+	* @param OutUVMax  Bottom right UV of the tile.
+	*/
+	UFUNCTION(BlueprintPure, Category = "Thumbnail Generator")
+	static void GetThumbnailAtlasTileUVs(const FThumbnailAtlasLayout& Layout, int32 TileIndex, FVector2D& OutUVMin, FVector2D& OutUVMax);
+
 	DECLARE_DELEGATE_OneParam(FGenerateThumbnailCallbackNative, UTexture2D*)
 	DECLARE_DELEGATE_OneParam(FPreCaptureThumbnailNative, AActor*)
 
@@ -161,10 +683,28 @@ public:
 	* @param PreCaptureThumbnail This delegate will be executed on the thumbnail actor before the thumbnail is captured
 	* @param ResourceObject      Optional pointer to a UTexture2D object to use for the generated thumbnail (if nullptr a new UTexture2D will be created)
 	* @param Properties          Property values to apply to the actor before thumbnail generation (In format Pair<Name, Value>, where the value is applied using Property->ImportText)
-	* @return                    Pointer to the generated UTexture2D object (null if thumbnail failed to generate)
+	* @param Priority            Requests with a higher priority are processed first, requests with the same priority are processed in the order they were made.
+	* @return                    Handle which can be used to cancel or re-prioritize the request
 	*/
-	static void GenerateThumbnailAsync(UClass* ActorClass, const FGenerateThumbnailCallbackNative& Callback, const FThumbnailSettings& ThumbnailSettings = FThumbnailSettings(),
-		const FPreCaptureThumbnailNative& PreCaptureThumbnail = FPreCaptureThumbnailNative(), UTexture2D* ResourceObject = nullptr, const TMap<FString, FString>& Properties = TMap<FString, FString>());
+	static FThumbnailRequestHandle GenerateThumbnailAsync(UClass* ActorClass, const FGenerateThumbnailCallbackNative& Callback, const FThumbnailSettings& ThumbnailSettings = FThumbnailSettings(),
+		const FPreCaptureThumbnailNative& PreCaptureThumbnail = FPreCaptureThumbnailNative(), UTexture2D* ResourceObject = nullptr, const TMap<FString, FString>& Properties = TMap<FString, FString>(),
+		EThumbnailRequestPriority Priority = EThumbnailRequestPriority::ENormal);
+
+	/** 
+	* Asynchronousy generates a thumbnail for the supplied Actor Class using the global thumbnail generator, with property values which are copied to the actor without going through text.
+	* 
+	* @param ActorClass          The actor class of which a thumbnail will be generated.
+	* @param Callback            Callback for when the thumbnail has finished generating.
+	* @param ThumbnailSettings   This struct can be used to override individual Thumbnail Settings for this capture.
+	* @param PreCaptureThumbnail This delegate will be executed on the thumbnail actor before the thumbnail is captured
+	* @param ResourceObject      Optional pointer to a UTexture2D object to use for the generated thumbnail (if nullptr a new UTexture2D will be created)
+	* @param PropertyBag         Property values to apply to the actor before thumbnail generation, matched with the actor's properties by name. Objects referenced by the values are kept alive until the request has finished.
+	* @param Priority            Requests with a higher priority are processed first, requests with the same priority are processed in the order they were made.
+	* @return                    Handle which can be used to cancel or re-prioritize the request
+	*/
+	static FThumbnailRequestHandle GenerateThumbnailAsync(UClass* ActorClass, const FGenerateThumbnailCallbackNative& Callback, const FThumbnailSettings& ThumbnailSettings,
+		const FPreCaptureThumbnailNative& PreCaptureThumbnail, UTexture2D* ResourceObject, const FInstancedPropertyBag& PropertyBag,
+		EThumbnailRequestPriority Priority = EThumbnailRequestPriority::ENormal);
 
 	/** 
 	* Gets the underlying world used for thumbnail generation in the global thumbnail generator
@@ -203,6 +743,62 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Thumbnail Generator|Editor Utility", meta=(DevelopmentOnly))
 	static UTexture2D* SaveThumbnail(UTexture2D* Thumbnail, const FDirectoryPath &OutputDirectory, FString OutputName = "");
 
+	/**
+	* Removes all cached thumbnails of the supplied actor class from the global thumbnail generator's result cache.
+	* Call this when something that affects the look of the actor has changed at runtime.
+	* 
+	* @param ActorClass The actor class to invalidate.
+	*/
+	UFUNCTION(BlueprintCallable, Category = "Thumbnail Generator|Cache")
+	static void InvalidateCachedThumbnails(TSubclassOf<AActor> ActorClass);
+
+	/**
+	* Removes all thumbnails from the global thumbnail generator's result cache.
+	*/
+	UFUNCTION(BlueprintCallable, Category = "Thumbnail Generator|Cache")
+	static void ClearThumbnailResultCache();
+
+	/**
+	* @return Hit/miss counters and memory usage of the global thumbnail generator's result cache.
+	*/
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Thumbnail Generator|Cache")
+	static FThumbnailResultCacheStats GetThumbnailResultCacheStats();
+
+	/**
+	* Hands a generated thumbnail back to the global thumbnail generator once it is no longer used, so that the next thumbnail
+	* of the same size and bit depth can reuse the texture instead of creating a new one. Do not use the thumbnail after releasing it.
+	* 
+	* @param Thumbnail The thumbnail to release.
+	*/
+	UFUNCTION(BlueprintCallable, Category = "Thumbnail Generator|Cache")
+	static void ReleaseThumbnail(UTexture2D* Thumbnail);
+
+	/**
+	* Cancels an asynchronous thumbnail request if it has not started yet. The callback of a cancelled request is never called.
+	* 
+	* @param RequestHandle The handle returned by Generate Thumbnail Async.
+	* @return              True if the request was cancelled.
+	*/
+	UFUNCTION(BlueprintCallable, Category = "Thumbnail Generator|Async")
+	static bool CancelThumbnailRequest(UPARAM(ref) FThumbnailRequestHandle& RequestHandle);
+
+	/**
+	* Changes the priority of a queued asynchronous thumbnail request.
+	* 
+	* @param RequestHandle The handle returned by Generate Thumbnail Async.
+	* @param Priority      The new priority of the request.
+	* @return              True if the request is still queued.
+	*/
+	UFUNCTION(BlueprintCallable, Category = "Thumbnail Generator|Async")
+	static bool SetThumbnailRequestPriority(UPARAM(ref) FThumbnailRequestHandle& RequestHandle, EThumbnailRequestPriority Priority);
+
+	/**
+	* @param RequestHandle The handle returned by Generate Thumbnail Async.
+	* @return              The current state of the request.
+	*/
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Thumbnail Generator|Async")
+	static EThumbnailRequestState GetThumbnailRequestState(const FThumbnailRequestHandle& RequestHandle);
+
 
 	// Blueprint Internal Functions
 
@@ -219,8 +815,24 @@ public:
 	DECLARE_DYNAMIC_DELEGATE_OneParam(FPreCaptureThumbnail, class AActor*, Actor);
 
 	UFUNCTION(BlueprintCallable, meta = (BlueprintInternalUseOnly = "TRUE"))
-	static void K2_GenerateThumbnailAsync(UClass* ActorClass, FThumbnailSettings ThumbnailSettings, 
-		TMap<FString, FString> Properties, FGenerateThumbnailCallback Callback, FPreCaptureThumbnail PreCaptureThumbnail);
+	static FThumbnailRequestHandle K2_GenerateThumbnailAsync(UClass* ActorClass, FThumbnailSettings ThumbnailSettings, TMap<FString, FString> Properties, 
+		const FInstancedPropertyBag& PropertyBag, FGenerateThumbnailCallback Callback, FPreCaptureThumbnail PreCaptureThumbnail, EThumbnailRequestPriority Priority = EThumbnailRequestPriority::ENormal);
+
+	// Makes a property bag with the layout of the named properties of ActorClass, filled in by K2_SetPropertyBagValue
+	UFUNCTION(BlueprintCallable, meta = (BlueprintInternalUseOnly = "TRUE"))
+	static FInstancedPropertyBag K2_MakeThumbnailPropertyBag(UClass* ActorClass, const TArray<FName>& PropertyNames);
+
+	UFUNCTION(BlueprintCallable, CustomThunk, meta = (CustomStructureParam = "Value", BlueprintInternalUseOnly = "TRUE"))
+	static void K2_SetPropertyBagValue(UPARAM(ref) FInstancedPropertyBag& PropertyBag, FName PropertyName, const int32& Value);
+	DECLARE_FUNCTION(execK2_SetPropertyBagValue);
+
+	UFUNCTION(BlueprintCallable, CustomThunk, meta = (ArrayParm = "Value", BlueprintInternalUseOnly = "TRUE"))
+	static void K2_SetPropertyBagArrayValue(UPARAM(ref) FInstancedPropertyBag& PropertyBag, FName PropertyName, const TArray<int32>& Value);
+	DECLARE_FUNCTION(execK2_SetPropertyBagArrayValue);
+
+	UFUNCTION(BlueprintCallable, CustomThunk, meta = (SetParam = "Value", BlueprintInternalUseOnly = "TRUE"))
+	static void K2_SetPropertyBagSetValue(UPARAM(ref) FInstancedPropertyBag& PropertyBag, FName PropertyName, const TSet<int32>& Value);
+	DECLARE_FUNCTION(execK2_SetPropertyBagSetValue);
 
 	UFUNCTION(BlueprintPure, meta = (BlueprintInternalUseOnly = "TRUE"))
 	static FThumbnailSettings K2_FinalizeThumbnailSettings(FThumbnailSettings ThumbnailSettings);
@@ -241,4 +853,15 @@ public:
 	static FString K2_ExportSetPropertyText(const TSet<int32>& Property);
 	DECLARE_FUNCTION(execK2_ExportSetPropertyText);
 
+private:
+
+	static UTexture2D* GenerateThumbnailInternal(TSubclassOf<AActor> ActorClass, const FThumbnailSettings& ThumbnailSettings, UTexture2D* ResourceObject, 
+		const TMap<FString, FString>& Properties, const FInstancedPropertyBag& PropertyBag);
+
+	static FThumbnailRequestHandle GenerateThumbnailAsyncInternal(UClass* ActorClass, const FGenerateThumbnailCallbackNative& Callback, const FThumbnailSettings& ThumbnailSettings,
+		const FPreCaptureThumbnailNative& PreCaptureThumbnail, const FString& PreCaptureIdentity, UTexture2D* ResourceObject, const TMap<FString, FString>& Properties, 
+		const FInstancedPropertyBag& PropertyBag, EThumbnailRequestPriority Priority);
+
+	static UTexture2D* DeliverCoalescedThumbnail(ThumbnailGenerator::FCoalescedThumbnailRequest& Request);
+
 };
\ No newline at end of file
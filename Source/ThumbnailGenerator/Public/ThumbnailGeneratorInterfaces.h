@@ -42,4 +42,38 @@ public:
 	UFUNCTION(BlueprintNativeEvent, Category = "Thumbnail Actor")
 	FTransform GetThumbnailTransform() const;
 
+	/**
+	* Lets the actor supply the bounds the thumbnail camera is framed around, instead of the generator calculating them from the actor's components.
+	* Called after PreCaptureActorThumbnail and the scene simulation. Captures with a CustomActorBounds override don't call it.
+	* 
+	* @param OutBounds The bounds in actor space.
+	* @return          True if OutBounds has been set, false to calculate the bounds from the actor's components.
+	*/
+	UFUNCTION(BlueprintNativeEvent, Category = "Thumbnail Actor")
+	bool GetThumbnailBounds(FBox& OutBounds) const;
+	virtual bool GetThumbnailBounds_Implementation(FBox& OutBounds) const { return false; }
+
+	/**
+	* Lets the actor supply the point the thumbnail camera is centered on. The bounds are grown to be centered on the point, so the whole
+	* actor stays in view (e.g. to keep a character's face in the center of the thumbnail).
+	* 
+	* @param OutFocusPoint The point in actor space.
+	* @return              True if OutFocusPoint has been set, false to center the camera on the bounds.
+	*/
+	UFUNCTION(BlueprintNativeEvent, Category = "Thumbnail Actor")
+	bool GetThumbnailFocusPoint(FVector& OutFocusPoint) const;
+	virtual bool GetThumbnailFocusPoint_Implementation(FVector& OutFocusPoint) const { return false; }
+
+	/**
+	* Called when a pooled thumbnail actor is reused for another capture (see UThumbnailGeneratorSettings::PooledActorClasses).
+	* The properties changed by the previous capture have been restored to the class defaults, and the property overrides of the new capture have been applied.
+	* The actor should update itself and its components to match them, the same way its construction script would, and reset any state which isn't held in properties.
+	* Components which are unregistered or added by the reset are registered afterwards, components changed while registered must update their own render state.
+	* 
+	* @return True if the actor has been reset, false to re-run the construction scripts instead.
+	*/
+	UFUNCTION(BlueprintNativeEvent, Category = "Thumbnail Actor")
+	bool ResetThumbnailActor();
+	virtual bool ResetThumbnailActor_Implementation() { return false; }
+
 };
\ No newline at end of file
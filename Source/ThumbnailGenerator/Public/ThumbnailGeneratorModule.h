@@ -3,6 +3,7 @@
 #pragma once
 
 #include "Modules/ModuleManager.h"
+#include "Containers/Ticker.h"
 #include "Delegates/DelegateCombinations.h"
 #include "Logging/LogMacros.h"
 
@@ -33,4 +34,6 @@ public:
 
 private:
 	void Cleanup();
+
+	FTSTicker::FDelegateHandle DiskCacheTickerHandle;
 };
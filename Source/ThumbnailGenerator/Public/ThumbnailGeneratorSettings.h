@@ -37,6 +37,15 @@ enum class EThumbnailBitDepth : uint8
 	E16	UMETA(DisplayName = "16-bit"),
 };
 
+UENUM(BlueprintType)
+enum class EThumbnailRequestPriority : uint8
+{
+	EHigh		UMETA(DisplayName = "High (Visible)"),
+	ENormal		UMETA(DisplayName = "Normal"),
+	ELow		UMETA(DisplayName = "Low (Prefetch)"),
+	EMAX		UMETA(Hidden),
+};
+
 UENUM(BlueprintType)
 enum class EThumbnailCameraFitMode : uint8
 {
@@ -46,6 +55,16 @@ enum class EThumbnailCameraFitMode : uint8
 	EFitY   UMETA(DisplayName="Fit Y"),
 };
 
+UENUM(BlueprintType)
+enum class EThumbnailBoundsMode : uint8
+{
+	EExact			UMETA(DisplayName = "Exact"),
+	ELowestLOD		UMETA(DisplayName = "Lowest LOD"),
+	EPhysicsAsset	UMETA(DisplayName = "Physics Asset"),
+	ERenderBounds	UMETA(DisplayName = "Render Bounds"),
+	ESampled		UMETA(DisplayName = "Sampled Vertices"),
+};
+
 USTRUCT(BlueprintType, meta=(HiddenByDefault))
 struct THUMBNAILGENERATOR_API FThumbnailSettings
 {
@@ -138,6 +157,12 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category=Overrides, meta=(PinHiddenByDefault, InlineEditConditionToggle))
 	uint8 bOverride_bIncludeHiddenComponentsInBounds:1;
 
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category=Overrides, meta=(PinHiddenByDefault, InlineEditConditionToggle))
+	uint8 bOverride_BoundsMode:1;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category=Overrides, meta=(PinHiddenByDefault, InlineEditConditionToggle))
+	uint8 bOverride_BoundsSampleCount:1;
+
 
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category=Overrides, meta=(PinHiddenByDefault, InlineEditConditionToggle))
 	uint8 bOverride_DirectionalLightRotation:1;
@@ -307,6 +332,19 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Thumbnail Actor", meta=(EditCondition = "bOverride_bIncludeHiddenComponentsInBounds"))
 	bool bIncludeHiddenComponentsInBounds;
 
+	// How the bounds of skinned meshes are calculated for framing, other components always use their render bounds.
+	// Exact:            Skins every vertex of LOD 0 in the current pose.
+	// Lowest LOD:       Skins every vertex of the lowest detail LOD, close to exact for a fraction of the vertices.
+	// Physics Asset:    The bodies of the mesh's physics asset in the current pose, falls back to Exact for meshes without one.
+	// Render Bounds:    The bounds used for culling, cheapest but usually larger than the mesh.
+	// Sampled Vertices: Skins at most Bounds Sample Count evenly spaced vertices of LOD 0, may be slightly smaller than the mesh.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Thumbnail Actor", meta=(EditCondition = "bOverride_BoundsMode"))
+	EThumbnailBoundsMode BoundsMode;
+
+	// The max number of vertices skinned per mesh when Bounds Mode is Sampled Vertices.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Thumbnail Actor", meta=(EditCondition = "bOverride_BoundsSampleCount", ClampMin=1))
+	int32 BoundsSampleCount;
+
 
 	// The rotation of the thumbnail scene directional light.
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Environment", meta=(EditCondition = "bOverride_DirectionalLightRotation"))
@@ -439,6 +477,63 @@ public:
 	UPROPERTY(config, EditAnywhere, BlueprintReadOnly, Category = "Thumbnail Generator", AdvancedDisplay)
 	int32 MaxRenderTargetCacheSize = 50;
 
+	// The max size in MB of generated thumbnails kept around by UThumbnailGeneration::GenerateThumbnail and GenerateThumbnailAsync.
+	// Requests with the same Actor Class, Thumbnail Settings and Properties will return the cached texture without capturing a new thumbnail.
+	// (0 disables the result cache, every request will generate a new texture)
+	UPROPERTY(config, EditAnywhere, BlueprintReadOnly, Category = "Thumbnail Generator", AdvancedDisplay, meta=(ClampMin=0))
+	int32 MaxThumbnailResultCacheSize = 0;
+
+	// How many milliseconds per frame asynchronous thumbnail requests are allowed to take. As many requests as fit in the budget are processed each frame.
+	// Requests that overrun the budget are paid back on the following frames. (0 processes exactly one request per frame)
+	UPROPERTY(config, EditAnywhere, BlueprintReadOnly, Category = "Thumbnail Generator", AdvancedDisplay, meta=(ClampMin=0, Units="ms"))
+	float AsyncFrameBudget = 4.f;
+
+	// Whether generated thumbnails should be stored in a cache on disk (Saved/ThumbnailCache) and reused between sessions.
+	// Thumbnails are keyed on the saved state of the actor's blueprint, the thumbnail settings, the properties and the plugin version.
+	// Requests with a custom PreCapture delegate are never cached.
+	UPROPERTY(config, EditAnywhere, BlueprintReadOnly, Category = "Thumbnail Generator", AdvancedDisplay)
+	bool bEnableThumbnailDiskCache = false;
+
+	// The max size in MB of the on-disk thumbnail cache. When exceeded the least recently used thumbnails are removed.
+	UPROPERTY(config, EditAnywhere, BlueprintReadOnly, Category = "Thumbnail Generator", AdvancedDisplay, meta=(ClampMin=1, EditCondition="bEnableThumbnailDiskCache"))
+	int32 MaxThumbnailDiskCacheSize = 256;
+
+	// The max number of captures GenerateActorThumbnailsBatch keeps in flight while their pixels are read back from the GPU.
+	// Each capture in flight uses its own render target (two if the alpha is captured). Set to 1 to disable pipelining.
+	UPROPERTY(config, EditAnywhere, BlueprintReadOnly, Category = "Thumbnail Generator", AdvancedDisplay, meta=(ClampMin=1, ClampMax=16))
+	int32 MaxCapturesInFlight = 3;
+
+	// The max size in MB of thumbnail textures handed back with UThumbnailGeneration::ReleaseThumbnail which are kept for reuse.
+	// New thumbnails of the same size and bit depth reuse a released texture instead of creating a new UTexture2D. (0 disables texture pooling)
+	UPROPERTY(config, EditAnywhere, BlueprintReadOnly, Category = "Thumbnail Generator", AdvancedDisplay, meta=(ClampMin=0))
+	int32 MaxPooledThumbnailTextureSize = 32;
+
+	// Actor classes (and their child classes) whose thumbnail actors are kept in the thumbnail world and reused for the next capture of the same class,
+	// instead of being spawned and destroyed for every capture. When a capture is done, every non-transient property of the actor and its components which differs from
+	// the class defaults (or the component templates) is restored. References to the actor's own subobjects, such as attachments, are not restored. The actor is then reset for the
+	// next capture with IThumbnailActorInterface::ResetThumbnailActor, or by re-running its construction scripts. Actors which were simulated, had instanced (subobject) properties
+	// overridden, were given components at runtime, or were passed to a PreCapture delegate, are not reused.
+	UPROPERTY(config, EditAnywhere, BlueprintReadOnly, Category = "Thumbnail Generator", AdvancedDisplay)
+	TArray<TSoftClassPtr<AActor>> PooledActorClasses;
+
+	// The max number of idle actors kept for reuse, one per actor class. When exceeded the least recently used actor is destroyed.
+	UPROPERTY(config, EditAnywhere, BlueprintReadOnly, Category = "Thumbnail Generator", AdvancedDisplay, meta=(ClampMin=0))
+	int32 MaxPooledThumbnailActors = 8;
+
+	// The max number of actor bounds, and camera views framed from them, remembered between captures. Captures of the same Actor Class with the same
+	// Properties, simulation settings and scripts reuse the bounds instead of computing them from the actor's components (skinning every vertex of skeletal meshes).
+	// Requests with a custom PreCapture delegate, or whose actor is modified between BeginGenerateActorThumbnail and FinishGenerateActorThumbnail, are never cached.
+	// Set to 0 if the bounds of your thumbnail actors depend on anything else, e.g. random values or the state of the world. (0 disables the bounds cache)
+	UPROPERTY(config, EditAnywhere, BlueprintReadOnly, Category = "Thumbnail Generator", AdvancedDisplay, meta=(ClampMin=0))
+	int32 MaxThumbnailBoundsCacheSize = 1024;
+
+	// Actor bounds calculated ahead of time by the ThumbnailPrecomputeBounds commandlet (-run=ThumbnailPrecomputeBounds), used by cooked builds so that
+	// the first capture of an actor class doesn't have to calculate its bounds. Only captures with the settings the bounds were calculated with (the
+	// default settings) and without Properties use them, any other capture calculates the bounds as usual.
+	// The asset is not referenced by anything else, make sure it is cooked (e.g. with the Asset Manager or "Additional Asset Directories to Cook").
+	UPROPERTY(config, EditAnywhere, BlueprintReadOnly, Category = "Thumbnail Generator", AdvancedDisplay)
+	TSoftObjectPtr<class UThumbnailPrecomputedBounds> PrecomputedThumbnailBounds;
+
 public:
 
 	static const TArray<FName> &GetPresetList();
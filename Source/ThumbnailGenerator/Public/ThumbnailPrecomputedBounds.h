@@ -0,0 +1,43 @@
+// Copyright Mans Isaksson. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/DataAsset.h"
+#include "ThumbnailPrecomputedBounds.generated.h"
+
+class AActor;
+
+// The local bounds of one actor class, calculated in the editor under the default thumbnail settings
+USTRUCT()
+struct THUMBNAILGENERATOR_API FThumbnailPrecomputedActorBounds
+{
+	GENERATED_BODY()
+
+	UPROPERTY(VisibleAnywhere, Category = "Thumbnail Generator")
+	TSoftClassPtr<AActor> ActorClass;
+
+	// The bounds in actor space, see UThumbnailGeneratorSettings::PrecomputedThumbnailBounds
+	UPROPERTY(VisibleAnywhere, Category = "Thumbnail Generator")
+	FBox Bounds = FBox(EForceInit::ForceInit);
+
+	// The bounds key (actor class and the settings which affect the bounds) the bounds were calculated for, a capture only uses the bounds if its key matches
+	UPROPERTY()
+	uint64 BoundsKeyHigh = 0;
+
+	UPROPERTY()
+	uint64 BoundsKeyLow = 0;
+};
+
+// Thumbnail bounds of actor blueprints, generated by the ThumbnailPrecomputeBounds commandlet.
+// Cooked builds use these bounds for captures which match the settings the bounds were calculated with, instead of calculating the bounds of the spawned actor.
+UCLASS()
+class THUMBNAILGENERATOR_API UThumbnailPrecomputedBounds : public UDataAsset
+{
+	GENERATED_BODY()
+
+public:
+
+	UPROPERTY(VisibleAnywhere, Category = "Thumbnail Generator")
+	TArray<FThumbnailPrecomputedActorBounds> ActorBounds;
+};
@@ -20,7 +20,8 @@ public class ThumbnailGenerator : ModuleRules
 			"Slate",
             "RHI",
             "UMG",
-            "RenderCore"
+            "RenderCore",
+            "Projects"
         });
 
         if (Target.bBuildEditor == true)
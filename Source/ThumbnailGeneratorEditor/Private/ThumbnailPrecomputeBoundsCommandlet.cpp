@@ -0,0 +1,173 @@
+// Copyright Mans Isaksson. All Rights Reserved.
+
+#include "ThumbnailPrecomputeBoundsCommandlet.h"
+#include "ThumbnailGeneratorEditor.h"
+#include "ThumbnailGeneratorSettings.h"
+#include "ThumbnailPrecomputedBounds.h"
+#include "ThumbnailGenerator.h"
+
+#include "AssetRegistry/AssetRegistryModule.h"
+#include "Engine/Blueprint.h"
+#include "Misc/PackageName.h"
+#include "UObject/SavePackage.h"
+
+namespace ThumbnailPrecomputeBoundsHelpers
+{
+	static const TCHAR* DefaultOutputPackage = TEXT("/Game/ThumbnailGenerator/ThumbnailPrecomputedBounds");
+
+	// Blueprints are loaded one at a time, collect the ones which have been processed every now and then
+	static constexpr int32 GarbageCollectionInterval = 64;
+
+	bool IsActorBlueprint(const FAssetData& Asset)
+	{
+		// Check the Native Class to avoid loading blueprints which aren't actors
+		const auto NativeParentClassPath = Asset.TagsAndValues.FindTag("NativeParentClass");
+		return NativeParentClassPath.IsSet() && FSoftClassPath(NativeParentClassPath.GetValue()).TryLoadClass<AActor>() != nullptr;
+	}
+}
+
+UThumbnailPrecomputeBoundsCommandlet::UThumbnailPrecomputeBoundsCommandlet()
+{
+	IsClient       = false;
+	IsEditor       = true;
+	IsServer       = false;
+	LogToConsole   = true;
+	ShowErrorCount = true;
+}
+
+int32 UThumbnailPrecomputeBoundsCommandlet::Main(const FString& Params)
+{
+	using namespace ThumbnailPrecomputeBoundsHelpers;
+
+	TArray<FString> Tokens;
+	TArray<FString> Switches;
+	TMap<FString, FString> ParamValues;
+	ParseCommandLine(*Params, Tokens, Switches, ParamValues);
+
+	UThumbnailGeneratorSettings* Settings = UThumbnailGeneratorSettings::Get();
+
+	TArray<FString> SearchPaths;
+	if (const FString* PathsParam = ParamValues.Find(TEXT("Paths")))
+		PathsParam->ParseIntoArray(SearchPaths, TEXT("+"));
+
+	if (SearchPaths.Num() == 0)
+		SearchPaths.Add(TEXT("/Game"));
+
+	const FString OutputPackage = [&]()
+	{
+		if (const FString* OutputParam = ParamValues.Find(TEXT("Output")))
+			return *OutputParam;
+
+		const FString SettingsPackage = Settings->PrecomputedThumbnailBounds.ToSoftObjectPath().GetLongPackageName();
+		return SettingsPackage.IsEmpty() ? FString(DefaultOutputPackage) : SettingsPackage;
+	}();
+
+	FText PackageNameError;
+	if (!FPackageName::IsValidLongPackageName(OutputPackage, false, &PackageNameError))
+	{
+		UE_LOG(LogThumbnailGeneratorEd, Error, TEXT("ThumbnailPrecomputeBounds - Invalid output package %s (%s)"), *OutputPackage, *PackageNameError.ToString());
+		return 1;
+	}
+
+	if (GThumbnailGenerator == nullptr)
+	{
+		UE_LOG(LogThumbnailGeneratorEd, Error, TEXT("ThumbnailPrecomputeBounds - The thumbnail generator has not been created"));
+		return 1;
+	}
+
+	IAssetRegistry& AssetRegistry = FAssetRegistryModule::GetRegistry();
+	AssetRegistry.SearchAllAssets(true);
+
+	FARFilter Filter;
+	Filter.ClassPaths.Add(UBlueprint::StaticClass()->GetClassPathName());
+	Filter.bRecursiveClasses = true;
+	Filter.bRecursivePaths   = true;
+	for (const FString& SearchPath : SearchPaths)
+		Filter.PackagePaths.Add(FName(*SearchPath));
+
+	TArray<FAssetData> Assets;
+	AssetRegistry.GetAssets(Filter, Assets);
+
+	// The same settings a capture without overrides is merged with
+	const FThumbnailSettings ThumbnailSettings = FThumbnailSettings::MergeThumbnailSettings(Settings->DefaultThumbnailSettings, FThumbnailSettings());
+	if (ThumbnailSettings.bDebugBounds)
+		UE_LOG(LogThumbnailGeneratorEd, Warning, TEXT("ThumbnailPrecomputeBounds - bDebugBounds is set in the default thumbnail settings, the precomputed bounds will not be used"));
+
+	TArray<FThumbnailPrecomputedActorBounds> ActorBounds;
+	int32 NumFailed = 0;
+	int32 NumLoaded = 0;
+
+	for (const FAssetData& Asset : Assets)
+	{
+		if (!IsActorBlueprint(Asset))
+			continue;
+
+		const UBlueprint* Blueprint = Cast<UBlueprint>(Asset.GetAsset());
+		UClass* const ActorClass = Blueprint ? Blueprint->GeneratedClass.Get() : nullptr;
+		if (!ActorClass || !ActorClass->IsChildOf<AActor>() || ActorClass->HasAnyClassFlags(CLASS_Abstract | CLASS_Deprecated | CLASS_NewerVersionExists))
+			continue;
+
+		FThumbnailPrecomputedActorBounds Bounds;
+		if (GThumbnailGenerator->CalculateActorThumbnailBounds(ActorClass, ThumbnailSettings, Bounds) && Bounds.Bounds.IsValid)
+		{
+			UE_LOG(LogThumbnailGeneratorEd, Display, TEXT("ThumbnailPrecomputeBounds - %s: %s"), *ActorClass->GetPathName(), *Bounds.Bounds.ToString());
+			ActorBounds.Add(MoveTemp(Bounds));
+		}
+		else
+		{
+			UE_LOG(LogThumbnailGeneratorEd, Warning, TEXT("ThumbnailPrecomputeBounds - Could not calculate the bounds of %s"), *ActorClass->GetPathName());
+			NumFailed++;
+		}
+
+		if (++NumLoaded % GarbageCollectionInterval == 0)
+			CollectGarbage(RF_NoFlags);
+	}
+
+	// Keep the asset stable between runs, so that it only changes when the bounds do
+	ActorBounds.Sort([](const FThumbnailPrecomputedActorBounds& A, const FThumbnailPrecomputedActorBounds& B)
+	{
+		return A.ActorClass.ToSoftObjectPath().ToString() < B.ActorClass.ToSoftObjectPath().ToString();
+	});
+
+	UPackage* Package = CreatePackage(*OutputPackage);
+	if (!Package)
+	{
+		UE_LOG(LogThumbnailGeneratorEd, Error, TEXT("ThumbnailPrecomputeBounds - Failed to create package %s"), *OutputPackage);
+		return 1;
+	}
+
+	Package->FullyLoad();
+
+	const FString AssetName = FPackageName::GetShortName(OutputPackage);
+	UThumbnailPrecomputedBounds* PrecomputedBounds = FindObject<UThumbnailPrecomputedBounds>(Package, *AssetName);
+	if (!PrecomputedBounds)
+	{
+		PrecomputedBounds = NewObject<UThumbnailPrecomputedBounds>(Package, *AssetName, RF_Public | RF_Standalone);
+		FAssetRegistryModule::AssetCreated(PrecomputedBounds);
+	}
+
+	PrecomputedBounds->ActorBounds = MoveTemp(ActorBounds);
+	PrecomputedBounds->MarkPackageDirty();
+
+	FSavePackageArgs SaveArgs;
+	SaveArgs.TopLevelFlags = RF_Public | RF_Standalone;
+	SaveArgs.SaveFlags     = SAVE_NoError;
+
+	const FString Filename = FPackageName::LongPackageNameToFilename(OutputPackage, FPackageName::GetAssetPackageExtension());
+	if (!UPackage::SavePackage(Package, PrecomputedBounds, *Filename, SaveArgs))
+	{
+		UE_LOG(LogThumbnailGeneratorEd, Error, TEXT("ThumbnailPrecomputeBounds - Failed to save %s"), *Filename);
+		return 1;
+	}
+
+	if (Settings->PrecomputedThumbnailBounds.IsNull())
+	{
+		Settings->PrecomputedThumbnailBounds = PrecomputedBounds;
+		Settings->TryUpdateDefaultConfigFile();
+	}
+
+	UE_LOG(LogThumbnailGeneratorEd, Display, TEXT("ThumbnailPrecomputeBounds - Saved the bounds of %d actor blueprints to %s (%d failed)"), PrecomputedBounds->ActorBounds.Num(), *OutputPackage, NumFailed);
+
+	// Classes which failed keep calculating their bounds at runtime, so they don't fail the commandlet
+	return 0;
+}
@@ -0,0 +1,26 @@
+// Copyright Mans Isaksson. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "ThumbnailPrecomputeBoundsCommandlet.generated.h"
+
+// Calculates the thumbnail bounds of every actor blueprint under the default thumbnail settings, and saves them to a UThumbnailPrecomputedBounds asset
+// which cooked builds use instead of calculating the bounds at runtime (see UThumbnailGeneratorSettings::PrecomputedThumbnailBounds).
+// Meant to be run before cooking, so that the bounds match the cooked blueprints.
+//
+// Usage: UnrealEditor-Cmd.exe <Project> -run=ThumbnailPrecomputeBounds [-Paths=/Game/A+/Game/B] [-Output=/Game/Path/AssetName]
+//   -Paths  Content paths to search for actor blueprints, /Game by default.
+//   -Output Package of the asset, the PrecomputedThumbnailBounds setting by default. The setting is set to the asset if it is empty.
+UCLASS()
+class UThumbnailPrecomputeBoundsCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+
+	UThumbnailPrecomputeBoundsCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+};
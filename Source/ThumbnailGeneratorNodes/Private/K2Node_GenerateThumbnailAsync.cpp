@@ -4,6 +4,9 @@
 #include "K2Node_CustomEvent.h"
 #include "K2Node_CallFunction.h"
 #include "K2Node_MakeMap.h"
+#include "K2Node_MakeArray.h"
+#include "K2Node_TemporaryVariable.h"
+#include "K2Node_AssignmentStatement.h"
 #include "K2Node_DynamicCast.h"
 #include "KismetCompiler.h"
 #include "BlueprintNodeSpawner.h"
@@ -11,12 +14,15 @@
 #include "BlueprintCompilationManager.h"
 #include "Kismet2/BlueprintEditorUtils.h"
 #include "ThumbnailGenerator.h"
+#include "StructUtils/PropertyBag.h"
 
 #define LOCTEXT_NAMESPACE "K2Node_GenerateThumbnailAsync"
 
 namespace K2Node_GenerateThumbnail
 {
-	const TCHAR* CallbackPinName = TEXT("Callback");
+	const TCHAR* CallbackPinName      = TEXT("Callback");
+	const TCHAR* PriorityPinName      = TEXT("Priority");
+	const TCHAR* RequestHandlePinName = TEXT("RequestHandle");
 }
 
 void UK2Node_GenerateThumbnailAsync::AllocateDefaultPins()
@@ -29,6 +35,20 @@ void UK2Node_GenerateThumbnailAsync::AllocateDefaultPins()
 	UEdGraphPin* CallbackPin = CreatePin(EGPD_Output, UEdGraphSchema_K2::PC_Exec, K2Node_GenerateThumbnail::CallbackPinName, PinParams);
 	CallbackPin->PinFriendlyName = LOCTEXT("CallbackPin_Name", "Callback");
 	SetPinToolTip(*CallbackPin, LOCTEXT("CallbackPin_Description", "Executed once the thumbnail has been generated."));
+
+	// Add In Priority Pin
+	UEdGraphPin* PriorityPin = CreatePin(EGPD_Input, UEdGraphSchema_K2::PC_Byte, StaticEnum<EThumbnailRequestPriority>(), K2Node_GenerateThumbnail::PriorityPinName);
+	PriorityPin->PinFriendlyName = LOCTEXT("PriorityPin_Name", "Priority");
+	PriorityPin->DefaultValue    = StaticEnum<EThumbnailRequestPriority>()->GetNameStringByValue((int64)EThumbnailRequestPriority::ENormal);
+	PriorityPin->bAdvancedView   = true;
+	SetPinToolTip(*PriorityPin, LOCTEXT("PriorityPin_Description", "Requests with a higher priority are processed first, requests with the same priority are processed in the order they were made."));
+
+	// Add Request Handle Output Pin
+	FCreatePinParams RequestHandlePinParams;
+	RequestHandlePinParams.Index = Pins.IndexOfByKey(GetThumbnailOutputPin());
+	UEdGraphPin* RequestHandlePin = CreatePin(EGPD_Output, UEdGraphSchema_K2::PC_Struct, FThumbnailRequestHandle::StaticStruct(), K2Node_GenerateThumbnail::RequestHandlePinName, RequestHandlePinParams);
+	RequestHandlePin->PinFriendlyName = LOCTEXT("RequestHandlePin_Name", "Request Handle");
+	SetPinToolTip(*RequestHandlePin, LOCTEXT("RequestHandlePin_Description", "Handle which can be used to cancel the request, change its priority or query its state."));
 }
 
 FText UK2Node_GenerateThumbnailAsync::GetNodeTitle(ENodeTitleType::Type TitleType) const
@@ -76,6 +96,8 @@ void UK2Node_GenerateThumbnailAsync::ExpandNode(class FKismetCompilerContext& Co
 	UEdGraphPin* const OriginalThumbnailSettingsInPin = GetThumbnailSettingsPin();
 	UEdGraphPin* const OriginalClassPin               = GetClassPin();
 	UEdGraphPin* const OriginalActorOutputPin         = GetResultPin();
+	UEdGraphPin* const OriginalPriorityInPin          = FindPinChecked(K2Node_GenerateThumbnail::PriorityPinName);
+	UEdGraphPin* const OriginalRequestHandleOutPin    = FindPinChecked(K2Node_GenerateThumbnail::RequestHandlePinName);
 
 	UClass* SpawnClass = (OriginalClassPin != nullptr) ? Cast<UClass>(OriginalClassPin->DefaultObject) : nullptr;
 	if (!OriginalClassPin || (OriginalClassPin->LinkedTo.Num() == 0 && SpawnClass == nullptr))
@@ -89,19 +111,19 @@ void UK2Node_GenerateThumbnailAsync::ExpandNode(class FKismetCompilerContext& Co
 	// FUNCTION NODE
 	const FName FunctionName = GET_FUNCTION_NAME_CHECKED(UThumbnailGeneration, K2_GenerateThumbnailAsync);
 	UK2Node_CallFunction* const GenerateThumbnailFunctionNode = CompilerContext.SpawnIntermediateNode<UK2Node_CallFunction>(this, SourceGraph);
+	GenerateThumbnailFunctionNode->FunctionReference.SetExternalMember(FunctionName, UThumbnailGeneration::StaticClass());
+	GenerateThumbnailFunctionNode->AllocateDefaultPins();
+
+	// The Exec pin is connected once the property values have been hooked up, they might need to be set up first
+	UEdGraphPin* const FunctionNodeExecPin = GenerateThumbnailFunctionNode->GetExecPin();
 
 	// Connect user function inputs
 	{
-		GenerateThumbnailFunctionNode->FunctionReference.SetExternalMember(FunctionName, UThumbnailGeneration::StaticClass());
-		GenerateThumbnailFunctionNode->AllocateDefaultPins();
-
-		UEdGraphPin* const FunctionNodeExecPin            = GenerateThumbnailFunctionNode->GetExecPin();
 		UEdGraphPin* const FunctionNodeThenPin            = GenerateThumbnailFunctionNode->GetThenPin();
 		UEdGraphPin* const FunctionClassInPin             = GenerateThumbnailFunctionNode->FindPinChecked(ActorClassClassParamName);
 		UEdGraphPin* const FunctionThumbnailSettingsInPin = GenerateThumbnailFunctionNode->FindPinChecked(K2Node_GenerateThumbnail::ThumbnailSettingsPinName);
-
-		// Connect Original Exec pin to function Exec input
-		bIsErrorFree &= CompilerContext.MovePinLinksToIntermediate(*GetExecPin(), *FunctionNodeExecPin).CanSafeConnect();
+		UEdGraphPin* const FunctionPriorityInPin          = GenerateThumbnailFunctionNode->FindPinChecked(K2Node_GenerateThumbnail::PriorityPinName);
+		UEdGraphPin* const FunctionRequestHandleOutPin    = GenerateThumbnailFunctionNode->GetReturnValuePin();
 
 		// Connect Original Then pin to function Then input
 		bIsErrorFree &= CompilerContext.MovePinLinksToIntermediate(*GetThenPin(), *FunctionNodeThenPin).CanSafeConnect();
@@ -111,6 +133,12 @@ void UK2Node_GenerateThumbnailAsync::ExpandNode(class FKismetCompilerContext& Co
 
 		// Connect Original ThumbnailSettings input to function ThumbnailSettings input
 		bIsErrorFree &= CompilerContext.MovePinLinksToIntermediate(*OriginalThumbnailSettingsInPin, *FunctionThumbnailSettingsInPin).CanSafeConnect();
+
+		// Connect Original Priority input to function Priority input
+		bIsErrorFree &= CompilerContext.MovePinLinksToIntermediate(*OriginalPriorityInPin, *FunctionPriorityInPin).CanSafeConnect();
+
+		// Connect function Return Value to Original Request Handle output
+		bIsErrorFree &= CompilerContext.MovePinLinksToIntermediate(*OriginalRequestHandleOutPin, *FunctionRequestHandleOutPin).CanSafeConnect();
 	}
 
 	// Uses K2Node_LoadAsset as reference, look into that function for a more generic approach
@@ -187,8 +215,14 @@ void UK2Node_GenerateThumbnailAsync::ExpandNode(class FKismetCompilerContext& Co
 	// Hook up properties exposed on spawn
 	{
 		static const FName FunctionPropertiesInputName(TEXT("Properties"));
+		static const FName FunctionPropertyBagInputName(TEXT("PropertyBag"));
 		static const FName PropertyExporterPropertyInputName(TEXT("Property"));
 		static const FName PropertyExporterReturnValueName(UEdGraphSchema_K2::PN_ReturnValue);
+		static const FName MakePropertyBagActorClassInputName(TEXT("ActorClass"));
+		static const FName MakePropertyBagNamesInputName(TEXT("PropertyNames"));
+		static const FName SetPropertyBagValueBagInputName(TEXT("PropertyBag"));
+		static const FName SetPropertyBagValueNameInputName(TEXT("PropertyName"));
+		static const FName SetPropertyBagValueValueInputName(TEXT("Value"));
 
 		UClass* ClassToSpawn = GetClassToSpawn();
 
@@ -225,6 +259,16 @@ void UK2Node_GenerateThumbnailAsync::ExpandNode(class FKismetCompilerContext& Co
 			return false;
 		};
 
+		// Property bags can't hold maps, those (and any other type a bag can't represent) are still exported as text
+		const auto CanUsePropertyBag = [&](UEdGraphPin* InPin)
+		{
+			if (InPin->PinType.ContainerType == EPinContainerType::Map)
+				return false;
+
+			const FProperty* Property = ClassToSpawn ? FindFProperty<FProperty>(ClassToSpawn, InPin->PinName) : nullptr;
+			return Property && FPropertyBagPropertyDesc(InPin->PinName, Property).ValueType != EPropertyBagPropertyType::None;
+		};
+
 		const auto SelectPropertyExportTextFunction = [](UEdGraphPin* InPin)->FName
 		{
 			switch (InPin->PinType.ContainerType)
@@ -244,6 +288,23 @@ void UK2Node_GenerateThumbnailAsync::ExpandNode(class FKismetCompilerContext& Co
 			return NAME_None;
 		};
 
+		const auto SelectSetPropertyBagValueFunction = [](UEdGraphPin* InPin)->FName
+		{
+			switch (InPin->PinType.ContainerType)
+			{
+			case EPinContainerType::None:
+				return GET_FUNCTION_NAME_CHECKED(UThumbnailGeneration, K2_SetPropertyBagValue);
+			case EPinContainerType::Array:
+				return GET_FUNCTION_NAME_CHECKED(UThumbnailGeneration, K2_SetPropertyBagArrayValue);
+			case EPinContainerType::Set:
+				return GET_FUNCTION_NAME_CHECKED(UThumbnailGeneration, K2_SetPropertyBagSetValue);
+			default:
+				checkf(0, TEXT("Pin Type Set Property Bag Value Function not defined"));
+			}
+
+			return NAME_None;
+		};
+
 		const auto GetMakeMapIndexNames = [](int32 PinIndex)->TPair<FName, FName>
 		{
 			// Look at UK2Node_MakeMap::GetPinName for reference
@@ -252,6 +313,14 @@ void UK2Node_GenerateThumbnailAsync::ExpandNode(class FKismetCompilerContext& Co
 			return TPair<FName, FName>(*FString::Printf(TEXT("Key %d"), KeyIndex), *FString::Printf(TEXT("Value %d"), ValueIndex));
 		};
 
+		TArray<UEdGraphPin*> PropertyBagPins;
+		TArray<UEdGraphPin*> PropertyTextPins;
+		for (UEdGraphPin* Pin : Pins)
+		{
+			if (IsSpawnVarPin(Pin) && CheckIsValidSpawnVarPin(Pin))
+				(CanUsePropertyBag(Pin) ? PropertyBagPins : PropertyTextPins).Add(Pin);
+		}
+
 		UK2Node_MakeMap* MakeMapNode = CompilerContext.SpawnIntermediateNode<UK2Node_MakeMap>(this, SourceGraph);
 		MakeMapNode->NumInputs = 0;
 		MakeMapNode->AllocateDefaultPins();
@@ -263,13 +332,10 @@ void UK2Node_GenerateThumbnailAsync::ExpandNode(class FKismetCompilerContext& Co
 		// This will set the "Make Map" node's type, only works if one pin is connected.
 		MakeMapNode->PinConnectionListChanged(MapOut); 
 
-		int32 ArgIdx = 0;
 		// Create 'export property text' nodes and hook them up
-		for (int32 PinIdx = 0; PinIdx < Pins.Num(); PinIdx++)
+		for (int32 ArgIdx = 0; ArgIdx < PropertyTextPins.Num(); ArgIdx++)
 		{
-			UEdGraphPin* Pin = Pins[PinIdx];
-			if (!CheckIsValidSpawnVarPin(Pin))
-				continue;
+			UEdGraphPin* Pin = PropertyTextPins[ArgIdx];
 
 			MakeMapNode->AddInputPin();
 
@@ -300,9 +366,81 @@ void UK2Node_GenerateThumbnailAsync::ExpandNode(class FKismetCompilerContext& Co
 			{
 				ValueInputPin->DefaultValue = Pin->GetDefaultAsString();
 			}
+		}
+
+		// Fill a property bag with the values of the remaining pins, the values are copied as they are and never converted to text.
+		// Exec -> MakeThumbnailPropertyBag -> Assign to temporary -> SetPropertyBagValue (per pin) -> GenerateThumbnailAsync
+		UEdGraphPin* PropertiesExecPin = FunctionNodeExecPin;
+		if (PropertyBagPins.Num() > 0)
+		{
+			UK2Node_TemporaryVariable* PropertyBagVariableNode = CompilerContext.SpawnIntermediateNode<UK2Node_TemporaryVariable>(this, SourceGraph);
+			PropertyBagVariableNode->VariableType.PinCategory          = UEdGraphSchema_K2::PC_Struct;
+			PropertyBagVariableNode->VariableType.PinSubCategoryObject = FInstancedPropertyBag::StaticStruct();
+			PropertyBagVariableNode->AllocateDefaultPins();
+
+			UEdGraphPin* const PropertyBagVariablePin = PropertyBagVariableNode->GetVariablePin();
+
+			// The layout of the bag is made from the properties of the class the pins were created for
+			UK2Node_CallFunction* const MakePropertyBagNode = CompilerContext.SpawnIntermediateNode<UK2Node_CallFunction>(this, SourceGraph);
+			MakePropertyBagNode->FunctionReference.SetExternalMember(GET_FUNCTION_NAME_CHECKED(UThumbnailGeneration, K2_MakeThumbnailPropertyBag), UThumbnailGeneration::StaticClass());
+			MakePropertyBagNode->AllocateDefaultPins();
+			MakePropertyBagNode->FindPinChecked(MakePropertyBagActorClassInputName)->DefaultObject = ClassToSpawn;
+
+			UK2Node_MakeArray* MakeNamesNode = CompilerContext.SpawnIntermediateNode<UK2Node_MakeArray>(this, SourceGraph);
+			MakeNamesNode->NumInputs = PropertyBagPins.Num();
+			MakeNamesNode->AllocateDefaultPins();
+
+			UEdGraphPin* const NamesOut = MakeNamesNode->GetOutputPin();
+			bIsErrorFree &= Schema->TryCreateConnection(NamesOut, MakePropertyBagNode->FindPinChecked(MakePropertyBagNamesInputName));
+			MakeNamesNode->PinConnectionListChanged(NamesOut);
+
+			UK2Node_AssignmentStatement* AssignPropertyBagNode = CompilerContext.SpawnIntermediateNode<UK2Node_AssignmentStatement>(this, SourceGraph);
+			AssignPropertyBagNode->AllocateDefaultPins();
+
+			bIsErrorFree &= Schema->TryCreateConnection(PropertyBagVariablePin, AssignPropertyBagNode->GetVariablePin());
+			AssignPropertyBagNode->NotifyPinConnectionListChanged(AssignPropertyBagNode->GetVariablePin());
+			bIsErrorFree &= Schema->TryCreateConnection(MakePropertyBagNode->GetReturnValuePin(), AssignPropertyBagNode->GetValuePin());
+			AssignPropertyBagNode->NotifyPinConnectionListChanged(AssignPropertyBagNode->GetValuePin());
+
+			bIsErrorFree &= Schema->TryCreateConnection(MakePropertyBagNode->GetThenPin(), AssignPropertyBagNode->GetExecPin());
 
-			ArgIdx++;
+			UEdGraphPin* LastThenPin = AssignPropertyBagNode->GetThenPin();
+			for (int32 ArgIdx = 0; ArgIdx < PropertyBagPins.Num(); ArgIdx++)
+			{
+				UEdGraphPin* Pin = PropertyBagPins[ArgIdx];
+
+				// Look at UK2Node_MakeContainer::GetPinName for reference
+				MakeNamesNode->FindPinChecked(*FString::Printf(TEXT("[%d]"), ArgIdx))->DefaultValue = Pin->PinName.ToString();
+
+				UK2Node_CallFunction* const SetValueNode = CompilerContext.SpawnIntermediateNode<UK2Node_CallFunction>(this, SourceGraph);
+				SetValueNode->FunctionReference.SetExternalMember(SelectSetPropertyBagValueFunction(Pin), UThumbnailGeneration::StaticClass());
+				SetValueNode->AllocateDefaultPins();
+
+				UEdGraphPin* const SetValueBagPin   = SetValueNode->FindPinChecked(SetPropertyBagValueBagInputName);
+				UEdGraphPin* const SetValueValuePin = SetValueNode->FindPinChecked(SetPropertyBagValueValueInputName);
+
+				SetValueNode->FindPinChecked(SetPropertyBagValueNameInputName)->DefaultValue = Pin->PinName.ToString();
+				bIsErrorFree &= Schema->TryCreateConnection(PropertyBagVariablePin, SetValueBagPin);
+
+				// The value pin is a wildcard, give it the type of the property so unconnected pins keep their default value
+				const bool bIsLinked = Pin->LinkedTo.Num() > 0;
+				SetValueValuePin->PinType = Pin->PinType;
+				bIsErrorFree &= CompilerContext.MovePinLinksToIntermediate(*Pin, *SetValueValuePin).CanSafeConnect();
+				if (bIsLinked)
+					SetValueNode->PinConnectionListChanged(SetValueValuePin);
+
+				bIsErrorFree &= Schema->TryCreateConnection(LastThenPin, SetValueNode->GetExecPin());
+				LastThenPin = SetValueNode->GetThenPin();
+			}
+
+			bIsErrorFree &= Schema->TryCreateConnection(LastThenPin, FunctionNodeExecPin);
+			bIsErrorFree &= Schema->TryCreateConnection(PropertyBagVariablePin, GenerateThumbnailFunctionNode->FindPinChecked(FunctionPropertyBagInputName));
+
+			PropertiesExecPin = MakePropertyBagNode->GetExecPin();
 		}
+
+		// Connect Original Exec pin to the first node setting up the request
+		bIsErrorFree &= CompilerContext.MovePinLinksToIntermediate(*GetExecPin(), *PropertiesExecPin).CanSafeConnect();
 	}
 
 	if (!bIsErrorFree)
@@ -321,7 +459,9 @@ FName UK2Node_GenerateThumbnailAsync::GetCornerIcon() const
 bool UK2Node_GenerateThumbnailAsync::IsSpawnVarPin(UEdGraphPin* Pin) const
 {
 	return Super::IsSpawnVarPin(Pin) &&
-		Pin->PinName != K2Node_GenerateThumbnail::CallbackPinName;
+		Pin->PinName != K2Node_GenerateThumbnail::CallbackPinName &&
+		Pin->PinName != K2Node_GenerateThumbnail::PriorityPinName &&
+		Pin->PinName != K2Node_GenerateThumbnail::RequestHandlePinName;
 }
 
 #undef LOCTEXT_NAMESPACE
\ No newline at end of file